@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkmain.cpp
+// ============
+// entry point of the CPU kernel and per draw benchmarks
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmarks.h"
+#include "CpuFeatures.h"
+
+#include <iostream>
+#include <cstdlib>
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function runs every benchmark suite and fails when
+ *  any SIMD kernel disagrees with its scalar reference, or
+ *  a per draw path with the one it replaced.  It is run
+ *  from the project directory, like the application.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	bool bPassed = true;
+
+	std::cout << "INFO: Widest instruction set: " << CpuFeatures::GetBestInstructionSetName() << "\n" << std::endl;
+
+	bPassed = RunCullingBenchmarks() && bPassed;
+	bPassed = RunTransformBenchmarks() && bPassed;
+	bPassed = RunDrawStateBenchmarks() && bPassed;
+
+	if (bPassed == false)
+	{
+		std::cout << "ERROR: Benchmarked results differ from their reference" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	return(EXIT_SUCCESS);
+}
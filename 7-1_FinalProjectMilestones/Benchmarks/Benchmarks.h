@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarks.h
+// ============
+// shared helpers for the CPU kernel and per draw benchmarks
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/***********************************************************
+ *  BenchmarkTimer
+ *
+ *  This class measures the wall clock time of one run of a
+ *  benchmarked kernel in milliseconds.
+ ***********************************************************/
+class BenchmarkTimer
+{
+public:
+	BenchmarkTimer() { Start(); }
+
+	void Start() { m_start = std::chrono::high_resolution_clock::now(); }
+
+	double GetElapsedMilliseconds() const
+	{
+		std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::high_resolution_clock::now() - m_start;
+		return(elapsed.count());
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point m_start;
+};
+
+/***********************************************************
+ *  BenchmarkRandom
+ *
+ *  This class is a small deterministic random generator so
+ *  every run benchmarks the same synthetic data.
+ ***********************************************************/
+class BenchmarkRandom
+{
+public:
+	explicit BenchmarkRandom(uint32_t seed) : m_state(seed ? seed : 1u) {}
+
+	// uniform value in [minValue, maxValue)
+	float Range(float minValue, float maxValue)
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return(minValue + (maxValue - minValue) * ((m_state >> 8) * (1.0f / 16777216.0f)));
+	}
+
+private:
+	uint32_t m_state;
+};
+
+// benchmark suites - each returns false when a kernel
+// produced results different from the scalar reference,
+// or a new path from the old one
+bool RunCullingBenchmarks();
+bool RunTransformBenchmarks();
+bool RunDrawStateBenchmarks();
@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+// cullingbenchmark.cpp
+// ============
+// benchmark of the scalar, SSE2 and AVX2 frustum culling kernels, and of the
+// fastest kernel split across the job system threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmarks.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// object counts benchmarked, from a dense scene up to the
+	// counts where culling dominates the frame
+	const size_t g_ObjectCounts[] = { 1000, 10000, 100000, 1000000 };
+	// minimum measured time per kernel and object count
+	const double g_MinimumMilliseconds = 200.0;
+	// half size of the cube the synthetic objects are spread in
+	const float g_WorldExtent = 500.0f;
+
+	/***********************************************************
+	 *  FillBounds()
+	 *
+	 *  This function is used for filling the culler with the
+	 *  passed in number of randomly placed boxes.
+	 ***********************************************************/
+	void FillBounds(FrustumCuller& culler, size_t count)
+	{
+		BenchmarkRandom random(12345u);
+
+		culler.ClearBounds();
+		culler.ReserveBounds(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			glm::vec3 center(
+				random.Range(-g_WorldExtent, g_WorldExtent),
+				random.Range(-g_WorldExtent, g_WorldExtent),
+				random.Range(-g_WorldExtent, g_WorldExtent));
+			glm::vec3 extents(
+				random.Range(0.1f, 5.0f),
+				random.Range(0.1f, 5.0f),
+				random.Range(0.1f, 5.0f));
+			culler.AddBounds(center, extents);
+		}
+	}
+
+	/***********************************************************
+	 *  MeasureKernel()
+	 *
+	 *  This function is used for running one kernel repeatedly
+	 *  and returning the best time of a single run, split into
+	 *  jobs when a job system is passed in.
+	 ***********************************************************/
+	double MeasureKernel(
+		const FrustumCuller& culler,
+		FrustumCuller::CULL_PATH cullPath,
+		JobSystem* pJobSystem,
+		std::vector<uint32_t>& visibleIndices)
+	{
+		double bestMilliseconds = 0.0;
+		double totalMilliseconds = 0.0;
+		int runs = 0;
+
+		while ((runs < 3) || (totalMilliseconds < g_MinimumMilliseconds))
+		{
+			BenchmarkTimer timer;
+			if (pJobSystem != NULL)
+			{
+				culler.CullBounds(visibleIndices, *pJobSystem, cullPath);
+			}
+			else
+			{
+				culler.CullBounds(visibleIndices, cullPath);
+			}
+			double elapsed = timer.GetElapsedMilliseconds();
+
+			if ((runs == 0) || (elapsed < bestMilliseconds))
+			{
+				bestMilliseconds = elapsed;
+			}
+			totalMilliseconds += elapsed;
+			runs++;
+		}
+
+		return(bestMilliseconds);
+	}
+}
+
+/***********************************************************
+ *  RunCullingBenchmarks()
+ *
+ *  This function is used for benchmarking every supported
+ *  culling kernel against the scalar kernel for each object
+ *  count, then the fastest kernel on all the job threads,
+ *  and verifying that the visible lists are equal.
+ ***********************************************************/
+bool RunCullingBenchmarks()
+{
+	const FrustumCuller::CULL_PATH paths[] = {
+		FrustumCuller::CULL_PATH_SCALAR,
+		FrustumCuller::CULL_PATH_SSE2,
+		FrustumCuller::CULL_PATH_AVX2 };
+	bool bPassed = true;
+
+	FrustumCuller culler;
+	JobSystem jobSystem;
+	glm::mat4 view = glm::lookAt(
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1.25f, 0.1f, 1000.0f);
+	culler.SetFrustum(projection * view);
+
+	std::cout << "=== Frustum culling ===" << std::endl;
+	std::cout << std::setw(10) << "objects"
+		<< std::setw(10) << "kernel"
+		<< std::setw(12) << "ms"
+		<< std::setw(12) << "ns/object"
+		<< std::setw(10) << "speedup"
+		<< std::setw(10) << "visible" << std::endl;
+
+	for (size_t count : g_ObjectCounts)
+	{
+		std::vector<uint32_t> referenceIndices;
+		std::vector<uint32_t> visibleIndices;
+		double scalarMilliseconds = 0.0;
+
+		FillBounds(culler, count);
+
+		for (FrustumCuller::CULL_PATH cullPath : paths)
+		{
+			if (FrustumCuller::IsPathSupported(cullPath) == false)
+			{
+				continue;
+			}
+
+			double milliseconds = MeasureKernel(culler, cullPath, NULL, visibleIndices);
+			if (cullPath == FrustumCuller::CULL_PATH_SCALAR)
+			{
+				scalarMilliseconds = milliseconds;
+				referenceIndices = visibleIndices;
+			}
+			else if (visibleIndices != referenceIndices)
+			{
+				std::cout << "ERROR: " << FrustumCuller::GetPathName(cullPath)
+					<< " visible list differs from scalar for " << count << " objects" << std::endl;
+				bPassed = false;
+			}
+
+			std::cout << std::setw(10) << count
+				<< std::setw(10) << FrustumCuller::GetPathName(cullPath)
+				<< std::setw(12) << std::fixed << std::setprecision(3) << milliseconds
+				<< std::setw(12) << std::setprecision(2) << (milliseconds * 1000000.0 / count)
+				<< std::setw(9) << std::setprecision(2) << (scalarMilliseconds / milliseconds) << "x"
+				<< std::setw(10) << visibleIndices.size() << std::endl;
+		}
+
+		FrustumCuller::CULL_PATH autoPath = culler.GetAutoPath();
+		double milliseconds = MeasureKernel(culler, autoPath, &jobSystem, visibleIndices);
+		if (visibleIndices != referenceIndices)
+		{
+			std::cout << "ERROR: " << FrustumCuller::GetPathName(autoPath)
+				<< " on " << jobSystem.GetThreadCount() << " threads visible list differs from scalar for "
+				<< count << " objects" << std::endl;
+			bPassed = false;
+		}
+
+		std::cout << std::setw(10) << count
+			<< std::setw(6) << FrustumCuller::GetPathName(autoPath) << " x" << std::setw(2) << jobSystem.GetThreadCount()
+			<< std::setw(12) << std::fixed << std::setprecision(3) << milliseconds
+			<< std::setw(12) << std::setprecision(2) << (milliseconds * 1000000.0 / count)
+			<< std::setw(9) << std::setprecision(2) << (scalarMilliseconds / milliseconds) << "x"
+			<< std::setw(10) << visibleIndices.size() << std::endl;
+	}
+	std::cout << std::endl;
+
+	return(bPassed);
+}
@@ -0,0 +1,473 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawstatebenchmark.cpp
+// ============
+// benchmark of the scene manager methods called for every draw, and of
+// loading textures, each timed on its old path and on the path replacing it
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>
+
+#include "Benchmarks.h"
+#include "HeadlessContext.h"
+#include "SceneFile.h"
+#include "SceneManager.h"
+#include "ShaderManager.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// copies of the patio scene benchmarked, from the scene
+	// itself to a large replicated scene
+	const int g_SceneCopies[] = { 1, 100, 1000 };
+	const float g_CopySpacing = 40.0f;
+	// minimum measured time per path and scene size
+	const double g_MinimumMilliseconds = 200.0;
+	// scene read from the project directory, and the asset pack
+	// SceneCompiler bakes from it
+	const char* g_SceneFile = "scenes/patio.scene";
+	const char* g_PackFile = "scenes/patio.pack";
+	// uniform names the shader manager looks up on every call
+	const char* g_ColorValueName = "objectColor";
+	const char* g_UseTextureName = "bUseTexture";
+
+	// results of the lookups are added up here, so they are
+	// not optimized away
+	volatile int g_ResultSink = 0;
+
+	/***********************************************************
+	 *  MeasureLoop()
+	 *
+	 *  This function is used for running a loop over the draws
+	 *  repeatedly and returning the best time of a single run.
+	 ***********************************************************/
+	template <typename LOOP>
+	double MeasureLoop(LOOP loop)
+	{
+		double bestMilliseconds = 0.0;
+		double totalMilliseconds = 0.0;
+		int runs = 0;
+
+		while ((runs < 3) || (totalMilliseconds < g_MinimumMilliseconds))
+		{
+			BenchmarkTimer timer;
+			loop();
+			double elapsed = timer.GetElapsedMilliseconds();
+
+			if ((runs == 0) || (elapsed < bestMilliseconds))
+			{
+				bestMilliseconds = elapsed;
+			}
+			totalMilliseconds += elapsed;
+			runs++;
+		}
+
+		return(bestMilliseconds);
+	}
+
+	/***********************************************************
+	 *  ReportPath()
+	 *
+	 *  This function is used for printing the time of one path
+	 *  and its speedup over the old path of the function.
+	 ***********************************************************/
+	void ReportPath(
+		const char* pFunction,
+		const char* pPath,
+		size_t calls,
+		double milliseconds,
+		double oldMilliseconds)
+	{
+		std::cout << std::setw(20) << pFunction
+			<< std::setw(12) << pPath
+			<< std::setw(10) << calls
+			<< std::setw(12) << std::fixed << std::setprecision(3) << milliseconds
+			<< std::setw(14) << std::setprecision(1) << (milliseconds * 1000000.0 / calls)
+			<< std::setw(9) << std::setprecision(2) << (oldMilliseconds / milliseconds) << "x"
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  ReportHeader()
+	 *
+	 *  This function is used for printing the column names.
+	 ***********************************************************/
+	void ReportHeader()
+	{
+		std::cout << std::setw(20) << "function"
+			<< std::setw(12) << "path"
+			<< std::setw(10) << "calls"
+			<< std::setw(12) << "ms"
+			<< std::setw(14) << "ns/call"
+			<< std::setw(10) << "speedup" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  DrawStateBenchmark
+ *
+ *  This class times the private per draw methods of the
+ *  scene manager, which it is a friend of.  The old paths
+ *  look textures and materials up by tag and set every
+ *  value as a uniform, the new paths use the slots and
+ *  indices resolved when the objects were added and write
+ *  the draw data buffer.
+ ***********************************************************/
+class DrawStateBenchmark
+{
+public:
+	static bool RunScene(ShaderManager* pShaderManager, int copies);
+	static bool RunTextureLoads(ShaderManager* pShaderManager);
+};
+
+/***********************************************************
+ *  RunScene()
+ *
+ *  This method is used for preparing the scene repeated the
+ *  passed in number of times and timing each per draw
+ *  method over all of its objects.  The slots and materials
+ *  of the new paths are checked against the tag lookups.
+ ***********************************************************/
+bool DrawStateBenchmark::RunScene(ShaderManager* pShaderManager, int copies)
+{
+	bool bPassed = true;
+
+	SceneManager* pScene = new SceneManager(pShaderManager);
+	SceneManager& scene = *pScene;
+	scene.SetSceneFile(g_SceneFile);
+	scene.SetSceneCopies(copies, g_CopySpacing);
+	scene.PrepareScene();
+	pShaderManager->use();
+
+	const std::vector<ENTITY>& entities = scene.m_renderEntities;
+	size_t draws = entities.size();
+	std::vector<SceneManager::DRAW_DATA> drawData(draws);
+
+	std::cout << "=== Per draw state, " << draws << " objects ===" << std::endl;
+	ReportHeader();
+
+	// the model matrix composed from the transformation values,
+	// or the one the transform batch and hierarchy composed
+	double oldMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				const TRANSFORM_COMPONENT& transform = scene.m_registry.Get<TRANSFORM_COMPONENT>(entity);
+				scene.SetTransformations(transform.scaleXYZ, transform.rotationDegrees.x,
+					transform.rotationDegrees.y, transform.rotationDegrees.z, transform.positionXYZ);
+			}
+		});
+	double newMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				const TRANSFORM_COMPONENT& transform = scene.m_registry.Get<TRANSFORM_COMPONENT>(entity);
+				glUniformMatrix4fv(scene.m_uniforms.model, 1, GL_FALSE, glm::value_ptr(transform.modelMatrix));
+			}
+		});
+	ReportPath("SetTransformations", "glm", draws, oldMilliseconds, oldMilliseconds);
+	ReportPath("", "composed", draws, newMilliseconds, oldMilliseconds);
+
+	// the texture slot by tag or resolved when added
+	oldMilliseconds = MeasureLoop([&]()
+		{
+			int sum = 0;
+			for (ENTITY entity : entities)
+			{
+				const TEXTURE_COMPONENT* pTexture = scene.m_registry.Find<TEXTURE_COMPONENT>(entity);
+				if (pTexture != NULL)
+				{
+					sum += scene.FindTextureSlot(pTexture->textureTag);
+				}
+			}
+			g_ResultSink += sum;
+		});
+	newMilliseconds = MeasureLoop([&]()
+		{
+			int sum = 0;
+			for (ENTITY entity : entities)
+			{
+				sum += scene.GetTextureSlot(entity);
+			}
+			g_ResultSink += sum;
+		});
+	ReportPath("FindTextureSlot", "tag", draws, oldMilliseconds, oldMilliseconds);
+	ReportPath("", "component", draws, newMilliseconds, oldMilliseconds);
+
+	// the material by tag or by the index resolved when added
+	oldMilliseconds = MeasureLoop([&]()
+		{
+			SceneManager::OBJECT_MATERIAL material;
+			float sum = 0.0f;
+			for (ENTITY entity : entities)
+			{
+				scene.FindMaterial(scene.m_registry.Get<MATERIAL_COMPONENT>(entity).materialTag, material);
+				sum += material.shininess;
+			}
+			g_ResultSink += (int)sum;
+		});
+	newMilliseconds = MeasureLoop([&]()
+		{
+			float sum = 0.0f;
+			for (ENTITY entity : entities)
+			{
+				int materialIndex = scene.m_registry.Get<MATERIAL_COMPONENT>(entity).materialIndex;
+				sum += scene.m_objectMaterials[materialIndex].shininess;
+			}
+			g_ResultSink += (int)sum;
+		});
+	ReportPath("FindMaterial", "tag", draws, oldMilliseconds, oldMilliseconds);
+	ReportPath("", "index", draws, newMilliseconds, oldMilliseconds);
+
+	// the material values as uniforms, or only its index in the
+	// draw data, with the values in the material buffer
+	oldMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				scene.SetShaderMaterial(scene.m_registry.Get<MATERIAL_COMPONENT>(entity).materialTag);
+			}
+		});
+	newMilliseconds = MeasureLoop([&]()
+		{
+			for (size_t i = 0; i < draws; i++)
+			{
+				drawData[i].materialIndex = scene.m_registry.Get<MATERIAL_COMPONENT>(entities[i]).materialIndex;
+			}
+		});
+	ReportPath("SetShaderMaterial", "uniforms", draws, oldMilliseconds, oldMilliseconds);
+	ReportPath("", "draw data", draws, newMilliseconds, oldMilliseconds);
+
+	// the object color set by name through the shader manager,
+	// or at the locations looked up once
+	oldMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				const glm::vec4& color = scene.m_registry.Get<MATERIAL_COMPONENT>(entity).color;
+				pShaderManager->setBoolValue(g_UseTextureName, false);
+				pShaderManager->setVec4Value(g_ColorValueName, color);
+			}
+		});
+	newMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				const glm::vec4& color = scene.m_registry.Get<MATERIAL_COMPONENT>(entity).color;
+				scene.SetShaderColor(color.r, color.g, color.b, color.a);
+			}
+		});
+	ReportPath("uniform setters", "by name", draws, oldMilliseconds, oldMilliseconds);
+	ReportPath("", "location", draws, newMilliseconds, oldMilliseconds);
+
+	// everything an object draws with, set the way the objects
+	// were drawn before the draw data buffer, or written into it
+	oldMilliseconds = MeasureLoop([&]()
+		{
+			for (ENTITY entity : entities)
+			{
+				const TRANSFORM_COMPONENT& transform = scene.m_registry.Get<TRANSFORM_COMPONENT>(entity);
+				const MATERIAL_COMPONENT& material = scene.m_registry.Get<MATERIAL_COMPONENT>(entity);
+				const TEXTURE_COMPONENT* pTexture = scene.m_registry.Find<TEXTURE_COMPONENT>(entity);
+				scene.SetTransformations(transform.scaleXYZ, transform.rotationDegrees.x,
+					transform.rotationDegrees.y, transform.rotationDegrees.z, transform.positionXYZ);
+				scene.SetShaderColor(material.color.r, material.color.g, material.color.b, material.color.a);
+				if (pTexture != NULL)
+				{
+					scene.SetShaderTexture(pTexture->textureTag);
+				}
+				scene.SetShaderMaterial(material.materialTag);
+			}
+		});
+	if (scene.m_drawDataRing.IsCreated() == true)
+	{
+		newMilliseconds = MeasureLoop([&]()
+			{
+				scene.BeginDrawData();
+				for (ENTITY entity : entities)
+				{
+					const TRANSFORM_COMPONENT& transform = scene.m_registry.Get<TRANSFORM_COMPONENT>(entity);
+					const MATERIAL_COMPONENT& material = scene.m_registry.Get<MATERIAL_COMPONENT>(entity);
+					scene.WriteDrawData(transform.modelMatrix, material.color,
+						scene.GetTextureSlot(entity), material.materialIndex, false);
+				}
+				scene.EndDrawData();
+			});
+		glUniform1i(scene.m_uniforms.bUseDrawData, false);
+		ReportPath("per draw state", "uniforms", draws, oldMilliseconds, oldMilliseconds);
+		ReportPath("", "draw data", draws, newMilliseconds, oldMilliseconds);
+	}
+	else
+	{
+		ReportPath("per draw state", "uniforms", draws, oldMilliseconds, oldMilliseconds);
+		std::cout << "INFO: No draw data buffer, persistent mapping is not supported" << std::endl;
+	}
+
+	// the new paths have to find what the tag lookups find
+	for (ENTITY entity : entities)
+	{
+		const MATERIAL_COMPONENT& material = scene.m_registry.Get<MATERIAL_COMPONENT>(entity);
+		const TEXTURE_COMPONENT* pTexture = scene.m_registry.Find<TEXTURE_COMPONENT>(entity);
+		SceneManager::OBJECT_MATERIAL foundMaterial;
+		scene.FindMaterial(material.materialTag, foundMaterial);
+
+		if (((pTexture != NULL) && (scene.FindTextureSlot(pTexture->textureTag) != scene.GetTextureSlot(entity))) ||
+			(foundMaterial.shininess != scene.m_objectMaterials[material.materialIndex].shininess) ||
+			(foundMaterial.diffuseColor != scene.m_objectMaterials[material.materialIndex].diffuseColor))
+		{
+			std::cout << "ERROR: Resolved texture slot or material differs from the tag lookup" << std::endl;
+			bPassed = false;
+			break;
+		}
+	}
+	std::cout << std::endl;
+
+	delete pScene;
+	return(bPassed);
+}
+
+/***********************************************************
+ *  RunTextureLoads()
+ *
+ *  This method is used for timing the textures of the scene
+ *  loaded with CreateGLTexture(), which decodes the images
+ *  and generates their mipmaps, against uploading their
+ *  levels from the asset pack.  Each run loads them into a
+ *  new scene manager, since the slots are never given back.
+ ***********************************************************/
+bool DrawStateBenchmark::RunTextureLoads(ShaderManager* pShaderManager)
+{
+	SceneFile sceneFile;
+	if (sceneFile.Open(g_SceneFile) == false)
+	{
+		return(false);
+	}
+
+	std::vector<std::string> tags;
+	std::vector<std::string> filenames;
+	for (uint32_t i = 0; i < sceneFile.GetTextureCount(); i++)
+	{
+		const SceneFile::TEXTURE& texture = sceneFile.GetTexture(i);
+		tags.push_back(sceneFile.GetString(texture.tag));
+		filenames.push_back(sceneFile.GetString(texture.filename));
+	}
+	sceneFile.Close();
+
+	std::cout << "=== Texture loads, " << tags.size() << " textures ===" << std::endl;
+	ReportHeader();
+
+	bool bLoaded = true;
+	double oldMilliseconds = MeasureLoop([&]()
+		{
+			SceneManager scene(pShaderManager);
+			for (size_t i = 0; i < tags.size(); i++)
+			{
+				bLoaded = scene.CreateGLTexture(filenames[i].c_str(), tags[i]) && bLoaded;
+			}
+			glFinish();
+			for (int i = 0; i < scene.m_loadedTextures; i++)
+			{
+				glDeleteTextures(1, &scene.m_textureIDs[i].ID);
+			}
+		});
+	ReportPath("CreateGLTexture", "decode", tags.size(), oldMilliseconds, oldMilliseconds);
+
+	if (AssetPack::IsAssetPack(g_PackFile) == false)
+	{
+		std::cout << "INFO: Run SceneCompiler " << g_SceneFile << " " << g_PackFile
+			<< " to compare with the packed textures" << std::endl;
+	}
+	else
+	{
+		// the pack is mapped before the timing starts, as it is
+		// when the scene is prepared
+		double newMilliseconds = 0.0;
+		double totalMilliseconds = 0.0;
+		for (int run = 0; (run < 3) || (totalMilliseconds < g_MinimumMilliseconds); run++)
+		{
+			SceneManager scene(pShaderManager);
+			scene.m_assetPack.Open(g_PackFile);
+
+			BenchmarkTimer timer;
+			for (size_t i = 0; i < tags.size(); i++)
+			{
+				const AssetPack::ENTRY* pEntry = scene.m_assetPack.FindEntry(AssetPack::ENTRY_TEXTURE, tags[i].c_str());
+				int textureSlot = scene.RegisterTexture(filenames[i], pEntry, tags[i]);
+				bLoaded = (pEntry != NULL) && (textureSlot >= 0) && scene.LoadTextureNow(textureSlot) && bLoaded;
+			}
+			glFinish();
+			double elapsed = timer.GetElapsedMilliseconds();
+
+			if ((run == 0) || (elapsed < newMilliseconds))
+			{
+				newMilliseconds = elapsed;
+			}
+			totalMilliseconds += elapsed;
+			for (int i = 0; i < scene.m_loadedTextures; i++)
+			{
+				glDeleteTextures(1, &scene.m_textureIDs[i].ID);
+			}
+		}
+		ReportPath("", "packed", tags.size(), newMilliseconds, oldMilliseconds);
+	}
+	std::cout << std::endl;
+
+	if (bLoaded == false)
+	{
+		std::cout << "ERROR: Not every texture of " << g_SceneFile << " could be loaded" << std::endl;
+	}
+	return(bLoaded);
+}
+
+/***********************************************************
+ *  RunDrawStateBenchmarks()
+ *
+ *  This function is used for creating an offscreen OpenGL
+ *  context and benchmarking the per draw methods for each
+ *  scene size and the texture loads.  It is run from the
+ *  project directory, so the shaders and the scene are
+ *  found, and is skipped when there is no context.
+ ***********************************************************/
+bool RunDrawStateBenchmarks()
+{
+	bool bPassed = true;
+
+#ifndef HEADLESS_EGL
+	// the hidden window of the offscreen context needs GLFW
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+
+	HeadlessContext context;
+	if ((context.CreateContext() == false) || (glewInit() != GLEW_OK))
+	{
+		std::cout << "WARNING: Per draw benchmarks skipped, no OpenGL context\n" << std::endl;
+		return(true);
+	}
+	std::cout << "INFO: Per draw benchmarks use " << glGetString(GL_RENDERER) << "\n" << std::endl;
+
+	ShaderManager* pShaderManager = new ShaderManager();
+	pShaderManager->LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+	pShaderManager->use();
+
+	for (int copies : g_SceneCopies)
+	{
+		bPassed = DrawStateBenchmark::RunScene(pShaderManager, copies) && bPassed;
+	}
+	bPassed = DrawStateBenchmark::RunTextureLoads(pShaderManager) && bPassed;
+
+	delete pShaderManager;
+	context.Destroy();
+	return(bPassed);
+}
@@ -0,0 +1,487 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbenchmark.cpp
+// ============
+// benchmark of the batched world matrix kernels against composing each
+// matrix from glm transformation products, and of updating part of a
+// transform hierarchy against updating all of it
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmarks.h"
+#include "TransformBatch.h"
+#include "TransformHierarchy.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// object counts benchmarked, from the demo scene size up to
+	// large replicated scenes
+	const size_t g_ObjectCounts[] = { 1000, 10000, 100000, 1000000 };
+	// minimum measured time per kernel and object count
+	const double g_MinimumMilliseconds = 200.0;
+	// largest difference from the glm matrices, relative to
+	// the size of the compared element
+	const double g_MaximumRelativeError = 1.0e-5;
+	// chairs of the hierarchy benchmark, each a seat with four
+	// legs attached to it like in the scene
+	const size_t g_ChairCounts[] = { 1000, 10000, 100000 };
+	const uint32_t g_NodesPerChair = 5;
+	// every this many seats one is moved in a partial update,
+	// about the share of an animated scene that moves
+	const size_t g_MovedSeatInterval = 100;
+
+	// transformation values of the synthetic objects
+	struct TRANSFORM_VALUES
+	{
+		glm::vec3 position;
+		glm::vec3 rotationDegrees;
+		glm::vec3 scale;
+	};
+
+	/***********************************************************
+	 *  FillTransforms()
+	 *
+	 *  This function is used for generating the passed in
+	 *  number of random transforms into the list and the batch.
+	 ***********************************************************/
+	void FillTransforms(
+		std::vector<TRANSFORM_VALUES>& transforms,
+		TransformBatch& batch,
+		size_t count)
+	{
+		BenchmarkRandom random(67890u);
+
+		transforms.resize(count);
+		batch.Clear();
+		batch.Reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			TRANSFORM_VALUES& values = transforms[i];
+
+			values.position = glm::vec3(
+				random.Range(-500.0f, 500.0f),
+				random.Range(-500.0f, 500.0f),
+				random.Range(-500.0f, 500.0f));
+			values.rotationDegrees = glm::vec3(
+				random.Range(-180.0f, 180.0f),
+				random.Range(-180.0f, 180.0f),
+				random.Range(-180.0f, 180.0f));
+			values.scale = glm::vec3(
+				random.Range(0.1f, 10.0f),
+				random.Range(0.1f, 10.0f),
+				random.Range(0.1f, 10.0f));
+			batch.Add(values.position, values.rotationDegrees, values.scale);
+		}
+	}
+
+	/***********************************************************
+	 *  ComposeWithGlm()
+	 *
+	 *  This function is used for composing every matrix the
+	 *  way SetTransformations() does, one glm product chain
+	 *  per object.
+	 ***********************************************************/
+	void ComposeWithGlm(
+		const std::vector<TRANSFORM_VALUES>& transforms,
+		std::vector<glm::mat4>& matrices)
+	{
+		matrices.resize(transforms.size());
+		for (size_t i = 0; i < transforms.size(); i++)
+		{
+			const TRANSFORM_VALUES& values = transforms[i];
+
+			matrices[i] =
+				glm::translate(values.position) *
+				glm::rotate(glm::radians(values.rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
+				glm::rotate(glm::radians(values.rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+				glm::rotate(glm::radians(values.rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+				glm::scale(values.scale);
+		}
+	}
+
+	/***********************************************************
+	 *  GetMatrixError()
+	 *
+	 *  This function is used for getting the largest relative
+	 *  element difference between two matrices.
+	 ***********************************************************/
+	double GetMatrixError(const glm::mat4& reference, const glm::mat4& matrix)
+	{
+		double maximumError = 0.0;
+
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				double expected = reference[column][row];
+				double difference = std::fabs(expected - matrix[column][row]);
+				double error = difference / std::fmax(1.0, std::fabs(expected));
+				if (error > maximumError)
+				{
+					maximumError = error;
+				}
+			}
+		}
+
+		return(maximumError);
+	}
+
+	/***********************************************************
+	 *  GetMaximumError()
+	 *
+	 *  This function is used for getting the largest relative
+	 *  element difference between two lists of matrices.
+	 ***********************************************************/
+	double GetMaximumError(
+		const std::vector<glm::mat4>& reference,
+		const std::vector<glm::mat4>& matrices)
+	{
+		double maximumError = 0.0;
+
+		for (size_t i = 0; i < reference.size(); i++)
+		{
+			maximumError = std::fmax(maximumError, GetMatrixError(reference[i], matrices[i]));
+		}
+
+		return(maximumError);
+	}
+
+	/***********************************************************
+	 *  MeasureKernel()
+	 *
+	 *  This function is used for running one kernel repeatedly
+	 *  and returning the best time of a single run.  A kernel
+	 *  of TRANSFORM_PATH_AUTO stands for the glm composition.
+	 ***********************************************************/
+	double MeasureKernel(
+		const std::vector<TRANSFORM_VALUES>& transforms,
+		const TransformBatch& batch,
+		TransformBatch::TRANSFORM_PATH transformPath,
+		std::vector<glm::mat4>& matrices)
+	{
+		double bestMilliseconds = 0.0;
+		double totalMilliseconds = 0.0;
+		int runs = 0;
+
+		while ((runs < 3) || (totalMilliseconds < g_MinimumMilliseconds))
+		{
+			BenchmarkTimer timer;
+			if (transformPath == TransformBatch::TRANSFORM_PATH_AUTO)
+			{
+				ComposeWithGlm(transforms, matrices);
+			}
+			else
+			{
+				batch.ComputeMatrices(matrices, transformPath);
+			}
+			double elapsed = timer.GetElapsedMilliseconds();
+
+			if ((runs == 0) || (elapsed < bestMilliseconds))
+			{
+				bestMilliseconds = elapsed;
+			}
+			totalMilliseconds += elapsed;
+			runs++;
+		}
+
+		return(bestMilliseconds);
+	}
+
+	/***********************************************************
+	 *  BuildChairs()
+	 *
+	 *  This function is used for adding the passed in number
+	 *  of chairs to the hierarchy, a seat at a random place
+	 *  with four legs below its corners, and keeping the local
+	 *  matrix and scale of every node.
+	 ***********************************************************/
+	void BuildChairs(
+		TransformHierarchy& hierarchy,
+		std::vector<glm::mat4>& localMatrices,
+		std::vector<glm::vec3>& scales,
+		size_t count)
+	{
+		const glm::vec3 legScale(0.1f, 1.0f, 0.1f);
+		const glm::vec3 seatScale(1.0f, 0.1f, 1.0f);
+		BenchmarkRandom random(13579u);
+
+		hierarchy.Clear();
+		hierarchy.Reserve(count * g_NodesPerChair);
+		localMatrices.clear();
+		scales.clear();
+		for (size_t i = 0; i < count; i++)
+		{
+			glm::mat4 seatMatrix =
+				glm::translate(glm::vec3(random.Range(-500.0f, 500.0f), 1.0f, random.Range(-500.0f, 500.0f))) *
+				glm::rotate(glm::radians(random.Range(-180.0f, 180.0f)), glm::vec3(0.0f, 1.0f, 0.0f));
+			int32_t seat = hierarchy.AddNode(TransformHierarchy::NO_PARENT, seatMatrix, seatScale);
+			localMatrices.push_back(seatMatrix);
+			scales.push_back(seatScale);
+
+			for (int leg = 0; leg < 4; leg++)
+			{
+				glm::mat4 legMatrix = glm::translate(glm::vec3(
+					(leg & 1) ? 0.4f : -0.4f, -1.0f, (leg & 2) ? 0.4f : -0.4f));
+				hierarchy.AddNode(seat, legMatrix, legScale);
+				localMatrices.push_back(legMatrix);
+				scales.push_back(legScale);
+			}
+		}
+		hierarchy.Update();
+	}
+
+	/***********************************************************
+	 *  CheckMovedSeat()
+	 *
+	 *  This function is used for moving one seat and verifying
+	 *  that the update recomputed only the seat and its legs,
+	 *  that the legs followed it, and that no other matrix
+	 *  changed.
+	 ***********************************************************/
+	bool CheckMovedSeat(
+		TransformHierarchy& hierarchy,
+		std::vector<glm::mat4>& localMatrices,
+		const std::vector<glm::vec3>& scales,
+		uint32_t seat)
+	{
+		std::vector<glm::mat4> modelMatrices(hierarchy.GetCount());
+		for (uint32_t i = 0; i < (uint32_t)hierarchy.GetCount(); i++)
+		{
+			modelMatrices[i] = hierarchy.GetModelMatrix(i);
+		}
+
+		localMatrices[seat] = glm::translate(glm::vec3(2.0f, 0.5f, -3.0f)) * localMatrices[seat];
+		hierarchy.SetLocalTransform(seat, localMatrices[seat], scales[seat]);
+		hierarchy.Update();
+
+		uint32_t subtreeEnd = seat + g_NodesPerChair;
+		const std::vector<uint32_t>& changedNodes = hierarchy.GetChangedNodes();
+		bool bPassed = (changedNodes.size() == g_NodesPerChair);
+		for (size_t i = 0; (i < changedNodes.size()) && (bPassed == true); i++)
+		{
+			bPassed = (changedNodes[i] == seat + (uint32_t)i);
+		}
+		if (bPassed == false)
+		{
+			std::cout << "ERROR: Moving seat " << seat << " recomputed " << changedNodes.size()
+				<< " nodes instead of the seat and its legs" << std::endl;
+			return(false);
+		}
+
+		for (uint32_t node = seat; node < subtreeEnd; node++)
+		{
+			glm::mat4 world = localMatrices[node];
+			if (node != seat)
+			{
+				world = localMatrices[seat] * world;
+			}
+			glm::mat4 expected = world * glm::scale(scales[node]);
+			if (GetMatrixError(expected, hierarchy.GetModelMatrix(node)) > g_MaximumRelativeError)
+			{
+				std::cout << "ERROR: Node " << node << " did not follow its moved seat" << std::endl;
+				return(false);
+			}
+		}
+
+		for (uint32_t node = 0; node < (uint32_t)hierarchy.GetCount(); node++)
+		{
+			if (((node < seat) || (node >= subtreeEnd)) &&
+				(memcmp(&modelMatrices[node], &hierarchy.GetModelMatrix(node), sizeof(glm::mat4)) != 0))
+			{
+				std::cout << "ERROR: Node " << node << " changed although seat " << seat << " was moved" << std::endl;
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  MeasureHierarchyUpdate()
+	 *
+	 *  This function is used for moving every seat at the
+	 *  passed in interval and updating the hierarchy, the work
+	 *  of an animated frame, and returning the best time of a
+	 *  single run.
+	 ***********************************************************/
+	double MeasureHierarchyUpdate(
+		TransformHierarchy& hierarchy,
+		const std::vector<glm::mat4>& localMatrices,
+		const std::vector<glm::vec3>& scales,
+		size_t seatInterval,
+		size_t& updatedNodes)
+	{
+		uint32_t nodeInterval = (uint32_t)seatInterval * g_NodesPerChair;
+		double bestMilliseconds = 0.0;
+		double totalMilliseconds = 0.0;
+		int runs = 0;
+
+		while ((runs < 3) || (totalMilliseconds < g_MinimumMilliseconds))
+		{
+			BenchmarkTimer timer;
+			for (uint32_t seat = 0; seat < (uint32_t)hierarchy.GetCount(); seat += nodeInterval)
+			{
+				hierarchy.SetLocalTransform(seat, localMatrices[seat], scales[seat]);
+			}
+			updatedNodes = hierarchy.Update();
+			double elapsed = timer.GetElapsedMilliseconds();
+
+			if ((runs == 0) || (elapsed < bestMilliseconds))
+			{
+				bestMilliseconds = elapsed;
+			}
+			totalMilliseconds += elapsed;
+			runs++;
+		}
+
+		return(bestMilliseconds);
+	}
+
+	/***********************************************************
+	 *  RunHierarchyBenchmark()
+	 *
+	 *  This function is used for checking that a moved seat
+	 *  carries its legs while the other chairs are skipped,
+	 *  and timing an update of a few moved seats against one
+	 *  where every seat moved.
+	 ***********************************************************/
+	bool RunHierarchyBenchmark()
+	{
+		bool bPassed = true;
+
+		TransformHierarchy hierarchy;
+		std::vector<glm::mat4> localMatrices;
+		std::vector<glm::vec3> scales;
+
+		std::cout << "=== Transform hierarchy update ===" << std::endl;
+		std::cout << std::setw(10) << "chairs"
+			<< std::setw(10) << "update"
+			<< std::setw(10) << "nodes"
+			<< std::setw(12) << "ms"
+			<< std::setw(12) << "ns/node"
+			<< std::setw(10) << "speedup" << std::endl;
+
+		for (size_t count : g_ChairCounts)
+		{
+			BuildChairs(hierarchy, localMatrices, scales, count);
+			if (CheckMovedSeat(hierarchy, localMatrices, scales, (uint32_t)(count / 2) * g_NodesPerChair) == false)
+			{
+				bPassed = false;
+			}
+
+			size_t fullNodes = 0;
+			size_t partialNodes = 0;
+			double fullMilliseconds = MeasureHierarchyUpdate(hierarchy, localMatrices, scales, 1, fullNodes);
+			double partialMilliseconds = MeasureHierarchyUpdate(hierarchy, localMatrices, scales,
+				g_MovedSeatInterval, partialNodes);
+
+			std::cout << std::setw(10) << count
+				<< std::setw(10) << "full"
+				<< std::setw(10) << fullNodes
+				<< std::setw(12) << std::fixed << std::setprecision(3) << fullMilliseconds
+				<< std::setw(12) << std::setprecision(2) << (fullMilliseconds * 1000000.0 / fullNodes)
+				<< std::setw(9) << std::setprecision(2) << 1.0 << "x" << std::defaultfloat << std::endl;
+			std::cout << std::setw(10) << count
+				<< std::setw(10) << "partial"
+				<< std::setw(10) << partialNodes
+				<< std::setw(12) << std::fixed << std::setprecision(3) << partialMilliseconds
+				<< std::setw(12) << std::setprecision(2) << (partialMilliseconds * 1000000.0 / partialNodes)
+				<< std::setw(9) << std::setprecision(2) << (fullMilliseconds / partialMilliseconds) << "x"
+				<< std::defaultfloat << std::endl;
+		}
+		std::cout << std::endl;
+
+		return(bPassed);
+	}
+}
+
+/***********************************************************
+ *  RunTransformBenchmarks()
+ *
+ *  This function is used for benchmarking every supported
+ *  matrix kernel against the glm composition for each
+ *  object count, and verifying the matrices agree, and
+ *  then the partial updates of the transform hierarchy.
+ ***********************************************************/
+bool RunTransformBenchmarks()
+{
+	const TransformBatch::TRANSFORM_PATH paths[] = {
+		TransformBatch::TRANSFORM_PATH_AUTO,
+		TransformBatch::TRANSFORM_PATH_SCALAR,
+		TransformBatch::TRANSFORM_PATH_SSE2,
+		TransformBatch::TRANSFORM_PATH_AVX2 };
+	bool bPassed = true;
+
+	TransformBatch batch;
+	std::vector<TRANSFORM_VALUES> transforms;
+
+	std::cout << "=== World matrix composition ===" << std::endl;
+	std::cout << std::setw(10) << "objects"
+		<< std::setw(10) << "kernel"
+		<< std::setw(12) << "ms"
+		<< std::setw(12) << "ns/object"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "max error" << std::endl;
+
+	for (size_t count : g_ObjectCounts)
+	{
+		std::vector<glm::mat4> referenceMatrices;
+		std::vector<glm::mat4> matrices;
+		double glmMilliseconds = 0.0;
+
+		FillTransforms(transforms, batch, count);
+
+		for (TransformBatch::TRANSFORM_PATH transformPath : paths)
+		{
+			const char* pName = "glm";
+			double error = 0.0;
+
+			if (transformPath != TransformBatch::TRANSFORM_PATH_AUTO)
+			{
+				if (TransformBatch::IsPathSupported(transformPath) == false)
+				{
+					continue;
+				}
+				pName = TransformBatch::GetPathName(transformPath);
+			}
+
+			double milliseconds = MeasureKernel(transforms, batch, transformPath, matrices);
+			if (transformPath == TransformBatch::TRANSFORM_PATH_AUTO)
+			{
+				glmMilliseconds = milliseconds;
+				referenceMatrices = matrices;
+			}
+			else
+			{
+				error = GetMaximumError(referenceMatrices, matrices);
+				if (error > g_MaximumRelativeError)
+				{
+					std::cout << "ERROR: " << pName
+						<< " matrices differ from glm for " << count << " objects" << std::endl;
+					bPassed = false;
+				}
+			}
+
+			std::cout << std::setw(10) << count
+				<< std::setw(10) << pName
+				<< std::setw(12) << std::fixed << std::setprecision(3) << milliseconds
+				<< std::setw(12) << std::setprecision(2) << (milliseconds * 1000000.0 / count)
+				<< std::setw(9) << std::setprecision(2) << (glmMilliseconds / milliseconds) << "x"
+				<< std::setw(12) << std::scientific << std::setprecision(1) << error
+				<< std::defaultfloat << std::endl;
+		}
+	}
+	std::cout << std::endl;
+
+	bPassed = RunHierarchyBenchmark() && bPassed;
+
+	return(bPassed);
+}
@@ -0,0 +1,481 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancegate.cpp
+// ============
+// performance baseline of the scene benchmark - the metrics of a run are
+// compared against a stored baseline with limits that allow for the noise
+// of the measurements, and a frame against a reference image
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerformanceGate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// names of the metric kinds in a baseline
+	const char* g_KindNames[] = { "time", "count", "memory" };
+
+	// change a metric of each kind may have before it counts as
+	// a regression, relative to the baseline and at least the
+	// absolute amount - counts are averaged over the frames, so
+	// half a draw or allocation per frame is allowed for
+	// rounding, and nothing more
+	struct KIND_TOLERANCE
+	{
+		double relative;
+		double absolute;
+	};
+	const KIND_TOLERANCE g_KindTolerances[] = {
+		{ 0.10, 0.05 },
+		{ 0.0, 0.5 },
+		{ 0.10, 1.0 } };
+
+	// the noise is the spread of a metric's samples, and a change
+	// within this many times the noise of the baseline and the
+	// run together is not counted
+	const double g_NoiseFactor = 3.0;
+	// scales the median absolute deviation to the standard
+	// deviation of normally distributed samples
+	const double g_DeviationScale = 1.4826;
+
+	// a pixel differs when one of its channels differs by more
+	// than this, which lets rounding differences of rasterizers
+	// pass, and the image differs when more of its pixels do
+	const int g_PixelTolerance = 24;
+	const double g_MaxDifferentPixels = 0.005;
+	// differences are amplified this much in the difference image
+	const int g_DifferenceScale = 4;
+
+	/***********************************************************
+	 *  GetMedian()
+	 *
+	 *  This function is used for getting the median of values,
+	 *  which are sorted in place.
+	 ***********************************************************/
+	double GetMedian(std::vector<double>& values)
+	{
+		if (values.empty() == true)
+		{
+			return(0.0);
+		}
+		std::sort(values.begin(), values.end());
+		size_t middle = values.size() / 2;
+		if ((values.size() % 2) == 0)
+		{
+			return((values[middle - 1] + values[middle]) * 0.5);
+		}
+		return(values[middle]);
+	}
+
+	/***********************************************************
+	 *  ReadImage()
+	 *
+	 *  This function is used for reading a binary PPM image as
+	 *  written by the headless context.
+	 ***********************************************************/
+	bool ReadImage(const char* filename, int& width, int& height, std::vector<uint8_t>& pixels)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		std::string magic;
+		int maxValue = 0;
+		if (!(file >> magic >> width >> height >> maxValue) || (magic != "P6") ||
+			(width <= 0) || (height <= 0) || (maxValue != 255))
+		{
+			std::cout << "ERROR: " << filename << " is not a binary PPM image" << std::endl;
+			return(false);
+		}
+		// a single whitespace separates the header from the pixels
+		file.get();
+
+		pixels.resize((size_t)width * height * 3);
+		file.read((char*)pixels.data(), (std::streamsize)pixels.size());
+		if (!file)
+		{
+			std::cout << "ERROR: " << filename << " ends before its pixels do" << std::endl;
+			return(false);
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  PerformanceGate()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerformanceGate::PerformanceGate()
+{
+}
+
+/***********************************************************
+ *  FindMetric()
+ *
+ *  This method is used for finding the index of a metric of
+ *  a scene size, -1 when there is none.
+ ***********************************************************/
+int PerformanceGate::FindMetric(const std::string& name, int copies) const
+{
+	for (size_t i = 0; i < m_metrics.size(); i++)
+	{
+		if ((m_metrics[i].copies == copies) && (m_metrics[i].name == name))
+		{
+			return((int)i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  AddSample()
+ *
+ *  This method is used for adding a measured value to a
+ *  metric, which is created by its first sample.
+ ***********************************************************/
+void PerformanceGate::AddSample(const char* name, int copies, METRIC_KIND kind, double value)
+{
+	int index = FindMetric(name, copies);
+	if (index < 0)
+	{
+		METRIC metric;
+		metric.name = name;
+		metric.copies = copies;
+		metric.kind = kind;
+		metric.value = 0.0;
+		metric.noise = 0.0;
+		m_metrics.push_back(metric);
+		index = (int)m_metrics.size() - 1;
+	}
+	m_metrics[index].samples.push_back(value);
+}
+
+/***********************************************************
+ *  Summarize()
+ *
+ *  This method is used for taking the median of the samples
+ *  as the value of each metric, and their median absolute
+ *  deviation as its noise, so a single disturbed run moves
+ *  neither of them.  A single sample has no noise.
+ ***********************************************************/
+void PerformanceGate::Summarize()
+{
+	for (size_t i = 0; i < m_metrics.size(); i++)
+	{
+		METRIC& metric = m_metrics[i];
+		std::vector<double> values = metric.samples;
+		metric.value = GetMedian(values);
+
+		std::vector<double> deviations;
+		for (size_t s = 0; s < values.size(); s++)
+		{
+			deviations.push_back(std::fabs(values[s] - metric.value));
+		}
+		metric.noise = (values.size() > 1) ? GetMedian(deviations) * g_DeviationScale : 0.0;
+	}
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the metrics of a
+ *  baseline.  The metrics read before an error are dropped,
+ *  so a baseline is either loaded whole or not at all.
+ ***********************************************************/
+bool PerformanceGate::Load(const char* filename)
+{
+	m_metrics.clear();
+	m_renderer.clear();
+
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: Could not open performance baseline " << filename << std::endl;
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream lineStream(line);
+		std::string keyword;
+		if (!(lineStream >> keyword))
+		{
+			continue;
+		}
+
+		if (keyword == "renderer")
+		{
+			std::getline(lineStream >> std::ws, m_renderer);
+			m_renderer.erase(m_renderer.find_last_not_of(" \t\r") + 1);
+			continue;
+		}
+
+		METRIC metric;
+		std::string kindName;
+		std::string extra;
+		bool bRead = (keyword == "metric") &&
+			(lineStream >> metric.name >> metric.copies >> kindName >> metric.value >> metric.noise) &&
+			!(lineStream >> extra);
+
+		int kind = 0;
+		while ((kind <= METRIC_MEMORY) && (kindName != g_KindNames[kind]))
+		{
+			kind++;
+		}
+
+		std::string error;
+		if (bRead == false)
+		{
+			error = "a metric needs a name, copies, a kind, a value and its noise";
+		}
+		else if (kind > METRIC_MEMORY)
+		{
+			error = "the kind of a metric is time, count or memory";
+		}
+		else if (FindMetric(metric.name, metric.copies) >= 0)
+		{
+			error = "the metric is there twice";
+		}
+
+		if (error.empty() == false)
+		{
+			std::cout << "ERROR: " << filename << " line " << lineNumber << ": " << error << std::endl;
+			m_metrics.clear();
+			return(false);
+		}
+		metric.kind = (METRIC_KIND)kind;
+		m_metrics.push_back(metric);
+	}
+
+	if (m_metrics.empty() == true)
+	{
+		std::cout << "ERROR: Performance baseline " << filename << " has no metrics" << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Loaded performance baseline " << filename << " - " << m_metrics.size() << " metrics" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method is used for writing the metrics as a
+ *  baseline, in the order they were measured.
+ ***********************************************************/
+bool PerformanceGate::Save(const char* filename) const
+{
+	std::ofstream file(filename, std::ios::trunc);
+	file << "# performance baseline of the scene benchmark, written by\n"
+		<< "# SceneBenchmark --write-baseline - the value is the median of\n"
+		<< "# the runs and the noise the spread of the runs around it\n"
+		<< "renderer " << m_renderer << "\n"
+		<< "# metric <name> <copies> <kind> <value> <noise>\n";
+
+	file << std::setprecision(6);
+	for (size_t i = 0; i < m_metrics.size(); i++)
+	{
+		const METRIC& metric = m_metrics[i];
+		file << "metric " << metric.name << " " << metric.copies << " " << g_KindNames[metric.kind]
+			<< " " << metric.value << " " << metric.noise << "\n";
+	}
+
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write performance baseline " << filename << std::endl;
+		return(false);
+	}
+	std::cout << "INFO: Wrote performance baseline " << filename << " - " << m_metrics.size() << " metrics" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Compare()
+ *
+ *  This method is used for comparing the measured metrics
+ *  with a baseline, one row per baseline metric.  Metrics
+ *  that improved past their limit pass, and are marked so
+ *  the baseline can be written again.  Measured metrics the
+ *  baseline does not have are left out.  A run on another
+ *  renderer fails, since its times are not comparable, but
+ *  the rows are still reported.
+ ***********************************************************/
+bool PerformanceGate::Compare(const PerformanceGate& baseline, std::ostream& report) const
+{
+	int regressions = 0;
+	int improvements = 0;
+	int missing = 0;
+
+	bool bSameRenderer = (baseline.m_renderer.empty() == true) || (baseline.m_renderer == m_renderer);
+	if (bSameRenderer == false)
+	{
+		report << "ERROR: The baseline was measured with " << baseline.m_renderer
+			<< ", this run with " << m_renderer << "\n\n";
+	}
+
+	report << std::left << std::setw(24) << "metric" << std::right
+		<< std::setw(8) << "copies"
+		<< std::setw(13) << "baseline"
+		<< std::setw(13) << "current"
+		<< std::setw(10) << "change"
+		<< std::setw(11) << "limit"
+		<< "  result\n";
+
+	for (size_t i = 0; i < baseline.m_metrics.size(); i++)
+	{
+		const METRIC& expected = baseline.m_metrics[i];
+		int measuredIndex = FindMetric(expected.name, expected.copies);
+
+		report << std::left << std::setw(24) << expected.name << std::right
+			<< std::setw(8) << expected.copies
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(13) << expected.value;
+
+		if (measuredIndex < 0)
+		{
+			report << std::setw(13) << "-" << std::setw(10) << "-" << std::setw(11) << "-" << "  MISSING\n";
+			missing++;
+			continue;
+		}
+
+		const METRIC& measured = m_metrics[measuredIndex];
+		const KIND_TOLERANCE& tolerance = g_KindTolerances[expected.kind];
+		double noise = std::sqrt(expected.noise * expected.noise + measured.noise * measured.noise);
+		double limit = std::max(tolerance.relative * std::fabs(expected.value), tolerance.absolute);
+		// counts only change with the code, so a count that varies
+		// between frames does not widen its limit
+		if (expected.kind != METRIC_COUNT)
+		{
+			limit = std::max(limit, g_NoiseFactor * noise);
+		}
+		double change = measured.value - expected.value;
+
+		const char* pResult = "ok";
+		if (change > limit)
+		{
+			pResult = "REGRESSED";
+			regressions++;
+		}
+		else if (change < -limit)
+		{
+			pResult = "improved";
+			improvements++;
+		}
+
+		report << std::setw(13) << measured.value;
+		if (expected.value != 0.0)
+		{
+			report << std::showpos << std::setw(9) << std::setprecision(1)
+				<< (change * 100.0 / std::fabs(expected.value)) << "%" << std::noshowpos;
+		}
+		else
+		{
+			report << std::setw(10) << "-";
+		}
+		report << std::setw(11) << std::setprecision(3) << limit << "  " << pResult << "\n";
+	}
+	report << std::defaultfloat;
+
+	bool bPassed = (bSameRenderer == true) && (regressions == 0) && (missing == 0);
+	report << "\n" << (bPassed ? "PASS" : "FAIL") << ": " << baseline.m_metrics.size() << " metrics, "
+		<< regressions << " regressed, " << improvements << " improved, " << missing << " not measured";
+	if (bSameRenderer == false)
+	{
+		report << ", other renderer";
+	}
+	report << "\n";
+	if (improvements > 0)
+	{
+		report << "INFO: Metrics improved past their limit, write the baseline again to keep the gain\n";
+	}
+	return(bPassed);
+}
+
+/***********************************************************
+ *  CompareImages()
+ *
+ *  This method is used for counting the pixels of a frame
+ *  that differ from the reference image by more than the
+ *  rasterizers' rounding, so a change that speeds a frame
+ *  up by drawing it wrong is caught.  The difference image
+ *  shows where they differ.
+ ***********************************************************/
+bool PerformanceGate::CompareImages(
+	const char* imageFile,
+	const char* referenceFile,
+	const char* differenceFile,
+	std::ostream& report)
+{
+	int width = 0;
+	int height = 0;
+	int referenceWidth = 0;
+	int referenceHeight = 0;
+	std::vector<uint8_t> pixels;
+	std::vector<uint8_t> referencePixels;
+
+	if ((ReadImage(imageFile, width, height, pixels) == false) ||
+		(ReadImage(referenceFile, referenceWidth, referenceHeight, referencePixels) == false))
+	{
+		report << "FAIL: The frame could not be compared with " << referenceFile << "\n";
+		return(false);
+	}
+	if ((width != referenceWidth) || (height != referenceHeight))
+	{
+		report << "FAIL: The frame is " << width << " x " << height << ", the reference image "
+			<< referenceWidth << " x " << referenceHeight << "\n";
+		return(false);
+	}
+
+	size_t pixelCount = (size_t)width * height;
+	size_t differentPixels = 0;
+	double totalDifference = 0.0;
+	std::vector<uint8_t> difference(pixels.size());
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		int largest = 0;
+		for (int channel = 0; channel < 3; channel++)
+		{
+			int value = std::abs((int)pixels[i * 3 + channel] - (int)referencePixels[i * 3 + channel]);
+			largest = std::max(largest, value);
+			totalDifference += value;
+			difference[i * 3 + channel] = (uint8_t)std::min(value * g_DifferenceScale, 255);
+		}
+		if (largest > g_PixelTolerance)
+		{
+			differentPixels++;
+		}
+	}
+
+	std::ofstream file(differenceFile, std::ios::binary | std::ios::trunc);
+	file << "P6\n" << width << " " << height << "\n255\n";
+	file.write((const char*)difference.data(), (std::streamsize)difference.size());
+
+	double differentFraction = (double)differentPixels / pixelCount;
+	bool bPassed = (differentFraction <= g_MaxDifferentPixels);
+	report << (bPassed ? "PASS" : "FAIL") << ": " << std::fixed << std::setprecision(2)
+		<< differentFraction * 100.0 << "% of the pixels differ from " << referenceFile
+		<< " (limit " << g_MaxDifferentPixels * 100.0 << "%), mean difference "
+		<< totalDifference / (pixelCount * 3) << std::defaultfloat << "\n";
+	if (bPassed == false)
+	{
+		report << "INFO: The differences are shown in " << differenceFile << "\n";
+	}
+	return(bPassed);
+}
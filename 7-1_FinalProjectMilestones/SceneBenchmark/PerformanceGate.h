@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancegate.h
+// ============
+// performance baseline of the scene benchmark - the metrics of a run are
+// compared against a stored baseline with limits that allow for the noise
+// of the measurements, and a frame against a reference image
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  PerformanceGate
+ *
+ *  This class collects the metrics of the measured scene
+ *  sizes, each measured one or more times.  The value of a
+ *  metric is the median of its samples and its noise is
+ *  the spread of the samples around it.  A baseline is
+ *  stored as text, one metric per line, and # starts a
+ *  comment:
+ *
+ *    renderer <name of the OpenGL renderer>
+ *    metric <name> <copies> <time|count|memory> <value> <noise>
+ *
+ *  A metric regresses when it grows past the baseline by
+ *  more than its limit, which is the larger of a tolerance
+ *  for its kind and a multiple of the combined noise.
+ *  Counts are held to their tolerance alone, since they do
+ *  not vary from run to run.
+ ***********************************************************/
+class PerformanceGate
+{
+public:
+	// what a metric measures, which sets its tolerance
+	enum METRIC_KIND
+	{
+		// milliseconds, which vary from run to run
+		METRIC_TIME = 0,
+		// draws, allocations and other counts that only change
+		// with the code
+		METRIC_COUNT,
+		// megabytes of memory
+		METRIC_MEMORY
+	};
+
+	struct METRIC
+	{
+		std::string name;
+		int copies;
+		METRIC_KIND kind;
+		std::vector<double> samples;
+		double value;
+		double noise;
+	};
+
+	// constructor
+	PerformanceGate();
+
+	// add one measurement of a metric for a scene size
+	void AddSample(const char* name, int copies, METRIC_KIND kind, double value);
+	// compute the value and noise of every metric from its
+	// samples, once all were added
+	void Summarize();
+	// renderer the metrics were measured with
+	void SetRenderer(const std::string& renderer) { m_renderer = renderer; }
+
+	// read a baseline, false when it is missing or has errors,
+	// which are reported with their line
+	bool Load(const char* filename);
+	// write the metrics as a baseline
+	bool Save(const char* filename) const;
+
+	// print a table of every baseline metric next to the
+	// measured one, false when any of them regressed or was
+	// not measured
+	bool Compare(const PerformanceGate& baseline, std::ostream& report) const;
+
+	// compare a frame with its reference image and write the
+	// differences amplified into an image, false when too many
+	// pixels differ or an image cannot be read
+	static bool CompareImages(
+		const char* imageFile,
+		const char* referenceFile,
+		const char* differenceFile,
+		std::ostream& report);
+
+private:
+	std::vector<METRIC> m_metrics;
+	std::string m_renderer;
+
+	int FindMetric(const std::string& name, int copies) const;
+};
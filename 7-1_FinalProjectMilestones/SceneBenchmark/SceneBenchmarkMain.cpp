@@ -0,0 +1,686 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebenchmarkmain.cpp
+// ============
+// benchmark of the renderer at scale - the scene is repeated on a grid from
+// one copy up to 100k copies, rendered headless for a fixed number of frames,
+// and the stage times, draws and memory of every size are written as JSON -
+// the results can be stored as a baseline and later runs checked against it
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderManager.h"
+#include "AllocationTracker.h"
+#include "CameraPath.h"
+#include "PerformanceGate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// copies of the scene measured when none are passed
+	const int g_DefaultCopies[] = { 1, 10, 100, 1000, 10000, 100000 };
+	// frames measured per size, after the warm up frames that
+	// let the buffers and the frame pipeline fill
+	const int g_DefaultFrames = 120;
+	const int g_DefaultWarmupFrames = 20;
+	// distance between the copies, the size of the patio ground
+	const float g_CopySpacing = 40.0f;
+	// camera over the center of the grid, looking down at it,
+	// when no camera path is passed
+	const glm::vec3 g_CameraPosition(0.0f, 25.0f, 45.0f);
+	const glm::vec3 g_CameraTarget(0.0f, 0.0f, 0.0f);
+
+	// measurements of one frame
+	struct FRAME_SAMPLE
+	{
+		// from the start of the frame until it finished rendering
+		double frameMilliseconds;
+		SceneManager::FRAME_PROFILE profile;
+		// waiting for the frame to finish rendering
+		double finishMilliseconds;
+		RenderCommandBuffer::REPLAY_STATS stats;
+		AllocationTracker::FRAME_ALLOCATIONS allocations;
+	};
+
+	// measurements of one scene size
+	struct RUN_RESULT
+	{
+		int copies;
+		uint32_t objectCount;
+		// creating the scene and loading its assets
+		double startupMilliseconds;
+		std::vector<FRAME_SAMPLE> frames;
+		uint64_t residentBytes;
+		uint64_t peakResidentBytes;
+		// which of the repeated runs of the size it was
+		int repeat;
+	};
+
+	// settings of the benchmark passed on the command line
+	struct BENCHMARK_SETTINGS
+	{
+		std::vector<int> copies;
+		int frameCount;
+		int warmupFrames;
+		int frameQueueDepth;
+		const char* sceneFile;
+		const char* outputFile;
+		CameraPath cameraPath;
+		// times every size is measured, for the noise of the
+		// metrics
+		int repeatCount;
+		// baseline checked against and baseline written, each
+		// with its reference image next to it
+		const char* baselineFile;
+		const char* writeBaselineFile;
+		// last frame of the first size, and the report of the
+		// baseline check
+		const char* imageFile;
+		const char* reportFile;
+	};
+
+	/***********************************************************
+	 *  GetResidentBytes()
+	 *
+	 *  This function is used for getting the memory the
+	 *  process has resident now and the most it had so far.
+	 ***********************************************************/
+	void GetResidentBytes(uint64_t& residentBytes, uint64_t& peakResidentBytes)
+	{
+		residentBytes = 0;
+		peakResidentBytes = 0;
+
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) != FALSE)
+		{
+			residentBytes = counters.WorkingSetSize;
+			peakResidentBytes = counters.PeakWorkingSetSize;
+		}
+#else
+		// the values are in kB
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			std::istringstream lineStream(line);
+			std::string key;
+			uint64_t value = 0;
+			lineStream >> key >> value;
+			if (key == "VmRSS:")
+			{
+				residentBytes = value * 1024;
+			}
+			else if (key == "VmHWM:")
+			{
+				peakResidentBytes = value * 1024;
+			}
+		}
+#endif
+	}
+
+	/***********************************************************
+	 *  GetPercentile()
+	 *
+	 *  This function is used for getting the nearest rank
+	 *  percentile of sorted values.
+	 ***********************************************************/
+	double GetPercentile(const std::vector<double>& sortedValues, int percentile)
+	{
+		if (sortedValues.empty() == true)
+		{
+			return(0.0);
+		}
+		size_t rank = (sortedValues.size() * percentile + 99) / 100;
+		return(sortedValues[std::max(rank, (size_t)1) - 1]);
+	}
+
+	/***********************************************************
+	 *  GetSortedFrameTimes()
+	 *
+	 *  This function is used for getting the frame times of a
+	 *  run in increasing order, for their percentiles.
+	 ***********************************************************/
+	std::vector<double> GetSortedFrameTimes(const RUN_RESULT& result)
+	{
+		std::vector<double> frameTimes;
+		for (size_t i = 0; i < result.frames.size(); i++)
+		{
+			frameTimes.push_back(result.frames[i].frameMilliseconds);
+		}
+		std::sort(frameTimes.begin(), frameTimes.end());
+		return(frameTimes);
+	}
+
+	/***********************************************************
+	 *  GetMean()
+	 *
+	 *  This function is used for averaging a value of the
+	 *  measured frames, read by the passed in function.
+	 ***********************************************************/
+	template <typename READ_FUNCTION>
+	double GetMean(const std::vector<FRAME_SAMPLE>& frames, READ_FUNCTION readValue)
+	{
+		double total = 0.0;
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			total += (double)readValue(frames[i]);
+		}
+		return((frames.empty() == false) ? total / frames.size() : 0.0);
+	}
+
+	/***********************************************************
+	 *  WriteJsonString()
+	 *
+	 *  This function is used for writing a quoted JSON string,
+	 *  escaping the characters JSON does not allow in one.
+	 ***********************************************************/
+	void WriteJsonString(std::ostream& stream, const char* text)
+	{
+		stream << '"';
+		for (const char* pChar = text; *pChar != '\0'; pChar++)
+		{
+			if ((*pChar == '"') || (*pChar == '\\'))
+			{
+				stream << '\\' << *pChar;
+			}
+			else if ((unsigned char)*pChar >= 0x20)
+			{
+				stream << *pChar;
+			}
+		}
+		stream << '"';
+	}
+
+	/***********************************************************
+	 *  RunScene()
+	 *
+	 *  This function is used for preparing the scene with the
+	 *  passed in number of copies and rendering the warm up
+	 *  and the measured frames.  Every frame waits until it is
+	 *  rendered, so its time covers the rasterization, which
+	 *  is done by the CPU on nodes without a GPU.  The last
+	 *  frame is saved when an image file is passed.
+	 ***********************************************************/
+	void RunScene(
+		const BENCHMARK_SETTINGS& settings,
+		int copies,
+		ShaderManager* pShaderManager,
+		ViewManager* pViewManager,
+		const char* imageFile,
+		RUN_RESULT& result)
+	{
+		result.copies = copies;
+		result.frames.clear();
+		result.frames.reserve(settings.frameCount);
+
+		std::chrono::steady_clock::time_point startupStart = std::chrono::steady_clock::now();
+		SceneManager* pSceneManager = new SceneManager(pShaderManager);
+		if (settings.sceneFile != NULL)
+		{
+			pSceneManager->SetSceneFile(settings.sceneFile);
+		}
+		pSceneManager->SetSceneCopies(copies, g_CopySpacing);
+		pSceneManager->SetPreloadAssets(true);
+		pSceneManager->SetFrameQueueDepth(settings.frameQueueDepth);
+		pSceneManager->PrepareScene();
+		result.startupMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - startupStart).count();
+		result.objectCount = pSceneManager->GetObjectCount();
+
+		for (int frame = 0; frame < settings.warmupFrames + settings.frameCount; frame++)
+		{
+			std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+			AllocationTracker::BeginFrame();
+
+			glEnable(GL_DEPTH_TEST);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			glm::vec3 position = g_CameraPosition;
+			glm::vec3 front = glm::normalize(g_CameraTarget - g_CameraPosition);
+			settings.cameraPath.GetPose(frame, position, front);
+			pViewManager->SetCameraPose(position, front);
+			pViewManager->PrepareSceneView();
+			pSceneManager->SetViewTransforms(
+				pViewManager->GetViewMatrix(),
+				pViewManager->GetProjectionMatrix());
+			pSceneManager->RenderScene();
+
+			std::chrono::steady_clock::time_point submitEnd = std::chrono::steady_clock::now();
+			pViewManager->FinishOffscreenFrame();
+			std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+			AllocationTracker::FRAME_ALLOCATIONS allocations = AllocationTracker::EndFrame();
+
+			if (frame < settings.warmupFrames)
+			{
+				continue;
+			}
+
+			FRAME_SAMPLE sample;
+			sample.frameMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+			sample.profile = pSceneManager->GetFrameProfile();
+			sample.finishMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - submitEnd).count();
+			sample.stats = pSceneManager->GetReplayStats();
+			sample.allocations = allocations;
+			result.frames.push_back(sample);
+		}
+
+		if (imageFile != NULL)
+		{
+			pViewManager->SaveOffscreenImage(imageFile);
+		}
+		GetResidentBytes(result.residentBytes, result.peakResidentBytes);
+		delete pSceneManager;
+	}
+
+	/***********************************************************
+	 *  ReportRun()
+	 *
+	 *  This function is used for printing one line of the
+	 *  summary table.
+	 ***********************************************************/
+	void ReportRun(const RUN_RESULT& result)
+	{
+		std::vector<double> frameTimes = GetSortedFrameTimes(result);
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(8) << result.copies
+			<< std::setw(11) << result.objectCount
+			<< std::setw(12) << GetMean(result.frames, [](const FRAME_SAMPLE& f) { return f.frameMilliseconds; })
+			<< std::setw(12) << GetPercentile(frameTimes, 95)
+			<< std::setw(10) << std::setprecision(0)
+			<< GetMean(result.frames, [](const FRAME_SAMPLE& f) { return f.stats.drawCalls; })
+			<< std::setw(14) << GetMean(result.frames, [](const FRAME_SAMPLE& f) { return f.profile.triangles; })
+			<< std::setw(10) << result.residentBytes / (1024 * 1024)
+			<< std::defaultfloat << std::endl;
+	}
+
+	/***********************************************************
+	 *  WriteResults()
+	 *
+	 *  This function is used for writing every measured size
+	 *  as JSON, with the frame time percentiles, the average
+	 *  CPU time of each stage and the average draws and heap
+	 *  allocations of a frame.
+	 ***********************************************************/
+	bool WriteResults(const BENCHMARK_SETTINGS& settings, const std::vector<RUN_RESULT>& results)
+	{
+		std::ofstream file(settings.outputFile, std::ios::trunc);
+		file << std::setprecision(6);
+		file << "{\n";
+		file << "  \"benchmark\": \"scene\",\n";
+		file << "  \"renderer\": ";
+		WriteJsonString(file, (const char*)glGetString(GL_RENDERER));
+		file << ",\n  \"glVersion\": ";
+		WriteJsonString(file, (const char*)glGetString(GL_VERSION));
+		file << ",\n";
+		file << "  \"frames\": " << settings.frameCount << ",\n";
+		file << "  \"warmupFrames\": " << settings.warmupFrames << ",\n";
+		file << "  \"frameQueueDepth\": " << settings.frameQueueDepth << ",\n";
+		file << "  \"repeatCount\": " << settings.repeatCount << ",\n";
+		file << "  \"cameraPath\": " << ((settings.cameraPath.IsEmpty() == false) ? "true" : "false") << ",\n";
+		file << "  \"allocationsTracked\": " << ((AllocationTracker::IsEnabled() == true) ? "true" : "false") << ",\n";
+		file << "  \"runs\": [";
+
+		for (size_t r = 0; r < results.size(); r++)
+		{
+			const RUN_RESULT& result = results[r];
+			const std::vector<FRAME_SAMPLE>& frames = result.frames;
+			std::vector<double> frameTimes = GetSortedFrameTimes(result);
+
+			file << ((r > 0) ? "," : "") << "\n    {\n";
+			file << "      \"copies\": " << result.copies << ",\n";
+			file << "      \"repeat\": " << result.repeat << ",\n";
+			file << "      \"objects\": " << result.objectCount << ",\n";
+			file << "      \"startupMs\": " << result.startupMilliseconds << ",\n";
+			file << "      \"frameMs\": { "
+				<< "\"mean\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.frameMilliseconds; })
+				<< ", \"p50\": " << GetPercentile(frameTimes, 50)
+				<< ", \"p95\": " << GetPercentile(frameTimes, 95)
+				<< ", \"p99\": " << GetPercentile(frameTimes, 99)
+				<< ", \"max\": " << ((frameTimes.empty() == false) ? frameTimes.back() : 0.0) << " },\n";
+			file << "      \"stageMs\": { "
+				<< "\"update\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.updateMilliseconds; })
+				<< ", \"cull\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.cullMilliseconds; })
+				<< ", \"record\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.recordMilliseconds; })
+				<< ", \"submit\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.submitMilliseconds; })
+				<< ", \"finish\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.finishMilliseconds; }) << " },\n";
+			file << "      \"visibleObjects\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.visibleObjects; }) << ",\n";
+			file << "      \"uploadedObjects\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.uploadedObjects; }) << ",\n";
+			file << "      \"gpuCullDrawCalls\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.gpuCullDrawCalls; }) << ",\n";
+			file << "      \"occlusionSkippedDraws\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.occlusionSkippedDraws; }) << ",\n";
+			file << "      \"hiZCulledObjects\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.hiZCulledObjects; }) << ",\n";
+			file << "      \"lodTriangles\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.lodTriangles; }) << ",\n";
+			file << "      \"drawCalls\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.stats.drawCalls; }) << ",\n";
+			file << "      \"stateChanges\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.stats.stateChanges; }) << ",\n";
+			file << "      \"commands\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.stats.commandCount; }) << ",\n";
+			file << "      \"triangles\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.triangles; }) << ",\n";
+			file << "      \"memory\": { "
+				<< "\"allocationsPerFrame\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.allocations.count; })
+				<< ", \"allocatedBytesPerFrame\": " << GetMean(frames, [](const FRAME_SAMPLE& f) { return f.allocations.bytes; })
+				<< ", \"residentBytes\": " << result.residentBytes
+				<< ", \"peakResidentBytes\": " << result.peakResidentBytes << " }\n";
+			file << "    }";
+		}
+		file << "\n  ]\n}\n";
+
+		if (!file)
+		{
+			std::cout << "ERROR: Could not write benchmark results " << settings.outputFile << std::endl;
+			return(false);
+		}
+		std::cout << "\nINFO: Wrote benchmark results to " << settings.outputFile << std::endl;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AddRunMetrics()
+	 *
+	 *  This function is used for adding the metrics of a run
+	 *  that are checked against the baseline.  The resident
+	 *  memory is taken while the scene is loaded, since the
+	 *  peak covers the larger sizes measured before it.
+	 ***********************************************************/
+	void AddRunMetrics(PerformanceGate& gate, const RUN_RESULT& result)
+	{
+		const std::vector<FRAME_SAMPLE>& frames = result.frames;
+		std::vector<double> frameTimes = GetSortedFrameTimes(result);
+		int copies = result.copies;
+
+		gate.AddSample("startup_ms", copies, PerformanceGate::METRIC_TIME, result.startupMilliseconds);
+		gate.AddSample("frame_mean_ms", copies, PerformanceGate::METRIC_TIME,
+			GetMean(frames, [](const FRAME_SAMPLE& f) { return f.frameMilliseconds; }));
+		gate.AddSample("frame_p50_ms", copies, PerformanceGate::METRIC_TIME, GetPercentile(frameTimes, 50));
+		gate.AddSample("frame_p95_ms", copies, PerformanceGate::METRIC_TIME, GetPercentile(frameTimes, 95));
+		gate.AddSample("frame_p99_ms", copies, PerformanceGate::METRIC_TIME, GetPercentile(frameTimes, 99));
+		gate.AddSample("draw_calls", copies, PerformanceGate::METRIC_COUNT,
+			GetMean(frames, [](const FRAME_SAMPLE& f) { return f.stats.drawCalls; }));
+		gate.AddSample("state_changes", copies, PerformanceGate::METRIC_COUNT,
+			GetMean(frames, [](const FRAME_SAMPLE& f) { return f.stats.stateChanges; }));
+		gate.AddSample("triangles", copies, PerformanceGate::METRIC_COUNT,
+			GetMean(frames, [](const FRAME_SAMPLE& f) { return f.profile.triangles; }));
+		// a build without the tracker counts no allocations, which
+		// would pass against any baseline, so the metric is left out
+		// and the gate reports it as not measured
+		if (AllocationTracker::IsEnabled() == true)
+		{
+			gate.AddSample("allocations_per_frame", copies, PerformanceGate::METRIC_COUNT,
+				GetMean(frames, [](const FRAME_SAMPLE& f) { return f.allocations.count; }));
+		}
+		gate.AddSample("resident_mb", copies, PerformanceGate::METRIC_MEMORY,
+			(double)result.residentBytes / (1024.0 * 1024.0));
+	}
+
+	/***********************************************************
+	 *  CopyImage()
+	 *
+	 *  This function is used for copying the saved frame to
+	 *  the reference image of a baseline.
+	 ***********************************************************/
+	bool CopyImage(const char* sourceFile, const std::string& targetFile)
+	{
+		std::ifstream source(sourceFile, std::ios::binary);
+		std::ofstream target(targetFile.c_str(), std::ios::binary | std::ios::trunc);
+		target << source.rdbuf();
+		if (!source || !target)
+		{
+			std::cout << "ERROR: Could not write reference image " << targetFile << std::endl;
+			return(false);
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  CheckBaseline()
+	 *
+	 *  This function is used for checking the metrics and the
+	 *  saved frame against the baseline and its reference
+	 *  image.  The report is printed, and written to the
+	 *  report file when one is passed.
+	 ***********************************************************/
+	bool CheckBaseline(const BENCHMARK_SETTINGS& settings, const PerformanceGate& gate)
+	{
+		PerformanceGate baseline;
+		if (baseline.Load(settings.baselineFile) == false)
+		{
+			return(false);
+		}
+
+		std::string referenceFile = std::string(settings.baselineFile) + ".ppm";
+		std::string differenceFile = settings.imageFile;
+		if ((differenceFile.size() > 4) && (differenceFile.compare(differenceFile.size() - 4, 4, ".ppm") == 0))
+		{
+			differenceFile.erase(differenceFile.size() - 4);
+		}
+		differenceFile += "_diff.ppm";
+
+		std::ostringstream report;
+		report << "=== Performance against " << settings.baselineFile << " ===\n";
+		bool bPassed = gate.Compare(baseline, report);
+		report << "\n=== Frame against " << referenceFile << " ===\n";
+		bPassed = PerformanceGate::CompareImages(settings.imageFile, referenceFile.c_str(),
+			differenceFile.c_str(), report) && bPassed;
+		report << "\n" << ((bPassed == true) ? "PASS" : "FAIL") << ": Performance gate\n";
+
+		std::cout << "\n" << report.str() << std::flush;
+		if (settings.reportFile != NULL)
+		{
+			std::ofstream file(settings.reportFile, std::ios::trunc);
+			file << report.str();
+			if (!file)
+			{
+				std::cout << "ERROR: Could not write report " << settings.reportFile << std::endl;
+				return(false);
+			}
+		}
+		return(bPassed);
+	}
+
+	/***********************************************************
+	 *  ReadCopies()
+	 *
+	 *  This function is used for reading a comma separated
+	 *  list of scene copies.
+	 ***********************************************************/
+	bool ReadCopies(const char* text, std::vector<int>& copies)
+	{
+		copies.clear();
+		std::istringstream stream(text);
+		std::string value;
+		while (std::getline(stream, value, ','))
+		{
+			int count = atoi(value.c_str());
+			if (count <= 0)
+			{
+				return(false);
+			}
+			copies.push_back(count);
+		}
+		return(copies.empty() == false);
+	}
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function creates the offscreen view, measures each
+ *  scene size in turn and writes the results.  It is run
+ *  from the project directory, like the application, so the
+ *  shaders, scenes and textures are found.  With a baseline
+ *  it fails when the run regressed against it, so it can
+ *  gate changes on a batch node:
+ *
+ *    SceneBenchmark --copies 1,100 --repeat 5
+ *        --write-baseline scenes/patio.baseline
+ *    SceneBenchmark --copies 1,100 --repeat 5
+ *        --baseline scenes/patio.baseline --report gate.txt
+ *
+ *  The CMake build runs these as the performance_baseline
+ *  target, and as the performance_gate target once the
+ *  baseline is checked in.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	BENCHMARK_SETTINGS settings;
+	settings.copies.assign(g_DefaultCopies, g_DefaultCopies + sizeof(g_DefaultCopies) / sizeof(g_DefaultCopies[0]));
+	settings.frameCount = g_DefaultFrames;
+	settings.warmupFrames = g_DefaultWarmupFrames;
+	settings.frameQueueDepth = 2;
+	settings.sceneFile = NULL;
+	settings.outputFile = "scene_benchmark.json";
+	settings.repeatCount = 1;
+	settings.baselineFile = NULL;
+	settings.writeBaselineFile = NULL;
+	settings.imageFile = NULL;
+	settings.reportFile = NULL;
+
+	bool bValid = true;
+	for (int i = 1; (i < argc) && (bValid == true); i++)
+	{
+		bool bHasValue = (i + 1 < argc);
+		if ((strcmp(argv[i], "--copies") == 0) && (bHasValue == true))
+			bValid = ReadCopies(argv[++i], settings.copies);
+		else if ((strcmp(argv[i], "--frames") == 0) && (bHasValue == true))
+			bValid = ((settings.frameCount = atoi(argv[++i])) > 0);
+		else if ((strcmp(argv[i], "--warmup") == 0) && (bHasValue == true))
+			bValid = ((settings.warmupFrames = atoi(argv[++i])) >= 0);
+		else if ((strcmp(argv[i], "--frame-queue-depth") == 0) && (bHasValue == true))
+			bValid = ((settings.frameQueueDepth = atoi(argv[++i])) > 0);
+		else if ((strcmp(argv[i], "--scene") == 0) && (bHasValue == true))
+			settings.sceneFile = argv[++i];
+		else if ((strcmp(argv[i], "--camera-path") == 0) && (bHasValue == true))
+			bValid = settings.cameraPath.Load(argv[++i]);
+		else if ((strcmp(argv[i], "--output") == 0) && (bHasValue == true))
+			settings.outputFile = argv[++i];
+		else if ((strcmp(argv[i], "--repeat") == 0) && (bHasValue == true))
+			bValid = ((settings.repeatCount = atoi(argv[++i])) > 0);
+		else if ((strcmp(argv[i], "--baseline") == 0) && (bHasValue == true))
+			settings.baselineFile = argv[++i];
+		else if ((strcmp(argv[i], "--write-baseline") == 0) && (bHasValue == true))
+			settings.writeBaselineFile = argv[++i];
+		else if ((strcmp(argv[i], "--image") == 0) && (bHasValue == true))
+			settings.imageFile = argv[++i];
+		else if ((strcmp(argv[i], "--report") == 0) && (bHasValue == true))
+			settings.reportFile = argv[++i];
+		else
+			bValid = false;
+	}
+	// the baselines have a reference image of the first size
+	if (((settings.baselineFile != NULL) || (settings.writeBaselineFile != NULL)) && (settings.imageFile == NULL))
+	{
+		settings.imageFile = "scene_benchmark.ppm";
+	}
+	if (bValid == false)
+	{
+		std::cout << "usage: SceneBenchmark [--copies 1,10,100] [--frames n] [--warmup n]\n"
+			<< "                      [--frame-queue-depth 1-3] [--scene file] [--camera-path file]\n"
+			<< "                      [--output file.json] [--repeat n] [--image file.ppm]\n"
+			<< "                      [--baseline file] [--write-baseline file] [--report file]" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	// a missing baseline fails before the runs, which take minutes
+	if ((settings.baselineFile != NULL) && (!std::ifstream(settings.baselineFile)))
+	{
+		std::cout << "ERROR: No performance baseline " << settings.baselineFile << " - record it on the reference node with\n"
+			<< "       --write-baseline " << settings.baselineFile << " and check it in with its .ppm image" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	AllocationTracker::Initialize();
+	if ((settings.writeBaselineFile != NULL) && (AllocationTracker::IsEnabled() == false))
+	{
+		std::cout << "WARNING: Allocations are not tracked in this build, so the baseline will not gate them" << std::endl;
+	}
+
+#ifndef HEADLESS_EGL
+	// the hidden window of the offscreen view needs GLFW
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+
+	ShaderManager* pShaderManager = new ShaderManager();
+	ViewManager* pViewManager = new ViewManager(pShaderManager);
+	if (pViewManager->CreateOffscreenView() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	GLenum glewResult = glewInit();
+	if (glewResult != GLEW_OK)
+	{
+		std::cout << "ERROR: " << glewGetErrorString(glewResult) << std::endl;
+		return(EXIT_FAILURE);
+	}
+	if (pViewManager->CreateOffscreenTarget() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	std::cout << "INFO: Rendering with " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+
+	pShaderManager->LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+	pShaderManager->use();
+
+	// the sizes are measured in turn and then again, so a slow
+	// stretch of the node falls on all of them
+	std::vector<RUN_RESULT> results(settings.copies.size() * settings.repeatCount);
+	PerformanceGate gate;
+	gate.SetRenderer((const char*)glGetString(GL_RENDERER));
+	for (int repeat = 0; repeat < settings.repeatCount; repeat++)
+	{
+		for (size_t i = 0; i < settings.copies.size(); i++)
+		{
+			RUN_RESULT& result = results[repeat * settings.copies.size() + i];
+			const char* imageFile = ((repeat == 0) && (i == 0)) ? settings.imageFile : NULL;
+
+			std::cout << "INFO: Measuring " << settings.copies[i] << " copies of the scene, run "
+				<< repeat + 1 << " of " << settings.repeatCount << std::endl;
+			RunScene(settings, settings.copies[i], pShaderManager, pViewManager, imageFile, result);
+			result.repeat = repeat;
+			AddRunMetrics(gate, result);
+		}
+	}
+	gate.Summarize();
+
+	std::cout << "\n  copies    objects    frame ms     p95 ms     draws     triangles    RSS MB" << std::endl;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		ReportRun(results[i]);
+	}
+	bool bPassed = WriteResults(settings, results);
+
+	if (settings.writeBaselineFile != NULL)
+	{
+		bPassed = gate.Save(settings.writeBaselineFile) &&
+			CopyImage(settings.imageFile, std::string(settings.writeBaselineFile) + ".ppm") && bPassed;
+	}
+	if (settings.baselineFile != NULL)
+	{
+		bPassed = CheckBaseline(settings, gate) && bPassed;
+	}
+
+	delete pViewManager;
+	delete pShaderManager;
+	return((bPassed == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,304 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenecompilermain.cpp
+// ============
+// command line tool that compiles a scene and every asset it references into
+// one asset pack, so the application opens a single file at startup and
+// uploads from it without decoding images or generating meshes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+#include "SceneFile.h"
+#include "MeshLibrary.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// one entry of the pack being written, with its data
+	struct PACK_ITEM
+	{
+		AssetPack::ENTRY entry;
+		std::vector<uint8_t> data;
+	};
+
+	/***********************************************************
+	 *  AddItem()
+	 *
+	 *  This function is used for adding an entry to the pack
+	 *  being written.  The offset is filled in when the pack
+	 *  is laid out.
+	 ***********************************************************/
+	bool AddItem(
+		std::vector<PACK_ITEM>& items,
+		AssetPack::ENTRY_TYPE type,
+		const char* name,
+		const void* pData,
+		size_t size)
+	{
+		if (strlen(name) >= AssetPack::NAME_LENGTH)
+		{
+			std::cout << "ERROR: Entry name " << name << " is too long for the pack" << std::endl;
+			return(false);
+		}
+
+		PACK_ITEM item;
+		memset(&item.entry, 0, sizeof(item.entry));
+		memcpy(item.entry.name, name, strlen(name));
+		item.entry.type = (uint32_t)type;
+		item.entry.size = (uint32_t)size;
+		item.data.assign((const uint8_t*)pData, (const uint8_t*)pData + size);
+		items.push_back(item);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  BuildMipLevels()
+	 *
+	 *  This function is used for filtering an RGBA8 image down
+	 *  to 1 x 1, averaging each 2 x 2 block of the level above.
+	 *  Odd edges repeat their last row or column.  The levels
+	 *  are appended to the image, and their count returned.
+	 ***********************************************************/
+	uint32_t BuildMipLevels(std::vector<uint8_t>& levels, uint32_t width, uint32_t height)
+	{
+		uint32_t levelCount = 1;
+		size_t sourceStart = 0;
+
+		while ((AssetPack::GetLevelSize(width, levelCount - 1) > 1) ||
+			(AssetPack::GetLevelSize(height, levelCount - 1) > 1))
+		{
+			uint32_t sourceWidth = AssetPack::GetLevelSize(width, levelCount - 1);
+			uint32_t sourceHeight = AssetPack::GetLevelSize(height, levelCount - 1);
+			uint32_t levelWidth = AssetPack::GetLevelSize(width, levelCount);
+			uint32_t levelHeight = AssetPack::GetLevelSize(height, levelCount);
+			size_t levelStart = levels.size();
+
+			levels.resize(levelStart + (size_t)levelWidth * levelHeight * 4);
+			const uint8_t* pSource = levels.data() + sourceStart;
+			uint8_t* pLevel = levels.data() + levelStart;
+
+			for (uint32_t y = 0; y < levelHeight; y++)
+			{
+				uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+				uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+				for (uint32_t x = 0; x < levelWidth; x++)
+				{
+					uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+					uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+					for (int channel = 0; channel < 4; channel++)
+					{
+						uint32_t sum =
+							pSource[((size_t)y0 * sourceWidth + x0) * 4 + channel] +
+							pSource[((size_t)y0 * sourceWidth + x1) * 4 + channel] +
+							pSource[((size_t)y1 * sourceWidth + x0) * 4 + channel] +
+							pSource[((size_t)y1 * sourceWidth + x1) * 4 + channel];
+						pLevel[((size_t)y * levelWidth + x) * 4 + channel] = (uint8_t)((sum + 2) / 4);
+					}
+				}
+			}
+
+			sourceStart = levelStart;
+			levelCount++;
+		}
+
+		return(levelCount);
+	}
+
+	/***********************************************************
+	 *  AddTexture()
+	 *
+	 *  This function is used for decoding a texture image the
+	 *  same way the application does, flipped vertically, and
+	 *  adding it to the pack as RGBA8 with all its mip levels.
+	 ***********************************************************/
+	bool AddTexture(std::vector<PACK_ITEM>& items, const char* tag, const char* filename)
+	{
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+
+		stbi_set_flip_vertically_on_load(true);
+		unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, 4);
+		if (image == NULL)
+		{
+			std::cout << "ERROR: Could not load image " << filename << std::endl;
+			return(false);
+		}
+
+		std::vector<uint8_t> levels(image, image + (size_t)width * height * 4);
+		stbi_image_free(image);
+		uint32_t levelCount = BuildMipLevels(levels, (uint32_t)width, (uint32_t)height);
+
+		if (AddItem(items, AssetPack::ENTRY_TEXTURE, tag, levels.data(), levels.size()) == false)
+		{
+			return(false);
+		}
+		items.back().entry.values[0] = (uint32_t)width;
+		items.back().entry.values[1] = (uint32_t)height;
+		items.back().entry.values[2] = levelCount;
+
+		std::cout << "INFO: Texture " << tag << " - " << width << " x " << height << ", "
+			<< levelCount << " levels, " << levels.size() / 1024 << " KB" << std::endl;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AddMeshPool()
+	 *
+	 *  This function is used for generating and optimizing the
+	 *  mesh pool, packing its vertices the way the application
+	 *  draws them, and adding the vertices, the indices and a
+	 *  table of the ranges with their bounds to the pack.
+	 ***********************************************************/
+	bool AddMeshPool(std::vector<PACK_ITEM>& items)
+	{
+		MeshLibrary::MESH_DATA pool;
+		MeshLibrary::MESH_RANGE ranges[MeshLibrary::POOL_RANGE_COUNT];
+		MeshLibrary::BuildMeshPool(pool, ranges);
+
+		std::vector<AssetPack::MESH_ENTRY> meshes(MeshLibrary::POOL_RANGE_COUNT);
+		for (int i = 0; i < MeshLibrary::POOL_RANGE_COUNT; i++)
+		{
+			AssetPack::MESH_ENTRY& mesh = meshes[i];
+			mesh.firstIndex = ranges[i].firstIndex;
+			mesh.indexCount = ranges[i].indexCount;
+			mesh.baseVertex = ranges[i].baseVertex;
+
+			glm::vec3 boundsMin(0.0f);
+			glm::vec3 boundsMax(0.0f);
+			for (uint32_t index = 0; index < mesh.indexCount; index++)
+			{
+				const glm::vec3& position = pool.vertices[mesh.baseVertex + pool.indices[mesh.firstIndex + index]].position;
+				boundsMin = (index == 0) ? position : glm::min(boundsMin, position);
+				boundsMax = (index == 0) ? position : glm::max(boundsMax, position);
+			}
+			for (int axis = 0; axis < 3; axis++)
+			{
+				mesh.boundsMin[axis] = boundsMin[axis];
+				mesh.boundsMax[axis] = boundsMax[axis];
+			}
+		}
+
+		std::vector<MeshLibrary::PACKED_VERTEX> packedVertices;
+		MeshLibrary::PackVertices(pool.vertices, packedVertices);
+
+		bool bAdded =
+			AddItem(items, AssetPack::ENTRY_MESH_VERTICES, AssetPack::MESH_POOL_ENTRY_NAME,
+				packedVertices.data(), packedVertices.size() * sizeof(MeshLibrary::PACKED_VERTEX)) &&
+			AddItem(items, AssetPack::ENTRY_MESH_INDICES, AssetPack::MESH_POOL_ENTRY_NAME,
+				pool.indices.data(), pool.indices.size() * sizeof(uint32_t)) &&
+			AddItem(items, AssetPack::ENTRY_MESH_TABLE, AssetPack::MESH_POOL_ENTRY_NAME,
+				meshes.data(), meshes.size() * sizeof(AssetPack::MESH_ENTRY));
+		if (bAdded == false)
+		{
+			return(false);
+		}
+
+		items[items.size() - 3].entry.values[0] = MeshLibrary::VERTEX_FORMAT_PACKED;
+		items[items.size() - 3].entry.values[1] = (uint32_t)packedVertices.size();
+		items[items.size() - 2].entry.values[0] = (uint32_t)pool.indices.size();
+		return(true);
+	}
+
+	/***********************************************************
+	 *  WritePack()
+	 *
+	 *  This function is used for laying out the entries, each
+	 *  one on a page of its own after the header and the table
+	 *  of contents, and writing the pack.
+	 ***********************************************************/
+	bool WritePack(std::vector<PACK_ITEM>& items, const char* filename)
+	{
+		const uint64_t alignment = AssetPack::ENTRY_ALIGNMENT;
+
+		AssetPack::HEADER header;
+		header.magic = AssetPack::MAGIC;
+		header.version = AssetPack::VERSION;
+		header.entryCount = (uint32_t)items.size();
+		header.tocOffset = (uint32_t)sizeof(AssetPack::HEADER);
+
+		uint64_t offset = header.tocOffset + items.size() * sizeof(AssetPack::ENTRY);
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			offset = (offset + alignment - 1) / alignment * alignment;
+			items[i].entry.offset = (uint32_t)offset;
+			offset += items[i].data.size();
+		}
+		if (offset > 0xFFFFFFFF)
+		{
+			std::cout << "ERROR: Asset pack would be larger than 4 GB" << std::endl;
+			return(false);
+		}
+		header.packSize = (uint32_t)offset;
+
+		std::vector<uint8_t> pack(header.packSize, 0);
+		memcpy(pack.data(), &header, sizeof(header));
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			memcpy(pack.data() + header.tocOffset + i * sizeof(AssetPack::ENTRY), &items[i].entry, sizeof(AssetPack::ENTRY));
+			if (items[i].data.empty() == false)
+			{
+				memcpy(pack.data() + items[i].entry.offset, items[i].data.data(), items[i].data.size());
+			}
+		}
+
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+		file.write((const char*)pack.data(), (std::streamsize)pack.size());
+		if (!file)
+		{
+			std::cout << "ERROR: Could not write asset pack " << filename << std::endl;
+			return(false);
+		}
+
+		std::cout << "INFO: Wrote " << filename << " - " << items.size() << " entries, "
+			<< pack.size() / 1024 << " KB" << std::endl;
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function compiles the scene file passed in, reads
+ *  the textures it references and generates the mesh pool,
+ *  and writes all of them into the asset pack passed in.
+ *  The texture files are found relative to the working
+ *  directory, like the application finds them.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		std::cout << "usage: SceneCompiler <scene file> <asset pack>" << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	SceneFile sceneFile;
+	if (sceneFile.Open(argv[1]) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	std::vector<PACK_ITEM> items;
+	bool bCompiled = AddItem(items, AssetPack::ENTRY_SCENE, AssetPack::SCENE_ENTRY_NAME,
+		sceneFile.GetImage(), sceneFile.GetImageSize());
+
+	for (uint32_t i = 0; (i < sceneFile.GetTextureCount()) && (bCompiled == true); i++)
+	{
+		const SceneFile::TEXTURE& texture = sceneFile.GetTexture(i);
+		bCompiled = AddTexture(items, sceneFile.GetString(texture.tag), sceneFile.GetString(texture.filename));
+	}
+
+	bCompiled = bCompiled && AddMeshPool(items) && WritePack(items, argv[2]);
+	return((bCompiled == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,576 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationtracker.cpp
+// ============
+// heap allocation counting for proving that the steady state frames do not
+// allocate - global operator new and delete are replaced, and malloc is
+// hooked through the debug CRT on Windows and replaced on glibc, in builds
+// with TRACK_ALLOCATIONS defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#if defined(TRACK_ALLOCATIONS)
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <dbghelp.h>
+#pragma comment(lib, "dbghelp.lib")
+#else
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// call stacks kept per frame, and their depth
+	const int g_MaxCallStacks = 8;
+	const int g_MaxStackFrames = 32;
+	// distinct call stacks remembered as reported
+	const int g_MaxReportedStacks = 256;
+
+	// call stack of one allocation
+	struct CALL_STACK
+	{
+		size_t size;
+		int frameCount;
+		void* frames[g_MaxStackFrames];
+	};
+
+	// whether the allocations are counted, which starts with the
+	// first tracked frame
+	std::atomic<bool> g_bTracking(false);
+	// allocations since the frame began, and the call stacks of
+	// the first ones, which are only stored and taken out with
+	// the lock held - the count is also read without it, so the
+	// later allocations of a frame do not take the lock
+	std::atomic<uint64_t> g_allocationCount(0);
+	std::atomic<uint64_t> g_allocationBytes(0);
+	std::mutex g_callStackMutex;
+	std::atomic<int> g_callStackCount(0);
+	CALL_STACK g_callStacks[g_MaxCallStacks];
+
+	// call stacks of the last tracked frame
+	CALL_STACK g_frameCallStacks[g_MaxCallStacks];
+	int g_frameCallStackCount = 0;
+	// hashes of the call stacks already reported
+	uint64_t g_reportedHashes[g_MaxReportedStacks];
+	int g_reportedCount = 0;
+
+	// the thread ending a frame is not counted until it begins
+	// the next one, while the other threads keep being counted
+	thread_local bool t_bPaused = false;
+	// set while a hook runs, so the hook's own work is not counted
+	thread_local bool t_bInHook = false;
+}
+
+#if defined(TRACK_ALLOCATIONS)
+namespace
+{
+	/***********************************************************
+	 *  CaptureCallStack()
+	 *
+	 *  This function is used for reading the return addresses
+	 *  of the calling thread without allocating memory.
+	 ***********************************************************/
+	int CaptureCallStack(void** frames, int maxFrames)
+	{
+#if defined(_WIN32)
+		return((int)CaptureStackBackTrace(2, (DWORD)maxFrames, frames, NULL));
+#else
+		return(backtrace(frames, maxFrames));
+#endif
+	}
+
+	/***********************************************************
+	 *  TrackedMalloc()
+	 *
+	 *  This function is used for allocating the memory of the
+	 *  replaced operator new and counting it.
+	 ***********************************************************/
+	void* TrackedMalloc(size_t size)
+	{
+		// malloc is counted by the CRT hook or the replaced
+		// malloc as well, which skip the allocations made here
+		bool bInHook = t_bInHook;
+		t_bInHook = true;
+		void* pMemory = std::malloc((size > 0) ? size : 1);
+		t_bInHook = bInHook;
+
+		if (pMemory != NULL)
+		{
+			AllocationTracker::RecordAllocation(size);
+		}
+		return(pMemory);
+	}
+
+#if defined(__cpp_aligned_new)
+	/***********************************************************
+	 *  TrackedAlignedMalloc()
+	 *
+	 *  This function is used for allocating the memory of the
+	 *  replaced aligned operator new and counting it.
+	 ***********************************************************/
+	void* TrackedAlignedMalloc(size_t size, size_t alignment)
+	{
+		bool bInHook = t_bInHook;
+		t_bInHook = true;
+#if defined(_WIN32)
+		void* pMemory = _aligned_malloc((size > 0) ? size : 1, alignment);
+#else
+		// aligned_alloc needs a size that is a multiple of the
+		// alignment
+		size_t alignedSize = ((std::max(size, (size_t)1) + alignment - 1) / alignment) * alignment;
+		void* pMemory = aligned_alloc(alignment, alignedSize);
+#endif
+		t_bInHook = bInHook;
+
+		if (pMemory != NULL)
+		{
+			AllocationTracker::RecordAllocation(size);
+		}
+		return(pMemory);
+	}
+
+	/***********************************************************
+	 *  AlignedFree()
+	 *
+	 *  This function is used for freeing the memory of the
+	 *  replaced aligned operator new.
+	 ***********************************************************/
+	void AlignedFree(void* pMemory)
+	{
+#if defined(_WIN32)
+		_aligned_free(pMemory);
+#else
+		std::free(pMemory);
+#endif
+	}
+#endif
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+	/***********************************************************
+	 *  CrtAllocationHook()
+	 *
+	 *  This function is used for counting the allocations of
+	 *  malloc and realloc through the debug CRT.  The CRT's own
+	 *  internal blocks are not counted.
+	 ***********************************************************/
+	int __cdecl CrtAllocationHook(
+		int allocationType,
+		void*,
+		size_t size,
+		int blockType,
+		long,
+		const unsigned char*,
+		int)
+	{
+		if (((allocationType == _HOOK_ALLOC) || (allocationType == _HOOK_REALLOC)) &&
+			(blockType != _CRT_BLOCK))
+		{
+			AllocationTracker::RecordAllocation(size);
+		}
+		return(TRUE);
+	}
+#endif
+}
+
+#if defined(__GLIBC__)
+// the allocation functions of glibc itself, which the replaced
+// ones below forward to
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pMemory, size_t size);
+extern "C" void __libc_free(void* pMemory);
+
+/***********************************************************
+ *  malloc()
+ *
+ *  This function replaces malloc of glibc for the whole
+ *  program, including the libraries it loads, and counts
+ *  the allocations like the debug CRT hook does on Windows.
+ *  The tracker sets t_bInHook while it allocates itself, so
+ *  its own allocations are not counted.
+ ***********************************************************/
+extern "C" void* malloc(size_t size) noexcept
+{
+	void* pMemory = __libc_malloc(size);
+	if (pMemory != NULL)
+	{
+		AllocationTracker::RecordAllocation(size);
+	}
+	return(pMemory);
+}
+
+/***********************************************************
+ *  calloc()
+ *
+ *  This function replaces calloc of glibc and counts the
+ *  allocation.
+ ***********************************************************/
+extern "C" void* calloc(size_t count, size_t size) noexcept
+{
+	void* pMemory = __libc_calloc(count, size);
+	if (pMemory != NULL)
+	{
+		AllocationTracker::RecordAllocation(count * size);
+	}
+	return(pMemory);
+}
+
+/***********************************************************
+ *  realloc()
+ *
+ *  This function replaces realloc of glibc and counts the
+ *  new block as one allocation.
+ ***********************************************************/
+extern "C" void* realloc(void* pMemory, size_t size) noexcept
+{
+	void* pResized = __libc_realloc(pMemory, size);
+	if (pResized != NULL)
+	{
+		AllocationTracker::RecordAllocation(size);
+	}
+	return(pResized);
+}
+
+/***********************************************************
+ *  free()
+ *
+ *  This function replaces free of glibc, so the blocks of
+ *  the replaced functions go back to the same allocator.
+ ***********************************************************/
+extern "C" void free(void* pMemory) noexcept
+{
+	__libc_free(pMemory);
+}
+#endif
+
+void* operator new(size_t size)
+{
+	void* pMemory = TrackedMalloc(size);
+	if (pMemory == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	return(operator new(size));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return(TrackedMalloc(size));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(TrackedMalloc(size));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	std::free(pMemory);
+}
+
+#if defined(__cpp_aligned_new)
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* pMemory = TrackedAlignedMalloc(size, (size_t)alignment);
+	if (pMemory == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return(operator new(size, alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return(TrackedAlignedMalloc(size, (size_t)alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return(TrackedAlignedMalloc(size, (size_t)alignment));
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+	AlignedFree(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t) noexcept
+{
+	AlignedFree(pMemory);
+}
+
+void operator delete(void* pMemory, size_t, std::align_val_t) noexcept
+{
+	AlignedFree(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t, std::align_val_t) noexcept
+{
+	AlignedFree(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AlignedFree(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AlignedFree(pMemory);
+}
+#endif
+#endif
+
+/***********************************************************
+ *  IsEnabled()
+ *
+ *  This method is used for checking whether the build was
+ *  made with the allocation hooks.
+ ***********************************************************/
+bool AllocationTracker::IsEnabled()
+{
+#if defined(TRACK_ALLOCATIONS)
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for installing the malloc hook on
+ *  Windows and preparing the call stack lookups, which
+ *  allocate the first time they are used.
+ ***********************************************************/
+void AllocationTracker::Initialize()
+{
+#if defined(TRACK_ALLOCATIONS)
+#if defined(_WIN32)
+	SymSetOptions(SYMOPT_UNDNAME | SYMOPT_LOAD_LINES | SYMOPT_DEFERRED_LOADS);
+	SymInitialize(GetCurrentProcess(), NULL, TRUE);
+#else
+	void* frames[1];
+	backtrace(frames, 1);
+#endif
+#if defined(_MSC_VER) && defined(_DEBUG)
+	_CrtSetAllocHook(CrtAllocationHook);
+#endif
+	std::cout << "INFO: Heap allocations are tracked for every frame" << std::endl;
+#endif
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for counting the allocations of the
+ *  calling thread again, and starting the counting on the
+ *  first frame.
+ ***********************************************************/
+void AllocationTracker::BeginFrame()
+{
+	t_bPaused = false;
+	g_bTracking = true;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for taking the counts and the call
+ *  stacks collected since the frame began and starting
+ *  over.  Allocations of other threads after this call are
+ *  counted for the next frame.  The call stacks are copied
+ *  with the lock held, so no thread is still writing one of
+ *  them.
+ ***********************************************************/
+AllocationTracker::FRAME_ALLOCATIONS AllocationTracker::EndFrame()
+{
+	FRAME_ALLOCATIONS allocations;
+
+	t_bPaused = true;
+	allocations.count = g_allocationCount.exchange(0);
+	allocations.bytes = g_allocationBytes.exchange(0);
+
+	std::lock_guard<std::mutex> lock(g_callStackMutex);
+	g_frameCallStackCount = g_callStackCount.load();
+	for (int i = 0; i < g_frameCallStackCount; i++)
+	{
+		g_frameCallStacks[i] = g_callStacks[i];
+	}
+	g_callStackCount = 0;
+
+	return(allocations);
+}
+
+/***********************************************************
+ *  ReportCallStacks()
+ *
+ *  This method is used for printing where the allocations
+ *  of the last tracked frame were made.  A call stack that
+ *  was reported before is skipped, so an allocation made on
+ *  every frame is only printed once.
+ ***********************************************************/
+void AllocationTracker::ReportCallStacks()
+{
+#if defined(TRACK_ALLOCATIONS)
+	bool bInHook = t_bInHook;
+	t_bInHook = true;
+
+	for (int i = 0; i < g_frameCallStackCount; i++)
+	{
+		const CALL_STACK& callStack = g_frameCallStacks[i];
+
+		// FNV-1a hash of the return addresses
+		uint64_t hash = 14695981039346656037ull;
+		for (int j = 0; j < callStack.frameCount; j++)
+		{
+			hash = (hash ^ (uint64_t)(uintptr_t)callStack.frames[j]) * 1099511628211ull;
+		}
+
+		bool bReported = false;
+		for (int j = 0; (j < g_reportedCount) && (bReported == false); j++)
+		{
+			bReported = (g_reportedHashes[j] == hash);
+		}
+		if (bReported == true)
+		{
+			continue;
+		}
+		if (g_reportedCount < g_MaxReportedStacks)
+		{
+			g_reportedHashes[g_reportedCount++] = hash;
+		}
+
+		std::cout << "WARNING: Allocation of " << callStack.size << " bytes from:" << std::endl;
+#if defined(_WIN32)
+		HANDLE process = GetCurrentProcess();
+		char symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+		SYMBOL_INFO* pSymbol = (SYMBOL_INFO*)symbolBuffer;
+
+		for (int j = 0; j < callStack.frameCount; j++)
+		{
+			DWORD64 address = (DWORD64)(uintptr_t)callStack.frames[j];
+			DWORD64 symbolOffset = 0;
+			DWORD lineOffset = 0;
+			IMAGEHLP_LINE64 line;
+
+			pSymbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+			pSymbol->MaxNameLen = MAX_SYM_NAME;
+			line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+
+			std::cout << "    ";
+			if (SymFromAddr(process, address, &symbolOffset, pSymbol) == TRUE)
+			{
+				std::cout << pSymbol->Name;
+			}
+			else
+			{
+				std::cout << callStack.frames[j];
+			}
+			if (SymGetLineFromAddr64(process, address, &lineOffset, &line) == TRUE)
+			{
+				std::cout << " (" << line.FileName << ":" << line.LineNumber << ")";
+			}
+			std::cout << std::endl;
+		}
+#else
+		std::cout.flush();
+		backtrace_symbols_fd(callStack.frames, callStack.frameCount, STDOUT_FILENO);
+#endif
+	}
+
+	t_bInHook = bInHook;
+#endif
+}
+
+/***********************************************************
+ *  RecordAllocation()
+ *
+ *  This method is used for counting one allocation and
+ *  keeping its call stack when it is one of the first of
+ *  the frame.  It runs inside the allocation, so it must
+ *  not allocate itself.  The call stack is read before the
+ *  lock is taken, so only the copy waits for other threads.
+ ***********************************************************/
+void AllocationTracker::RecordAllocation(size_t size)
+{
+#if defined(TRACK_ALLOCATIONS)
+	if ((g_bTracking.load(std::memory_order_relaxed) == false) ||
+		(t_bPaused == true) || (t_bInHook == true))
+	{
+		return;
+	}
+
+	t_bInHook = true;
+	g_allocationCount++;
+	g_allocationBytes += size;
+
+	if (g_callStackCount.load(std::memory_order_relaxed) < g_MaxCallStacks)
+	{
+		CALL_STACK callStack;
+		callStack.size = size;
+		callStack.frameCount = CaptureCallStack(callStack.frames, g_MaxStackFrames);
+
+		std::lock_guard<std::mutex> lock(g_callStackMutex);
+		int index = g_callStackCount.load();
+		if (index < g_MaxCallStacks)
+		{
+			g_callStacks[index] = callStack;
+			g_callStackCount = index + 1;
+		}
+	}
+	t_bInHook = false;
+#endif
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationtracker.h
+// ============
+// heap allocation counting for proving that the steady state frames do not
+// allocate - global operator new and delete are replaced, and malloc is
+// hooked through the debug CRT on Windows and replaced on glibc, in builds
+// with TRACK_ALLOCATIONS defined
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  AllocationTracker
+ *
+ *  This class counts the heap allocations and bytes made by
+ *  all threads while a frame is tracked, and keeps the call
+ *  stacks of the first allocations of the frame, so the code
+ *  that allocated can be reported once the frame is over.
+ *  Without TRACK_ALLOCATIONS the methods do nothing and the
+ *  counts stay zero.
+ ***********************************************************/
+class AllocationTracker
+{
+public:
+	// allocations made while the last frame was tracked
+	struct FRAME_ALLOCATIONS
+	{
+		uint64_t count;
+		uint64_t bytes;
+	};
+
+	// whether the build counts allocations
+	static bool IsEnabled();
+	// install the hooks and load the symbols for the reports
+	static void Initialize();
+
+	// start and stop counting the allocations of a frame
+	static void BeginFrame();
+	static FRAME_ALLOCATIONS EndFrame();
+
+	// print the call stacks kept for the last tracked frame,
+	// each distinct call stack is only reported once
+	static void ReportCallStacks();
+
+	// count one allocation, called by the hooks
+	static void RecordAllocation(size_t size);
+};
@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetloader.cpp
+// ============
+// on demand loading of assets - assets are registered as handles up front
+// and read or decoded on a loader thread the first time they are requested
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetLoader.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  AssetLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetLoader::AssetLoader()
+{
+	m_pendingCount = 0;
+	m_bQuit = false;
+	m_loadFunction = NULL;
+	m_pContext = NULL;
+}
+
+/***********************************************************
+ *  ~AssetLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetLoader::~AssetLoader()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  SetLoadFunction()
+ *
+ *  This method is used for setting the function that loads
+ *  an asset, which LoadNow() also calls before the loader
+ *  thread is started.
+ ***********************************************************/
+void AssetLoader::SetLoadFunction(LOAD_FUNCTION loadFunction, void* pContext)
+{
+	m_loadFunction = loadFunction;
+	m_pContext = pContext;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the loader thread.  The
+ *  assets requested before it started are loaded first.
+ ***********************************************************/
+bool AssetLoader::Start()
+{
+	if (m_loadFunction == NULL)
+	{
+		std::cout << "ERROR: An asset loader needs a load function" << std::endl;
+		return(false);
+	}
+
+	Stop();
+
+	m_bQuit = false;
+	m_thread = std::thread(&AssetLoader::LoadLoop, this);
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the loader thread.  It
+ *  is joined, so everything it loaded is visible to the
+ *  calling thread afterwards.
+ ***********************************************************/
+void AssetLoader::Stop()
+{
+	if (m_thread.joinable() == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bQuit = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+
+	for (size_t i = 0; i < m_queue.size(); i++)
+	{
+		if (m_states[m_queue[i]] == ASSET_QUEUED)
+		{
+			m_states[m_queue[i]] = ASSET_UNLOADED;
+			m_pendingCount--;
+		}
+	}
+	m_queue.clear();
+}
+
+/***********************************************************
+ *  Register()
+ *
+ *  This method is used for adding an asset and getting its
+ *  handle, which is the number of assets registered before.
+ ***********************************************************/
+AssetLoader::ASSET_HANDLE AssetLoader::Register()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_states.push_back(ASSET_UNLOADED);
+	return((ASSET_HANDLE)(m_states.size() - 1));
+}
+
+/***********************************************************
+ *  GetAssetCount()
+ *
+ *  This method is used for getting the number of
+ *  registered assets.
+ ***********************************************************/
+uint32_t AssetLoader::GetAssetCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return((uint32_t)m_states.size());
+}
+
+/***********************************************************
+ *  GetState()
+ *
+ *  This method is used for getting the state of an asset.
+ ***********************************************************/
+AssetLoader::ASSET_STATE AssetLoader::GetState(ASSET_HANDLE handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return(m_states[handle]);
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  This method is used for getting the number of assets
+ *  that were requested and are queued, loading, or loaded
+ *  and not taken yet.
+ ***********************************************************/
+uint32_t AssetLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return(m_pendingCount);
+}
+
+/***********************************************************
+ *  Request()
+ *
+ *  This method is used for queueing an asset the first time
+ *  it is needed.
+ ***********************************************************/
+void AssetLoader::Request(ASSET_HANDLE handle)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_states[handle] != ASSET_UNLOADED)
+		{
+			return;
+		}
+		m_states[handle] = ASSET_QUEUED;
+		m_queue.push_back(handle);
+		m_pendingCount++;
+	}
+	m_condition.notify_all();
+}
+
+/***********************************************************
+ *  LoadNow()
+ *
+ *  This method is used for loading an asset that is needed
+ *  before the calling thread goes on.  A queued asset is
+ *  loaded here instead of on the loader thread, which skips
+ *  it when it comes up.
+ ***********************************************************/
+bool AssetLoader::LoadNow(ASSET_HANDLE handle)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this, handle]() { return m_states[handle] != ASSET_LOADING; });
+
+	ASSET_STATE state = m_states[handle];
+	if (state == ASSET_LOADED)
+	{
+		m_states[handle] = ASSET_TAKEN;
+		m_pendingCount--;
+		return(true);
+	}
+	if ((state != ASSET_UNLOADED) && (state != ASSET_QUEUED))
+	{
+		return(false);
+	}
+
+	if (state == ASSET_UNLOADED)
+	{
+		m_pendingCount++;
+	}
+	m_states[handle] = ASSET_LOADING;
+	lock.unlock();
+
+	bool bLoaded = (m_loadFunction != NULL) && (m_loadFunction(m_pContext, handle) == true);
+
+	lock.lock();
+	m_states[handle] = (bLoaded == true) ? ASSET_TAKEN : ASSET_FAILED;
+	m_pendingCount--;
+	lock.unlock();
+	m_condition.notify_all();
+	return(bLoaded);
+}
+
+/***********************************************************
+ *  TakeLoaded()
+ *
+ *  This method is used for handing the next asset that the
+ *  loader thread finished to the owner.  Assets taken by
+ *  LoadNow() meanwhile are passed over.
+ ***********************************************************/
+bool AssetLoader::TakeLoaded(ASSET_HANDLE& handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	while (m_loaded.empty() == false)
+	{
+		handle = m_loaded.front();
+		m_loaded.pop_front();
+		if (m_states[handle] == ASSET_LOADED)
+		{
+			m_states[handle] = ASSET_TAKEN;
+			m_pendingCount--;
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  LoadLoop()
+ *
+ *  This method is used for loading the queued assets one
+ *  at a time, with the lock released while the load
+ *  function runs.
+ ***********************************************************/
+void AssetLoader::LoadLoop()
+{
+	while (true)
+	{
+		ASSET_HANDLE handle = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return (m_bQuit == true) || (m_queue.empty() == false); });
+			if (m_bQuit == true)
+			{
+				return;
+			}
+			handle = m_queue.front();
+			m_queue.pop_front();
+			if (m_states[handle] != ASSET_QUEUED)
+			{
+				continue;
+			}
+			m_states[handle] = ASSET_LOADING;
+		}
+
+		bool bLoaded = (m_loadFunction(m_pContext, handle) == true);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (bLoaded == true)
+			{
+				m_states[handle] = ASSET_LOADED;
+				m_loaded.push_back(handle);
+			}
+			else
+			{
+				m_states[handle] = ASSET_FAILED;
+				m_pendingCount--;
+			}
+		}
+		m_condition.notify_all();
+	}
+}
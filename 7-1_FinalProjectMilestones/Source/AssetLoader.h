@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetloader.h
+// ============
+// on demand loading of assets - assets are registered as handles up front
+// and read or decoded on a loader thread the first time they are requested
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  AssetLoader
+ *
+ *  This class keeps the state of every registered asset
+ *  and the loader thread that loads the requested ones in
+ *  request order.  What loading means is up to the load
+ *  function of the owner, which runs on the loader thread
+ *  and must not make OpenGL calls - the owner takes the
+ *  loaded assets on its own thread and finishes them there,
+ *  for example by uploading them.  An asset that is needed
+ *  right away is loaded on the calling thread instead.
+ *  Handles are given out in order starting at 0, so the
+ *  owner can use them as indices into its own asset data.
+ ***********************************************************/
+class AssetLoader
+{
+public:
+	// handle of a registered asset
+	typedef uint32_t ASSET_HANDLE;
+
+	// state of an asset
+	enum ASSET_STATE
+	{
+		// registered and not requested yet
+		ASSET_UNLOADED = 0,
+		// waiting for the loader thread
+		ASSET_QUEUED,
+		// being loaded
+		ASSET_LOADING,
+		// loaded and waiting to be taken by the owner
+		ASSET_LOADED,
+		// taken by the owner
+		ASSET_TAKEN,
+		// the load function failed, which it reported
+		ASSET_FAILED
+	};
+
+	// function that loads an asset on the loader thread,
+	// returns false when it could not be loaded
+	typedef bool (*LOAD_FUNCTION)(void* pContext, ASSET_HANDLE handle);
+
+	// constructor
+	AssetLoader();
+	// destructor
+	~AssetLoader();
+
+	// set the owner's load function, before anything is loaded
+	void SetLoadFunction(LOAD_FUNCTION loadFunction, void* pContext);
+	// start the loader thread
+	bool Start();
+	// let the loader thread finish the asset it is loading and
+	// stop it, the queued assets go back to unloaded
+	void Stop();
+	// whether the loader thread is running
+	bool IsRunning() const { return m_thread.joinable(); }
+
+	// register an asset, unloaded until it is requested
+	ASSET_HANDLE Register();
+	uint32_t GetAssetCount();
+	ASSET_STATE GetState(ASSET_HANDLE handle);
+	// assets requested and not taken yet
+	uint32_t GetPendingCount();
+
+	// queue an unloaded asset for the loader thread, nothing
+	// is done when it was requested before
+	void Request(ASSET_HANDLE handle);
+	// load an asset on the calling thread, or wait for the
+	// loader thread when it is loading it already, and take
+	// it - returns false when it could not be loaded or was
+	// taken before
+	bool LoadNow(ASSET_HANDLE handle);
+	// take the oldest asset the loader thread finished,
+	// false when there is none
+	bool TakeLoaded(ASSET_HANDLE& handle);
+
+private:
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::vector<ASSET_STATE> m_states;
+	// requested assets in request order, and the loaded ones
+	// in the order they finished
+	std::deque<ASSET_HANDLE> m_queue;
+	std::deque<ASSET_HANDLE> m_loaded;
+	uint32_t m_pendingCount;
+	bool m_bQuit;
+	LOAD_FUNCTION m_loadFunction;
+	void* m_pContext;
+
+	// loop of the loader thread
+	void LoadLoop();
+};
@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// single file archive of a compiled scene and everything it references -
+// decoded textures with their mip levels, the mesh pool and the mesh bounds -
+// laid out to be memory mapped and uploaded to the GPU as it lies
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// the table of contents is read straight from the mapping,
+// so its layout must not depend on the compiler
+static_assert(sizeof(AssetPack::HEADER) == 20, "asset pack header layout changed");
+static_assert(sizeof(AssetPack::ENTRY) == 64, "asset pack entry layout changed");
+static_assert(sizeof(AssetPack::MESH_ENTRY) == 36, "asset pack mesh layout changed");
+
+const char* const AssetPack::SCENE_ENTRY_NAME = "scene";
+const char* const AssetPack::MESH_POOL_ENTRY_NAME = "meshPool";
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pHeader = NULL;
+	m_pEntries = NULL;
+}
+
+/***********************************************************
+ *  IsAssetPack()
+ *
+ *  This method is used for telling a pack apart from the
+ *  other files a scene can be loaded from.
+ ***********************************************************/
+bool AssetPack::IsAssetPack(const char* filename)
+{
+	uint32_t magic = 0;
+	std::ifstream file(filename, std::ios::binary);
+	file.read((char*)&magic, sizeof(magic));
+	return((file.gcount() == sizeof(magic)) && (magic == MAGIC));
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a pack and checking its
+ *  table of contents.  Every entry has to lie inside the
+ *  pack on its alignment and have a terminated name, so
+ *  the entries can be used without checks later.
+ ***********************************************************/
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+
+	if (m_mappedFile.Open(filename) == false)
+	{
+		std::cout << "ERROR: Could not open asset pack " << filename << std::endl;
+		return(false);
+	}
+
+	const uint8_t* pData = m_mappedFile.GetData();
+	size_t packSize = m_mappedFile.GetSize();
+	const HEADER* pHeader = (const HEADER*)pData;
+	bool bValid = false;
+
+	if ((packSize >= sizeof(HEADER)) &&
+		(pHeader->magic == MAGIC) &&
+		(pHeader->version == VERSION) &&
+		(pHeader->packSize == packSize) &&
+		((pHeader->tocOffset % 4) == 0) &&
+		((uint64_t)pHeader->tocOffset + (uint64_t)pHeader->entryCount * sizeof(ENTRY) <= packSize))
+	{
+		const ENTRY* pEntries = (const ENTRY*)(pData + pHeader->tocOffset);
+
+		bValid = true;
+		for (uint32_t i = 0; (i < pHeader->entryCount) && (bValid == true); i++)
+		{
+			const ENTRY& entry = pEntries[i];
+			bValid = ((entry.offset % ENTRY_ALIGNMENT) == 0) &&
+				((uint64_t)entry.offset + entry.size <= packSize) &&
+				(memchr(entry.name, '\0', NAME_LENGTH) != NULL);
+		}
+	}
+
+	if (bValid == false)
+	{
+		std::cout << "ERROR: Asset pack " << filename << " is damaged or from another version" << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_pHeader = pHeader;
+	m_pEntries = (const ENTRY*)(pData + pHeader->tocOffset);
+	std::cout << "INFO: Opened asset pack " << filename << " - " << m_pHeader->entryCount << " entries, "
+		<< packSize / 1024 << " KB" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the pack.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	m_mappedFile.Close();
+	m_pHeader = NULL;
+	m_pEntries = NULL;
+}
+
+/***********************************************************
+ *  GetEntryCount()
+ *
+ *  This method is used for getting the number of entries,
+ *  0 when no pack is open.
+ ***********************************************************/
+uint32_t AssetPack::GetEntryCount() const
+{
+	return((m_pHeader != NULL) ? m_pHeader->entryCount : 0);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding an entry by its type
+ *  and name in the table of contents.
+ ***********************************************************/
+const AssetPack::ENTRY* AssetPack::FindEntry(ENTRY_TYPE type, const char* name) const
+{
+	for (uint32_t i = 0; i < GetEntryCount(); i++)
+	{
+		if ((m_pEntries[i].type == (uint32_t)type) && (strcmp(m_pEntries[i].name, name) == 0))
+		{
+			return(&m_pEntries[i]);
+		}
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  GetLevelSize()
+ *
+ *  This method is used for getting the width or height of
+ *  a texture at a mip level.
+ ***********************************************************/
+uint32_t AssetPack::GetLevelSize(uint32_t size, uint32_t level)
+{
+	size = (level < 32) ? (size >> level) : 0;
+	return((size > 0) ? size : 1);
+}
+
+/***********************************************************
+ *  GetTextureBytes()
+ *
+ *  This method is used for getting the size of the mip
+ *  levels of a texture entry, which follow each other with
+ *  no padding since RGBA8 rows are always 4 byte aligned.
+ ***********************************************************/
+size_t AssetPack::GetTextureBytes(uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	size_t bytes = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		bytes += (size_t)GetLevelSize(width, level) * GetLevelSize(height, level) * 4;
+	}
+	return(bytes);
+}
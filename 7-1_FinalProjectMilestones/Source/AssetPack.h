@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// single file archive of a compiled scene and everything it references -
+// decoded textures with their mip levels, the mesh pool and the mesh bounds -
+// laid out to be memory mapped and uploaded to the GPU as it lies
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class opens an asset pack written by the scene
+ *  compiler.  The pack starts with a header and a table of
+ *  contents, and every entry starts on a page of its own,
+ *  so an entry is read with whole pages and nothing else.
+ *  Entries are found by type and name and used straight
+ *  from the mapping - the pages of an entry are only read
+ *  from disk when it is uploaded.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// first bytes of a pack, "APAK" in file order
+	static const uint32_t MAGIC = 0x4B415041;
+	// raised whenever the layout or the baked data changes
+	static const uint32_t VERSION = 2;
+	// boundary every entry starts on
+	static const uint32_t ENTRY_ALIGNMENT = 4096;
+	// longest entry name, including the terminating zero
+	static const uint32_t NAME_LENGTH = 32;
+	// names of the scene entry and of the mesh pool entries
+	static const char* const SCENE_ENTRY_NAME;
+	static const char* const MESH_POOL_ENTRY_NAME;
+
+	// kinds of entries
+	enum ENTRY_TYPE
+	{
+		// the compiled scene file image
+		ENTRY_SCENE = 0,
+		// RGBA8 mip levels from the largest down to 1 x 1,
+		// named by the texture tag - values are the width, the
+		// height and the level count
+		ENTRY_TEXTURE,
+		// vertices of the mesh pool - values are the vertex
+		// format and the vertex count
+		ENTRY_MESH_VERTICES,
+		// indices of the mesh pool - values are the index count
+		ENTRY_MESH_INDICES,
+		// MESH_ENTRY of every pool range, in pool range order
+		ENTRY_MESH_TABLE
+	};
+
+	struct HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t packSize;
+		uint32_t entryCount;
+		uint32_t tocOffset;
+	};
+
+	// table of contents entry
+	struct ENTRY
+	{
+		char name[NAME_LENGTH];
+		uint32_t type;
+		uint32_t offset;
+		uint32_t size;
+		uint32_t values[5];
+	};
+
+	// one range of the mesh pool with its local space bounds
+	struct MESH_ENTRY
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t baseVertex;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// constructor
+	AssetPack();
+
+	// check the first bytes of a file for the pack magic
+	static bool IsAssetPack(const char* filename);
+	// open a pack, false when it is missing or damaged,
+	// which is reported
+	bool Open(const char* filename);
+	// close the pack, the entry data is no longer valid
+	void Close();
+	bool IsOpen() const { return m_pHeader != NULL; }
+
+	uint32_t GetEntryCount() const;
+	const ENTRY& GetEntry(uint32_t index) const { return m_pEntries[index]; }
+	// find an entry by type and name, NULL when it is missing
+	const ENTRY* FindEntry(ENTRY_TYPE type, const char* name) const;
+	// data of an entry, inside the mapping
+	const uint8_t* GetEntryData(const ENTRY& entry) const { return m_mappedFile.GetData() + entry.offset; }
+
+	// size of a texture at a mip level, never below 1
+	static uint32_t GetLevelSize(uint32_t size, uint32_t level);
+	// bytes of all the RGBA8 mip levels of a texture
+	static size_t GetTextureBytes(uint32_t width, uint32_t height, uint32_t levelCount);
+
+private:
+	MappedFile m_mappedFile;
+	const HEADER* m_pHeader;
+	const ENTRY* m_pEntries;
+};
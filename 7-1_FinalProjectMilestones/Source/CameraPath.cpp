@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// scripted camera movement for runs without input - camera keys read from a
+// text file and interpolated by frame number
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/***********************************************************
+ *  CameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraPath::CameraPath()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the keys of a camera
+ *  path file.  The keys read before an error are dropped,
+ *  so a path is either loaded whole or not at all.
+ ***********************************************************/
+bool CameraPath::Load(const char* filename)
+{
+	m_keys.clear();
+
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: Could not open camera path " << filename << std::endl;
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream lineStream(line);
+		std::string keyword;
+		if (!(lineStream >> keyword))
+		{
+			continue;
+		}
+
+		CAMERA_KEY key;
+		std::string extra;
+		bool bRead = (keyword == "key") &&
+			(lineStream >> key.frame) &&
+			(lineStream >> key.position.x >> key.position.y >> key.position.z) &&
+			(lineStream >> key.target.x >> key.target.y >> key.target.z) &&
+			!(lineStream >> extra);
+
+		std::string error;
+		if (bRead == false)
+		{
+			error = "a key needs a frame, a position and a target";
+		}
+		else if ((m_keys.empty() == false) && (key.frame <= m_keys.back().frame))
+		{
+			error = "keys have to be in frame order";
+		}
+		else if (key.position == key.target)
+		{
+			error = "the camera has to look away from its position";
+		}
+
+		if (error.empty() == false)
+		{
+			std::cout << "ERROR: " << filename << " line " << lineNumber << ": " << error << std::endl;
+			m_keys.clear();
+			return(false);
+		}
+		m_keys.push_back(key);
+	}
+
+	if (m_keys.empty() == true)
+	{
+		std::cout << "ERROR: Camera path " << filename << " has no keys" << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Loaded camera path " << filename << " - " << m_keys.size()
+		<< " keys over " << GetLastFrame() << " frames" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  GetLastFrame()
+ *
+ *  This method is used for getting the frame of the last
+ *  key, 0 when there are no keys.
+ ***********************************************************/
+int CameraPath::GetLastFrame() const
+{
+	return((m_keys.empty() == false) ? m_keys.back().frame : 0);
+}
+
+/***********************************************************
+ *  GetPose()
+ *
+ *  This method is used for interpolating the keys around a
+ *  frame.  The front is normalized, as the camera expects.
+ ***********************************************************/
+void CameraPath::GetPose(int frame, glm::vec3& position, glm::vec3& front) const
+{
+	if (m_keys.empty() == true)
+	{
+		return;
+	}
+
+	size_t next = 0;
+	while ((next < m_keys.size()) && (m_keys[next].frame < frame))
+	{
+		next++;
+	}
+
+	glm::vec3 target;
+	if (next == 0)
+	{
+		position = m_keys[0].position;
+		target = m_keys[0].target;
+	}
+	else if (next == m_keys.size())
+	{
+		position = m_keys[next - 1].position;
+		target = m_keys[next - 1].target;
+	}
+	else
+	{
+		const CAMERA_KEY& from = m_keys[next - 1];
+		const CAMERA_KEY& to = m_keys[next];
+		float t = (float)(frame - from.frame) / (float)(to.frame - from.frame);
+		position = glm::mix(from.position, to.position, t);
+		target = glm::mix(from.target, to.target, t);
+	}
+
+	// a path that moves the camera through its target leaves
+	// the last direction in place instead of a zero vector
+	glm::vec3 direction = target - position;
+	if (glm::length(direction) > 0.0001f)
+	{
+		front = glm::normalize(direction);
+	}
+}
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// scripted camera movement for runs without input - camera keys read from a
+// text file and interpolated by frame number
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class reads a camera path and places the camera on
+ *  it for a frame.  The text has one key per line, and #
+ *  starts a comment:
+ *
+ *    key <frame> <position x y z> <target x y z>
+ *
+ *  The keys have to be in frame order.  Between two keys
+ *  the position and the target move linearly, and before
+ *  the first or after the last key the camera stays there.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	// one key of the path
+	struct CAMERA_KEY
+	{
+		int frame;
+		glm::vec3 position;
+		glm::vec3 target;
+	};
+
+	// constructor
+	CameraPath();
+
+	// read a path, false when it is missing or has errors,
+	// which are reported with their line
+	bool Load(const char* filename);
+	// whether the path has any keys
+	bool IsEmpty() const { return m_keys.empty(); }
+	// frame of the last key
+	int GetLastFrame() const;
+
+	// get the camera position and the direction it looks in
+	// at a frame
+	void GetPose(int frame, glm::vec3& position, glm::vec3& front) const;
+
+private:
+	std::vector<CAMERA_KEY> m_keys;
+};
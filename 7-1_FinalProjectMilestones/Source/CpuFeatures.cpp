@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////
+// cpufeatures.cpp
+// ============
+// runtime detection of the SIMD instruction sets used by the batched kernels
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CpuFeatures.h"
+
+#if defined(SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	struct CPU_FEATURES
+	{
+		bool bSSE2;
+		bool bAVX2;
+	};
+
+#if defined(SIMD_X86)
+	/***********************************************************
+	 *  QueryCpuid()
+	 *
+	 *  This function is used for reading one CPUID leaf into
+	 *  the passed in register array (eax, ebx, ecx, edx).
+	 ***********************************************************/
+	void QueryCpuid(int leaf, int subLeaf, unsigned int registers[4])
+	{
+#if defined(_MSC_VER)
+		int values[4];
+		__cpuidex(values, leaf, subLeaf);
+		for (int i = 0; i < 4; i++)
+		{
+			registers[i] = (unsigned int)values[i];
+		}
+#else
+		__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	/***********************************************************
+	 *  QueryXCR0()
+	 *
+	 *  This function is used for reading the extended control
+	 *  register that reports which register files the OS saves.
+	 ***********************************************************/
+	unsigned long long QueryXCR0()
+	{
+#if defined(_MSC_VER)
+		return(_xgetbv(0));
+#else
+		unsigned int eax = 0;
+		unsigned int edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return(((unsigned long long)edx << 32) | eax);
+#endif
+	}
+#endif
+
+	/***********************************************************
+	 *  DetectFeatures()
+	 *
+	 *  This function is used for detecting the supported
+	 *  instruction sets of the running processor.
+	 ***********************************************************/
+	CPU_FEATURES DetectFeatures()
+	{
+		CPU_FEATURES features;
+		features.bSSE2 = false;
+		features.bAVX2 = false;
+
+#if defined(SIMD_X86)
+		unsigned int registers[4] = { 0, 0, 0, 0 };
+
+		QueryCpuid(0, 0, registers);
+		unsigned int maxLeaf = registers[0];
+
+		QueryCpuid(1, 0, registers);
+		features.bSSE2 = (registers[3] & (1u << 26)) != 0;
+
+		// AVX needs the OSXSAVE bit and the OS saving both the
+		// XMM and YMM register state before AVX2 can be used
+		bool bOSXSave = (registers[2] & (1u << 27)) != 0;
+		bool bAVX = (registers[2] & (1u << 28)) != 0;
+		bool bFMA = (registers[2] & (1u << 12)) != 0;
+		if (bOSXSave && bAVX && bFMA && (maxLeaf >= 7))
+		{
+			if ((QueryXCR0() & 0x6) == 0x6)
+			{
+				QueryCpuid(7, 0, registers);
+				features.bAVX2 = (registers[1] & (1u << 5)) != 0;
+			}
+		}
+#endif
+
+		return(features);
+	}
+
+	/***********************************************************
+	 *  GetFeatures()
+	 *
+	 *  This function is used for getting the cached features,
+	 *  detected on the first call.
+	 ***********************************************************/
+	const CPU_FEATURES& GetFeatures()
+	{
+		static const CPU_FEATURES features = DetectFeatures();
+		return(features);
+	}
+}
+
+/***********************************************************
+ *  HasSSE2()
+ *
+ *  This method is used for checking SSE2 support.
+ ***********************************************************/
+bool CpuFeatures::HasSSE2()
+{
+	return(GetFeatures().bSSE2);
+}
+
+/***********************************************************
+ *  HasAVX2()
+ *
+ *  This method is used for checking AVX2 (with FMA) support.
+ ***********************************************************/
+bool CpuFeatures::HasAVX2()
+{
+	return(GetFeatures().bAVX2);
+}
+
+/***********************************************************
+ *  GetBestInstructionSetName()
+ *
+ *  This method is used for getting a readable name of the
+ *  widest instruction set the kernels can use.
+ ***********************************************************/
+const char* CpuFeatures::GetBestInstructionSetName()
+{
+	if (HasAVX2())
+	{
+		return("AVX2");
+	}
+	if (HasSSE2())
+	{
+		return("SSE2");
+	}
+	return("scalar");
+}
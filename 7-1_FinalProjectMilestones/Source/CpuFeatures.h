@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// cpufeatures.h
+// ============
+// runtime detection of the SIMD instruction sets used by the batched kernels
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// the SIMD kernels are only compiled on x86 / x64 targets, every
+// other target uses the scalar fallback paths
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SIMD_X86 1
+#endif
+
+// MSVC allows intrinsics for any instruction set in any function,
+// GCC and Clang need the target enabled per function so that the
+// rest of the translation unit still runs on older processors
+#if defined(_MSC_VER)
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+/***********************************************************
+ *  CpuFeatures
+ *
+ *  This namespace contains the queries for the instruction
+ *  sets supported by the running processor and OS.  The
+ *  queries are evaluated once and cached.
+ ***********************************************************/
+namespace CpuFeatures
+{
+	// SSE2 is the baseline for every x86 target we build for
+	bool HasSSE2();
+	// AVX2 requires both processor support and OS support
+	// for saving the 256-bit registers
+	bool HasAVX2();
+	// readable name of the widest supported instruction set
+	const char* GetBestInstructionSetName();
+}
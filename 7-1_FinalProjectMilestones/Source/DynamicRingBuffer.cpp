@@ -0,0 +1,287 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicringbuffer.cpp
+// ============
+// persistently mapped buffer split into per frame regions that the CPU writes
+// dynamic data into while the GPU reads the regions of earlier frames
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicRingBuffer.h"
+
+#include <iostream>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	// time to wait on a fence before checking it again
+	const GLuint64 g_FenceWaitNanoseconds = 1000000;
+}
+
+/***********************************************************
+ *  DynamicRingBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicRingBuffer::DynamicRingBuffer()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_frameBytes = 0;
+	m_frameCount = 0;
+	m_offsetAlignment = 1;
+	m_frameIndex = 0;
+	m_writeOffset = 0;
+	m_requestedBytes = 0;
+	m_stallCount = 0;
+}
+
+/***********************************************************
+ *  ~DynamicRingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicRingBuffer::~DynamicRingBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the immutable buffer and
+ *  mapping it for the lifetime of the object.  Persistent
+ *  mapping needs OpenGL 4.4 or ARB_buffer_storage.
+ ***********************************************************/
+bool DynamicRingBuffer::Create(size_t frameBytes, int frameCount, size_t offsetAlignment)
+{
+	Destroy();
+
+	if (!(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage))
+	{
+		std::cout << "INFO: Persistent mapped buffers are not supported" << std::endl;
+		return(false);
+	}
+
+	// every region has to start at a valid binding offset
+	if (offsetAlignment == 0)
+	{
+		offsetAlignment = 1;
+	}
+	m_frameBytes = ((frameBytes + offsetAlignment - 1) / offsetAlignment) * offsetAlignment;
+	m_frameCount = frameCount;
+	m_offsetAlignment = offsetAlignment;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr totalBytes = (GLsizeiptr)(m_frameBytes * m_frameCount);
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, totalBytes, NULL, flags);
+	m_pMapped = (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalBytes, flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (m_pMapped == NULL)
+	{
+		std::cout << "ERROR: Could not map the dynamic ring buffer" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_fences.assign(m_frameCount, (GLsync)0);
+	m_frameIndex = m_frameCount - 1;
+	m_writeOffset = 0;
+	m_requestedBytes = 0;
+	m_stallCount = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for replacing the buffer with one
+ *  that has larger regions.  The buffer is immutable, so a
+ *  new one is made, and the old one is only freed after the
+ *  fences of all its regions, so no draw still reads it.
+ *  If the new buffer cannot be made the old one is kept.
+ ***********************************************************/
+bool DynamicRingBuffer::Resize(size_t frameBytes)
+{
+	if (m_pMapped == NULL)
+	{
+		return(false);
+	}
+
+	DynamicRingBuffer resized;
+	if (resized.Create(frameBytes, m_frameCount, m_offsetAlignment) == false)
+	{
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_fences.size(); i++)
+	{
+		if (m_fences[i] == 0)
+		{
+			continue;
+		}
+		GLenum result = glClientWaitSync(m_fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceWaitNanoseconds);
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(m_fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceWaitNanoseconds);
+		}
+	}
+
+	Destroy();
+
+	// the stalls are kept, since they count for the whole run
+	std::swap(m_buffer, resized.m_buffer);
+	std::swap(m_pMapped, resized.m_pMapped);
+	std::swap(m_frameBytes, resized.m_frameBytes);
+	std::swap(m_frameCount, resized.m_frameCount);
+	std::swap(m_offsetAlignment, resized.m_offsetAlignment);
+	std::swap(m_frameIndex, resized.m_frameIndex);
+	std::swap(m_writeOffset, resized.m_writeOffset);
+	std::swap(m_requestedBytes, resized.m_requestedBytes);
+	std::swap(m_fences, resized.m_fences);
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the fences and the
+ *  mapped buffer.
+ ***********************************************************/
+void DynamicRingBuffer::Destroy()
+{
+	for (size_t i = 0; i < m_fences.size(); i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+		}
+	}
+	m_fences.clear();
+
+	if (m_buffer != 0)
+	{
+		if (m_pMapped != NULL)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_buffer);
+	}
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_frameBytes = 0;
+	m_frameCount = 0;
+	m_writeOffset = 0;
+	m_requestedBytes = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving to the next region.  Its
+ *  fence was placed when the region was last written, so
+ *  the wait only blocks when the GPU is a full ring behind.
+ ***********************************************************/
+void DynamicRingBuffer::BeginFrame()
+{
+	if (m_pMapped == NULL)
+	{
+		return;
+	}
+
+	m_frameIndex = (m_frameIndex + 1) % m_frameCount;
+	m_writeOffset = 0;
+	m_requestedBytes = 0;
+
+	GLsync fence = m_fences[m_frameIndex];
+	if (fence == 0)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED))
+	{
+		m_stallCount++;
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceWaitNanoseconds);
+		}
+	}
+
+	glDeleteSync(fence);
+	m_fences[m_frameIndex] = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing the fence after the
+ *  commands that read the current region.
+ ***********************************************************/
+void DynamicRingBuffer::EndFrame()
+{
+	if (m_pMapped == NULL)
+	{
+		return;
+	}
+
+	m_fences[m_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for reserving bytes in the current
+ *  region.  The memory is written directly by the CPU and
+ *  is visible to the GPU through the coherent mapping.
+ ***********************************************************/
+void* DynamicRingBuffer::Allocate(size_t bytes, size_t alignment, size_t& frameOffset)
+{
+	if (m_pMapped == NULL)
+	{
+		return(NULL);
+	}
+
+	if (alignment == 0)
+	{
+		alignment = 1;
+	}
+	// the bytes are counted even when they do not fit, so the
+	// owner knows how large the region has to be
+	m_requestedBytes = ((m_requestedBytes + alignment - 1) / alignment) * alignment + bytes;
+
+	size_t offset = ((m_writeOffset + alignment - 1) / alignment) * alignment;
+	if (offset + bytes > m_frameBytes)
+	{
+		return(NULL);
+	}
+
+	m_writeOffset = offset + bytes;
+	frameOffset = offset;
+	return(m_pMapped + GetFrameStart() + offset);
+}
+
+/***********************************************************
+ *  BindFrameRange()
+ *
+ *  This method is used for binding the current region, so
+ *  the shaders index the data from the region start.
+ ***********************************************************/
+void DynamicRingBuffer::BindFrameRange(GLenum target, GLuint bindingIndex) const
+{
+	if (m_pMapped == NULL)
+	{
+		return;
+	}
+
+	glBindBufferRange(target, bindingIndex, m_buffer,
+		(GLintptr)GetFrameStart(), (GLsizeiptr)m_frameBytes);
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicringbuffer.h
+// ============
+// persistently mapped buffer split into per frame regions that the CPU writes
+// dynamic data into while the GPU reads the regions of earlier frames
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  DynamicRingBuffer
+ *
+ *  This class owns one immutable buffer created with
+ *  glBufferStorage and mapped once as persistent and
+ *  coherent.  The buffer holds one region per frame in
+ *  flight, and a fence at the end of each frame protects
+ *  its region until the GPU is done reading it, so the CPU
+ *  only waits when it gets more than the frame count ahead.
+ ***********************************************************/
+class DynamicRingBuffer
+{
+public:
+	// constructor
+	DynamicRingBuffer();
+	// destructor
+	~DynamicRingBuffer();
+
+	// create and map the buffer with a region of the passed in
+	// size for each frame in flight, regions are aligned to
+	// the passed in offset alignment
+	bool Create(size_t frameBytes, int frameCount = 3, size_t offsetAlignment = 256);
+	// unmap and free the buffer and the fences
+	void Destroy();
+	// recreate the buffer with regions of the passed in size,
+	// after the GPU is done with every region
+	bool Resize(size_t frameBytes);
+	// check whether the buffer was created
+	bool IsCreated() const { return m_pMapped != NULL; }
+
+	// move to the next region, waiting for the GPU to finish
+	// the frame that last used it
+	void BeginFrame();
+	// fence the commands that read the current region
+	void EndFrame();
+
+	// reserve bytes in the current region, returns NULL when
+	// the region is full, and the offset from the region start
+	void* Allocate(size_t bytes, size_t alignment, size_t& frameOffset);
+
+	// bind the current region to an indexed buffer target
+	void BindFrameRange(GLenum target, GLuint bindingIndex) const;
+
+	// get the buffer object and the current region's location
+	GLuint GetBuffer() const { return m_buffer; }
+	size_t GetFrameStart() const { return m_frameIndex * m_frameBytes; }
+	size_t GetFrameBytes() const { return m_frameBytes; }
+	// get the bytes asked for this frame, including the
+	// allocations that did not fit in the region
+	size_t GetRequestedBytes() const { return m_requestedBytes; }
+	// get the number of frames that had to wait for the GPU
+	uint32_t GetStallCount() const { return m_stallCount; }
+
+private:
+	GLuint m_buffer;
+	uint8_t* m_pMapped;
+	// size of one region and the number of regions
+	size_t m_frameBytes;
+	int m_frameCount;
+	size_t m_offsetAlignment;
+	// region written this frame and the bytes used in it
+	int m_frameIndex;
+	size_t m_writeOffset;
+	size_t m_requestedBytes;
+	// fence after the last commands reading each region
+	std::vector<GLsync> m_fences;
+	uint32_t m_stallCount;
+};
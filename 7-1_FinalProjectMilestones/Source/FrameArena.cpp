@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// frame scoped linear allocator - memory for the transient data of a frame
+// is bumped out of blocks that are kept from frame to frame, plus an
+// allocator that lets the standard containers use it
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t initialSize)
+{
+	m_blockIndex = 0;
+	m_offset = 0;
+	m_initialSize = std::max((size_t)1024, initialSize);
+	m_usedBytes = 0;
+	m_peakBytes = 0;
+	m_growCount = 0;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for bumping an aligned allocation
+ *  out of the current block.  When it does not fit, the
+ *  following block is tried, and a new block is only taken
+ *  from the heap when none of the kept blocks is left.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	// the alignment has to be a power of two
+	if ((alignment == 0) || ((alignment & (alignment - 1)) != 0))
+	{
+		return(NULL);
+	}
+
+	size = std::max((size_t)1, size);
+	while (true)
+	{
+		if (m_blockIndex < m_blocks.size())
+		{
+			std::vector<uint8_t>& block = m_blocks[m_blockIndex];
+			uintptr_t start = (uintptr_t)block.data() + m_offset;
+			size_t padding = (alignment - (start & (alignment - 1))) & (alignment - 1);
+
+			if (m_offset + padding + size <= block.size())
+			{
+				void* pMemory = block.data() + m_offset + padding;
+				m_offset += padding + size;
+				m_usedBytes += padding + size;
+				m_peakBytes = std::max(m_peakBytes, m_usedBytes);
+				return(pMemory);
+			}
+
+			if (m_blockIndex + 1 < m_blocks.size())
+			{
+				m_blockIndex++;
+				m_offset = 0;
+				continue;
+			}
+		}
+
+		AddBlock(size + alignment);
+		m_blockIndex = m_blocks.size() - 1;
+		m_offset = 0;
+	}
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for dropping all the allocations at
+ *  once.  A frame that spilled into several blocks leaves
+ *  one block of their combined size behind, so the same
+ *  frame fits into a single block from then on.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		size_t totalSize = 0;
+		for (size_t i = 0; i < m_blocks.size(); i++)
+		{
+			totalSize += m_blocks[i].size();
+		}
+		m_blocks.clear();
+		AddBlock(totalSize);
+	}
+
+	m_blockIndex = 0;
+	m_offset = 0;
+	m_usedBytes = 0;
+}
+
+/***********************************************************
+ *  AddBlock()
+ *
+ *  This method is used for taking a new block from the
+ *  heap, at least twice the size of the last one so a
+ *  growing frame needs few of them.
+ ***********************************************************/
+void FrameArena::AddBlock(size_t minimumSize)
+{
+	size_t blockSize = m_initialSize;
+	if (m_blocks.empty() == false)
+	{
+		blockSize = m_blocks.back().size() * 2;
+	}
+	blockSize = std::max(blockSize, minimumSize);
+
+	m_blocks.push_back(std::vector<uint8_t>(blockSize));
+	m_growCount++;
+}
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// frame scoped linear allocator - memory for the transient data of a frame
+// is bumped out of blocks that are kept from frame to frame, plus an
+// allocator that lets the standard containers use it
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class contains the memory blocks that the data of
+ *  one frame is allocated from.  Allocating only moves an
+ *  offset forward and single allocations are never freed -
+ *  Reset() drops everything at once when the frame's data
+ *  is no longer used.  A frame that needs more than the
+ *  current block takes a new one, and the next Reset()
+ *  joins the blocks into one, so once the arena has seen
+ *  the largest frame it no longer touches the heap.  An
+ *  arena is used by one thread at a time.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor - no memory is taken until the first allocation
+	FrameArena(size_t initialSize = 64 * 1024);
+
+	// take memory for the rest of the frame, NULL for a bad size
+	void* Allocate(size_t size, size_t alignment);
+	// drop all the allocations of the frame
+	void Reset();
+
+	// bytes allocated since the last reset and the most ever
+	size_t GetUsedBytes() const { return m_usedBytes; }
+	size_t GetPeakBytes() const { return m_peakBytes; }
+	// blocks taken from the heap since the arena was created
+	uint32_t GetGrowCount() const { return m_growCount; }
+
+private:
+	std::vector<std::vector<uint8_t>> m_blocks;
+	// block and offset the next allocation starts at
+	size_t m_blockIndex;
+	size_t m_offset;
+	size_t m_initialSize;
+	size_t m_usedBytes;
+	size_t m_peakBytes;
+	uint32_t m_growCount;
+
+	// take a new block that holds at least the passed in size
+	void AddBlock(size_t minimumSize);
+};
+
+/***********************************************************
+ *  FrameAllocator
+ *
+ *  This class template lets the standard containers take
+ *  their storage from a frame arena.  Deallocating does
+ *  nothing, so a container should be sized once per frame
+ *  rather than grown one element at a time.  Without an
+ *  arena it uses the heap like the default allocator.
+ ***********************************************************/
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+	// containers take the arena of the container they are
+	// assigned from, since the old memory cannot be freed
+	typedef std::true_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	FrameAllocator(FrameArena* pArena = NULL) : m_pArena(pArena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : m_pArena(other.GetArena()) {}
+
+	T* allocate(size_t count)
+	{
+		if (m_pArena == NULL)
+		{
+			return (T*)::operator new(count * sizeof(T));
+		}
+
+		void* pMemory = m_pArena->Allocate(count * sizeof(T), alignof(T));
+		if (pMemory == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		return (T*)pMemory;
+	}
+
+	void deallocate(T* pMemory, size_t count)
+	{
+		// arena memory is given back when the arena is reset
+		if (m_pArena == NULL)
+		{
+			::operator delete(pMemory, count * sizeof(T));
+		}
+	}
+
+	FrameArena* GetArena() const { return m_pArena; }
+
+private:
+	FrameArena* m_pArena;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& left, const FrameAllocator<U>& right)
+{
+	return left.GetArena() == right.GetArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& left, const FrameAllocator<U>& right)
+{
+	return left.GetArena() != right.GetArena();
+}
+
+// vector whose storage lives in a frame arena
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepipeline.cpp
+// ============
+// two stage frame pipeline - an update thread builds the next frames into a
+// small queue of packets while the render thread draws the oldest one
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePipeline.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  FramePipeline()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePipeline::FramePipeline()
+{
+	m_nextBuild = 0;
+	m_nextRender = 0;
+	m_bQuit = false;
+	m_buildFunction = NULL;
+	m_pContext = NULL;
+	m_pJobSystem = NULL;
+	m_bThreadReady = false;
+	m_bRegistered = false;
+}
+
+/***********************************************************
+ *  ~FramePipeline()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePipeline::~FramePipeline()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the update thread with
+ *  all the slots free, so it starts building right away.
+ ***********************************************************/
+bool FramePipeline::Start(
+	int queueDepth,
+	BUILD_FUNCTION buildFunction,
+	void* pContext,
+	JobSystem* pJobSystem)
+{
+	if ((queueDepth < 2) || (buildFunction == NULL))
+	{
+		std::cout << "ERROR: A frame pipeline needs a build function and at least 2 frames" << std::endl;
+		return(false);
+	}
+
+	Stop();
+
+	m_states.assign(queueDepth, SLOT_FREE);
+	m_nextBuild = 0;
+	m_nextRender = 0;
+	m_bQuit = false;
+	m_buildFunction = buildFunction;
+	m_pContext = pContext;
+	m_pJobSystem = pJobSystem;
+	m_bThreadReady = false;
+	m_bRegistered = false;
+	m_thread = std::thread(&FramePipeline::BuildLoop, this);
+
+	// the update thread cannot build frames without its own
+	// slot of the job system
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_bThreadReady == true; });
+	}
+	if (m_bRegistered == false)
+	{
+		m_thread.join();
+		m_states.clear();
+		return(false);
+	}
+
+	std::cout << "INFO: Frames are built " << (queueDepth - 1)
+		<< " ahead of the drawn frame on the update thread" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the update thread.  It
+ *  is joined, so everything it wrote is visible to the
+ *  calling thread afterwards.
+ ***********************************************************/
+void FramePipeline::Stop()
+{
+	if (m_thread.joinable() == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bQuit = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+	m_states.clear();
+
+	std::cout << "INFO: Frames are built on the render thread" << std::endl;
+}
+
+/***********************************************************
+ *  AcquireFrame()
+ *
+ *  This method is used for waiting until the oldest frame
+ *  in the queue is built and handing its slot to the render
+ *  thread.
+ ***********************************************************/
+int FramePipeline::AcquireFrame()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this]() { return m_states[m_nextRender] == SLOT_READY; });
+
+	int slot = m_nextRender;
+	m_states[slot] = SLOT_RENDERING;
+	m_nextRender = (m_nextRender + 1) % (int)m_states.size();
+	return(slot);
+}
+
+/***********************************************************
+ *  ReleaseFrame()
+ *
+ *  This method is used for freeing the slot of a drawn frame
+ *  for the update thread.
+ ***********************************************************/
+void FramePipeline::ReleaseFrame(int slot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_states[slot] = SLOT_FREE;
+	}
+	m_condition.notify_all();
+}
+
+/***********************************************************
+ *  BuildLoop()
+ *
+ *  This method is used for building a frame into each slot
+ *  that becomes free, in ring order.  The thread holds its
+ *  own slot of the job system while it runs, so its jobs do
+ *  not share a queue with the render thread.
+ ***********************************************************/
+void FramePipeline::BuildLoop()
+{
+	bool bRegistered = (m_pJobSystem == NULL) || (m_pJobSystem->RegisterThread() == true);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bThreadReady = true;
+		m_bRegistered = bRegistered;
+	}
+	m_condition.notify_all();
+	if (bRegistered == false)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		int slot = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() {
+				return (m_bQuit == true) || (m_states[m_nextBuild] == SLOT_FREE); });
+			if (m_bQuit == true)
+			{
+				break;
+			}
+			slot = m_nextBuild;
+			m_states[slot] = SLOT_BUILDING;
+			m_nextBuild = (m_nextBuild + 1) % (int)m_states.size();
+		}
+
+		m_buildFunction(m_pContext, slot);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_states[slot] = SLOT_READY;
+		}
+		m_condition.notify_all();
+	}
+
+	if (m_pJobSystem != NULL)
+	{
+		m_pJobSystem->UnregisterThread();
+	}
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepipeline.h
+// ============
+// two stage frame pipeline - an update thread builds the next frames into a
+// small queue of packets while the render thread draws the oldest one
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FramePipeline
+ *
+ *  This class contains the update thread and the states of
+ *  the packet slots it builds frames into.  The slots are
+ *  used in a ring - the update thread builds into the next
+ *  free slot and the render thread draws the slots in the
+ *  same order, so with a queue depth of 2 one frame is built
+ *  while the previous one is drawn, and a depth of 3 lets
+ *  the update run one more frame ahead.  The packets
+ *  themselves belong to the caller, which only reads a slot
+ *  between AcquireFrame() and ReleaseFrame().
+ ***********************************************************/
+class FramePipeline
+{
+public:
+	// constructor
+	FramePipeline();
+	// destructor
+	~FramePipeline();
+
+	// function that builds the frame of a slot on the update thread
+	typedef void (*BUILD_FUNCTION)(void* pContext, int slot);
+
+	// start the update thread with the passed in number of
+	// slots, registered with the job system when one is passed
+	// so the build function can run jobs
+	bool Start(
+		int queueDepth,
+		BUILD_FUNCTION buildFunction,
+		void* pContext,
+		JobSystem* pJobSystem = NULL);
+	// let the update thread finish the frame it is building and
+	// stop it, the frames that were not drawn are dropped
+	void Stop();
+	// whether the update thread is running
+	bool IsRunning() const { return m_thread.joinable(); }
+	// number of slots of the running pipeline
+	int GetQueueDepth() const { return (int)m_states.size(); }
+
+	// wait until the oldest frame is built and return its slot
+	int AcquireFrame();
+	// give the slot of a drawn frame back to the update thread
+	void ReleaseFrame(int slot);
+
+private:
+	// state of a packet slot
+	enum SLOT_STATE
+	{
+		SLOT_FREE = 0,
+		SLOT_BUILDING,
+		SLOT_READY,
+		SLOT_RENDERING
+	};
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::vector<SLOT_STATE> m_states;
+	// next slot to build and next slot to draw
+	int m_nextBuild;
+	int m_nextRender;
+	bool m_bQuit;
+	BUILD_FUNCTION m_buildFunction;
+	void* m_pContext;
+	JobSystem* m_pJobSystem;
+	// set by the update thread once it tried to register
+	bool m_bThreadReady;
+	bool m_bRegistered;
+
+	// loop of the update thread
+	void BuildLoop();
+};
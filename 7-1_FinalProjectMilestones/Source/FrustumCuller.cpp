@@ -0,0 +1,578 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// batched view frustum culling of object bounding boxes - SoA bounds storage
+// with SSE2 / AVX2 kernels selected at runtime and a scalar fallback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// the SIMD kernels store a full group of candidate indices
+	// before advancing the output, so the output list always
+	// needs room for one extra group past the visible count
+	const size_t g_OutputPadding = 8;
+	// bounds per chunk of the parallel test, a multiple of the
+	// widest kernel so the chunks keep the same alignment
+	const uint32_t g_CullChunkSize = 4096;
+}
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	for (int i = 0; i < 6; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// pick the widest kernel the processor supports
+	if (IsPathSupported(CULL_PATH_AVX2))
+	{
+		m_autoPath = CULL_PATH_AVX2;
+	}
+	else if (IsPathSupported(CULL_PATH_SSE2))
+	{
+		m_autoPath = CULL_PATH_SSE2;
+	}
+	else
+	{
+		m_autoPath = CULL_PATH_SCALAR;
+	}
+}
+
+/***********************************************************
+ *  ~FrustumCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrustumCuller::~FrustumCuller()
+{
+	ClearBounds();
+}
+
+/***********************************************************
+ *  ClearBounds()
+ *
+ *  This method is used for removing all the stored bounds.
+ ***********************************************************/
+void FrustumCuller::ClearBounds()
+{
+	m_centerX.clear();
+	m_centerY.clear();
+	m_centerZ.clear();
+	m_extentX.clear();
+	m_extentY.clear();
+	m_extentZ.clear();
+}
+
+/***********************************************************
+ *  ReserveBounds()
+ *
+ *  This method is used for reserving the storage for the
+ *  passed in number of bounds.
+ ***********************************************************/
+void FrustumCuller::ReserveBounds(size_t count)
+{
+	m_centerX.reserve(count);
+	m_centerY.reserve(count);
+	m_centerZ.reserve(count);
+	m_extentX.reserve(count);
+	m_extentY.reserve(count);
+	m_extentZ.reserve(count);
+}
+
+/***********************************************************
+ *  AddBounds()
+ *
+ *  This method is used for adding a box given by its center
+ *  and half extents, and returns the index of the box.
+ ***********************************************************/
+uint32_t FrustumCuller::AddBounds(const glm::vec3& center, const glm::vec3& extents)
+{
+	uint32_t index = (uint32_t)m_centerX.size();
+
+	m_centerX.push_back(center.x);
+	m_centerY.push_back(center.y);
+	m_centerZ.push_back(center.z);
+	m_extentX.push_back(extents.x);
+	m_extentY.push_back(extents.y);
+	m_extentZ.push_back(extents.z);
+
+	return(index);
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used for replacing the previously added
+ *  box at the passed in index.
+ ***********************************************************/
+void FrustumCuller::SetBounds(uint32_t index, const glm::vec3& center, const glm::vec3& extents)
+{
+	if (index < m_centerX.size())
+	{
+		m_centerX[index] = center.x;
+		m_centerY[index] = center.y;
+		m_centerZ[index] = center.z;
+		m_extentX[index] = extents.x;
+		m_extentY[index] = extents.y;
+		m_extentZ[index] = extents.z;
+	}
+}
+
+/***********************************************************
+ *  AddTransformedBounds()
+ *
+ *  This method is used for adding the world space bounds of
+ *  a local space box transformed by the model matrix.
+ ***********************************************************/
+uint32_t FrustumCuller::AddTransformedBounds(
+	const glm::mat4& model,
+	const glm::vec3& localMin,
+	const glm::vec3& localMax)
+{
+	glm::vec3 center;
+	glm::vec3 extents;
+
+	TransformBounds(model, localMin, localMax, center, extents);
+	return(AddBounds(center, extents));
+}
+
+/***********************************************************
+ *  GetBoundsCount()
+ *
+ *  This method is used for getting the number of stored
+ *  bounds.
+ ***********************************************************/
+size_t FrustumCuller::GetBoundsCount() const
+{
+	return(m_centerX.size());
+}
+
+/***********************************************************
+ *  GetBounds()
+ *
+ *  This method is used for getting the box stored at the
+ *  passed in index.
+ ***********************************************************/
+void FrustumCuller::GetBounds(uint32_t index, glm::vec3& center, glm::vec3& extents) const
+{
+	if (index < m_centerX.size())
+	{
+		center = glm::vec3(m_centerX[index], m_centerY[index], m_centerZ[index]);
+		extents = glm::vec3(m_extentX[index], m_extentY[index], m_extentZ[index]);
+	}
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method is used for transforming a local space box
+ *  into the world space box that encloses it.  The extents
+ *  are projected onto the world axes through the absolute
+ *  values of the model matrix rotation and scale.
+ ***********************************************************/
+void FrustumCuller::TransformBounds(
+	const glm::mat4& model,
+	const glm::vec3& localMin,
+	const glm::vec3& localMax,
+	glm::vec3& center,
+	glm::vec3& extents)
+{
+	glm::vec3 localCenter = (localMin + localMax) * 0.5f;
+	glm::vec3 localExtents = (localMax - localMin) * 0.5f;
+
+	center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+	for (int row = 0; row < 3; row++)
+	{
+		extents[row] =
+			std::fabs(model[0][row]) * localExtents.x +
+			std::fabs(model[1][row]) * localExtents.y +
+			std::fabs(model[2][row]) * localExtents.z;
+	}
+}
+
+/***********************************************************
+ *  SetFrustum()
+ *
+ *  This method is used for extracting the six frustum planes
+ *  from the combined view projection matrix.  Each plane is
+ *  the sum or difference of the w row and one clip row.
+ ***********************************************************/
+void FrustumCuller::SetFrustum(const glm::mat4& viewProjection)
+{
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(
+			viewProjection[0][row],
+			viewProjection[1][row],
+			viewProjection[2][row],
+			viewProjection[3][row]);
+	}
+
+	m_planes[0] = rows[3] + rows[0];	// left
+	m_planes[1] = rows[3] - rows[0];	// right
+	m_planes[2] = rows[3] + rows[1];	// bottom
+	m_planes[3] = rows[3] - rows[1];	// top
+	m_planes[4] = rows[3] + rows[2];	// near
+	m_planes[5] = rows[3] - rows[2];	// far
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(m_planes[i]));
+		if (length > 0.0f)
+		{
+			m_planes[i] = m_planes[i] / length;
+		}
+	}
+}
+
+/***********************************************************
+ *  CullBounds()
+ *
+ *  This method is used for testing all the stored bounds
+ *  against the frustum and writing the indices of the boxes
+ *  that are not fully outside of any plane into the list.
+ ***********************************************************/
+size_t FrustumCuller::CullBounds(
+	std::vector<uint32_t>& visibleIndices,
+	CULL_PATH cullPath) const
+{
+	uint32_t count = (uint32_t)m_centerX.size();
+	size_t visibleCount = 0;
+
+	if ((cullPath == CULL_PATH_AUTO) || (IsPathSupported(cullPath) == false))
+	{
+		cullPath = m_autoPath;
+	}
+
+	// the kernels write straight into the list storage
+	visibleIndices.resize(count + g_OutputPadding);
+	visibleCount = CullRange(cullPath, 0, count, visibleIndices.data());
+
+	visibleIndices.resize(visibleCount);
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  CullBounds()
+ *
+ *  This method is used for testing the bounds in chunks on
+ *  the job threads.  Every chunk writes its visible indices
+ *  into its own stretch of the list, and the stretches are
+ *  then moved together in chunk order, so the list is the
+ *  same as the one of the single threaded test.
+ ***********************************************************/
+size_t FrustumCuller::CullBounds(
+	std::vector<uint32_t>& visibleIndices,
+	JobSystem& jobSystem,
+	CULL_PATH cullPath) const
+{
+	uint32_t count = (uint32_t)m_centerX.size();
+	uint32_t chunkCount = (count + g_CullChunkSize - 1) / g_CullChunkSize;
+
+	// small scenes are not worth splitting
+	if ((chunkCount <= 1) || (jobSystem.GetThreadCount() == 1))
+	{
+		return(CullBounds(visibleIndices, cullPath));
+	}
+
+	if ((cullPath == CULL_PATH_AUTO) || (IsPathSupported(cullPath) == false))
+	{
+		cullPath = m_autoPath;
+	}
+
+	uint32_t stride = g_CullChunkSize + (uint32_t)g_OutputPadding;
+	visibleIndices.resize((size_t)chunkCount * stride);
+	m_chunkCounts.resize(chunkCount);
+	uint32_t* pOutput = visibleIndices.data();
+
+	jobSystem.ParallelFor(chunkCount, 1,
+		[this, cullPath, count, stride, pOutput](uint32_t firstChunk, uint32_t lastChunk) {
+		for (uint32_t chunk = firstChunk; chunk < lastChunk; chunk++)
+		{
+			uint32_t first = chunk * g_CullChunkSize;
+			uint32_t last = std::min(count, first + g_CullChunkSize);
+			m_chunkCounts[chunk] = (uint32_t)CullRange(cullPath, first, last, pOutput + (size_t)chunk * stride);
+		}
+	});
+
+	// the first chunk is already in place
+	size_t visibleCount = m_chunkCounts[0];
+	for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+	{
+		const uint32_t* pChunk = pOutput + (size_t)chunk * stride;
+		std::copy(pChunk, pChunk + m_chunkCounts[chunk], pOutput + visibleCount);
+		visibleCount += m_chunkCounts[chunk];
+	}
+
+	visibleIndices.resize(visibleCount);
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  CullRange()
+ *
+ *  This method is used for running the kernel of a culling
+ *  path on a range of the bounds.
+ ***********************************************************/
+size_t FrustumCuller::CullRange(
+	CULL_PATH cullPath,
+	uint32_t first,
+	uint32_t last,
+	uint32_t* pOutput) const
+{
+	switch (cullPath)
+	{
+	case CULL_PATH_AVX2:
+		return(CullAVX2(first, last, pOutput));
+	case CULL_PATH_SSE2:
+		return(CullSSE2(first, last, pOutput));
+	default:
+		return(CullScalar(first, last, pOutput));
+	}
+}
+
+/***********************************************************
+ *  GetAutoPath()
+ *
+ *  This method is used for getting the kernel that is used
+ *  when no specific kernel is requested.
+ ***********************************************************/
+FrustumCuller::CULL_PATH FrustumCuller::GetAutoPath() const
+{
+	return(m_autoPath);
+}
+
+/***********************************************************
+ *  GetPathName()
+ *
+ *  This method is used for getting a readable kernel name.
+ ***********************************************************/
+const char* FrustumCuller::GetPathName(CULL_PATH cullPath)
+{
+	switch (cullPath)
+	{
+	case CULL_PATH_SCALAR:
+		return("scalar");
+	case CULL_PATH_SSE2:
+		return("SSE2");
+	case CULL_PATH_AVX2:
+		return("AVX2");
+	default:
+		return("auto");
+	}
+}
+
+/***********************************************************
+ *  IsPathSupported()
+ *
+ *  This method is used for checking whether the running
+ *  processor can execute the passed in kernel.
+ ***********************************************************/
+bool FrustumCuller::IsPathSupported(CULL_PATH cullPath)
+{
+	switch (cullPath)
+	{
+	case CULL_PATH_SCALAR:
+		return(true);
+#if defined(SIMD_X86)
+	case CULL_PATH_SSE2:
+		return(CpuFeatures::HasSSE2());
+	case CULL_PATH_AVX2:
+		return(CpuFeatures::HasAVX2());
+#endif
+	default:
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  CullScalar()
+ *
+ *  This method is used for testing the bounds one at a time.
+ *  A box is outside a plane when the signed distance of its
+ *  center plus its projected radius is below zero.
+ ***********************************************************/
+size_t FrustumCuller::CullScalar(uint32_t first, uint32_t last, uint32_t* pOutput) const
+{
+	size_t visibleCount = 0;
+
+	for (uint32_t i = first; i < last; i++)
+	{
+		bool bVisible = true;
+		int plane = 0;
+
+		while ((plane < 6) && (bVisible == true))
+		{
+			const glm::vec4& p = m_planes[plane];
+			float distance = p.x * m_centerX[i] + p.y * m_centerY[i] + p.z * m_centerZ[i] + p.w;
+			float radius =
+				std::fabs(p.x) * m_extentX[i] +
+				std::fabs(p.y) * m_extentY[i] +
+				std::fabs(p.z) * m_extentZ[i];
+
+			if (distance + radius < 0.0f)
+			{
+				bVisible = false;
+			}
+			plane++;
+		}
+
+		if (bVisible == true)
+		{
+			pOutput[visibleCount++] = i;
+		}
+	}
+
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  CullSSE2()
+ *
+ *  This method is used for testing four bounds per loop
+ *  iteration.  The visible lanes are compacted into the
+ *  output without branches by always storing every index
+ *  and only advancing the output for the visible lanes.
+ ***********************************************************/
+size_t FrustumCuller::CullSSE2(uint32_t first, uint32_t last, uint32_t* pOutput) const
+{
+#if defined(SIMD_X86)
+	size_t visibleCount = 0;
+	uint32_t i = first;
+
+	const __m128 zero = _mm_setzero_ps();
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 absX[6], absY[6], absZ[6];
+	for (int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm_set1_ps(m_planes[plane].x);
+		planeY[plane] = _mm_set1_ps(m_planes[plane].y);
+		planeZ[plane] = _mm_set1_ps(m_planes[plane].z);
+		planeW[plane] = _mm_set1_ps(m_planes[plane].w);
+		absX[plane] = _mm_set1_ps(std::fabs(m_planes[plane].x));
+		absY[plane] = _mm_set1_ps(std::fabs(m_planes[plane].y));
+		absZ[plane] = _mm_set1_ps(std::fabs(m_planes[plane].z));
+	}
+
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&m_centerX[i]);
+		__m128 cy = _mm_loadu_ps(&m_centerY[i]);
+		__m128 cz = _mm_loadu_ps(&m_centerZ[i]);
+		__m128 ex = _mm_loadu_ps(&m_extentX[i]);
+		__m128 ey = _mm_loadu_ps(&m_extentY[i]);
+		__m128 ez = _mm_loadu_ps(&m_extentZ[i]);
+		__m128 outside = _mm_setzero_ps();
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[plane], cx), _mm_mul_ps(planeY[plane], cy)),
+				_mm_add_ps(_mm_mul_ps(planeZ[plane], cz), planeW[plane]));
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(absX[plane], ex), _mm_mul_ps(absY[plane], ey)),
+				_mm_mul_ps(absZ[plane], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+		for (uint32_t lane = 0; lane < 4; lane++)
+		{
+			pOutput[visibleCount] = i + lane;
+			visibleCount += (visibleMask >> lane) & 1;
+		}
+	}
+
+	// the remaining bounds that do not fill a full group
+	visibleCount += CullScalar(i, last, pOutput + visibleCount);
+	return(visibleCount);
+#else
+	return(CullScalar(first, last, pOutput));
+#endif
+}
+
+/***********************************************************
+ *  CullAVX2()
+ *
+ *  This method is used for testing eight bounds per loop
+ *  iteration with fused multiply-add plane distances.
+ ***********************************************************/
+#if defined(SIMD_X86)
+SIMD_TARGET_AVX2
+#endif
+size_t FrustumCuller::CullAVX2(uint32_t first, uint32_t last, uint32_t* pOutput) const
+{
+#if defined(SIMD_X86)
+	size_t visibleCount = 0;
+	uint32_t i = first;
+
+	const __m256 zero = _mm256_setzero_ps();
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m256 absX[6], absY[6], absZ[6];
+	for (int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm256_set1_ps(m_planes[plane].x);
+		planeY[plane] = _mm256_set1_ps(m_planes[plane].y);
+		planeZ[plane] = _mm256_set1_ps(m_planes[plane].z);
+		planeW[plane] = _mm256_set1_ps(m_planes[plane].w);
+		absX[plane] = _mm256_set1_ps(std::fabs(m_planes[plane].x));
+		absY[plane] = _mm256_set1_ps(std::fabs(m_planes[plane].y));
+		absZ[plane] = _mm256_set1_ps(std::fabs(m_planes[plane].z));
+	}
+
+	for (; i + 8 <= last; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&m_centerX[i]);
+		__m256 cy = _mm256_loadu_ps(&m_centerY[i]);
+		__m256 cz = _mm256_loadu_ps(&m_centerZ[i]);
+		__m256 ex = _mm256_loadu_ps(&m_extentX[i]);
+		__m256 ey = _mm256_loadu_ps(&m_extentY[i]);
+		__m256 ez = _mm256_loadu_ps(&m_extentZ[i]);
+		__m256 outside = _mm256_setzero_ps();
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			// distance + radius accumulated in a single chain
+			__m256 sum = _mm256_fmadd_ps(planeX[plane], cx, planeW[plane]);
+			sum = _mm256_fmadd_ps(planeY[plane], cy, sum);
+			sum = _mm256_fmadd_ps(planeZ[plane], cz, sum);
+			sum = _mm256_fmadd_ps(absX[plane], ex, sum);
+			sum = _mm256_fmadd_ps(absY[plane], ey, sum);
+			sum = _mm256_fmadd_ps(absZ[plane], ez, sum);
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(sum, zero, _CMP_LT_OQ));
+		}
+
+		int visibleMask = ~_mm256_movemask_ps(outside) & 0xFF;
+		for (uint32_t lane = 0; lane < 8; lane++)
+		{
+			pOutput[visibleCount] = i + lane;
+			visibleCount += (visibleMask >> lane) & 1;
+		}
+	}
+
+	// the remaining bounds that do not fill a full group
+	visibleCount += CullScalar(i, last, pOutput + visibleCount);
+	return(visibleCount);
+#else
+	return(CullScalar(first, last, pOutput));
+#endif
+}
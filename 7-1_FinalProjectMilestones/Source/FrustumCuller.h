@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// batched view frustum culling of object bounding boxes - SoA bounds storage
+// with SSE2 / AVX2 kernels selected at runtime and a scalar fallback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class contains the axis aligned bounding boxes of
+ *  the scene objects stored as separate arrays per component
+ *  so that 4 (SSE2) or 8 (AVX2) boxes are tested against the
+ *  view frustum planes per loop iteration.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// constructor
+	FrustumCuller();
+	// destructor
+	~FrustumCuller();
+
+	// available culling kernels
+	enum CULL_PATH
+	{
+		CULL_PATH_AUTO = 0,
+		CULL_PATH_SCALAR,
+		CULL_PATH_SSE2,
+		CULL_PATH_AVX2
+	};
+
+	// remove all the stored bounds
+	void ClearBounds();
+	// reserve storage for the passed in number of bounds
+	void ReserveBounds(size_t count);
+	// add bounds given as box center and half extents,
+	// the returned index is reported by CullBounds()
+	uint32_t AddBounds(const glm::vec3& center, const glm::vec3& extents);
+	// replace previously added bounds
+	void SetBounds(uint32_t index, const glm::vec3& center, const glm::vec3& extents);
+	// add the bounds of a local space box transformed by a model matrix
+	uint32_t AddTransformedBounds(
+		const glm::mat4& model,
+		const glm::vec3& localMin,
+		const glm::vec3& localMax);
+	// number of stored bounds
+	size_t GetBoundsCount() const;
+	// get previously added bounds as center and half extents
+	void GetBounds(uint32_t index, glm::vec3& center, glm::vec3& extents) const;
+
+	// extract the frustum planes from the view projection matrix
+	void SetFrustum(const glm::mat4& viewProjection);
+	// get the six planes extracted by SetFrustum()
+	const glm::vec4* GetPlanes() const { return m_planes; }
+
+	// test all the stored bounds and write the indices of the visible
+	// ones into the list in ascending order, returns the visible count
+	size_t CullBounds(
+		std::vector<uint32_t>& visibleIndices,
+		CULL_PATH cullPath = CULL_PATH_AUTO) const;
+	// test the bounds in chunks spread across the job threads,
+	// with the same result as the single threaded test
+	size_t CullBounds(
+		std::vector<uint32_t>& visibleIndices,
+		JobSystem& jobSystem,
+		CULL_PATH cullPath = CULL_PATH_AUTO) const;
+
+	// the kernel used when CULL_PATH_AUTO is requested
+	CULL_PATH GetAutoPath() const;
+	// readable name of a culling kernel
+	static const char* GetPathName(CULL_PATH cullPath);
+	// whether the running processor supports a culling kernel
+	static bool IsPathSupported(CULL_PATH cullPath);
+
+	// transform a local space box by a model matrix into a
+	// world space box given as center and half extents
+	static void TransformBounds(
+		const glm::mat4& model,
+		const glm::vec3& localMin,
+		const glm::vec3& localMax,
+		glm::vec3& center,
+		glm::vec3& extents);
+
+private:
+	// bounds stored as one array per component
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_extentX;
+	std::vector<float> m_extentY;
+	std::vector<float> m_extentZ;
+
+	// normalized frustum planes - xyz is the plane normal
+	// pointing inside the frustum and w is the distance
+	glm::vec4 m_planes[6];
+
+	// kernel chosen from the detected instruction sets
+	CULL_PATH m_autoPath;
+	// visible count of each chunk of the parallel test
+	mutable std::vector<uint32_t> m_chunkCounts;
+
+	// run the kernel of a path on the bounds in [first, last)
+	size_t CullRange(CULL_PATH cullPath, uint32_t first, uint32_t last, uint32_t* pOutput) const;
+
+	// culling kernels - each tests the bounds in [first, last)
+	// and returns the visible count written into the output
+	size_t CullScalar(uint32_t first, uint32_t last, uint32_t* pOutput) const;
+	size_t CullSSE2(uint32_t first, uint32_t last, uint32_t* pOutput) const;
+	size_t CullAVX2(uint32_t first, uint32_t last, uint32_t* pOutput) const;
+};
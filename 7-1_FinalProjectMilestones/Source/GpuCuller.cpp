@@ -0,0 +1,682 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// compute shader culling of the scene objects against the view frustum and
+// the previous frame's depth pyramid, which writes the indirect draw commands
+// of the visible objects without the CPU looking at them
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCuller.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CullShaderFile = "shaders/cullCompute.glsl";
+	const char* g_ReduceShaderFile = "shaders/depthReduceCompute.glsl";
+
+	// buffer bindings shared with the compute shaders
+	const GLuint g_BoundsBinding = 2;
+	const GLuint g_RangeBinding = 3;
+	const GLuint g_BucketStartBinding = 4;
+	const GLuint g_CommandBinding = 5;
+	const GLuint g_CountBinding = 6;
+	// texture unit the pyramid is read from, above the units
+	// the scene textures are bound to
+	const int g_PyramidTextureUnit = 15;
+	// work group sizes declared in the compute shaders
+	const GLuint g_CullGroupSize = 64;
+	const GLuint g_ReduceGroupSize = 8;
+
+	// indexed indirect draw laid out as OpenGL reads it
+	struct DRAW_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+}
+
+/***********************************************************
+ *  GpuCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCuller::GpuCuller()
+{
+	m_cullProgram = 0;
+	m_reduceProgram = 0;
+	m_cullUniforms = CULL_UNIFORMS();
+	m_reduceUniforms = REDUCE_UNIFORMS();
+	m_drawRecordBuffer = 0;
+	m_boundsBuffer = 0;
+	m_rangeBuffer = 0;
+	m_bucketStartBuffer = 0;
+	m_commandBuffer = 0;
+	m_countBuffer = 0;
+	m_depthTexture = 0;
+	m_pyramidTexture = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_pyramidLevels = 0;
+	m_bPyramidValid = false;
+	m_objectCount = 0;
+	m_drawRecordBytes = 0;
+	m_bucketCount = 0;
+	m_rangeCount = 0;
+	m_lodThresholds = glm::vec3(0.0f);
+	m_uploadedObjects = 0;
+	m_bLayoutDirty = false;
+}
+
+/***********************************************************
+ *  ~GpuCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCuller::~GpuCuller()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking for compute shaders and
+ *  multi-draw calls that read their count from a buffer.
+ ***********************************************************/
+bool GpuCuller::IsSupported()
+{
+	if (GLEW_VERSION_4_6)
+	{
+		return(true);
+	}
+	return((GLEW_VERSION_4_3 || GLEW_ARB_compute_shader) &&
+		GLEW_ARB_multi_draw_indirect && GLEW_ARB_indirect_parameters &&
+		GLEW_ARB_shader_draw_parameters);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for loading the compute shaders and
+ *  creating the buffers.  The draw records are opaque to
+ *  the culler, it only stores them where the draw shaders
+ *  index them by object.
+ ***********************************************************/
+bool GpuCuller::Create(
+	size_t objectCount,
+	size_t drawRecordBytes,
+	int bucketCount,
+	const std::vector<GPU_MESH_RANGE>& meshRanges)
+{
+	Destroy();
+
+	if ((objectCount == 0) || (bucketCount <= 0) || (meshRanges.empty() == true))
+	{
+		return(false);
+	}
+	if (IsSupported() == false)
+	{
+		std::cout << "INFO: Compute shader culling is not supported" << std::endl;
+		return(false);
+	}
+
+	m_cullProgram = LoadComputeProgram(g_CullShaderFile);
+	m_reduceProgram = LoadComputeProgram(g_ReduceShaderFile);
+	if ((m_cullProgram == 0) || (m_reduceProgram == 0))
+	{
+		Destroy();
+		return(false);
+	}
+
+	m_cullUniforms.objectCount = glGetUniformLocation(m_cullProgram, "objectCount");
+	m_cullUniforms.frustumPlanes = glGetUniformLocation(m_cullProgram, "frustumPlanes");
+	m_cullUniforms.view = glGetUniformLocation(m_cullProgram, "view");
+	m_cullUniforms.projection = glGetUniformLocation(m_cullProgram, "projection");
+	m_cullUniforms.lodThresholds = glGetUniformLocation(m_cullProgram, "lodThresholds");
+	m_cullUniforms.bUseLOD = glGetUniformLocation(m_cullProgram, "bUseLOD");
+	m_cullUniforms.bUseDepthPyramid = glGetUniformLocation(m_cullProgram, "bUseDepthPyramid");
+	m_cullUniforms.depthPyramid = glGetUniformLocation(m_cullProgram, "depthPyramid");
+	m_cullUniforms.pyramidSize = glGetUniformLocation(m_cullProgram, "pyramidSize");
+	m_cullUniforms.pyramidLevelCount = glGetUniformLocation(m_cullProgram, "pyramidLevelCount");
+	m_reduceUniforms.sourceDepth = glGetUniformLocation(m_reduceProgram, "sourceDepth");
+	m_reduceUniforms.bCopyLevel = glGetUniformLocation(m_reduceProgram, "bCopyLevel");
+	m_reduceUniforms.sourceLevel = glGetUniformLocation(m_reduceProgram, "sourceLevel");
+	m_reduceUniforms.sourceSize = glGetUniformLocation(m_reduceProgram, "sourceSize");
+	m_reduceUniforms.targetSize = glGetUniformLocation(m_reduceProgram, "targetSize");
+
+	m_objectCount = objectCount;
+	m_drawRecordBytes = drawRecordBytes;
+	m_bucketCount = bucketCount;
+	m_rangeCount = meshRanges.size();
+
+	m_drawRecords.assign(objectCount * drawRecordBytes, 0);
+	m_bounds.assign(objectCount, GPU_BOUNDS());
+	m_dirtyFlags.assign(objectCount, 0);
+	m_dirtyObjects.clear();
+	m_bucketCapacities.assign(bucketCount, 0);
+	m_bucketStarts.assign(bucketCount, 0);
+
+	glGenBuffers(1, &m_drawRecordBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawRecordBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawRecords.size(), NULL, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &m_boundsBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_boundsBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, objectCount * sizeof(GPU_BOUNDS), NULL, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &m_rangeBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_rangeBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER,
+		meshRanges.size() * sizeof(GPU_MESH_RANGE), meshRanges.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_bucketStartBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bucketStartBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, bucketCount * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+
+	// every object can be visible in its own bucket, so the
+	// buckets together never need more than one command each
+	glGenBuffers(1, &m_commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, objectCount * sizeof(DRAW_COMMAND), NULL, GL_DYNAMIC_COPY);
+
+	glGenBuffers(1, &m_countBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, bucketCount * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_bLayoutDirty = true;
+
+	std::cout << "INFO: Compute shader culling created for " << objectCount
+		<< " objects in " << bucketCount << " buckets" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the programs, buffers
+ *  and textures.
+ ***********************************************************/
+void GpuCuller::Destroy()
+{
+	GLuint buffers[] = { m_drawRecordBuffer, m_boundsBuffer, m_rangeBuffer,
+		m_bucketStartBuffer, m_commandBuffer, m_countBuffer };
+
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++)
+	{
+		if (buffers[i] != 0)
+		{
+			glDeleteBuffers(1, &buffers[i]);
+		}
+	}
+	if (m_cullProgram != 0)
+	{
+		glDeleteProgram(m_cullProgram);
+	}
+	if (m_reduceProgram != 0)
+	{
+		glDeleteProgram(m_reduceProgram);
+	}
+	if (m_depthTexture != 0)
+	{
+		glDeleteTextures(1, &m_depthTexture);
+	}
+	if (m_pyramidTexture != 0)
+	{
+		glDeleteTextures(1, &m_pyramidTexture);
+	}
+
+	m_cullProgram = 0;
+	m_reduceProgram = 0;
+	m_cullUniforms = CULL_UNIFORMS();
+	m_reduceUniforms = REDUCE_UNIFORMS();
+	m_drawRecordBuffer = 0;
+	m_boundsBuffer = 0;
+	m_rangeBuffer = 0;
+	m_bucketStartBuffer = 0;
+	m_commandBuffer = 0;
+	m_countBuffer = 0;
+	m_depthTexture = 0;
+	m_pyramidTexture = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_pyramidLevels = 0;
+	m_bPyramidValid = false;
+	m_objectCount = 0;
+	m_drawRecords.clear();
+	m_bounds.clear();
+	m_dirtyObjects.clear();
+	m_dirtyFlags.clear();
+}
+
+/***********************************************************
+ *  SetObject()
+ *
+ *  This method is used for replacing the values of an
+ *  object on the CPU and marking it for the next upload.
+ *  Moving an object to another bucket changes how the
+ *  commands are split between the buckets.
+ ***********************************************************/
+void GpuCuller::SetObject(
+	uint32_t objectIndex,
+	const void* pDrawRecord,
+	const glm::vec3& center,
+	const glm::vec3& extents,
+	uint32_t firstRange,
+	uint32_t rangeCount,
+	int bucket)
+{
+	if ((objectIndex >= m_objectCount) || (bucket < 0) || (bucket >= m_bucketCount))
+	{
+		return;
+	}
+
+	std::memcpy(&m_drawRecords[objectIndex * m_drawRecordBytes], pDrawRecord, m_drawRecordBytes);
+
+	// ranges outside the table leave the object undrawn
+	if (firstRange + rangeCount > m_rangeCount)
+	{
+		rangeCount = 0;
+	}
+
+	GPU_BOUNDS& bounds = m_bounds[objectIndex];
+	if (bounds.bucket != (uint32_t)bucket)
+	{
+		m_bLayoutDirty = true;
+	}
+	bounds.center = glm::vec4(center, 0.0f);
+	bounds.extents = glm::vec4(extents, 0.0f);
+	bounds.firstRange = firstRange;
+	bounds.rangeCount = std::min(rangeCount, (uint32_t)MAX_OBJECT_RANGES);
+	bounds.bucket = (uint32_t)bucket;
+	bounds.padding = 0;
+
+	if (m_dirtyFlags[objectIndex] == 0)
+	{
+		m_dirtyFlags[objectIndex] = 1;
+		m_dirtyObjects.push_back(objectIndex);
+	}
+}
+
+/***********************************************************
+ *  SetLODThresholds()
+ *
+ *  This method is used for setting the screen sizes that
+ *  the compute pass switches between mesh ranges at, the
+ *  same values the LOD selector on the CPU uses.
+ ***********************************************************/
+void GpuCuller::SetLODThresholds(const std::vector<float>& minScreenSizes)
+{
+	m_lodThresholds = glm::vec3(0.0f);
+	for (size_t i = 0; (i < minScreenSizes.size()) && (i < 3); i++)
+	{
+		m_lodThresholds[(int)i] = minScreenSizes[i];
+	}
+}
+
+/***********************************************************
+ *  UploadChangedObjects()
+ *
+ *  This method is used for uploading the dirty objects.
+ *  The list is sorted so that neighbouring objects that
+ *  changed together go up in one call per buffer.
+ ***********************************************************/
+void GpuCuller::UploadChangedObjects()
+{
+	m_uploadedObjects = m_dirtyObjects.size();
+	if (m_dirtyObjects.empty() == true)
+	{
+		return;
+	}
+
+	std::sort(m_dirtyObjects.begin(), m_dirtyObjects.end());
+
+	size_t first = 0;
+	while (first < m_dirtyObjects.size())
+	{
+		size_t last = first + 1;
+		while ((last < m_dirtyObjects.size()) &&
+			(m_dirtyObjects[last] == m_dirtyObjects[last - 1] + 1))
+		{
+			last++;
+		}
+
+		uint32_t firstObject = m_dirtyObjects[first];
+		size_t runLength = last - first;
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawRecordBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+			firstObject * m_drawRecordBytes, runLength * m_drawRecordBytes,
+			&m_drawRecords[firstObject * m_drawRecordBytes]);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_boundsBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+			firstObject * sizeof(GPU_BOUNDS), runLength * sizeof(GPU_BOUNDS),
+			&m_bounds[firstObject]);
+
+		first = last;
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	for (size_t i = 0; i < m_dirtyObjects.size(); i++)
+	{
+		m_dirtyFlags[m_dirtyObjects[i]] = 0;
+	}
+	m_dirtyObjects.clear();
+}
+
+/***********************************************************
+ *  UpdateBucketLayout()
+ *
+ *  This method is used for giving every bucket as many
+ *  command slots as it has objects, one after the other in
+ *  the command buffer.
+ ***********************************************************/
+void GpuCuller::UpdateBucketLayout()
+{
+	std::fill(m_bucketCapacities.begin(), m_bucketCapacities.end(), 0);
+	for (size_t i = 0; i < m_objectCount; i++)
+	{
+		m_bucketCapacities[m_bounds[i].bucket]++;
+	}
+
+	uint32_t start = 0;
+	for (int bucket = 0; bucket < m_bucketCount; bucket++)
+	{
+		m_bucketStarts[bucket] = start;
+		start += m_bucketCapacities[bucket];
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bucketStartBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+		m_bucketStarts.size() * sizeof(GLuint), m_bucketStarts.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_bLayoutDirty = false;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the culling pass.  The
+ *  bucket counts are cleared, one invocation per object
+ *  appends its command, and the barrier makes the commands
+ *  and counts visible to the following indirect draws.
+ ***********************************************************/
+void GpuCuller::Cull(
+	const glm::vec4 frustumPlanes[6],
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	bool bUseLOD,
+	bool bUseDepthPyramid)
+{
+	if (IsCreated() == false)
+	{
+		return;
+	}
+
+	UploadChangedObjects();
+	if (m_bLayoutDirty == true)
+	{
+		UpdateBucketLayout();
+	}
+
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glUseProgram(m_cullProgram);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_BoundsBinding, m_boundsBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_RangeBinding, m_rangeBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_BucketStartBinding, m_bucketStartBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CommandBinding, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CountBinding, m_countBuffer);
+
+	bool bPyramid = (bUseDepthPyramid == true) && (m_bPyramidValid == true);
+
+	glUniform1ui(m_cullUniforms.objectCount, (GLuint)m_objectCount);
+	glUniform4fv(m_cullUniforms.frustumPlanes, 6, &frustumPlanes[0][0]);
+	glUniformMatrix4fv(m_cullUniforms.view, 1, GL_FALSE, &view[0][0]);
+	glUniformMatrix4fv(m_cullUniforms.projection, 1, GL_FALSE, &projection[0][0]);
+	glUniform3fv(m_cullUniforms.lodThresholds, 1, &m_lodThresholds[0]);
+	glUniform1i(m_cullUniforms.bUseLOD, bUseLOD ? 1 : 0);
+	glUniform1i(m_cullUniforms.bUseDepthPyramid, bPyramid ? 1 : 0);
+	if (bPyramid == true)
+	{
+		glActiveTexture(GL_TEXTURE0 + g_PyramidTextureUnit);
+		glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+		glActiveTexture(GL_TEXTURE0);
+		glUniform1i(m_cullUniforms.depthPyramid, g_PyramidTextureUnit);
+		glUniform2f(m_cullUniforms.pyramidSize, (float)m_pyramidWidth, (float)m_pyramidHeight);
+		glUniform1i(m_cullUniforms.pyramidLevelCount, m_pyramidLevels);
+	}
+
+	glDispatchCompute((GLuint)((m_objectCount + g_CullGroupSize - 1) / g_CullGroupSize), 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	glUseProgram((GLuint)previousProgram);
+}
+
+/***********************************************************
+ *  DrawBuckets()
+ *
+ *  This method is used for drawing every bucket that has
+ *  objects with one multi-draw call.  The number of draws
+ *  is read from the bucket's counter on the GPU, so nothing
+ *  is read back.  The draw shaders find the draw record of
+ *  each command at gl_BaseInstance.
+ ***********************************************************/
+int GpuCuller::DrawBuckets(GLuint drawRecordBinding) const
+{
+	if (IsCreated() == false)
+	{
+		return(0);
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawRecordBinding, m_drawRecordBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBindBuffer(GL_PARAMETER_BUFFER, m_countBuffer);
+
+	// OpenGL 4.5 only has the entry point of the extension
+	PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC multiDrawIndirectCount = (GLEW_VERSION_4_6) ?
+		glMultiDrawElementsIndirectCount : glMultiDrawElementsIndirectCountARB;
+
+	int callCount = 0;
+	for (int bucket = 0; bucket < m_bucketCount; bucket++)
+	{
+		if (m_bucketCapacities[bucket] == 0)
+		{
+			continue;
+		}
+
+		multiDrawIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(void*)(m_bucketStarts[bucket] * sizeof(DRAW_COMMAND)),
+			(GLintptr)(bucket * sizeof(GLuint)),
+			(GLsizei)m_bucketCapacities[bucket], sizeof(DRAW_COMMAND));
+		callCount++;
+	}
+
+	glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	return(callCount);
+}
+
+/***********************************************************
+ *  CreateDepthPyramid()
+ *
+ *  This method is used for creating the texture the depth
+ *  buffer is copied into and the pyramid texture with a
+ *  full mip chain, both the size of the viewport.
+ ***********************************************************/
+void GpuCuller::CreateDepthPyramid(int width, int height)
+{
+	if (m_depthTexture != 0)
+	{
+		glDeleteTextures(1, &m_depthTexture);
+	}
+	if (m_pyramidTexture != 0)
+	{
+		glDeleteTextures(1, &m_pyramidTexture);
+	}
+
+	m_pyramidWidth = width;
+	m_pyramidHeight = height;
+	m_pyramidLevels = 1;
+	while (((width | height) >> m_pyramidLevels) != 0)
+	{
+		m_pyramidLevels++;
+	}
+
+	glGenTextures(1, &m_depthTexture);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_pyramidTexture);
+	glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_bPyramidValid = false;
+}
+
+/***********************************************************
+ *  BuildDepthPyramid()
+ *
+ *  This method is used for copying the depth buffer of the
+ *  frame that was just drawn and reducing it one level at
+ *  a time, each texel keeping the farthest depth below it.
+ *  The next frame tests against it before its own depth
+ *  exists, which can keep an object hidden for one frame
+ *  after it comes into view.
+ ***********************************************************/
+void GpuCuller::BuildDepthPyramid()
+{
+	if (IsCreated() == false)
+	{
+		return;
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if ((viewport[2] <= 0) || (viewport[3] <= 0))
+	{
+		return;
+	}
+	if ((viewport[2] != m_pyramidWidth) || (viewport[3] != m_pyramidHeight))
+	{
+		CreateDepthPyramid(viewport[2], viewport[3]);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], viewport[2], viewport[3]);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glUseProgram(m_reduceProgram);
+	glUniform1i(m_reduceUniforms.sourceDepth, g_PyramidTextureUnit);
+	glActiveTexture(GL_TEXTURE0 + g_PyramidTextureUnit);
+
+	int sourceWidth = m_pyramidWidth;
+	int sourceHeight = m_pyramidHeight;
+	for (int level = 0; level < m_pyramidLevels; level++)
+	{
+		int targetWidth = std::max(1, m_pyramidWidth >> level);
+		int targetHeight = std::max(1, m_pyramidHeight >> level);
+
+		// level 0 is a copy of the depth buffer, every other
+		// level reduces the one below it
+		glBindTexture(GL_TEXTURE_2D, (level == 0) ? m_depthTexture : m_pyramidTexture);
+		glUniform1i(m_reduceUniforms.bCopyLevel, (level == 0) ? 1 : 0);
+		glUniform1i(m_reduceUniforms.sourceLevel, (level == 0) ? 0 : level - 1);
+		glUniform2i(m_reduceUniforms.sourceSize, sourceWidth, sourceHeight);
+		glUniform2i(m_reduceUniforms.targetSize, targetWidth, targetHeight);
+		glBindImageTexture(0, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute(
+			(GLuint)((targetWidth + g_ReduceGroupSize - 1) / g_ReduceGroupSize),
+			(GLuint)((targetHeight + g_ReduceGroupSize - 1) / g_ReduceGroupSize), 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		sourceWidth = targetWidth;
+		sourceHeight = targetHeight;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glUseProgram((GLuint)previousProgram);
+
+	m_bPyramidValid = true;
+}
+
+/***********************************************************
+ *  LoadComputeProgram()
+ *
+ *  This method is used for reading a compute shader file,
+ *  compiling it and linking it into a program.  Errors are
+ *  printed with the shader log and return 0.
+ ***********************************************************/
+GLuint GpuCuller::LoadComputeProgram(const char* filename)
+{
+	std::ifstream file(filename);
+	if (file.is_open() == false)
+	{
+		std::cout << "ERROR: Could not open the compute shader " << filename << std::endl;
+		return(0);
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	std::string source = stream.str();
+	const char* pSource = source.c_str();
+
+	GLint result = GL_FALSE;
+	char log[1024];
+
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shader, 1, &pSource, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+	if (result == GL_FALSE)
+	{
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "ERROR: Could not compile " << filename << std::endl << log << std::endl;
+		glDeleteShader(shader);
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+	glGetProgramiv(program, GL_LINK_STATUS, &result);
+	if (result == GL_FALSE)
+	{
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		std::cout << "ERROR: Could not link " << filename << std::endl << log << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+
+	return(program);
+}
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// compute shader culling of the scene objects against the view frustum and
+// the previous frame's depth pyramid, which writes the indirect draw commands
+// of the visible objects without the CPU looking at them
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  GpuCuller
+ *
+ *  This class keeps the per draw record, the world space
+ *  bounds and the mesh ranges of every object in shader
+ *  storage buffers.  Each frame a compute pass tests the
+ *  bounds, picks a mesh range by screen size, and appends a
+ *  draw command to the bucket the object belongs to, so the
+ *  bucket can be drawn with one multi-draw call whose count
+ *  comes from the GPU.  The CPU only uploads the objects
+ *  that changed since the previous frame.
+ ***********************************************************/
+class GpuCuller
+{
+public:
+	// constructor
+	GpuCuller();
+	// destructor
+	~GpuCuller();
+
+	// location of a mesh in the index buffer the commands draw
+	// from, laid out to match the std430 MeshRange struct
+	struct GPU_MESH_RANGE
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+		GLuint padding;
+	};
+
+	// most mesh ranges an object can switch between by size
+	static const int MAX_OBJECT_RANGES = 4;
+
+	// check whether the compute and indirect count features are
+	// available in the current context
+	static bool IsSupported();
+
+	// load the compute shaders and create the buffers for the
+	// passed in number of objects, draw record size, buckets
+	// and mesh ranges
+	bool Create(
+		size_t objectCount,
+		size_t drawRecordBytes,
+		int bucketCount,
+		const std::vector<GPU_MESH_RANGE>& meshRanges);
+	// free the programs, buffers and textures
+	void Destroy();
+	// check whether the culler was created
+	bool IsCreated() const { return m_cullProgram != 0; }
+
+	// replace the values of an object, which are uploaded by
+	// the next cull - the object uses rangeCount mesh ranges
+	// starting at firstRange, finest first
+	void SetObject(
+		uint32_t objectIndex,
+		const void* pDrawRecord,
+		const glm::vec3& center,
+		const glm::vec3& extents,
+		uint32_t firstRange,
+		uint32_t rangeCount,
+		int bucket);
+	// set the smallest screen size of each mesh range but the
+	// last, as fractions of the viewport height
+	void SetLODThresholds(const std::vector<float>& minScreenSizes);
+
+	// upload the changed objects and run the culling pass,
+	// which replaces the draw commands of every bucket
+	void Cull(
+		const glm::vec4 frustumPlanes[6],
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		bool bUseLOD,
+		bool bUseDepthPyramid);
+	// draw the commands of every bucket with the draw records
+	// bound for the shaders, returns the number of calls
+	int DrawBuckets(GLuint drawRecordBinding) const;
+	// copy the depth buffer of the drawn frame and reduce it
+	// into the pyramid that the next cull tests against
+	void BuildDepthPyramid();
+
+	// get the number of objects uploaded by the last cull
+	size_t GetUploadedObjectCount() const { return m_uploadedObjects; }
+
+private:
+	// bounds and mesh selection of one object, laid out to
+	// match the std430 ObjectBounds struct
+	struct GPU_BOUNDS
+	{
+		glm::vec4 center;
+		glm::vec4 extents;
+		uint32_t firstRange;
+		uint32_t rangeCount;
+		uint32_t bucket;
+		uint32_t padding;
+	};
+
+	// locations of the uniforms of the cull shader
+	struct CULL_UNIFORMS
+	{
+		GLint objectCount;
+		GLint frustumPlanes;
+		GLint view;
+		GLint projection;
+		GLint lodThresholds;
+		GLint bUseLOD;
+		GLint bUseDepthPyramid;
+		GLint depthPyramid;
+		GLint pyramidSize;
+		GLint pyramidLevelCount;
+	};
+
+	// locations of the uniforms of the pyramid reduce shader
+	struct REDUCE_UNIFORMS
+	{
+		GLint sourceDepth;
+		GLint bCopyLevel;
+		GLint sourceLevel;
+		GLint sourceSize;
+		GLint targetSize;
+	};
+
+	GLuint m_cullProgram;
+	GLuint m_reduceProgram;
+	// uniform locations looked up once the programs are linked
+	CULL_UNIFORMS m_cullUniforms;
+	REDUCE_UNIFORMS m_reduceUniforms;
+	// per object draw records read by the draw shaders
+	GLuint m_drawRecordBuffer;
+	// per object bounds and the shared mesh ranges
+	GLuint m_boundsBuffer;
+	GLuint m_rangeBuffer;
+	// first command of every bucket, the commands themselves
+	// and the number of commands written to each bucket
+	GLuint m_bucketStartBuffer;
+	GLuint m_commandBuffer;
+	GLuint m_countBuffer;
+	// copy of the depth buffer and the pyramid built from it
+	GLuint m_depthTexture;
+	GLuint m_pyramidTexture;
+	int m_pyramidWidth;
+	int m_pyramidHeight;
+	int m_pyramidLevels;
+	bool m_bPyramidValid;
+
+	size_t m_objectCount;
+	size_t m_drawRecordBytes;
+	int m_bucketCount;
+	size_t m_rangeCount;
+	glm::vec3 m_lodThresholds;
+
+	// CPU copies of the object values and the objects that
+	// changed since the last upload
+	std::vector<uint8_t> m_drawRecords;
+	std::vector<GPU_BOUNDS> m_bounds;
+	std::vector<uint32_t> m_dirtyObjects;
+	std::vector<uint8_t> m_dirtyFlags;
+	size_t m_uploadedObjects;
+	// command capacity and first command of every bucket
+	std::vector<uint32_t> m_bucketCapacities;
+	std::vector<uint32_t> m_bucketStarts;
+	bool m_bLayoutDirty;
+
+	// upload the objects in the dirty list in runs of
+	// consecutive indices
+	void UploadChangedObjects();
+	// split the command buffer between the buckets by the
+	// number of objects in each one
+	void UpdateBucketLayout();
+	// create the depth copy and the pyramid for a viewport size
+	void CreateDepthPyramid(int width, int height);
+
+	// load, compile and link a compute shader file
+	static GLuint LoadComputeProgram(const char* filename);
+};
@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.cpp
+// ============
+// OpenGL context and frame buffer for rendering without a display, so the
+// renderer runs on batch nodes that only have a CPU rasterizer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HeadlessContext.h"
+
+#ifdef HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// OpenGL version the shaders are written for - multi-draw
+	// also needs the shader draw parameters, which the renderer
+	// checks for once the context exists
+	const int g_ContextMajorVersion = 4;
+	const int g_ContextMinorVersion = 5;
+}
+
+/***********************************************************
+ *  HeadlessContext()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HeadlessContext::HeadlessContext()
+{
+	m_pDisplay = NULL;
+	m_pContext = NULL;
+	m_pWindow = NULL;
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~HeadlessContext()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  CreateContext()
+ *
+ *  This method is used for creating the context.  With EGL
+ *  the surfaceless platform of Mesa is used when it is
+ *  there, which needs no display server and no GPU.
+ ***********************************************************/
+bool HeadlessContext::CreateContext()
+{
+	Destroy();
+
+#ifdef HEADLESS_EGL
+	EGLDisplay display = EGL_NO_DISPLAY;
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if ((clientExtensions != NULL) && (strstr(clientExtensions, "EGL_MESA_platform_surfaceless") != NULL) &&
+		(getPlatformDisplay != NULL))
+	{
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major = 0;
+	EGLint minor = 0;
+	if ((display == EGL_NO_DISPLAY) || (eglInitialize(display, &major, &minor) == EGL_FALSE))
+	{
+		std::cout << "ERROR: Could not initialize EGL for rendering without a display" << std::endl;
+		return(false);
+	}
+	m_pDisplay = display;
+
+	// the surface type defaults to windows, which the
+	// surfaceless platform has no configurations for
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE };
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, g_ContextMajorVersion,
+		EGL_CONTEXT_MINOR_VERSION, g_ContextMinorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE };
+
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+	EGLContext context = EGL_NO_CONTEXT;
+	if ((configCount > 0) && (eglBindAPI(EGL_OPENGL_API) == EGL_TRUE))
+	{
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	}
+	if ((context == EGL_NO_CONTEXT) || (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_FALSE))
+	{
+		std::cout << "ERROR: Could not create a surfaceless OpenGL " << g_ContextMajorVersion << "."
+			<< g_ContextMinorVersion << " context, EGL error 0x" << std::hex << eglGetError() << std::dec << std::endl;
+		if (context != EGL_NO_CONTEXT)
+		{
+			eglDestroyContext(display, context);
+		}
+		Destroy();
+		return(false);
+	}
+	m_pContext = context;
+
+	std::cout << "INFO: Created surfaceless EGL " << major << "." << minor << " context" << std::endl;
+#else
+	// GLFW is initialized by the application, with the version
+	// and profile hints set
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_pWindow = glfwCreateWindow(1, 1, "", NULL, NULL);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (m_pWindow == NULL)
+	{
+		std::cout << "ERROR: Could not create a hidden window for rendering offscreen" << std::endl;
+		return(false);
+	}
+	glfwMakeContextCurrent(m_pWindow);
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used for creating the color and depth
+ *  buffers of the frames, the same formats a window gets.
+ ***********************************************************/
+bool HeadlessContext::CreateFramebuffer(int width, int height)
+{
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: Offscreen frame buffer of " << width << " x " << height << " is not complete" << std::endl;
+		return(false);
+	}
+
+	glViewport(0, 0, width, height);
+	m_width = width;
+	m_height = height;
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for deleting the frame buffer while
+ *  the context is still current, and the context after it.
+ ***********************************************************/
+void HeadlessContext::Destroy()
+{
+	if (m_framebuffer != 0)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_framebuffer = 0;
+		m_colorBuffer = 0;
+		m_depthBuffer = 0;
+	}
+
+#ifdef HEADLESS_EGL
+	if (m_pDisplay != NULL)
+	{
+		eglMakeCurrent(m_pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (m_pContext != NULL)
+		{
+			eglDestroyContext(m_pDisplay, m_pContext);
+		}
+		eglTerminate(m_pDisplay);
+	}
+#else
+	if (m_pWindow != NULL)
+	{
+		glfwDestroyWindow(m_pWindow);
+	}
+#endif
+	m_pDisplay = NULL;
+	m_pContext = NULL;
+	m_pWindow = NULL;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting for the frame, which
+ *  takes the place of swapping buffers - a CPU rasterizer
+ *  does most of its work here, so frame times are taken
+ *  after it.
+ ***********************************************************/
+void HeadlessContext::Finish()
+{
+	glFinish();
+}
+
+/***********************************************************
+ *  SaveImage()
+ *
+ *  This method is used for reading back the color buffer
+ *  and writing it with the rows flipped, since OpenGL reads
+ *  them bottom up.
+ ***********************************************************/
+bool HeadlessContext::SaveImage(const char* filename)
+{
+	if (m_framebuffer == 0)
+	{
+		return(false);
+	}
+
+	size_t rowSize = (size_t)m_width * 4;
+	m_pixels.resize(rowSize * m_height);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+	std::vector<uint8_t> row((size_t)m_width * 3);
+	for (int y = m_height - 1; y >= 0; y--)
+	{
+		const uint8_t* pSource = m_pixels.data() + rowSize * y;
+		for (int x = 0; x < m_width; x++)
+		{
+			row[x * 3 + 0] = pSource[x * 4 + 0];
+			row[x * 3 + 1] = pSource[x * 4 + 1];
+			row[x * 3 + 2] = pSource[x * 4 + 2];
+		}
+		file.write((const char*)row.data(), (std::streamsize)row.size());
+	}
+
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write image " << filename << std::endl;
+		return(false);
+	}
+	return(true);
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.h
+// ============
+// OpenGL context and frame buffer for rendering without a display, so the
+// renderer runs on batch nodes that only have a CPU rasterizer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <cstdint>
+#include <vector>
+
+// offscreen contexts are created with EGL on Linux, where
+// Mesa renders with llvmpipe when there is no GPU, and with
+// a hidden GLFW window on the other platforms
+#if defined(__linux__)
+#define HEADLESS_EGL
+#endif
+
+/***********************************************************
+ *  HeadlessContext
+ *
+ *  This class creates an OpenGL context that is not tied to
+ *  a window and a frame buffer object that the frames are
+ *  rendered into instead of a back buffer.  On Linux the
+ *  context is a surfaceless EGL context, which needs GLEW
+ *  built with GLEW_EGL and the application linked with
+ *  libEGL, as CMakeLists.txt sets up.  The frame buffer is
+ *  created once OpenGL is initialized and stays bound, so
+ *  the renderer draws into it without knowing it has no
+ *  window.
+ ***********************************************************/
+class HeadlessContext
+{
+public:
+	// constructor
+	HeadlessContext();
+	// destructor
+	~HeadlessContext();
+
+	// create the context and make it current on the calling
+	// thread, false when no context could be created, which
+	// is reported
+	bool CreateContext();
+	// create the frame buffer and bind it with a viewport of
+	// its size, once GLEW is initialized
+	bool CreateFramebuffer(int width, int height);
+	// release the frame buffer and the context
+	void Destroy();
+
+	// wait until the frame that was rendered is finished
+	void Finish();
+	// read the frame buffer and save it as a binary PPM image,
+	// top row first
+	bool SaveImage(const char* filename);
+
+private:
+	// EGL display and context, kept untyped so the platform
+	// headers of EGL stay out of the renderer
+	void* m_pDisplay;
+	void* m_pContext;
+	// hidden window that owns the context without EGL
+	GLFWwindow* m_pWindow;
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+	// pixels of the last saved frame, kept for the next one
+	std::vector<uint8_t> m_pixels;
+};
@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////
+// hizocclusionculler.cpp
+// ============
+// occlusion culling on the CPU - occluders are rasterized into a low
+// resolution depth buffer, which is reduced into a min/max depth hierarchy
+// that object bounds are tested against before they are submitted
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HiZOcclusionCuller.h"
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// depth of the cleared buffer - the far plane
+	const float g_FarDepth = 1.0f;
+	// smallest rows per rasterization task
+	const uint32_t g_MinRowsPerTask = 8;
+	// smallest candidates per object test task
+	const uint32_t g_CandidatesPerTask = 64;
+
+	/***********************************************************
+	 *  EdgeFunction()
+	 *
+	 *  This function is used for getting the signed area of the
+	 *  parallelogram spanned by the edge a-b and the point p.
+	 ***********************************************************/
+	inline float EdgeFunction(float ax, float ay, float bx, float by, float px, float py)
+	{
+		return((bx - ax) * (py - ay) - (by - ay) * (px - ax));
+	}
+}
+
+/***********************************************************
+ *  HiZOcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HiZOcclusionCuller::HiZOcclusionCuller(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_viewProjection = glm::mat4(1.0f);
+	m_pJobSystem = NULL;
+
+	// allocate every level of the hierarchy down to one texel
+	int levelWidth = width;
+	int levelHeight = height;
+	while (true)
+	{
+		DEPTH_LEVEL level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.minDepth.resize((size_t)levelWidth * levelHeight, g_FarDepth);
+		level.maxDepth.resize((size_t)levelWidth * levelHeight, g_FarDepth);
+		m_levels.push_back(level);
+
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+}
+
+/***********************************************************
+ *  ~HiZOcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HiZOcclusionCuller::~HiZOcclusionCuller()
+{
+	m_pJobSystem = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the occluders and the
+ *  depth buffer for a new frame.
+ ***********************************************************/
+void HiZOcclusionCuller::BeginFrame(const glm::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+	m_triangles.clear();
+	std::fill(m_levels[0].maxDepth.begin(), m_levels[0].maxDepth.end(), g_FarDepth);
+}
+
+/***********************************************************
+ *  AddBoxOccluder()
+ *
+ *  This method is used for adding the twelve triangles of a
+ *  local space box transformed by the model matrix.
+ ***********************************************************/
+void HiZOcclusionCuller::AddBoxOccluder(
+	const glm::mat4& model,
+	const glm::vec3& localMin,
+	const glm::vec3& localMax)
+{
+	// corner i uses the max x for bit 0, max y for bit 1
+	// and max z for bit 2
+	static const int faces[6][4] = {
+		{ 0, 2, 6, 4 },	// -x
+		{ 1, 5, 7, 3 },	// +x
+		{ 0, 4, 5, 1 },	// -y
+		{ 2, 3, 7, 6 },	// +y
+		{ 0, 1, 3, 2 },	// -z
+		{ 4, 6, 7, 5 }	// +z
+	};
+
+	glm::mat4 modelViewProjection = m_viewProjection * model;
+	glm::vec4 corners[8];
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner(
+			(i & 1) ? localMax.x : localMin.x,
+			(i & 2) ? localMax.y : localMin.y,
+			(i & 4) ? localMax.z : localMin.z);
+		corners[i] = modelViewProjection * glm::vec4(corner, 1.0f);
+	}
+
+	for (int face = 0; face < 6; face++)
+	{
+		const int* quad = faces[face];
+		AddClipTriangle(corners[quad[0]], corners[quad[1]], corners[quad[2]]);
+		AddClipTriangle(corners[quad[0]], corners[quad[2]], corners[quad[3]]);
+	}
+}
+
+/***********************************************************
+ *  AddClipTriangle()
+ *
+ *  This method is used for clipping a clip space triangle
+ *  against the near plane (z >= -w).  The other planes are
+ *  handled by clamping to the buffer during rasterization.
+ ***********************************************************/
+void HiZOcclusionCuller::AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	const glm::vec4 input[3] = { a, b, c };
+	glm::vec4 output[4];
+	int outputCount = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& current = input[i];
+		const glm::vec4& next = input[(i + 1) % 3];
+		float currentDistance = current.z + current.w;
+		float nextDistance = next.z + next.w;
+
+		if (currentDistance >= 0.0f)
+		{
+			output[outputCount++] = current;
+		}
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			float t = currentDistance / (currentDistance - nextDistance);
+			output[outputCount++] = current + (next - current) * t;
+		}
+	}
+
+	// the clipped polygon is a fan of one or two triangles
+	for (int i = 2; i < outputCount; i++)
+	{
+		AddScreenTriangle(output[0], output[i - 1], output[i]);
+	}
+}
+
+/***********************************************************
+ *  AddScreenTriangle()
+ *
+ *  This method is used for projecting a clipped triangle
+ *  into buffer coordinates and storing its bounding rows
+ *  and columns.
+ ***********************************************************/
+void HiZOcclusionCuller::AddScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	const glm::vec4* vertices[3] = { &a, &b, &c };
+	SCREEN_TRIANGLE triangle;
+
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& v = *vertices[i];
+		if (v.w <= 0.0f)
+		{
+			return;
+		}
+		float inverseW = 1.0f / v.w;
+		triangle.x[i] = (v.x * inverseW * 0.5f + 0.5f) * m_width;
+		triangle.y[i] = (v.y * inverseW * 0.5f + 0.5f) * m_height;
+		triangle.z[i] = v.z * inverseW * 0.5f + 0.5f;
+	}
+
+	// both windings are rasterized, so order the vertices
+	// to give a positive area and skip degenerate triangles
+	float area = EdgeFunction(
+		triangle.x[0], triangle.y[0],
+		triangle.x[1], triangle.y[1],
+		triangle.x[2], triangle.y[2]);
+	if (std::fabs(area) < 1e-6f)
+	{
+		return;
+	}
+	if (area < 0.0f)
+	{
+		std::swap(triangle.x[1], triangle.x[2]);
+		std::swap(triangle.y[1], triangle.y[2]);
+		std::swap(triangle.z[1], triangle.z[2]);
+	}
+
+	float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+	float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+	float minY = std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]));
+	float maxY = std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]));
+
+	// pixel centers are at +0.5, so only pixels whose center
+	// can be inside the triangle are visited
+	triangle.minX = std::max(0, (int)std::ceil(minX - 0.5f));
+	triangle.maxX = std::min(m_width - 1, (int)std::floor(maxX - 0.5f));
+	triangle.minY = std::max(0, (int)std::ceil(minY - 0.5f));
+	triangle.maxY = std::min(m_height - 1, (int)std::floor(maxY - 0.5f));
+
+	if ((triangle.minX <= triangle.maxX) && (triangle.minY <= triangle.maxY))
+	{
+		m_triangles.push_back(triangle);
+	}
+}
+
+/***********************************************************
+ *  RenderOccluders()
+ *
+ *  This method is used for rasterizing the occluders in
+ *  bands of rows across the jobs and then reducing the
+ *  depth buffer into the min/max hierarchy level by level.
+ ***********************************************************/
+void HiZOcclusionCuller::RenderOccluders()
+{
+	RunParallel((uint32_t)m_height, g_MinRowsPerTask, [this](uint32_t firstRow, uint32_t lastRow) {
+		RasterizeRows((int)firstRow, (int)lastRow);
+	});
+
+	// at full resolution the nearest and farthest depth match
+	m_levels[0].minDepth = m_levels[0].maxDepth;
+
+	for (int level = 1; level < (int)m_levels.size(); level++)
+	{
+		RunParallel((uint32_t)m_levels[level].height, g_MinRowsPerTask,
+			[this, level](uint32_t firstRow, uint32_t lastRow) {
+			ReduceRows(level, (int)firstRow, (int)lastRow);
+		});
+	}
+}
+
+/***********************************************************
+ *  RasterizeRows()
+ *
+ *  This method is used for rasterizing every occluder
+ *  triangle into the passed in band of rows, keeping the
+ *  nearest depth at each pixel center.
+ ***********************************************************/
+void HiZOcclusionCuller::RasterizeRows(int firstRow, int lastRow)
+{
+	std::vector<float>& depth = m_levels[0].maxDepth;
+
+	for (size_t t = 0; t < m_triangles.size(); t++)
+	{
+		const SCREEN_TRIANGLE& tri = m_triangles[t];
+		int minY = std::max(tri.minY, firstRow);
+		int maxY = std::min(tri.maxY, lastRow - 1);
+		if (minY > maxY)
+		{
+			continue;
+		}
+
+		float area = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+		float inverseArea = 1.0f / area;
+
+		// edge functions at the first pixel center and their
+		// steps along a row and down a column
+		float startX = tri.minX + 0.5f;
+		float startY = minY + 0.5f;
+		float w0Row = EdgeFunction(tri.x[1], tri.y[1], tri.x[2], tri.y[2], startX, startY);
+		float w1Row = EdgeFunction(tri.x[2], tri.y[2], tri.x[0], tri.y[0], startX, startY);
+		float w2Row = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], startX, startY);
+		float w0StepX = -(tri.y[2] - tri.y[1]);
+		float w1StepX = -(tri.y[0] - tri.y[2]);
+		float w2StepX = -(tri.y[1] - tri.y[0]);
+		float w0StepY = tri.x[2] - tri.x[1];
+		float w1StepY = tri.x[0] - tri.x[2];
+		float w2StepY = tri.x[1] - tri.x[0];
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float w0 = w0Row;
+			float w1 = w1Row;
+			float w2 = w2Row;
+			float* pRow = &depth[(size_t)y * m_width];
+
+			for (int x = tri.minX; x <= tri.maxX; x++)
+			{
+				if ((w0 >= 0.0f) && (w1 >= 0.0f) && (w2 >= 0.0f))
+				{
+					float z = (w0 * tri.z[0] + w1 * tri.z[1] + w2 * tri.z[2]) * inverseArea;
+					z = std::max(z, 0.0f);
+					if (z < pRow[x])
+					{
+						pRow[x] = z;
+					}
+				}
+				w0 += w0StepX;
+				w1 += w1StepX;
+				w2 += w2StepX;
+			}
+
+			w0Row += w0StepY;
+			w1Row += w1StepY;
+			w2Row += w2StepY;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReduceRows()
+ *
+ *  This method is used for building rows of a hierarchy
+ *  level from the 2x2 texels below each texel.
+ ***********************************************************/
+void HiZOcclusionCuller::ReduceRows(int level, int firstRow, int lastRow)
+{
+	const DEPTH_LEVEL& source = m_levels[level - 1];
+	DEPTH_LEVEL& target = m_levels[level];
+
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		int y0 = std::min(y * 2, source.height - 1);
+		int y1 = std::min(y * 2 + 1, source.height - 1);
+
+		for (int x = 0; x < target.width; x++)
+		{
+			int x0 = std::min(x * 2, source.width - 1);
+			int x1 = std::min(x * 2 + 1, source.width - 1);
+			size_t i00 = (size_t)y0 * source.width + x0;
+			size_t i01 = (size_t)y0 * source.width + x1;
+			size_t i10 = (size_t)y1 * source.width + x0;
+			size_t i11 = (size_t)y1 * source.width + x1;
+
+			target.minDepth[(size_t)y * target.width + x] = std::min(
+				std::min(source.minDepth[i00], source.minDepth[i01]),
+				std::min(source.minDepth[i10], source.minDepth[i11]));
+			target.maxDepth[(size_t)y * target.width + x] = std::max(
+				std::max(source.maxDepth[i00], source.maxDepth[i01]),
+				std::max(source.maxDepth[i10], source.maxDepth[i11]));
+		}
+	}
+}
+
+/***********************************************************
+ *  IsBoxVisible()
+ *
+ *  This method is used for testing a world space box.  The
+ *  box is projected to a buffer rectangle and its nearest
+ *  depth, which is compared against the hierarchy level
+ *  where the rectangle covers about two texels across.
+ ***********************************************************/
+bool HiZOcclusionCuller::IsBoxVisible(const glm::vec3& center, const glm::vec3& extents) const
+{
+	float minX = (float)m_width;
+	float minY = (float)m_height;
+	float maxX = 0.0f;
+	float maxY = 0.0f;
+	float nearestDepth = g_FarDepth;
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner(
+			center.x + ((i & 1) ? extents.x : -extents.x),
+			center.y + ((i & 2) ? extents.y : -extents.y),
+			center.z + ((i & 4) ? extents.z : -extents.z));
+		glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+
+		// boxes crossing the near plane are always visible
+		if ((clip.w <= 1e-5f) || (clip.z < -clip.w))
+		{
+			return(true);
+		}
+
+		float inverseW = 1.0f / clip.w;
+		float x = (clip.x * inverseW * 0.5f + 0.5f) * m_width;
+		float y = (clip.y * inverseW * 0.5f + 0.5f) * m_height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::min(nearestDepth, clip.z * inverseW * 0.5f + 0.5f);
+	}
+
+	int pixelMinX = std::max(0, (int)std::floor(minX));
+	int pixelMaxX = std::min(m_width - 1, (int)std::floor(maxX));
+	int pixelMinY = std::max(0, (int)std::floor(minY));
+	int pixelMaxY = std::min(m_height - 1, (int)std::floor(maxY));
+
+	// boxes off the buffer are left to the frustum test
+	if ((pixelMinX > pixelMaxX) || (pixelMinY > pixelMaxY))
+	{
+		return(true);
+	}
+
+	int size = std::max(pixelMaxX - pixelMinX + 1, pixelMaxY - pixelMinY + 1);
+	int level = 0;
+	while (((size >> level) > 2) && (level < (int)m_levels.size() - 1))
+	{
+		level++;
+	}
+
+	return(IsRegionVisible(level, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, nearestDepth));
+}
+
+/***********************************************************
+ *  IsRegionVisible()
+ *
+ *  This method is used for testing a rectangle, given in
+ *  full resolution pixels, against a hierarchy level.  A
+ *  texel whose farthest depth is in front of the box hides
+ *  it, a texel whose nearest depth is behind the box cannot
+ *  hide it, and any other texel is refined one level down.
+ ***********************************************************/
+bool HiZOcclusionCuller::IsRegionVisible(
+	int level,
+	int minX, int minY,
+	int maxX, int maxY,
+	float nearestDepth) const
+{
+	const DEPTH_LEVEL& depthLevel = m_levels[level];
+	int texelMinX = minX >> level;
+	int texelMaxX = std::min(maxX >> level, depthLevel.width - 1);
+	int texelMinY = minY >> level;
+	int texelMaxY = std::min(maxY >> level, depthLevel.height - 1);
+
+	for (int ty = texelMinY; ty <= texelMaxY; ty++)
+	{
+		for (int tx = texelMinX; tx <= texelMaxX; tx++)
+		{
+			size_t index = (size_t)ty * depthLevel.width + tx;
+
+			if (nearestDepth > depthLevel.maxDepth[index])
+			{
+				continue;
+			}
+			if ((level == 0) || (nearestDepth <= depthLevel.minDepth[index]))
+			{
+				return(true);
+			}
+
+			// the part of the rectangle under this texel
+			int childMinX = std::max(minX, tx << level);
+			int childMaxX = std::min(maxX, ((tx + 1) << level) - 1);
+			int childMinY = std::max(minY, ty << level);
+			int childMaxY = std::min(maxY, ((ty + 1) << level) - 1);
+			if (IsRegionVisible(level - 1, childMinX, childMinY, childMaxX, childMaxY, nearestDepth))
+			{
+				return(true);
+			}
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  CullBounds()
+ *
+ *  This method is used for testing the candidate objects'
+ *  bounds in parallel chunks and compacting the results.
+ ***********************************************************/
+size_t HiZOcclusionCuller::CullBounds(
+	const std::vector<uint32_t>& candidateIndices,
+	const FrustumCuller& bounds,
+	std::vector<uint32_t>& visibleIndices)
+{
+	int candidateCount = (int)candidateIndices.size();
+
+	m_visibleFlags.resize(candidateIndices.size());
+
+	RunParallel((uint32_t)candidateCount, g_CandidatesPerTask,
+		[this, &candidateIndices, &bounds](uint32_t first, uint32_t last) {
+		for (uint32_t i = first; i < last; i++)
+		{
+			glm::vec3 center;
+			glm::vec3 extents;
+			bounds.GetBounds(candidateIndices[i], center, extents);
+			m_visibleFlags[i] = IsBoxVisible(center, extents) ? 1 : 0;
+		}
+	});
+
+	visibleIndices.clear();
+	for (int i = 0; i < candidateCount; i++)
+	{
+		if (m_visibleFlags[i] != 0)
+		{
+			visibleIndices.push_back(candidateIndices[i]);
+		}
+	}
+
+	return(visibleIndices.size());
+}
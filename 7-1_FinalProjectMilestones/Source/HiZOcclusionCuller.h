@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// hizocclusionculler.h
+// ============
+// occlusion culling on the CPU - occluders are rasterized into a low
+// resolution depth buffer, which is reduced into a min/max depth hierarchy
+// that object bounds are tested against before they are submitted
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class FrustumCuller;
+
+/***********************************************************
+ *  HiZOcclusionCuller
+ *
+ *  This class contains a small software depth rasterizer
+ *  and the hierarchical depth buffer built from it.  The
+ *  rasterization, the hierarchy reduction and the object
+ *  tests are split into jobs across the threads of the
+ *  job system.
+ ***********************************************************/
+class HiZOcclusionCuller
+{
+public:
+	// constructor - the buffer size must be a power of two
+	// in each direction
+	HiZOcclusionCuller(int width = 256, int height = 128);
+	// destructor
+	~HiZOcclusionCuller();
+
+	// set the job system the work is split across, without
+	// one everything runs on the calling thread
+	void SetJobSystem(JobSystem* pJobSystem) { m_pJobSystem = pJobSystem; }
+
+	// clear the depth buffer and set the view projection
+	// that the occluders and the tested bounds are projected by
+	void BeginFrame(const glm::mat4& viewProjection);
+	// add the triangles of a local space box as an occluder
+	void AddBoxOccluder(
+		const glm::mat4& model,
+		const glm::vec3& localMin,
+		const glm::vec3& localMax);
+	// rasterize the added occluders and build the hierarchy
+	void RenderOccluders();
+
+	// test a world space box given as center and half extents,
+	// returns false only when the box is fully hidden
+	bool IsBoxVisible(const glm::vec3& center, const glm::vec3& extents) const;
+	// test the bounds of the candidate objects and write the
+	// indices of the ones that are not hidden, in input order
+	size_t CullBounds(
+		const std::vector<uint32_t>& candidateIndices,
+		const FrustumCuller& bounds,
+		std::vector<uint32_t>& visibleIndices);
+
+	// get the buffer size and the number of hierarchy levels
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	int GetLevelCount() const { return (int)m_levels.size(); }
+	// get the number of occluder triangles rasterized this frame
+	size_t GetTriangleCount() const { return m_triangles.size(); }
+
+private:
+	// occluder triangle projected into buffer coordinates,
+	// the depth is the normalized device depth in [0, 1]
+	struct SCREEN_TRIANGLE
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+		int minX, minY;
+		int maxX, maxY;
+	};
+
+	// one level of the depth hierarchy
+	struct DEPTH_LEVEL
+	{
+		int width;
+		int height;
+		// nearest and farthest depth of the covered pixels
+		std::vector<float> minDepth;
+		std::vector<float> maxDepth;
+	};
+
+	int m_width;
+	int m_height;
+	glm::mat4 m_viewProjection;
+	// projected occluder triangles of the current frame
+	std::vector<SCREEN_TRIANGLE> m_triangles;
+	// level 0 is the rasterized depth buffer
+	std::vector<DEPTH_LEVEL> m_levels;
+	// per candidate results of the parallel object tests
+	std::vector<uint8_t> m_visibleFlags;
+
+	// clip a clip space triangle against the near plane and
+	// add the resulting screen space triangles
+	void AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+	void AddScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+	// rasterize all the triangles into the rows [firstRow, lastRow)
+	void RasterizeRows(int firstRow, int lastRow);
+	// reduce rows of the level below into the passed in level
+	void ReduceRows(int level, int firstRow, int lastRow);
+	// test a buffer space rectangle against one hierarchy level,
+	// refining to the finer levels where the result is unclear
+	bool IsRegionVisible(
+		int level,
+		int minX, int minY,
+		int maxX, int maxY,
+		float nearestDepth) const;
+
+	// job system running the parallel work
+	JobSystem* m_pJobSystem;
+
+	// call function(first, last) for chunks of [0, count) of
+	// at least minChunkSize items across the job threads
+	template<typename FUNCTION>
+	void RunParallel(uint32_t count, uint32_t minChunkSize, const FUNCTION& function)
+	{
+		if (m_pJobSystem != NULL)
+		{
+			m_pJobSystem->ParallelFor(count, minChunkSize, function);
+		}
+		else if (count > 0)
+		{
+			function(0, count);
+		}
+	}
+};
@@ -0,0 +1,436 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// work stealing job system - every thread keeps its own job queue and idle
+// threads take work from the others, with parent / child completion
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include <cassert>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// jobs in the pool of each thread and the capacity of each
+	// queue, both powers of two
+	const uint32_t g_JobPoolSize = 1024;
+	const uint32_t g_QueueCapacity = 1024;
+	static_assert(JobSystem::MAX_PARALLEL_CHUNKS * 2 <= g_JobPoolSize, "parallel chunks do not fit the job pool");
+
+	// job system and queue index of the running thread, the
+	// thread that creates a system uses index 0 without them
+	// and registered threads set them until they unregister
+	thread_local const JobSystem* t_pJobSystem = NULL;
+	thread_local int t_workerIndex = 0;
+}
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(int threadCount)
+{
+	m_queuedCount = 0;
+	m_sleepingCount = 0;
+	m_bQuit = false;
+
+	if (threadCount <= 0)
+	{
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+
+	// every queue exists before any thread can steal from it,
+	// including the ones of the external slots
+	for (int i = 0; i < threadCount + MAX_EXTERNAL_THREADS; i++)
+	{
+		WORKER* pWorker = new WORKER();
+		pWorker->pQueue = new JOB*[g_QueueCapacity];
+		pWorker->queueFront = 0;
+		pWorker->queueSize = 0;
+		pWorker->pJobs = new JOB[g_JobPoolSize];
+		pWorker->nextJob = 0;
+		pWorker->owner = std::thread::id();
+		for (uint32_t j = 0; j < g_JobPoolSize; j++)
+		{
+			pWorker->pJobs[j].unfinishedCount = 0;
+			pWorker->pJobs[j].bSubmitted = false;
+		}
+		m_workers.push_back(pWorker);
+	}
+	m_workers[0]->owner = std::this_thread::get_id();
+
+	// the creating thread runs jobs while it waits, so one
+	// less thread is started
+	for (int i = 1; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_bQuit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		delete[] m_workers[i]->pQueue;
+		delete[] m_workers[i]->pJobs;
+		delete m_workers[i];
+	}
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  CreateJob()
+ *
+ *  This method is used for taking the next job from the
+ *  calling thread's pool.  The pool is reused in a ring, and
+ *  in the rare case that the next job is still running the
+ *  thread helps with the queued jobs until it is finished.
+ *  A job that was not submitted yet never finishes, so the
+ *  thread holding more than a pool of jobs is a bug.
+ ***********************************************************/
+JobSystem::JOB* JobSystem::CreateJob(
+	JOB_FUNCTION function,
+	void* pContext,
+	uint32_t first,
+	uint32_t last,
+	JOB* pParent)
+{
+	int workerIndex = GetWorkerIndex();
+	WORKER* pWorker = m_workers[workerIndex];
+
+	// the pool cursor is not atomic, so a second thread using
+	// the slot would hand out the same jobs twice
+	assert(pWorker->owner.load() == std::this_thread::get_id());
+	JOB* pJob = &pWorker->pJobs[pWorker->nextJob++ & (g_JobPoolSize - 1)];
+	assert((IsFinished(pJob) == true) || (pJob->bSubmitted == true));
+
+	while (IsFinished(pJob) == false)
+	{
+		if (RunOneJob(workerIndex) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	pJob->function = function;
+	pJob->pContext = pContext;
+	pJob->first = first;
+	pJob->last = last;
+	pJob->pParent = pParent;
+	pJob->bSubmitted = false;
+	pJob->unfinishedCount = 1;
+
+	if (pParent != NULL)
+	{
+		pParent->unfinishedCount++;
+	}
+
+	return(pJob);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queuing a created job on the
+ *  calling thread.
+ ***********************************************************/
+void JobSystem::Submit(JOB* pJob)
+{
+	pJob->bSubmitted = true;
+	Push(GetWorkerIndex(), pJob);
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used for running queued jobs on the
+ *  calling thread until the passed in job is finished, so
+ *  the waiting thread never sits idle.
+ ***********************************************************/
+void JobSystem::Wait(const JOB* pJob)
+{
+	int workerIndex = GetWorkerIndex();
+
+	while (IsFinished(pJob) == false)
+	{
+		if (RunOneJob(workerIndex) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  IsFinished()
+ *
+ *  This method is used for checking whether a job and all
+ *  its children have run.
+ ***********************************************************/
+bool JobSystem::IsFinished(const JOB* pJob)
+{
+	return(pJob->unfinishedCount.load() == 0);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running jobs on a worker thread
+ *  and sleeping while all the queues are empty.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int workerIndex)
+{
+	t_pJobSystem = this;
+	t_workerIndex = workerIndex;
+	m_workers[workerIndex]->owner = std::this_thread::get_id();
+
+	while (true)
+	{
+		if (RunOneJob(workerIndex) == true)
+		{
+			continue;
+		}
+
+		// a job pushed after the queued count was read wakes
+		// this thread, since the pusher checks the sleeping
+		// count after it raised the queued count
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingCount++;
+		m_wakeCondition.wait(lock, [this]() {
+			return (m_bQuit == true) || (m_queuedCount.load() > 0); });
+		m_sleepingCount--;
+		if (m_bQuit == true)
+		{
+			return;
+		}
+	}
+}
+
+/***********************************************************
+ *  RegisterThread()
+ *
+ *  This method is used for claiming a free external slot
+ *  for the calling thread.  The slots follow the ones of
+ *  the worker threads, which also steal from their queues.
+ ***********************************************************/
+bool JobSystem::RegisterThread()
+{
+	if (t_pJobSystem == this)
+	{
+		return(true);
+	}
+
+	for (int i = (int)m_threads.size() + 1; i < (int)m_workers.size(); i++)
+	{
+		std::thread::id noOwner;
+		if (m_workers[i]->owner.compare_exchange_strong(noOwner, std::this_thread::get_id()) == true)
+		{
+			t_pJobSystem = this;
+			t_workerIndex = i;
+			return(true);
+		}
+	}
+
+	std::cout << "ERROR: A job system cannot take more than " << MAX_EXTERNAL_THREADS
+		<< " registered threads" << std::endl;
+	return(false);
+}
+
+/***********************************************************
+ *  UnregisterThread()
+ *
+ *  This method is used for freeing the external slot of the
+ *  calling thread.  The jobs it created were waited for, so
+ *  its queue is empty and the next thread can take over its
+ *  pool.
+ ***********************************************************/
+void JobSystem::UnregisterThread()
+{
+	if ((t_pJobSystem != this) || (t_workerIndex <= (int)m_threads.size()))
+	{
+		return;
+	}
+
+	WORKER* pWorker = m_workers[t_workerIndex];
+	assert(pWorker->queueSize == 0);
+	pWorker->owner = std::thread::id();
+	t_pJobSystem = NULL;
+	t_workerIndex = 0;
+}
+
+/***********************************************************
+ *  GetWorkerIndex()
+ *
+ *  This method is used for getting the queue and pool of the
+ *  calling thread.  Threads that are not registered get the
+ *  index of the creator, which only they may use.
+ ***********************************************************/
+int JobSystem::GetWorkerIndex() const
+{
+	if (t_pJobSystem == this)
+	{
+		return(t_workerIndex);
+	}
+
+	assert(m_workers[0]->owner.load() == std::this_thread::get_id());
+	return(0);
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding a runnable job at the
+ *  back of a thread's queue and waking an idle thread.  A
+ *  job that does not fit into a full queue runs directly.
+ ***********************************************************/
+void JobSystem::Push(int workerIndex, JOB* pJob)
+{
+	WORKER* pWorker = m_workers[workerIndex];
+	bool bQueued = false;
+
+	{
+		std::lock_guard<std::mutex> lock(pWorker->queueMutex);
+		if (pWorker->queueSize < g_QueueCapacity)
+		{
+			pWorker->pQueue[(pWorker->queueFront + pWorker->queueSize) & (g_QueueCapacity - 1)] = pJob;
+			pWorker->queueSize++;
+			bQueued = true;
+		}
+	}
+
+	if (bQueued == false)
+	{
+		Execute(workerIndex, pJob);
+		return;
+	}
+
+	m_queuedCount++;
+	if (m_sleepingCount.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.notify_one();
+	}
+}
+
+/***********************************************************
+ *  Pop()
+ *
+ *  This method is used for taking the newest job of the
+ *  thread's own queue, which is likely still in its cache,
+ *  or else stealing the oldest job of another queue.
+ ***********************************************************/
+JobSystem::JOB* JobSystem::Pop(int workerIndex)
+{
+	JOB* pJob = NULL;
+	int workerCount = (int)m_workers.size();
+
+	if (m_queuedCount.load() == 0)
+	{
+		return(NULL);
+	}
+
+	{
+		WORKER* pWorker = m_workers[workerIndex];
+		std::lock_guard<std::mutex> lock(pWorker->queueMutex);
+		if (pWorker->queueSize > 0)
+		{
+			pWorker->queueSize--;
+			pJob = pWorker->pQueue[(pWorker->queueFront + pWorker->queueSize) & (g_QueueCapacity - 1)];
+		}
+	}
+
+	for (int i = 1; (pJob == NULL) && (i < workerCount); i++)
+	{
+		WORKER* pVictim = m_workers[(workerIndex + i) % workerCount];
+		std::lock_guard<std::mutex> lock(pVictim->queueMutex);
+		if (pVictim->queueSize > 0)
+		{
+			pJob = pVictim->pQueue[pVictim->queueFront];
+			pVictim->queueFront = (pVictim->queueFront + 1) & (g_QueueCapacity - 1);
+			pVictim->queueSize--;
+		}
+	}
+
+	if (pJob != NULL)
+	{
+		m_queuedCount--;
+	}
+	return(pJob);
+}
+
+/***********************************************************
+ *  RunOneJob()
+ *
+ *  This method is used for running one queued job on the
+ *  calling thread.
+ ***********************************************************/
+bool JobSystem::RunOneJob(int workerIndex)
+{
+	JOB* pJob = Pop(workerIndex);
+
+	if (pJob == NULL)
+	{
+		return(false);
+	}
+
+	Execute(workerIndex, pJob);
+	return(true);
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for calling the function of a job
+ *  and finishing it.
+ ***********************************************************/
+void JobSystem::Execute(int workerIndex, JOB* pJob)
+{
+	if (pJob->function != NULL)
+	{
+		pJob->function(pJob->pContext, pJob->first, pJob->last);
+	}
+	Finish(workerIndex, pJob);
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for counting down a job.  When the
+ *  job and all its children are done, the parent is counted
+ *  down in turn.  The parent is read first, since the job
+ *  can be reused as soon as it is finished.
+ ***********************************************************/
+void JobSystem::Finish(int workerIndex, JOB* pJob)
+{
+	JOB* pParent = pJob->pParent;
+
+	if (pJob->unfinishedCount.fetch_sub(1) != 1)
+	{
+		return;
+	}
+
+	if (pParent != NULL)
+	{
+		Finish(workerIndex, pParent);
+	}
+}
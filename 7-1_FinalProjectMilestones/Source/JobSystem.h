@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// work stealing job system - every thread keeps its own job queue and idle
+// threads take work from the others, with parent / child completion
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class contains a set of worker threads and one job
+ *  queue per thread, including the thread that created the
+ *  system.  A thread pushes and pops its own jobs at the
+ *  back of its queue and steals from the front of the other
+ *  queues when its own is empty.  Jobs are taken from fixed
+ *  pools, so running jobs does not allocate memory.  Other
+ *  threads, like the update thread of a frame pipeline, get
+ *  a queue and pool of their own by registering.  The jobs
+ *  must not make OpenGL calls, which stay on the thread
+ *  that owns the context.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// constructor - a thread count of 0 uses all the cores,
+	// the creating thread counts as one of the threads
+	JobSystem(int threadCount = 0);
+	// destructor
+	~JobSystem();
+
+	// function run by a job for the range [first, last)
+	typedef void (*JOB_FUNCTION)(void* pContext, uint32_t first, uint32_t last);
+
+	// most chunks of one ParallelFor(), well below the job pool
+	// of a thread, so the pool never wraps onto its root job
+	static const uint32_t MAX_PARALLEL_CHUNKS = 512;
+	// most threads outside the system that can be registered
+	// at the same time
+	static const int MAX_EXTERNAL_THREADS = 2;
+
+	// one unit of work, the callers only keep pointers to it
+	struct JOB
+	{
+		JOB_FUNCTION function;
+		void* pContext;
+		uint32_t first;
+		uint32_t last;
+		// job that is only finished after this one is
+		JOB* pParent;
+		// this job plus its unfinished children
+		std::atomic<int> unfinishedCount;
+		// whether the creating thread submitted the job yet
+		bool bSubmitted;
+	};
+
+	// create a job that runs once it is submitted, and that
+	// keeps the parent from finishing until it is - a NULL
+	// function only waits
+	JOB* CreateJob(
+		JOB_FUNCTION function,
+		void* pContext,
+		uint32_t first = 0,
+		uint32_t last = 0,
+		JOB* pParent = NULL);
+	// queue a created job on the calling thread
+	void Submit(JOB* pJob);
+	// run queued jobs on the calling thread until the job and
+	// all its children are finished
+	void Wait(const JOB* pJob);
+	// check whether a job and all its children are finished
+	static bool IsFinished(const JOB* pJob);
+
+	// give the calling thread, which is neither the creator
+	// nor a worker, its own queue and job pool, so it can run
+	// jobs at the same time as the creator - false when every
+	// external slot is taken
+	bool RegisterThread();
+	// give the slot of a registered thread back, once all the
+	// jobs it created are finished
+	void UnregisterThread();
+
+	// number of threads running jobs, including the creator
+	int GetThreadCount() const { return (int)m_threads.size() + 1; }
+	// number of queues including the external slots, the size
+	// of data kept per worker index
+	int GetSlotCount() const { return (int)m_workers.size(); }
+	// index of the calling thread, below the slot count - the
+	// creator has index 0 and other threads have to register
+	int GetWorkerIndex() const;
+
+	// call function(first, last) for chunks of [0, count) across
+	// the threads and wait for all of them - the chunks hold at
+	// least minChunkSize items, and a range that is too small to
+	// split runs directly on the calling thread - the function
+	// must not call ParallelFor() itself, since a waiting thread
+	// can take on so many chunks that its pool wraps
+	template<typename FUNCTION>
+	void ParallelFor(uint32_t count, uint32_t minChunkSize, const FUNCTION& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// a few chunks per thread so the stealing can even out
+		// chunks that take longer than the others, but never
+		// more chunks than the pool of the thread can hold
+		uint32_t threadCount = (uint32_t)GetThreadCount();
+		uint32_t chunkCount = std::min(threadCount * 4, (uint32_t)MAX_PARALLEL_CHUNKS);
+		uint32_t chunkSize = std::max(std::max(minChunkSize, 1u),
+			(count + chunkCount - 1) / chunkCount);
+		if ((threadCount == 1) || (chunkSize >= count))
+		{
+			function(0, count);
+			return;
+		}
+
+		JOB* pRoot = CreateJob(NULL, NULL);
+		for (uint32_t first = 0; first < count; first += chunkSize)
+		{
+			JOB* pChunk = CreateJob(&RunChunk<FUNCTION>, (void*)&function,
+				first, std::min(count, first + chunkSize), pRoot);
+			Submit(pChunk);
+		}
+		Submit(pRoot);
+		Wait(pRoot);
+	}
+
+private:
+	// job queue and job pool of one thread
+	struct WORKER
+	{
+		std::mutex queueMutex;
+		// circular queue, the owner uses the back and the
+		// other threads steal from the front
+		JOB** pQueue;
+		uint32_t queueFront;
+		uint32_t queueSize;
+		// jobs created by the thread, reused in a ring
+		JOB* pJobs;
+		uint32_t nextJob;
+		// the only thread that may create jobs from the pool,
+		// none while an external slot is free
+		std::atomic<std::thread::id> owner;
+	};
+
+	// index 0 belongs to the thread that created the system,
+	// the worker threads follow, then the external slots
+	std::vector<WORKER*> m_workers;
+	std::vector<std::thread> m_threads;
+	// queued jobs in all the queues
+	std::atomic<int> m_queuedCount;
+	// idle threads waiting for jobs
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+	std::atomic<int> m_sleepingCount;
+	bool m_bQuit;
+
+	// loop of each worker thread
+	void WorkerLoop(int workerIndex);
+	// add a runnable job to the queue of a thread
+	void Push(int workerIndex, JOB* pJob);
+	// take a job from the thread's own queue or steal one
+	JOB* Pop(int workerIndex);
+	// run one queued job, returns false when there was none
+	bool RunOneJob(int workerIndex);
+	// run a job and finish it
+	void Execute(int workerIndex, JOB* pJob);
+	// count a job or one of its children as finished
+	void Finish(int workerIndex, JOB* pJob);
+
+	// job function running one chunk of a ParallelFor()
+	template<typename FUNCTION>
+	static void RunChunk(void* pContext, uint32_t first, uint32_t last)
+	{
+		(*(const FUNCTION*)pContext)(first, last);
+	}
+};
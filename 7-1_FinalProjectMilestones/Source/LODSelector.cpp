@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+// lodselector.cpp
+// ============
+// per object level of detail selection from the projected screen size, with
+// hysteresis so objects near a threshold do not switch levels every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LODSelector.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  LODSelector()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LODSelector::LODSelector()
+{
+	m_hysteresis = 0.2f;
+}
+
+/***********************************************************
+ *  ~LODSelector()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LODSelector::~LODSelector()
+{
+}
+
+/***********************************************************
+ *  SetThresholds()
+ *
+ *  This method is used for setting the screen sizes where
+ *  the levels change.  Objects already past the new last
+ *  level are moved to it.
+ ***********************************************************/
+void LODSelector::SetThresholds(const std::vector<float>& minScreenSizes)
+{
+	m_thresholds = minScreenSizes;
+
+	uint8_t lastLevel = (uint8_t)m_thresholds.size();
+	for (size_t i = 0; i < m_objectLevels.size(); i++)
+	{
+		m_objectLevels[i] = std::min(m_objectLevels[i], lastLevel);
+	}
+}
+
+/***********************************************************
+ *  SetHysteresis()
+ *
+ *  This method is used for setting the fraction of a
+ *  threshold that a size must pass it by to change level.
+ ***********************************************************/
+void LODSelector::SetHysteresis(float fraction)
+{
+	m_hysteresis = std::max(0.0f, std::min(fraction, 0.9f));
+}
+
+/***********************************************************
+ *  SetObjectCount()
+ *
+ *  This method is used for sizing the per object levels.
+ ***********************************************************/
+void LODSelector::SetObjectCount(size_t objectCount)
+{
+	m_objectLevels.assign(objectCount, 0);
+}
+
+/***********************************************************
+ *  SelectLevel()
+ *
+ *  This method is used for moving an object to a finer
+ *  level while it is clearly larger than the threshold
+ *  above its level, or to a coarser one while it is clearly
+ *  smaller than the threshold of its level.
+ ***********************************************************/
+int LODSelector::SelectLevel(uint32_t objectIndex, float screenSize)
+{
+	if (objectIndex >= m_objectLevels.size())
+	{
+		return(0);
+	}
+
+	int level = m_objectLevels[objectIndex];
+	int lastLevel = (int)m_thresholds.size();
+
+	while ((level > 0) && (screenSize >= m_thresholds[level - 1] * (1.0f + m_hysteresis)))
+	{
+		level--;
+	}
+	while ((level < lastLevel) && (screenSize < m_thresholds[level] * (1.0f - m_hysteresis)))
+	{
+		level++;
+	}
+
+	m_objectLevels[objectIndex] = (uint8_t)level;
+	return(level);
+}
+
+/***********************************************************
+ *  GetScreenSize()
+ *
+ *  This method is used for projecting the diameter of a
+ *  bounding sphere.  Row 1 of the projection scales view
+ *  space height into normalized device height, which is 2
+ *  across the viewport, and a perspective projection also
+ *  divides it by the view depth.
+ ***********************************************************/
+float LODSelector::GetScreenSize(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& center,
+	float radius)
+{
+	float depth = -(view * glm::vec4(center, 1.0f)).z;
+	float scale = projection[1][1];
+
+	// an orthographic projection has no perspective divide
+	if (projection[3][3] != 0.0f)
+	{
+		return(radius * scale);
+	}
+
+	if (depth <= radius)
+	{
+		return(2.0f);
+	}
+	return(radius * scale / depth);
+}
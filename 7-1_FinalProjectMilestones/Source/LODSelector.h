@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// lodselector.h
+// ============
+// per object level of detail selection from the projected screen size, with
+// hysteresis so objects near a threshold do not switch levels every frame
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  LODSelector
+ *
+ *  This class keeps the current level of every object.  The
+ *  screen size is the projected diameter of the object's
+ *  bounding sphere as a fraction of the viewport height.
+ *  Level i is used down to the i-th threshold, and an
+ *  object only moves to another level once its size is past
+ *  the threshold by the hysteresis fraction.
+ ***********************************************************/
+class LODSelector
+{
+public:
+	// constructor
+	LODSelector();
+	// destructor
+	~LODSelector();
+
+	// set the smallest screen size of each level except the
+	// last, from the finest level to the coarsest
+	void SetThresholds(const std::vector<float>& minScreenSizes);
+	// set the fraction a size must pass a threshold by
+	void SetHysteresis(float fraction);
+	// set the number of objects, all starting at level 0
+	void SetObjectCount(size_t objectCount);
+
+	// pick the level of an object from its screen size
+	int SelectLevel(uint32_t objectIndex, float screenSize);
+	// get the number of levels the thresholds describe
+	int GetLevelCount() const { return (int)m_thresholds.size() + 1; }
+	// get the thresholds passed to SetThresholds()
+	const std::vector<float>& GetThresholds() const { return m_thresholds; }
+
+	// get the screen size of a world space bounding sphere,
+	// which is above 1 when the camera is inside the sphere
+	static float GetScreenSize(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& center,
+		float radius);
+
+private:
+	std::vector<float> m_thresholds;
+	float m_hysteresis;
+	// current level of every object
+	std::vector<uint8_t> m_objectLevels;
+};
@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////
+// maincode.cpp
+// ============
+// gets called when application is launched - initializes GLEW, GLFW
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "AllocationTracker.h"
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+
+	// frames after the start and after a render setting changed
+	// that may allocate, while the buffers grow to their size
+	const int ALLOCATION_WARMUP_FRAMES = 120;
+
+	// measurements of one frame rendered without a window
+	struct FRAME_METRICS
+	{
+		// time until the frame was submitted, and until it
+		// was finished rendering
+		double cpuMilliseconds;
+		double frameMilliseconds;
+		uint32_t drawCalls;
+		uint32_t stateChanges;
+		uint32_t commandCount;
+		uint64_t allocations;
+	};
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+int GetRenderSettingsKey();
+bool WriteFrameMetrics(const std::string& outputDirectory, const std::vector<FRAME_METRICS>& frames);
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int exitCode = EXIT_SUCCESS;
+
+	// with --check-allocations <frames> the application closes
+	// after that many frames and fails when a frame past the
+	// warm up allocated, in builds with TRACK_ALLOCATIONS
+	int checkFrames = 0;
+	// with --scene <file> another text or compiled scene file
+	// is loaded instead of the patio scene
+	const char* sceneFile = NULL;
+	// with --preload-assets every texture and mesh is loaded
+	// before the first frame instead of when it is first drawn
+	bool bPreloadAssets = false;
+	// with --headless <frames> that many frames are rendered
+	// offscreen without a window, or the whole camera path
+	// when 0 frames are passed
+	bool bHeadless = false;
+	int headlessFrames = 0;
+	// with --camera-path <file> the camera follows the keys
+	// of the file instead of the input
+	const char* cameraPathFile = NULL;
+	// with --output <directory> the images and the metrics of
+	// a headless run are written there instead of to the
+	// working directory, which has to exist
+	std::string outputDirectory = ".";
+	// with --capture-every <frames> every that many headless
+	// frames are saved as images, otherwise only the last one
+	int captureInterval = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--check-allocations") == 0) && (i + 1 < argc))
+		{
+			checkFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--scene") == 0) && (i + 1 < argc))
+		{
+			sceneFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--preload-assets") == 0)
+		{
+			bPreloadAssets = true;
+		}
+		else if ((strcmp(argv[i], "--headless") == 0) && (i + 1 < argc))
+		{
+			bHeadless = true;
+			headlessFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--camera-path") == 0) && (i + 1 < argc))
+		{
+			cameraPathFile = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputDirectory = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--capture-every") == 0) && (i + 1 < argc))
+		{
+			captureInterval = atoi(argv[++i]);
+		}
+	}
+	AllocationTracker::Initialize();
+
+	CameraPath cameraPath;
+	if ((cameraPathFile != NULL) && (cameraPath.Load(cameraPathFile) == false))
+	{
+		return(EXIT_FAILURE);
+	}
+	if ((bHeadless == true) && (headlessFrames <= 0))
+	{
+		headlessFrames = cameraPath.GetLastFrame() + 1;
+	}
+
+	// an EGL context needs no GLFW, which cannot be initialized
+	// on nodes without a display
+	bool bUseGLFW = true;
+#ifdef HEADLESS_EGL
+	bUseGLFW = (bHeadless == false);
+#endif
+
+	// if GLFW fails initialization, then terminate the application
+	if ((bUseGLFW == true) && (InitializeGLFW() == false))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// try to create a new shader manager object
+	g_ShaderManager = new ShaderManager();
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderManager);
+
+	// try to create the main display window, or the offscreen
+	// context without one
+	if (bHeadless == true)
+	{
+		if (g_ViewManager->CreateOffscreenView() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+	}
+	else
+	{
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	}
+
+	// if GLEW fails initialization, then terminate the application
+	if (InitializeGLEW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	if ((bHeadless == true) && (g_ViewManager->CreateOffscreenTarget() == false))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// load the shader code from the external GLSL files
+	g_ShaderManager->LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+	g_ShaderManager->use();
+
+	// try to create a new scene manager object and prepare the 3D scene
+	g_SceneManager = new SceneManager(g_ShaderManager);
+	if (sceneFile != NULL)
+	{
+		g_SceneManager->SetSceneFile(sceneFile);
+	}
+	// loading assets that come into view would count as steady
+	// state allocations, so they are loaded up front for the check,
+	// and a headless run renders the same images every time
+	g_SceneManager->SetPreloadAssets((bPreloadAssets == true) || (checkFrames > 0) || (bHeadless == true));
+	g_SceneManager->PrepareScene();
+
+	int frameNumber = 0;
+	int warmupFrames = ALLOCATION_WARMUP_FRAMES;
+	int renderSettings = GetRenderSettingsKey();
+	uint64_t steadyAllocations = 0;
+	uint64_t reportedAllocations = 0;
+	std::vector<FRAME_METRICS> frameMetrics;
+	if (bHeadless == true)
+	{
+		frameMetrics.reserve(std::max(headlessFrames, 0));
+	}
+	bool bRunning = (bHeadless == false) || (headlessFrames > 0);
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (bRunning == true)
+	{
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+		// the allocations of the frame are counted from the events
+		// until the frame is handed to the swap chain
+		AllocationTracker::BeginFrame();
+
+		// Enable z-depth
+		glEnable(GL_DEPTH_TEST);
+
+		// Clear the frame and z buffers
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// convert from 3D object space to 2D view
+		if (cameraPath.IsEmpty() == false)
+		{
+			glm::vec3 position;
+			glm::vec3 front;
+			cameraPath.GetPose(frameNumber, position, front);
+			g_ViewManager->SetCameraPose(position, front);
+		}
+		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetViewTransforms(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix());
+		g_SceneManager->SetOcclusionQueries(
+			g_ViewManager->IsOcclusionQueriesEnabled());
+		g_SceneManager->SetSoftwareOcclusion(
+			g_ViewManager->IsSoftwareOcclusionEnabled());
+		g_SceneManager->SetMeshLOD(
+			g_ViewManager->IsMeshLODEnabled());
+		g_SceneManager->SetMultiDrawIndirect(
+			g_ViewManager->IsMultiDrawEnabled());
+		g_SceneManager->SetGpuCulling(
+			g_ViewManager->IsGpuCullingEnabled());
+		g_SceneManager->SetFrameQueueDepth(
+			g_ViewManager->GetFrameQueueDepth());
+
+		// refresh the 3D scene
+		g_SceneManager->RenderScene();
+
+		std::chrono::steady_clock::time_point submitEnd = std::chrono::steady_clock::now();
+		if (bHeadless == true)
+		{
+			g_ViewManager->FinishOffscreenFrame();
+		}
+		std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+
+		AllocationTracker::FRAME_ALLOCATIONS allocations = AllocationTracker::EndFrame();
+		if (GetRenderSettingsKey() != renderSettings)
+		{
+			renderSettings = GetRenderSettingsKey();
+			warmupFrames = ALLOCATION_WARMUP_FRAMES;
+		}
+		if (warmupFrames > 0)
+		{
+			warmupFrames--;
+		}
+		else if (allocations.count > 0)
+		{
+			// report the frame whenever the count changes, with the
+			// call stacks that were not reported yet
+			steadyAllocations += allocations.count;
+			if (allocations.count != reportedAllocations)
+			{
+				reportedAllocations = allocations.count;
+				std::cout << "WARNING: Frame " << frameNumber << " made " << allocations.count
+					<< " heap allocations (" << allocations.bytes << " bytes) in steady state" << std::endl;
+			}
+			AllocationTracker::ReportCallStacks();
+		}
+
+		if (bHeadless == true)
+		{
+			const RenderCommandBuffer::REPLAY_STATS& stats = g_SceneManager->GetReplayStats();
+			FRAME_METRICS metrics;
+			metrics.cpuMilliseconds = std::chrono::duration<double, std::milli>(submitEnd - frameStart).count();
+			metrics.frameMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+			metrics.drawCalls = stats.drawCalls;
+			metrics.stateChanges = stats.stateChanges;
+			metrics.commandCount = stats.commandCount;
+			metrics.allocations = allocations.count;
+			frameMetrics.push_back(metrics);
+
+			// images are saved after the frame was measured
+			bool bLastFrame = (frameNumber + 1 >= headlessFrames);
+			if ((bLastFrame == true) || ((captureInterval > 0) && ((frameNumber % captureInterval) == 0)))
+			{
+				char imageName[64];
+				snprintf(imageName, sizeof(imageName), "/frame_%05d.ppm", frameNumber);
+				if (g_ViewManager->SaveOffscreenImage((outputDirectory + imageName).c_str()) == false)
+				{
+					exitCode = EXIT_FAILURE;
+				}
+			}
+		}
+
+		frameNumber++;
+		if (bHeadless == true)
+		{
+			bRunning = (frameNumber < headlessFrames) && ((checkFrames <= 0) || (frameNumber < checkFrames));
+		}
+		else
+		{
+			if ((checkFrames > 0) && (frameNumber >= checkFrames))
+			{
+				glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+			}
+
+			// Flips the the back buffer with the front buffer every frame.
+			glfwSwapBuffers(g_Window);
+
+			// query the latest GLFW events
+			glfwPollEvents();
+
+			bRunning = !glfwWindowShouldClose(g_Window);
+		}
+	}
+
+	if ((bHeadless == true) && (WriteFrameMetrics(outputDirectory, frameMetrics) == false))
+	{
+		exitCode = EXIT_FAILURE;
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	if (checkFrames > 0)
+	{
+		if (AllocationTracker::IsEnabled() == false)
+		{
+			std::cout << "WARNING: Allocations are only checked in builds with TRACK_ALLOCATIONS" << std::endl;
+		}
+		else if (steadyAllocations > 0)
+		{
+			std::cout << "ERROR: " << steadyAllocations << " heap allocations in steady state frames" << std::endl;
+			exitCode = EXIT_FAILURE;
+		}
+		else
+		{
+			std::cout << "INFO: No heap allocations in steady state frames" << std::endl;
+		}
+	}
+
+	// Terminates the program successfully
+	exit(exitCode); 
+}
+
+/***********************************************************
+ *	GetRenderSettingsKey()
+ *
+ *  This function is used to combine the render toggles into
+ *  one value, which changes whenever one of them does.
+ ***********************************************************/
+int GetRenderSettingsKey()
+{
+	int key = g_ViewManager->GetFrameQueueDepth();
+	key = (key << 1) | (g_ViewManager->IsOcclusionQueriesEnabled() ? 1 : 0);
+	key = (key << 1) | (g_ViewManager->IsSoftwareOcclusionEnabled() ? 1 : 0);
+	key = (key << 1) | (g_ViewManager->IsMeshLODEnabled() ? 1 : 0);
+	key = (key << 1) | (g_ViewManager->IsMultiDrawEnabled() ? 1 : 0);
+	key = (key << 1) | (g_ViewManager->IsGpuCullingEnabled() ? 1 : 0);
+	return(key);
+}
+
+/***********************************************************
+ *	WriteFrameMetrics()
+ *
+ *  This function is used to write the measurements of the
+ *  headless frames as comma separated values, one frame per
+ *  line, and to report their average and 95th percentile.
+ ***********************************************************/
+bool WriteFrameMetrics(const std::string& outputDirectory, const std::vector<FRAME_METRICS>& frames)
+{
+	std::string filename = outputDirectory + "/frames.csv";
+	std::ofstream file(filename.c_str(), std::ios::trunc);
+	file << "frame,cpu_ms,frame_ms,draw_calls,state_changes,commands,allocations\n";
+
+	std::vector<double> frameTimes;
+	double totalTime = 0.0;
+	for (size_t i = 0; i < frames.size(); i++)
+	{
+		const FRAME_METRICS& metrics = frames[i];
+		file << i << "," << metrics.cpuMilliseconds << "," << metrics.frameMilliseconds << ","
+			<< metrics.drawCalls << "," << metrics.stateChanges << "," << metrics.commandCount << ","
+			<< metrics.allocations << "\n";
+		frameTimes.push_back(metrics.frameMilliseconds);
+		totalTime += metrics.frameMilliseconds;
+	}
+
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write frame metrics " << filename << std::endl;
+		return(false);
+	}
+
+	if (frameTimes.empty() == false)
+	{
+		// nearest rank percentile
+		std::sort(frameTimes.begin(), frameTimes.end());
+		size_t percentileIndex = (frameTimes.size() * 95 + 99) / 100 - 1;
+		std::cout << "INFO: Rendered " << frames.size() << " frames offscreen, "
+			<< (totalTime / frames.size()) << " ms average, "
+			<< frameTimes[percentileIndex]
+			<< " ms 95th percentile" << std::endl;
+	}
+	std::cout << "INFO: Wrote frame metrics to " << filename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+	// set the version of OpenGL and profile to use - the
+	// shaders need OpenGL 4.5, which macOS does not have
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if defined(__linux__)
+	// GLEW is built for EGL on Linux for the headless context,
+	// so the window's context has to be an EGL context as well
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
+}
\ No newline at end of file
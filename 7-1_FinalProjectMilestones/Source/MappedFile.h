@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// read only memory mapping of a whole file, so its contents can be used in
+// place without being read into a buffer first
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a file into the address space of the
+ *  process for reading.  The pages are loaded by the OS on
+ *  first access and shared with every other process that
+ *  maps the same file.  The mapping starts on a page, so
+ *  data laid out with its alignment in the file keeps it.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the whole file, false when it is missing or empty
+	bool Open(const char* filename);
+	// unmap the file, the data pointer is no longer valid
+	void Close();
+
+	bool IsOpen() const { return m_pData != NULL; }
+	const uint8_t* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	const uint8_t* m_pData;
+	size_t m_size;
+#if defined(_WIN32)
+	// handles of the file and of its mapping object
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+
+	// a mapping has one owner
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
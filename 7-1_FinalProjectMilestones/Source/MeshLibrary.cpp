@@ -0,0 +1,679 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.cpp
+// ============
+// generated shape meshes with several tessellation levels per shape, so that
+// small or distant objects can be drawn with fewer triangles, stored either
+// as full floats or in a packed 16 byte vertex format, all in one shared pool
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshLibrary.h"
+#include "MeshOptimizer.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// segments around the finest level of every shape
+	const int g_FinestSegmentCount = 64;
+	const float g_Pi = 3.14159265358979f;
+	// shape names for the load report
+	const char* g_ShapeNames[MeshLibrary::LOD_SHAPE_COUNT] = { "cylinder", "sphere", "cone" };
+	const char* g_FixedShapeNames[MeshLibrary::FIXED_SHAPE_COUNT] = { "box", "plane" };
+	// range returned for shapes outside the pool
+	const MeshLibrary::MESH_RANGE g_EmptyRange = { 0, 0, 0 };
+}
+
+/***********************************************************
+ *  MeshLibrary()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshLibrary::MeshLibrary()
+{
+	m_vao = 0;
+	m_vbo = 0;
+	m_ibo = 0;
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+	m_vertexBytes = 0;
+
+	for (int shape = 0; shape < LOD_SHAPE_COUNT; shape++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+		{
+			m_lodRanges[shape][level] = g_EmptyRange;
+		}
+	}
+	for (int shape = 0; shape < FIXED_SHAPE_COUNT; shape++)
+	{
+		m_fixedRanges[shape] = g_EmptyRange;
+	}
+}
+
+/***********************************************************
+ *  ~MeshLibrary()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshLibrary::~MeshLibrary()
+{
+	DestroyMeshes();
+}
+
+/***********************************************************
+ *  LoadLODMeshes()
+ *
+ *  This method is used for generating every shape at every
+ *  tessellation level and the fixed shapes, optimizing the
+ *  triangle and vertex order of each one once, and
+ *  uploading all of them to the GPU as one pool.
+ ***********************************************************/
+void MeshLibrary::LoadLODMeshes(VERTEX_FORMAT format)
+{
+	MESH_DATA pool;
+	MESH_RANGE ranges[POOL_RANGE_COUNT];
+
+	BuildMeshPool(pool, ranges);
+
+	if (format == VERTEX_FORMAT_PACKED)
+	{
+		std::vector<PACKED_VERTEX> packedVertices;
+		PackVertices(pool.vertices, packedVertices);
+		LoadMeshPool(format, packedVertices.data(), packedVertices.size() * sizeof(PACKED_VERTEX),
+			pool.indices.data(), pool.indices.size(), ranges);
+	}
+	else
+	{
+		LoadMeshPool(format, pool.vertices.data(), pool.vertices.size() * sizeof(MESH_VERTEX),
+			pool.indices.data(), pool.indices.size(), ranges);
+	}
+}
+
+/***********************************************************
+ *  LoadMeshPool()
+ *
+ *  This method is used for uploading pool data that was
+ *  built ahead of time, such as the pool of an asset pack,
+ *  with the vertices already in the passed in format and
+ *  the ranges in the order BuildMeshPool() gives them.
+ ***********************************************************/
+void MeshLibrary::LoadMeshPool(
+	VERTEX_FORMAT format,
+	const void* pVertices,
+	size_t vertexBytes,
+	const uint32_t* pIndices,
+	size_t indexCount,
+	const MESH_RANGE ranges[POOL_RANGE_COUNT])
+{
+	DestroyMeshes();
+	m_vertexFormat = format;
+
+	for (int shape = 0; shape < LOD_SHAPE_COUNT; shape++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+		{
+			m_lodRanges[shape][level] = ranges[shape * LOD_LEVEL_COUNT + level];
+		}
+	}
+	for (int shape = 0; shape < FIXED_SHAPE_COUNT; shape++)
+	{
+		m_fixedRanges[shape] = ranges[LOD_SHAPE_COUNT * LOD_LEVEL_COUNT + shape];
+	}
+
+	UploadPool(pVertices, vertexBytes, pIndices, indexCount);
+
+	std::cout << "INFO: Mesh pool uses " << m_vertexBytes / 1024 << " KB of "
+		<< ((format == VERTEX_FORMAT_PACKED) ? "packed" : "float") << " vertices and "
+		<< indexCount * sizeof(uint32_t) / 1024 << " KB of indices" << std::endl;
+}
+
+/***********************************************************
+ *  BuildMeshPool()
+ *
+ *  This method is used for generating and optimizing every
+ *  shape level and fixed shape into one set of pool data,
+ *  without touching the GPU.  The ranges are the levels of
+ *  each shape in turn, followed by the fixed shapes.
+ ***********************************************************/
+void MeshLibrary::BuildMeshPool(MESH_DATA& pool, MESH_RANGE ranges[POOL_RANGE_COUNT])
+{
+	MESH_DATA data;
+
+	pool.vertices.clear();
+	pool.indices.clear();
+
+	for (int shape = 0; shape < LOD_SHAPE_COUNT; shape++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+		{
+			BuildShape((LOD_SHAPE)shape, level, data);
+			std::string name = std::string(g_ShapeNames[shape]) + " level " + std::to_string(level);
+			AddToPool(name.c_str(), data, ranges[shape * LOD_LEVEL_COUNT + level], pool);
+		}
+	}
+	for (int shape = 0; shape < FIXED_SHAPE_COUNT; shape++)
+	{
+		BuildFixedShape((FIXED_SHAPE)shape, data);
+		AddToPool(g_FixedShapeNames[shape], data, ranges[LOD_SHAPE_COUNT * LOD_LEVEL_COUNT + shape], pool);
+	}
+}
+
+/***********************************************************
+ *  DestroyMeshes()
+ *
+ *  This method is used for freeing the vertex array and the
+ *  buffers of the pool.
+ ***********************************************************/
+void MeshLibrary::DestroyMeshes()
+{
+	if (m_vao != 0)
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ibo);
+	}
+	m_vao = 0;
+	m_vbo = 0;
+	m_ibo = 0;
+
+	for (int shape = 0; shape < LOD_SHAPE_COUNT; shape++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT; level++)
+		{
+			m_lodRanges[shape][level] = g_EmptyRange;
+		}
+	}
+	for (int shape = 0; shape < FIXED_SHAPE_COUNT; shape++)
+	{
+		m_fixedRanges[shape] = g_EmptyRange;
+	}
+	m_vertexBytes = 0;
+}
+
+/***********************************************************
+ *  DrawLODMesh()
+ *
+ *  This method is used for drawing a shape at the passed in
+ *  tessellation level from its range of the pool.
+ ***********************************************************/
+void MeshLibrary::DrawLODMesh(LOD_SHAPE shape, int level) const
+{
+	const MESH_RANGE& range = GetMeshRange(shape, level);
+	if ((m_vao == 0) || (range.indexCount == 0))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_vao);
+	glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT,
+		(void*)(range.firstIndex * sizeof(uint32_t)), range.baseVertex);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method is used for getting the number of triangles
+ *  of a loaded shape level.
+ ***********************************************************/
+int MeshLibrary::GetTriangleCount(LOD_SHAPE shape, int level) const
+{
+	return((int)(GetMeshRange(shape, level).indexCount / 3));
+}
+
+/***********************************************************
+ *  GetMeshRange()
+ *
+ *  This method is used for getting where a shape level is
+ *  stored in the pool.  Shapes outside the pool get an
+ *  empty range.
+ ***********************************************************/
+const MeshLibrary::MESH_RANGE& MeshLibrary::GetMeshRange(LOD_SHAPE shape, int level) const
+{
+	if ((shape < 0) || (shape >= LOD_SHAPE_COUNT) ||
+		(level < 0) || (level >= LOD_LEVEL_COUNT))
+	{
+		return(g_EmptyRange);
+	}
+	return(m_lodRanges[shape][level]);
+}
+
+/***********************************************************
+ *  GetMeshRange()
+ *
+ *  This method is used for getting where a fixed shape is
+ *  stored in the pool.
+ ***********************************************************/
+const MeshLibrary::MESH_RANGE& MeshLibrary::GetMeshRange(FIXED_SHAPE shape) const
+{
+	if ((shape < 0) || (shape >= FIXED_SHAPE_COUNT))
+	{
+		return(g_EmptyRange);
+	}
+	return(m_fixedRanges[shape]);
+}
+
+/***********************************************************
+ *  BindMeshPool()
+ *
+ *  This method is used for binding the vertex array of the
+ *  pool, so that indirect draws can use the mesh ranges.
+ ***********************************************************/
+void MeshLibrary::BindMeshPool() const
+{
+	glBindVertexArray(m_vao);
+}
+
+/***********************************************************
+ *  GetSegmentCount()
+ *
+ *  This method is used for getting the number of segments
+ *  around a shape, which halves with every level.
+ ***********************************************************/
+int MeshLibrary::GetSegmentCount(int level)
+{
+	return(g_FinestSegmentCount >> level);
+}
+
+/***********************************************************
+ *  BuildShape()
+ *
+ *  This method is used for generating a shape at a level.
+ ***********************************************************/
+void MeshLibrary::BuildShape(LOD_SHAPE shape, int level, MESH_DATA& mesh)
+{
+	int segments = GetSegmentCount(level);
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	switch (shape)
+	{
+	case LOD_CYLINDER:
+		BuildCylinder(segments, mesh);
+		break;
+	case LOD_SPHERE:
+		BuildSphere(segments, segments / 2, mesh);
+		break;
+	case LOD_CONE:
+		BuildCone(segments, mesh);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  BuildFixedShape()
+ *
+ *  This method is used for generating a fixed shape.
+ ***********************************************************/
+void MeshLibrary::BuildFixedShape(FIXED_SHAPE shape, MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	switch (shape)
+	{
+	case FIXED_BOX:
+		BuildBox(mesh);
+		break;
+	case FIXED_PLANE:
+		BuildPlane(mesh);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  AddToPool()
+ *
+ *  This method is used for optimizing a generated mesh and
+ *  appending it to the pool.  The indices stay relative to
+ *  the mesh, and the range records the base vertex that the
+ *  draws add to them.
+ ***********************************************************/
+void MeshLibrary::AddToPool(const char* name, MESH_DATA& data, MESH_RANGE& range, MESH_DATA& pool)
+{
+	MeshOptimizer::CACHE_STATS before = MeshOptimizer::AnalyzeVertexCache(data.indices, data.vertices.size());
+	MeshOptimizer::OptimizeMesh(data);
+	MeshOptimizer::CACHE_STATS after = MeshOptimizer::AnalyzeVertexCache(data.indices, data.vertices.size());
+
+	std::cout << "INFO: " << name
+		<< " ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
+	range.firstIndex = (GLuint)pool.indices.size();
+	range.indexCount = (GLuint)data.indices.size();
+	range.baseVertex = (GLint)pool.vertices.size();
+
+	pool.vertices.insert(pool.vertices.end(), data.vertices.begin(), data.vertices.end());
+	pool.indices.insert(pool.indices.end(), data.indices.begin(), data.indices.end());
+}
+
+/***********************************************************
+ *  UploadPool()
+ *
+ *  This method is used for creating the vertex array, the
+ *  vertex buffer and the index buffer of the pool.  The
+ *  attribute locations match the vertex shader, which
+ *  decodes the packed normals when bUsePackedNormal is set.
+ ***********************************************************/
+void MeshLibrary::UploadPool(
+	const void* pVertices,
+	size_t vertexBytes,
+	const uint32_t* pIndices,
+	size_t indexCount)
+{
+	glGenVertexArrays(1, &m_vao);
+	glBindVertexArray(m_vao);
+
+	glGenBuffers(1, &m_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertexBytes, pVertices, GL_STATIC_DRAW);
+
+	if (m_vertexFormat == VERTEX_FORMAT_PACKED)
+	{
+		GLsizei stride = sizeof(PACKED_VERTEX);
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PACKED_VERTEX, position));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PACKED_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PACKED_VERTEX, textureCoordinate));
+	}
+	else
+	{
+		GLsizei stride = sizeof(MESH_VERTEX);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, textureCoordinate));
+	}
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	glGenBuffers(1, &m_ibo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint32_t), pIndices, GL_STATIC_DRAW);
+
+	glBindVertexArray(0);
+
+	m_vertexBytes = vertexBytes;
+}
+
+/***********************************************************
+ *  PackVertices()
+ *
+ *  This method is used for converting the generated float
+ *  vertices into the packed layout.  It runs on the pool
+ *  after the optimizer, which needs the full precision
+ *  positions and normals to order the triangles, so the
+ *  shapes are packed once when the pool is loaded or when
+ *  the scene compiler writes it.  The float vertices are
+ *  only kept until the packed ones are uploaded.
+ ***********************************************************/
+void MeshLibrary::PackVertices(
+	const std::vector<MESH_VERTEX>& vertices,
+	std::vector<PACKED_VERTEX>& packedVertices)
+{
+	packedVertices.resize(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const MESH_VERTEX& vertex = vertices[i];
+		PACKED_VERTEX& packed = packedVertices[i];
+		glm::vec2 normal = EncodeOctahedral(vertex.normal);
+
+		packed.position[0] = (int16_t)glm::packSnorm1x16(vertex.position.x);
+		packed.position[1] = (int16_t)glm::packSnorm1x16(vertex.position.y);
+		packed.position[2] = (int16_t)glm::packSnorm1x16(vertex.position.z);
+		packed.position[3] = 0;
+		packed.normal[0] = (int16_t)glm::packSnorm1x16(normal.x);
+		packed.normal[1] = (int16_t)glm::packSnorm1x16(normal.y);
+		packed.textureCoordinate[0] = glm::packHalf1x16(vertex.textureCoordinate.x);
+		packed.textureCoordinate[1] = glm::packHalf1x16(vertex.textureCoordinate.y);
+	}
+}
+
+/***********************************************************
+ *  EncodeOctahedral()
+ *
+ *  This method is used for projecting a unit normal onto the
+ *  octahedron |x| + |y| + |z| = 1 and folding the lower half
+ *  over the diagonals, which spreads the precision evenly
+ *  over all directions.
+ ***********************************************************/
+glm::vec2 MeshLibrary::EncodeOctahedral(const glm::vec3& normal)
+{
+	float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (sum <= 0.0f)
+	{
+		return(glm::vec2(0.0f, 0.0f));
+	}
+
+	glm::vec2 encoded(normal.x / sum, normal.y / sum);
+	if (normal.z < 0.0f)
+	{
+		float x = (1.0f - std::fabs(encoded.y)) * ((encoded.x >= 0.0f) ? 1.0f : -1.0f);
+		float y = (1.0f - std::fabs(encoded.x)) * ((encoded.y >= 0.0f) ? 1.0f : -1.0f);
+		encoded = glm::vec2(x, y);
+	}
+	return(encoded);
+}
+
+/***********************************************************
+ *  BuildCylinder()
+ *
+ *  This method is used for generating a capped cylinder.
+ *  The side repeats the first column of vertices at the end
+ *  so the texture wraps once around without a seam.
+ ***********************************************************/
+void MeshLibrary::BuildCylinder(int segments, MESH_DATA& mesh)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+
+	for (int i = 0; i <= segments; i++)
+	{
+		float u = (float)i / segments;
+		float angle = u * 2.0f * g_Pi;
+		glm::vec3 normal(std::cos(angle), 0.0f, std::sin(angle));
+
+		mesh.vertices.push_back({ glm::vec3(normal.x, 0.0f, normal.z), normal, glm::vec2(u, 0.0f) });
+		mesh.vertices.push_back({ glm::vec3(normal.x, 1.0f, normal.z), normal, glm::vec2(u, 1.0f) });
+	}
+
+	for (int i = 0; i < segments; i++)
+	{
+		uint32_t bottom = first + i * 2;
+		uint32_t top = bottom + 1;
+		uint32_t nextBottom = bottom + 2;
+		uint32_t nextTop = bottom + 3;
+
+		mesh.indices.insert(mesh.indices.end(), { bottom, top, nextBottom });
+		mesh.indices.insert(mesh.indices.end(), { nextBottom, top, nextTop });
+	}
+
+	AddCap(segments, 1.0f, true, mesh);
+	AddCap(segments, 0.0f, false, mesh);
+}
+
+/***********************************************************
+ *  BuildSphere()
+ *
+ *  This method is used for generating a sphere from rings
+ *  of latitude running from the top pole to the bottom.
+ ***********************************************************/
+void MeshLibrary::BuildSphere(int segments, int rings, MESH_DATA& mesh)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+	uint32_t columns = (uint32_t)segments + 1;
+
+	for (int ring = 0; ring <= rings; ring++)
+	{
+		float v = (float)ring / rings;
+		float polar = v * g_Pi;
+
+		for (int i = 0; i <= segments; i++)
+		{
+			float u = (float)i / segments;
+			float angle = u * 2.0f * g_Pi;
+			glm::vec3 normal(
+				std::sin(polar) * std::cos(angle),
+				std::cos(polar),
+				std::sin(polar) * std::sin(angle));
+
+			mesh.vertices.push_back({ normal, normal, glm::vec2(u, 1.0f - v) });
+		}
+	}
+
+	for (int ring = 0; ring < rings; ring++)
+	{
+		for (int i = 0; i < segments; i++)
+		{
+			uint32_t upper = first + ring * columns + i;
+			uint32_t lower = upper + columns;
+
+			// the rows at the poles collapse to a point, so each
+			// quad there is a single triangle
+			if (ring != rings - 1)
+			{
+				mesh.indices.insert(mesh.indices.end(), { lower, upper, lower + 1 });
+			}
+			if (ring != 0)
+			{
+				mesh.indices.insert(mesh.indices.end(), { lower + 1, upper, upper + 1 });
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildCone()
+ *
+ *  This method is used for generating a capped cone.  Each
+ *  side triangle has its own tip vertex so the tip normal
+ *  follows the slope of that triangle.
+ ***********************************************************/
+void MeshLibrary::BuildCone(int segments, MESH_DATA& mesh)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+
+	// with a radius and height of 1 the side slopes at 45 degrees
+	const float slope = std::sqrt(0.5f);
+
+	for (int i = 0; i <= segments; i++)
+	{
+		float u = (float)i / segments;
+		float angle = u * 2.0f * g_Pi;
+		float tipAngle = ((float)i + 0.5f) / segments * 2.0f * g_Pi;
+		glm::vec3 normal(std::cos(angle) * slope, slope, std::sin(angle) * slope);
+		glm::vec3 tipNormal(std::cos(tipAngle) * slope, slope, std::sin(tipAngle) * slope);
+
+		mesh.vertices.push_back({ glm::vec3(std::cos(angle), 0.0f, std::sin(angle)), normal, glm::vec2(u, 0.0f) });
+		mesh.vertices.push_back({ glm::vec3(0.0f, 1.0f, 0.0f), tipNormal, glm::vec2(u + 0.5f / segments, 1.0f) });
+	}
+
+	for (int i = 0; i < segments; i++)
+	{
+		uint32_t base = first + i * 2;
+		mesh.indices.insert(mesh.indices.end(), { base, base + 1, base + 2 });
+	}
+
+	AddCap(segments, 0.0f, false, mesh);
+}
+
+/***********************************************************
+ *  AddCap()
+ *
+ *  This method is used for adding a disc with a radius of 1
+ *  as a fan around a center vertex.
+ ***********************************************************/
+void MeshLibrary::AddCap(int segments, float height, bool bFacingUp, MESH_DATA& mesh)
+{
+	uint32_t center = (uint32_t)mesh.vertices.size();
+	glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+
+	mesh.vertices.push_back({ glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f) });
+	for (int i = 0; i <= segments; i++)
+	{
+		float angle = (float)i / segments * 2.0f * g_Pi;
+		float x = std::cos(angle);
+		float z = std::sin(angle);
+		mesh.vertices.push_back({ glm::vec3(x, height, z), normal, glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z) });
+	}
+
+	for (uint32_t i = 0; i < (uint32_t)segments; i++)
+	{
+		uint32_t ring = center + 1 + i;
+		if (bFacingUp == true)
+		{
+			mesh.indices.insert(mesh.indices.end(), { center, ring + 1, ring });
+		}
+		else
+		{
+			mesh.indices.insert(mesh.indices.end(), { center, ring, ring + 1 });
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildBox()
+ *
+ *  This method is used for generating a unit cube with four
+ *  vertices per face, so each face has its own normal and
+ *  shows the whole texture.
+ ***********************************************************/
+void MeshLibrary::BuildBox(MESH_DATA& mesh)
+{
+	// face normal and the two directions across the face,
+	// ordered so the triangles wind counter clockwise
+	const glm::vec3 faces[6][3] =
+	{
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		const glm::vec3& normal = faces[face][0];
+		const glm::vec3& across = faces[face][1];
+		const glm::vec3& up = faces[face][2];
+		glm::vec3 center = normal * 0.5f;
+		uint32_t first = (uint32_t)mesh.vertices.size();
+
+		mesh.vertices.push_back({ center - across * 0.5f - up * 0.5f, normal, glm::vec2(0.0f, 0.0f) });
+		mesh.vertices.push_back({ center + across * 0.5f - up * 0.5f, normal, glm::vec2(1.0f, 0.0f) });
+		mesh.vertices.push_back({ center + across * 0.5f + up * 0.5f, normal, glm::vec2(1.0f, 1.0f) });
+		mesh.vertices.push_back({ center - across * 0.5f + up * 0.5f, normal, glm::vec2(0.0f, 1.0f) });
+
+		mesh.indices.insert(mesh.indices.end(), { first, first + 1, first + 2 });
+		mesh.indices.insert(mesh.indices.end(), { first, first + 2, first + 3 });
+	}
+}
+
+/***********************************************************
+ *  BuildPlane()
+ *
+ *  This method is used for generating a flat square on the
+ *  ground that faces up.
+ ***********************************************************/
+void MeshLibrary::BuildPlane(MESH_DATA& mesh)
+{
+	glm::vec3 normal(0.0f, 1.0f, 0.0f);
+
+	mesh.vertices.push_back({ glm::vec3(-1.0f, 0.0f, 1.0f), normal, glm::vec2(0.0f, 0.0f) });
+	mesh.vertices.push_back({ glm::vec3(1.0f, 0.0f, 1.0f), normal, glm::vec2(1.0f, 0.0f) });
+	mesh.vertices.push_back({ glm::vec3(1.0f, 0.0f, -1.0f), normal, glm::vec2(1.0f, 1.0f) });
+	mesh.vertices.push_back({ glm::vec3(-1.0f, 0.0f, -1.0f), normal, glm::vec2(0.0f, 1.0f) });
+
+	mesh.indices.insert(mesh.indices.end(), { 0, 1, 2 });
+	mesh.indices.insert(mesh.indices.end(), { 0, 2, 3 });
+}
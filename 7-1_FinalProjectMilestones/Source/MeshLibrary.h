@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.h
+// ============
+// generated shape meshes with several tessellation levels per shape, so that
+// small or distant objects can be drawn with fewer triangles, stored either
+// as full floats or in a packed 16 byte vertex format, all in one shared pool
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MeshLibrary
+ *
+ *  This class generates the round shapes at a fixed set of
+ *  tessellation levels, plus a box and a plane, and keeps
+ *  all of them in one vertex and index buffer pool so any
+ *  mix of them can be drawn with one multi-draw call.  Each
+ *  mesh is a range of the pool.  Level 0 is the finest, and
+ *  each following level halves the number of segments
+ *  around the shape.  The shapes use the same local space
+ *  as ShapeMeshes.
+ *
+ *  The packed vertex format stores 16 bit normalized
+ *  positions, which works because every shape fits in the
+ *  -1 to 1 cube, octahedral normals in two 16 bit values
+ *  that the vertex shader decodes, and half float texture
+ *  coordinates so tiled UVs above 1 still work.  The shapes
+ *  are generated and optimized as float vertices and packed
+ *  once the pool is built, since the optimizer orders the
+ *  triangles by their float positions and normals.  The
+ *  course's ShapeMeshes keep their own float vertices.
+ ***********************************************************/
+class MeshLibrary
+{
+public:
+	// constructor
+	MeshLibrary();
+	// destructor
+	~MeshLibrary();
+
+	// shapes generated with tessellation levels
+	enum LOD_SHAPE
+	{
+		LOD_CYLINDER = 0,
+		LOD_SPHERE,
+		LOD_CONE,
+		LOD_SHAPE_COUNT
+	};
+
+	// number of tessellation levels of every shape
+	static const int LOD_LEVEL_COUNT = 4;
+
+	// shapes generated with a single level
+	enum FIXED_SHAPE
+	{
+		FIXED_BOX = 0,
+		FIXED_PLANE,
+		FIXED_SHAPE_COUNT
+	};
+
+	// ranges in a pool, every shape level then the fixed shapes
+	static const int POOL_RANGE_COUNT = LOD_SHAPE_COUNT * LOD_LEVEL_COUNT + FIXED_SHAPE_COUNT;
+
+	// vertex layouts the shapes can be uploaded in
+	enum VERTEX_FORMAT
+	{
+		VERTEX_FORMAT_FLOAT = 0,
+		VERTEX_FORMAT_PACKED
+	};
+
+	// vertex layout matching the basic shape meshes, 32 bytes
+	struct MESH_VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 textureCoordinate;
+	};
+
+	// packed vertex layout, 16 bytes - the fourth position
+	// value only pads the normal to a 4 byte boundary
+	struct PACKED_VERTEX
+	{
+		int16_t position[4];
+		int16_t normal[2];
+		uint16_t textureCoordinate[2];
+	};
+
+	// generated vertices and triangle list indices
+	struct MESH_DATA
+	{
+		std::vector<MESH_VERTEX> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// location of one mesh in the shared pool, in the units
+	// of an indexed indirect draw command
+	struct MESH_RANGE
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+	};
+
+	// generate every shape at every level and upload them
+	// into the pool in the passed in vertex format
+	void LoadLODMeshes(VERTEX_FORMAT format = VERTEX_FORMAT_PACKED);
+	// upload pool data built ahead of time, with the vertices
+	// in the passed in format and the ranges of BuildMeshPool()
+	void LoadMeshPool(
+		VERTEX_FORMAT format,
+		const void* pVertices,
+		size_t vertexBytes,
+		const uint32_t* pIndices,
+		size_t indexCount,
+		const MESH_RANGE ranges[POOL_RANGE_COUNT]);
+	// free the vertex array and buffers of the pool
+	void DestroyMeshes();
+
+	// draw one shape at the passed in tessellation level
+	void DrawLODMesh(LOD_SHAPE shape, int level) const;
+	// get the number of triangles of a shape at a level
+	int GetTriangleCount(LOD_SHAPE shape, int level) const;
+	// get the pool range of a shape level or a fixed shape
+	const MESH_RANGE& GetMeshRange(LOD_SHAPE shape, int level) const;
+	const MESH_RANGE& GetMeshRange(FIXED_SHAPE shape) const;
+	// bind the vertex array of the pool, whose index buffer is
+	// what the ranges point into
+	void BindMeshPool() const;
+	// check whether the pool was uploaded
+	bool IsLoaded() const { return m_vao != 0; }
+	// get the vertex format the shapes were uploaded in
+	VERTEX_FORMAT GetVertexFormat() const { return m_vertexFormat; }
+	// get the vertex buffer bytes of all the shape levels
+	size_t GetVertexBytes() const { return m_vertexBytes; }
+
+	// generate and optimize all the shapes into pool data on
+	// the CPU, with the range of every shape level followed by
+	// the ranges of the fixed shapes
+	static void BuildMeshPool(MESH_DATA& pool, MESH_RANGE ranges[POOL_RANGE_COUNT]);
+	// get the number of segments around a shape at a level
+	static int GetSegmentCount(int level);
+	// generate the vertices and indices of a shape at a level
+	static void BuildShape(LOD_SHAPE shape, int level, MESH_DATA& mesh);
+	// generate the vertices and indices of a fixed shape
+	static void BuildFixedShape(FIXED_SHAPE shape, MESH_DATA& mesh);
+	// convert the optimized pool vertices into the packed
+	// layout
+	static void PackVertices(
+		const std::vector<MESH_VERTEX>& vertices,
+		std::vector<PACKED_VERTEX>& packedVertices);
+	// map a unit normal onto the octahedron unfolded into the
+	// -1 to 1 square, which the vertex shader reverses
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+
+private:
+	// vertex array and buffers shared by every mesh
+	GLuint m_vao;
+	GLuint m_vbo;
+	GLuint m_ibo;
+	MESH_RANGE m_lodRanges[LOD_SHAPE_COUNT][LOD_LEVEL_COUNT];
+	MESH_RANGE m_fixedRanges[FIXED_SHAPE_COUNT];
+	VERTEX_FORMAT m_vertexFormat;
+	size_t m_vertexBytes;
+
+	// optimize a generated mesh, report its vertex cache
+	// statistics and append it to the pool data
+	static void AddToPool(const char* name, MESH_DATA& data, MESH_RANGE& range, MESH_DATA& pool);
+	// create the vertex array and buffers for the pool data
+	// in the current vertex format
+	void UploadPool(
+		const void* pVertices,
+		size_t vertexBytes,
+		const uint32_t* pIndices,
+		size_t indexCount);
+
+	// shape generators - the cylinder and cone stand on the
+	// origin with a radius and height of 1, the sphere has a
+	// radius of 1 around the origin, the box is a unit cube
+	// around the origin and the plane spans -1 to 1 on the
+	// ground facing up
+	static void BuildCylinder(int segments, MESH_DATA& mesh);
+	static void BuildSphere(int segments, int rings, MESH_DATA& mesh);
+	static void BuildCone(int segments, MESH_DATA& mesh);
+	static void BuildBox(MESH_DATA& mesh);
+	static void BuildPlane(MESH_DATA& mesh);
+	// add a flat disc facing up or down at the passed in height
+	static void AddCap(int segments, float height, bool bFacingUp, MESH_DATA& mesh);
+};
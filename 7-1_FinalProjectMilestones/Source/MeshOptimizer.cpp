@@ -0,0 +1,489 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// load time mesh optimization - triangle order for the post transform vertex
+// cache and for overdraw, vertex order for fetch locality, and the cache
+// statistics used to report the result
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// size of the modelled LRU cache for the triangle ordering
+	const int g_ModelCacheSize = 32;
+	// size of the FIFO cache used for the overdraw clusters
+	const int g_FifoCacheSize = 16;
+
+	// vertex scoring weights of the linear speed vertex cache
+	// optimization by Tom Forsyth
+	const float g_CacheDecayPower = 1.5f;
+	const float g_LastTriangleScore = 0.75f;
+	const float g_ValenceBoostScale = 2.0f;
+	const float g_ValenceBoostPower = 0.5f;
+
+	/***********************************************************
+	 *  GetVertexScore()
+	 *
+	 *  This function is used for scoring a vertex by its
+	 *  position in the modelled cache and by how many of its
+	 *  triangles are still left, so lonely vertices are
+	 *  finished off before they are evicted.
+	 ***********************************************************/
+	float GetVertexScore(int cachePosition, uint32_t remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// the vertices of the last triangle get a fixed score
+			// so the next triangle does not simply reuse them
+			if (cachePosition < 3)
+			{
+				score = g_LastTriangleScore;
+			}
+			else
+			{
+				float scale = 1.0f / (g_ModelCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scale, g_CacheDecayPower);
+			}
+		}
+
+		score += g_ValenceBoostScale * std::pow((float)remainingTriangles, -g_ValenceBoostPower);
+		return(score);
+	}
+
+	/***********************************************************
+	 *  CountCacheMisses()
+	 *
+	 *  This function is used for simulating a FIFO cache over
+	 *  a range of triangles and writing the misses of each.
+	 *  The cache holds a vertex while fewer than cacheSize
+	 *  misses happened since it was loaded.
+	 ***********************************************************/
+	void CountCacheMisses(
+		const std::vector<uint32_t>& indices,
+		size_t firstTriangle,
+		size_t lastTriangle,
+		std::vector<uint32_t>& loadTimes,
+		uint32_t& time,
+		std::vector<uint8_t>& misses)
+	{
+		for (size_t t = firstTriangle; t < lastTriangle; t++)
+		{
+			uint8_t triangleMisses = 0;
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t index = indices[t * 3 + corner];
+				if (time - loadTimes[index] > (uint32_t)g_FifoCacheSize)
+				{
+					loadTimes[index] = time;
+					time++;
+					triangleMisses++;
+				}
+			}
+			misses[t] = triangleMisses;
+		}
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This function is used for counting the vertex shader
+ *  invocations of an index buffer with a FIFO cache.
+ ***********************************************************/
+MeshOptimizer::CACHE_STATS MeshOptimizer::AnalyzeVertexCache(
+	const std::vector<uint32_t>& indices,
+	size_t vertexCount,
+	int cacheSize)
+{
+	CACHE_STATS stats = { 0.0f, 0.0f };
+	std::vector<uint32_t> loadTimes(vertexCount, 0);
+	uint32_t time = (uint32_t)cacheSize + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		uint32_t index = indices[i];
+		if (time - loadTimes[index] > (uint32_t)cacheSize)
+		{
+			loadTimes[index] = time;
+			time++;
+			misses++;
+		}
+	}
+
+	// only the vertices the triangles use count as unique
+	size_t usedVertices = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (loadTimes[i] != 0)
+		{
+			usedVertices++;
+		}
+	}
+
+	if (indices.size() >= 3)
+	{
+		stats.acmr = (float)misses / (float)(indices.size() / 3);
+	}
+	if (usedVertices > 0)
+	{
+		stats.atvr = (float)misses / (float)usedVertices;
+	}
+	return(stats);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This function is used for greedily emitting the triangle
+ *  with the highest vertex score next.  Only the triangles
+ *  of the vertices in the modelled cache are candidates, so
+ *  every step touches a bounded number of triangles.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// triangles of each vertex, where the first liveCounts
+	// entries of a vertex are the ones not emitted yet
+	std::vector<uint32_t> liveCounts(vertexCount, 0);
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		liveCounts[indices[i]]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		offsets[v + 1] = offsets[v] + liveCounts[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = GetVertexScore(-1, liveCounts[v]);
+	}
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScores[t] =
+			vertexScores[indices[t * 3]] +
+			vertexScores[indices[t * 3 + 1]] +
+			vertexScores[indices[t * 3 + 2]];
+	}
+
+	std::vector<uint32_t> output;
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	output.reserve(triangleCount * 3);
+	cache.reserve(g_ModelCacheSize + 3);
+	newCache.reserve(g_ModelCacheSize + 3);
+
+	// start with the best triangle of the whole mesh
+	int bestTriangle = 0;
+	for (size_t t = 1; t < triangleCount; t++)
+	{
+		if (triangleScores[t] > triangleScores[bestTriangle])
+		{
+			bestTriangle = (int)t;
+		}
+	}
+	size_t nextUnemitted = 0;
+
+	while (output.size() < triangleCount * 3)
+	{
+		// when the cache has nothing left to offer, continue with
+		// the next triangle that has not been emitted
+		if (bestTriangle < 0)
+		{
+			while (emitted[nextUnemitted] != 0)
+			{
+				nextUnemitted++;
+			}
+			bestTriangle = (int)nextUnemitted;
+		}
+
+		const uint32_t* corners = &indices[bestTriangle * 3];
+		emitted[bestTriangle] = 1;
+		output.insert(output.end(), corners, corners + 3);
+
+		// remove the triangle from its vertices' live lists
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t v = corners[corner];
+			uint32_t* pList = &adjacency[offsets[v]];
+			for (uint32_t i = 0; i < liveCounts[v]; i++)
+			{
+				if (pList[i] == (uint32_t)bestTriangle)
+				{
+					pList[i] = pList[liveCounts[v] - 1];
+					liveCounts[v]--;
+					break;
+				}
+			}
+		}
+
+		// move the triangle's vertices to the front of the cache
+		newCache.clear();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), corners[corner]) == newCache.end())
+			{
+				newCache.push_back(corners[corner]);
+			}
+		}
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), cache[i]) == newCache.end())
+			{
+				newCache.push_back(cache[i]);
+			}
+		}
+
+		// rescore the vertices that moved, including the ones
+		// pushed out of the cache, and their live triangles
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			uint32_t v = newCache[i];
+			int position = (i < (size_t)g_ModelCacheSize) ? (int)i : -1;
+			float score = GetVertexScore(position, liveCounts[v]);
+			float delta = score - vertexScores[v];
+
+			cachePositions[v] = position;
+			vertexScores[v] = score;
+			for (uint32_t j = 0; j < liveCounts[v]; j++)
+			{
+				triangleScores[adjacency[offsets[v] + j]] += delta;
+			}
+		}
+
+		cache.assign(newCache.begin(),
+			newCache.begin() + std::min(newCache.size(), (size_t)g_ModelCacheSize));
+
+		// the next triangle is the best one touching the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			uint32_t v = cache[i];
+			for (uint32_t j = 0; j < liveCounts[v]; j++)
+			{
+				uint32_t t = adjacency[offsets[v] + j];
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This function is used for splitting the cache optimized
+ *  triangles into clusters and sorting the clusters so the
+ *  ones that face outward are drawn first, since they are
+ *  the most likely to hide the rest of the mesh.  Clusters
+ *  end where the cache starts over anyway, or where the
+ *  cache efficiency so far is within the threshold of the
+ *  whole cluster's, after Sander, Nehab and Barczak.  The
+ *  new order is only kept when the whole mesh stays within
+ *  the threshold of the cache optimized order.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(
+	std::vector<uint32_t>& indices,
+	const std::vector<MeshLibrary::MESH_VERTEX>& vertices,
+	float threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> loadTimes(vertices.size(), 0);
+	std::vector<uint8_t> misses(triangleCount);
+	uint32_t time = g_FifoCacheSize + 1;
+
+	// hard boundaries where all three vertices miss the cache
+	std::vector<size_t> hardClusters;
+	CountCacheMisses(indices, 0, triangleCount, loadTimes, time, misses);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		if ((t == 0) || (misses[t] == 3))
+		{
+			hardClusters.push_back(t);
+		}
+	}
+	hardClusters.push_back(triangleCount);
+
+	// soft boundaries inside each hard cluster
+	std::vector<size_t> clusters;
+	for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+	{
+		size_t first = hardClusters[c];
+		size_t last = hardClusters[c + 1];
+
+		time += g_FifoCacheSize + 1;
+		CountCacheMisses(indices, first, last, loadTimes, time, misses);
+		size_t clusterMisses = 0;
+		for (size_t t = first; t < last; t++)
+		{
+			clusterMisses += misses[t];
+		}
+		float clusterThreshold = threshold * (float)clusterMisses / (float)(last - first);
+
+		time += g_FifoCacheSize + 1;
+		size_t start = first;
+		size_t runningMisses = 0;
+		clusters.push_back(first);
+		for (size_t t = first; t < last; t++)
+		{
+			CountCacheMisses(indices, t, t + 1, loadTimes, time, misses);
+			runningMisses += misses[t];
+
+			if ((t + 1 < last) &&
+				((float)runningMisses / (float)(t + 1 - start) <= clusterThreshold))
+			{
+				clusters.push_back(t + 1);
+				start = t + 1;
+				runningMisses = 0;
+				time += g_FifoCacheSize + 1;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	// mesh center from the used vertices
+	glm::vec3 meshCenter(0.0f);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		meshCenter += vertices[indices[i]].position;
+	}
+	meshCenter = meshCenter / (float)indices.size();
+
+	// sort key is how far each cluster faces away from the center
+	size_t clusterCount = clusters.size() - 1;
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<uint32_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const glm::vec3& a = vertices[indices[t * 3]].position;
+			const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+			const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+			glm::vec3 faceNormal = glm::cross(b - a, d - a);
+			float faceArea = glm::length(faceNormal);
+
+			centroid += (a + b + d) * (faceArea / 3.0f);
+			normal += faceNormal;
+			area += faceArea;
+		}
+
+		float normalLength = glm::length(normal);
+		sortKeys[c] = 0.0f;
+		if ((area > 0.0f) && (normalLength > 0.0f))
+		{
+			sortKeys[c] = glm::dot(centroid / area - meshCenter, normal / normalLength);
+		}
+		order[c] = (uint32_t)c;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) {
+		return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (size_t i = 0; i < clusterCount; i++)
+	{
+		size_t c = order[i];
+		output.insert(output.end(),
+			indices.begin() + clusters[c] * 3,
+			indices.begin() + clusters[c + 1] * 3);
+	}
+
+	// the clusters lose the reuse across their boundaries, so
+	// keep the cache order when that costs more than allowed
+	CACHE_STATS cacheOrder = AnalyzeVertexCache(indices, vertices.size(), g_FifoCacheSize);
+	CACHE_STATS overdrawOrder = AnalyzeVertexCache(output, vertices.size(), g_FifoCacheSize);
+	if (overdrawOrder.acmr <= cacheOrder.acmr * threshold)
+	{
+		indices.swap(output);
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This function is used for storing the vertices in the
+ *  order they are first referenced, so the vertex fetches
+ *  walk through memory mostly forward.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(MeshLibrary::MESH_DATA& mesh)
+{
+	const uint32_t unused = 0xFFFFFFFFu;
+	std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+	std::vector<MeshLibrary::MESH_VERTEX> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		uint32_t index = mesh.indices[i];
+		if (remap[index] == unused)
+		{
+			remap[index] = (uint32_t)vertices.size();
+			vertices.push_back(mesh.vertices[index]);
+		}
+		mesh.indices[i] = remap[index];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This function is used for running the triangle order
+ *  passes before the vertex order pass, which depends on
+ *  the final triangle order.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(MeshLibrary::MESH_DATA& mesh)
+{
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+	OptimizeOverdraw(mesh.indices, mesh.vertices);
+	OptimizeVertexFetch(mesh);
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// load time mesh optimization - triangle order for the post transform vertex
+// cache and for overdraw, vertex order for fetch locality, and the cache
+// statistics used to report the result
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshLibrary.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  These functions reorder the triangles and vertices of a
+ *  mesh without changing what is drawn.  They are meant to
+ *  run once when a mesh is generated or imported, never
+ *  per frame.
+ ***********************************************************/
+namespace MeshOptimizer
+{
+	// post transform vertex cache statistics of an index buffer
+	struct CACHE_STATS
+	{
+		// vertex shader invocations per triangle
+		float acmr;
+		// vertex shader invocations per unique vertex
+		float atvr;
+	};
+
+	// simulate a FIFO vertex cache of the passed in size
+	CACHE_STATS AnalyzeVertexCache(
+		const std::vector<uint32_t>& indices,
+		size_t vertexCount,
+		int cacheSize = 16);
+
+	// reorder the triangles so each one reuses as many of the
+	// recently transformed vertices as possible
+	void OptimizeVertexCache(
+		std::vector<uint32_t>& indices,
+		size_t vertexCount);
+	// reorder clusters of cache optimized triangles so the ones
+	// facing away from the mesh center are drawn first, while
+	// keeping the cache efficiency within the threshold
+	void OptimizeOverdraw(
+		std::vector<uint32_t>& indices,
+		const std::vector<MeshLibrary::MESH_VERTEX>& vertices,
+		float threshold = 1.05f);
+	// reorder the vertices in the order the triangles first use
+	// them and drop the ones no triangle uses
+	void OptimizeVertexFetch(MeshLibrary::MESH_DATA& mesh);
+
+	// run all the passes in order on a mesh
+	void OptimizeMesh(MeshLibrary::MESH_DATA& mesh);
+}
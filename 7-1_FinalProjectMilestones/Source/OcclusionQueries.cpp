@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionqueries.cpp
+// ============
+// occlusion culling with hardware occlusion queries - the results of the
+// queries issued in one frame decide which objects are drawn in the next
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionQueries.h"
+
+/***********************************************************
+ *  OcclusionQueries()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionQueries::OcclusionQueries()
+{
+	m_skippedDraws = 0;
+	m_testedDraws = 0;
+}
+
+/***********************************************************
+ *  ~OcclusionQueries()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionQueries::~OcclusionQueries()
+{
+	DestroyQueries();
+}
+
+/***********************************************************
+ *  CreateQueries()
+ *
+ *  This method is used for generating one query object for
+ *  each scene object.  Every object starts out visible.
+ ***********************************************************/
+void OcclusionQueries::CreateQueries(size_t objectCount)
+{
+	DestroyQueries();
+
+	m_queryIDs.resize(objectCount, 0);
+	m_queryStates.resize(objectCount, QUERY_IDLE);
+	m_hiddenFlags.resize(objectCount, 0);
+
+	if (objectCount > 0)
+	{
+		glGenQueries((GLsizei)objectCount, m_queryIDs.data());
+	}
+}
+
+/***********************************************************
+ *  DestroyQueries()
+ *
+ *  This method is used for freeing the query objects.
+ ***********************************************************/
+void OcclusionQueries::DestroyQueries()
+{
+	if (m_queryIDs.empty() == false)
+	{
+		glDeleteQueries((GLsizei)m_queryIDs.size(), m_queryIDs.data());
+	}
+	m_queryIDs.clear();
+	m_queryStates.clear();
+	m_hiddenFlags.clear();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for resetting the draw counters at
+ *  the start of a frame.
+ ***********************************************************/
+void OcclusionQueries::BeginFrame()
+{
+	m_skippedDraws = 0;
+	m_testedDraws = 0;
+}
+
+/***********************************************************
+ *  IsObjectHidden()
+ *
+ *  This method is used for collecting the result of the
+ *  object's query when it is available, and reporting
+ *  whether the last collected result proved it hidden.
+ ***********************************************************/
+bool OcclusionQueries::IsObjectHidden(uint32_t objectIndex)
+{
+	if (objectIndex >= m_queryIDs.size())
+	{
+		return(false);
+	}
+
+	if (m_queryStates[objectIndex] != QUERY_IDLE)
+	{
+		GLuint bAvailable = GL_FALSE;
+		glGetQueryObjectuiv(m_queryIDs[objectIndex], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+
+		// results that are not ready yet keep the previous
+		// visibility instead of stalling on the GPU
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint anySamplesPassed = 0;
+			glGetQueryObjectuiv(m_queryIDs[objectIndex], GL_QUERY_RESULT, &anySamplesPassed);
+
+			// a stale result was issued before the object left
+			// the view and no longer says anything about it
+			if (m_queryStates[objectIndex] == QUERY_PENDING)
+			{
+				m_hiddenFlags[objectIndex] = (anySamplesPassed == 0) ? 1 : 0;
+			}
+			m_queryStates[objectIndex] = QUERY_IDLE;
+		}
+	}
+
+	return(m_hiddenFlags[objectIndex] != 0);
+}
+
+/***********************************************************
+ *  CanIssueQuery()
+ *
+ *  This method is used for checking whether the object's
+ *  query object is free for a new query.
+ ***********************************************************/
+bool OcclusionQueries::CanIssueQuery(uint32_t objectIndex) const
+{
+	return((objectIndex < m_queryIDs.size()) && (m_queryStates[objectIndex] == QUERY_IDLE));
+}
+
+/***********************************************************
+ *  BeginQuery()
+ *
+ *  This method is used for starting the object's query.
+ ***********************************************************/
+void OcclusionQueries::BeginQuery(uint32_t objectIndex)
+{
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, m_queryIDs[objectIndex]);
+	m_queryStates[objectIndex] = QUERY_PENDING;
+}
+
+/***********************************************************
+ *  EndQuery()
+ *
+ *  This method is used for ending the active query.
+ ***********************************************************/
+void OcclusionQueries::EndQuery()
+{
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+/***********************************************************
+ *  ResetObject()
+ *
+ *  This method is used for marking an object as visible.
+ *  A query still in flight is left to finish, and its result
+ *  is discarded the next time the object is checked.
+ ***********************************************************/
+void OcclusionQueries::ResetObject(uint32_t objectIndex)
+{
+	if (objectIndex < m_hiddenFlags.size())
+	{
+		m_hiddenFlags[objectIndex] = 0;
+		if (m_queryStates[objectIndex] == QUERY_PENDING)
+		{
+			m_queryStates[objectIndex] = QUERY_STALE;
+		}
+	}
+}
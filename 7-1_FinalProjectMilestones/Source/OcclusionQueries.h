@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionqueries.h
+// ============
+// occlusion culling with hardware occlusion queries - the results of the
+// queries issued in one frame decide which objects are drawn in the next
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  OcclusionQueries
+ *
+ *  This class owns one occlusion query object per scene
+ *  object.  Results are read with one frame of latency so
+ *  the CPU never waits on the GPU - an object counts as
+ *  hidden only when its query from the previous frame has
+ *  finished and reported that no samples passed.
+ ***********************************************************/
+class OcclusionQueries
+{
+public:
+	// constructor
+	OcclusionQueries();
+	// destructor
+	~OcclusionQueries();
+
+	// create the query objects for the passed in object count
+	void CreateQueries(size_t objectCount);
+	// free the query objects
+	void DestroyQueries();
+
+	// reset the per frame draw counters
+	void BeginFrame();
+	// read the finished results and check whether an object
+	// was proven hidden by its query from the previous frame
+	bool IsObjectHidden(uint32_t objectIndex);
+	// check whether a new query can be issued for an object,
+	// which is false while the previous query is in flight
+	bool CanIssueQuery(uint32_t objectIndex) const;
+	// begin and end the query of an object - everything drawn
+	// in between counts toward the object's visible samples
+	void BeginQuery(uint32_t objectIndex);
+	void EndQuery();
+	// forget the result of an object that was not queried this
+	// frame, so it is drawn again once it comes back into view
+	void ResetObject(uint32_t objectIndex);
+
+	// record that a draw was skipped or issued this frame
+	void CountSkippedDraw() { m_skippedDraws++; }
+	void CountTestedDraw() { m_testedDraws++; }
+
+	// get the draw counters of the current frame
+	int GetSkippedDraws() const { return m_skippedDraws; }
+	int GetTestedDraws() const { return m_testedDraws; }
+
+private:
+	// query result state of one scene object
+	enum QUERY_STATE
+	{
+		QUERY_IDLE = 0,
+		QUERY_PENDING,
+		QUERY_STALE
+	};
+
+	// one query object per scene object
+	std::vector<GLuint> m_queryIDs;
+	// whether a query is in flight for each object
+	std::vector<uint8_t> m_queryStates;
+	// whether the last finished query reported no samples
+	std::vector<uint8_t> m_hiddenFlags;
+	// draws skipped and draws tested in the current frame
+	int m_skippedDraws;
+	int m_testedDraws;
+};
@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendercommandbuffer.cpp
+// ============
+// backend neutral list of render commands - recorded on any thread into
+// preallocated storage and replayed in order on the thread that owns the
+// graphics context, with redundant state changes filtered out
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderCommandBuffer.h"
+
+// declaration of global variables
+namespace
+{
+	// value that no recorded bind uses, so the first bind of a
+	// replay always runs
+	const uint32_t g_UnboundValue = 0xFFFFFFFF;
+}
+
+/***********************************************************
+ *  RenderCommandBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderCommandBuffer::RenderCommandBuffer()
+{
+	m_pCommands = NULL;
+	m_capacity = 0;
+	m_count = 0;
+	m_bOverflowed = false;
+}
+
+/***********************************************************
+ *  SetStorage()
+ *
+ *  This method is used for pointing the buffer at the memory
+ *  the commands are recorded into, which drops the commands
+ *  recorded so far.  The buffer does not own the memory, so
+ *  the recording itself never allocates.
+ ***********************************************************/
+void RenderCommandBuffer::SetStorage(RENDER_COMMAND* pStorage, size_t capacity)
+{
+	m_pCommands = pStorage;
+	m_capacity = (pStorage != NULL) ? capacity : 0;
+	m_count = 0;
+	m_bOverflowed = false;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for dropping the recorded commands
+ *  while keeping the storage for the next frame.
+ ***********************************************************/
+void RenderCommandBuffer::Reset()
+{
+	m_count = 0;
+	m_bOverflowed = false;
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for recording a switch to another
+ *  way of drawing, such as another set of meshes.
+ ***********************************************************/
+bool RenderCommandBuffer::BindPipeline(uint32_t pipeline)
+{
+	return(Record(COMMAND_BIND_PIPELINE, pipeline, 0, 0));
+}
+
+/***********************************************************
+ *  BindMaterial()
+ *
+ *  This method is used for recording the material and the
+ *  texture slot of the next draws, -1 for no texture.
+ ***********************************************************/
+bool RenderCommandBuffer::BindMaterial(int materialIndex, int textureSlot)
+{
+	return(Record(COMMAND_BIND_MATERIAL, (uint32_t)materialIndex, (uint32_t)textureSlot, 0));
+}
+
+/***********************************************************
+ *  SetDrawData()
+ *
+ *  This method is used for recording which per draw values
+ *  the next draws use.
+ ***********************************************************/
+bool RenderCommandBuffer::SetDrawData(uint32_t drawIndex)
+{
+	return(Record(COMMAND_SET_DRAW_DATA, drawIndex, 0, 0));
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for recording the draw of one mesh,
+ *  or of one level of a mesh with several levels.
+ ***********************************************************/
+bool RenderCommandBuffer::Draw(uint32_t mesh, int meshLevel)
+{
+	return(Record(COMMAND_DRAW, mesh, (uint32_t)meshLevel, 0));
+}
+
+/***********************************************************
+ *  DrawIndirect()
+ *
+ *  This method is used for recording a multi-draw call of a
+ *  range of indirect commands.  Ranges that continue each
+ *  other and have the same key are drawn in one call.
+ ***********************************************************/
+bool RenderCommandBuffer::DrawIndirect(uint32_t firstCommand, uint32_t commandCount, uint32_t mergeKey)
+{
+	return(Record(COMMAND_DRAW_INDIRECT, firstCommand, commandCount, mergeKey));
+}
+
+/***********************************************************
+ *  Record()
+ *
+ *  This method is used for adding a command to the reserved
+ *  storage.  A command that does not fit is dropped and the
+ *  buffer is marked, so the caller can hand in more storage
+ *  next time.
+ ***********************************************************/
+bool RenderCommandBuffer::Record(uint32_t type, uint32_t value0, uint32_t value1, uint32_t value2)
+{
+	if (m_count >= m_capacity)
+	{
+		m_bOverflowed = true;
+		return(false);
+	}
+
+	RENDER_COMMAND& command = m_pCommands[m_count++];
+	command.type = type;
+	command.values[0] = value0;
+	command.values[1] = value1;
+	command.values[2] = value2;
+	return(true);
+}
+
+/***********************************************************
+ *  Replay()
+ *
+ *  This method is used for executing the commands of several
+ *  buffers as one list.  The bound pipeline, material and
+ *  draw data are tracked across the buffers, so a bind that
+ *  repeats the current state is skipped.  An indirect draw
+ *  is held back until the next executed command, in case the
+ *  following command continues its range - buffers recorded
+ *  for neighbouring parts of one list then still end up in
+ *  a single call.
+ ***********************************************************/
+void RenderCommandBuffer::Replay(
+	const RenderCommandBuffer* pBuffers,
+	size_t bufferCount,
+	EXECUTE_FUNCTION executeFunction,
+	void* pContext,
+	REPLAY_STATS& stats)
+{
+	uint32_t pipeline = g_UnboundValue;
+	uint32_t materialIndex = g_UnboundValue;
+	uint32_t textureSlot = g_UnboundValue;
+	uint32_t drawIndex = g_UnboundValue;
+	RENDER_COMMAND pendingDraw;
+	bool bPendingDraw = false;
+
+	stats.commandCount = 0;
+	stats.stateChanges = 0;
+	stats.filteredChanges = 0;
+	stats.drawCalls = 0;
+	stats.mergedDraws = 0;
+
+	for (size_t i = 0; i < bufferCount; i++)
+	{
+		const RenderCommandBuffer& buffer = pBuffers[i];
+
+		for (size_t j = 0; j < buffer.m_count; j++)
+		{
+			const RENDER_COMMAND& command = buffer.m_pCommands[j];
+			bool bRedundant = false;
+
+			stats.commandCount++;
+			switch (command.type)
+			{
+			case COMMAND_BIND_PIPELINE:
+				bRedundant = (command.values[0] == pipeline);
+				pipeline = command.values[0];
+				break;
+			case COMMAND_BIND_MATERIAL:
+				bRedundant = (command.values[0] == materialIndex) && (command.values[1] == textureSlot);
+				materialIndex = command.values[0];
+				textureSlot = command.values[1];
+				break;
+			case COMMAND_SET_DRAW_DATA:
+				bRedundant = (command.values[0] == drawIndex);
+				drawIndex = command.values[0];
+				break;
+			case COMMAND_DRAW_INDIRECT:
+				if ((bPendingDraw == true) &&
+					(pendingDraw.values[2] == command.values[2]) &&
+					(pendingDraw.values[0] + pendingDraw.values[1] == command.values[0]))
+				{
+					pendingDraw.values[1] += command.values[1];
+					stats.mergedDraws++;
+					continue;
+				}
+				break;
+			}
+
+			if (bRedundant == true)
+			{
+				stats.filteredChanges++;
+				continue;
+			}
+
+			if (bPendingDraw == true)
+			{
+				executeFunction(pContext, pendingDraw);
+				bPendingDraw = false;
+			}
+
+			if (command.type == COMMAND_DRAW_INDIRECT)
+			{
+				pendingDraw = command;
+				bPendingDraw = true;
+				stats.drawCalls++;
+			}
+			else
+			{
+				if (command.type == COMMAND_DRAW)
+				{
+					stats.drawCalls++;
+				}
+				else
+				{
+					stats.stateChanges++;
+				}
+				executeFunction(pContext, command);
+			}
+		}
+	}
+
+	if (bPendingDraw == true)
+	{
+		executeFunction(pContext, pendingDraw);
+	}
+}
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendercommandbuffer.h
+// ============
+// backend neutral list of render commands - recorded on any thread into
+// preallocated storage and replayed in order on the thread that owns the
+// graphics context, with redundant state changes filtered out
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  RenderCommandBuffer
+ *
+ *  This class contains a list of small fixed size render
+ *  commands.  The storage is handed in up front, so recording
+ *  never allocates memory and several job threads can each
+ *  fill their own buffer at the same time, such as in the
+ *  frame arena of each thread.  The commands
+ *  only hold indices and counts - what a pipeline, material
+ *  or mesh stands for is up to the function that executes
+ *  them, which is the only code that talks to the graphics
+ *  API.  Replay() walks a set of buffers as one merged list.
+ ***********************************************************/
+class RenderCommandBuffer
+{
+public:
+	// constructor
+	RenderCommandBuffer();
+
+	// kinds of commands
+	enum COMMAND_TYPE
+	{
+		// values[0] - pipeline
+		COMMAND_BIND_PIPELINE = 0,
+		// values[0] - material index, values[1] - texture slot
+		COMMAND_BIND_MATERIAL,
+		// values[0] - index of the per draw values
+		COMMAND_SET_DRAW_DATA,
+		// values[0] - mesh, values[1] - mesh level
+		COMMAND_DRAW,
+		// values[0] - first indirect command, values[1] - command
+		// count, values[2] - key that must match to merge calls
+		COMMAND_DRAW_INDIRECT
+	};
+
+	// one recorded command, signed values are stored as their
+	// two's complement bits
+	struct RENDER_COMMAND
+	{
+		uint32_t type;
+		uint32_t values[3];
+	};
+
+	// commands seen and executed by a replay
+	struct REPLAY_STATS
+	{
+		uint32_t commandCount;
+		uint32_t stateChanges;
+		uint32_t filteredChanges;
+		uint32_t drawCalls;
+		uint32_t mergedDraws;
+	};
+
+	// function that executes one command on the graphics thread
+	typedef void (*EXECUTE_FUNCTION)(void* pContext, const RENDER_COMMAND& command);
+
+	// record into the passed in storage from now on, which has
+	// to stay valid until the commands are replayed
+	void SetStorage(RENDER_COMMAND* pStorage, size_t capacity);
+	// drop the recorded commands and keep the storage
+	void Reset();
+
+	// record the commands, false when the buffer is full
+	bool BindPipeline(uint32_t pipeline);
+	bool BindMaterial(int materialIndex, int textureSlot);
+	bool SetDrawData(uint32_t drawIndex);
+	bool Draw(uint32_t mesh, int meshLevel);
+	bool DrawIndirect(uint32_t firstCommand, uint32_t commandCount, uint32_t mergeKey);
+
+	// number of recorded commands
+	size_t GetCount() const { return m_count; }
+	const RENDER_COMMAND* GetCommands() const { return m_pCommands; }
+	// whether a command did not fit since the last reset
+	bool HasOverflowed() const { return m_bOverflowed; }
+
+	// execute the commands of the buffers in order, skipping
+	// binds of the pipeline, material or draw data that is
+	// already bound and merging indirect draws of consecutive
+	// commands with the same key into one call
+	static void Replay(
+		const RenderCommandBuffer* pBuffers,
+		size_t bufferCount,
+		EXECUTE_FUNCTION executeFunction,
+		void* pContext,
+		REPLAY_STATS& stats);
+
+private:
+	RENDER_COMMAND* m_pCommands;
+	size_t m_capacity;
+	size_t m_count;
+	bool m_bOverflowed;
+
+	// add one command if it fits
+	bool Record(uint32_t type, uint32_t value0, uint32_t value1, uint32_t value2);
+};
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenecomponents.h
+// ============
+// entity handles and the components that the scene objects and lights are
+// made of
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+// an entity is an index into the registry's slots in the low
+// bits and the generation of the slot in the high bits, so a
+// handle kept after the entity is destroyed no longer matches
+typedef uint32_t ENTITY;
+
+const ENTITY NULL_ENTITY = 0xFFFFFFFF;
+const uint32_t ENTITY_INDEX_BITS = 24;
+const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+// basic shape meshes the scene objects are drawn with
+enum SCENE_MESH
+{
+	MESH_PLANE = 0,
+	MESH_BOX,
+	MESH_CYLINDER
+};
+
+// light source types supported by the shaders
+enum LIGHT_TYPE
+{
+	LIGHT_DIRECTIONAL = 0,
+	LIGHT_POINT
+};
+
+// transformation values relative to the parent entity, and
+// the model matrix they produce
+struct TRANSFORM_COMPONENT
+{
+	glm::vec3 scaleXYZ;
+	glm::vec3 rotationDegrees;
+	glm::vec3 positionXYZ;
+	ENTITY parent;
+	// node of the entity in the transform hierarchy
+	uint32_t transformIndex;
+	glm::mat4 modelMatrix;
+};
+
+// mesh an entity is drawn with, and its slot in the culling
+// and draw arrays that are indexed per drawn object
+struct MESH_COMPONENT
+{
+	SCENE_MESH mesh;
+	// large objects drawn first that hide the objects behind them
+	bool bOccluder;
+	uint32_t renderIndex;
+};
+
+// color and lighting material, the index is resolved from the tag
+struct MATERIAL_COMPONENT
+{
+	glm::vec4 color;
+	std::string materialTag;
+	int materialIndex;
+};
+
+// texture, the slot is resolved from the tag
+struct TEXTURE_COMPONENT
+{
+	std::string textureTag;
+	int textureSlot;
+};
+
+// local space bounds of the mesh, the world space box is kept
+// by the culling at the entity's render index
+struct BOUNDS_COMPONENT
+{
+	glm::vec3 localMin;
+	glm::vec3 localMax;
+};
+
+// light source values sent to the shaders
+struct LIGHT_COMPONENT
+{
+	LIGHT_TYPE type;
+	// position of a point light, direction of a directional one
+	glm::vec3 position;
+	glm::vec3 direction;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+};
@@ -0,0 +1,692 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// scene descriptions - the textures, materials, lights and objects of a scene
+// written as text for authoring, and compiled into a flat binary image that
+// is used in place straight from a memory mapped file
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+#include "SceneComponents.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// the records are read straight from the image, so their
+// layout must not depend on the compiler
+static_assert(sizeof(SceneFile::HEADER) == 52, "scene header layout changed");
+static_assert(sizeof(SceneFile::TEXTURE) == 12, "scene texture layout changed");
+static_assert(sizeof(SceneFile::MATERIAL) == 32, "scene material layout changed");
+static_assert(sizeof(SceneFile::LIGHT) == 64, "scene light layout changed");
+static_assert(sizeof(SceneFile::OBJECT) == 76, "scene object layout changed");
+
+// declaration of global variables
+namespace
+{
+	// first bytes of a compiled scene, "SCNE" in file order
+	const uint32_t g_SceneMagic = 0x454E4353;
+	// raised whenever a record of the compiled layout changes
+	const uint32_t g_SceneVersion = 2;
+
+	// names of the SCENE_MESH and LIGHT_TYPE values in the text
+	const char* g_MeshNames[] = { "plane", "box", "cylinder" };
+	const char* g_LightTypeNames[] = { "directional", "point" };
+
+	/***********************************************************
+	 *  FindName()
+	 *
+	 *  This function is used for getting the index of a name
+	 *  in a list, or -1 when it is not in the list.
+	 ***********************************************************/
+	int FindName(const std::vector<std::string>& names, const std::string& name)
+	{
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			if (names[i] == name)
+			{
+				return((int)i);
+			}
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  ReadValues()
+	 *
+	 *  This function is used for reading the numbers that
+	 *  follow a keyword of an entry, moving the token index
+	 *  past them.
+	 ***********************************************************/
+	bool ReadValues(const std::vector<std::string>& tokens, size_t& index, float* values, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			index++;
+			if (index >= tokens.size())
+			{
+				return(false);
+			}
+
+			const char* pToken = tokens[index].c_str();
+			char* pEnd = NULL;
+			values[i] = strtof(pToken, &pEnd);
+			if ((pEnd == pToken) || (*pEnd != '\0'))
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadWord()
+	 *
+	 *  This function is used for reading the word that follows
+	 *  a keyword of an entry, moving the token index past it.
+	 ***********************************************************/
+	bool ReadWord(const std::vector<std::string>& tokens, size_t& index, std::string& word)
+	{
+		index++;
+		if (index >= tokens.size())
+		{
+			return(false);
+		}
+		word = tokens[index];
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AddString()
+	 *
+	 *  This function is used for appending a string to the
+	 *  string table and getting its offset.
+	 ***********************************************************/
+	uint32_t AddString(std::vector<char>& strings, const std::string& text)
+	{
+		if (text.empty() == true)
+		{
+			return(0);
+		}
+
+		uint32_t offset = (uint32_t)strings.size();
+		strings.insert(strings.end(), text.begin(), text.end());
+		strings.push_back('\0');
+		return(offset);
+	}
+
+	/***********************************************************
+	 *  IsRangeValid()
+	 *
+	 *  This function is used for checking that an array of
+	 *  records lies inside the image and is aligned for them.
+	 ***********************************************************/
+	bool IsRangeValid(uint32_t offset, uint32_t count, size_t recordSize, size_t imageSize)
+	{
+		return(((offset % 4) == 0) &&
+			((uint64_t)offset + (uint64_t)count * recordSize <= (uint64_t)imageSize));
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pImage = NULL;
+	m_imageSize = 0;
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjects = NULL;
+	m_pStrings = NULL;
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for opening a scene.  The file is
+ *  mapped either way, and a compiled scene is used from the
+ *  mapping as it is, while text is compiled into memory and
+ *  the mapping dropped.
+ ***********************************************************/
+bool SceneFile::Open(const char* filename)
+{
+	Close();
+
+	if (m_mappedFile.Open(filename) == false)
+	{
+		std::cout << "ERROR: Could not open scene file " << filename << std::endl;
+		return(false);
+	}
+
+	uint32_t magic = 0;
+	if (m_mappedFile.GetSize() >= sizeof(magic))
+	{
+		memcpy(&magic, m_mappedFile.GetData(), sizeof(magic));
+	}
+
+	if (magic == g_SceneMagic)
+	{
+		if (UseImage(m_mappedFile.GetData(), m_mappedFile.GetSize(), filename) == false)
+		{
+			Close();
+			return(false);
+		}
+	}
+	else
+	{
+		bool bCompiled = Compile((const char*)m_mappedFile.GetData(), m_mappedFile.GetSize(),
+			filename, m_compiledImage);
+		m_mappedFile.Close();
+		if ((bCompiled == false) ||
+			(UseImage(m_compiledImage.data(), m_compiledImage.size(), filename) == false))
+		{
+			Close();
+			return(false);
+		}
+	}
+
+	std::cout << "INFO: Loaded scene " << filename << " - " << GetObjectCount() << " objects, "
+		<< GetLightCount() << " lights, " << GetTextureCount() << " textures" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  OpenImage()
+ *
+ *  This method is used for using a compiled image that the
+ *  caller keeps in memory, which is checked like a mapped
+ *  one but not copied.
+ ***********************************************************/
+bool SceneFile::OpenImage(const uint8_t* pImage, size_t imageSize, const char* sourceName)
+{
+	Close();
+
+	if (UseImage(pImage, imageSize, sourceName) == false)
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Loaded scene " << sourceName << " - " << GetObjectCount() << " objects, "
+		<< GetLightCount() << " lights, " << GetTextureCount() << " textures" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for dropping the open scene.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_mappedFile.Close();
+	m_compiledImage.clear();
+	m_compiledImage.shrink_to_fit();
+	m_pImage = NULL;
+	m_imageSize = 0;
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjects = NULL;
+	m_pStrings = NULL;
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method is used for writing the compiled image of
+ *  the open scene, which can then be opened without being
+ *  compiled again.
+ ***********************************************************/
+bool SceneFile::Save(const char* filename) const
+{
+	if (IsOpen() == false)
+	{
+		return(false);
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR: Could not create scene file " << filename << std::endl;
+		return(false);
+	}
+
+	file.write((const char*)m_pImage, (std::streamsize)m_imageSize);
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write scene file " << filename << std::endl;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for turning the text of a scene into
+ *  its binary image.  The entries are checked as they are
+ *  read, and the first error is reported with its line.
+ ***********************************************************/
+bool SceneFile::Compile(
+	const char* pText,
+	size_t textSize,
+	const char* sourceName,
+	std::vector<uint8_t>& image)
+{
+	std::vector<TEXTURE> textures;
+	std::vector<MATERIAL> materials;
+	std::vector<LIGHT> lights;
+	std::vector<OBJECT> objects;
+	std::vector<std::string> textureTags;
+	std::vector<std::string> materialTags;
+	std::vector<std::string> objectNames;
+	// offset 0 is the empty string
+	std::vector<char> strings(1, '\0');
+
+	size_t lineStart = 0;
+	int lineNumber = 0;
+	while (lineStart < textSize)
+	{
+		size_t lineEnd = lineStart;
+		while ((lineEnd < textSize) && (pText[lineEnd] != '\n'))
+		{
+			lineEnd++;
+		}
+		std::string line(pText + lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::vector<std::string> tokens;
+		std::istringstream lineStream(line);
+		std::string token;
+		while (lineStream >> token)
+		{
+			tokens.push_back(token);
+		}
+		if (tokens.empty() == true)
+		{
+			continue;
+		}
+
+		const std::string& keyword = tokens[0];
+		std::string error;
+		size_t index = 1;
+
+		if (keyword == "texture")
+		{
+			if ((tokens.size() < 3) || (tokens.size() > 4) ||
+				((tokens.size() == 4) && (tokens[3] != "preload")))
+			{
+				error = "texture needs a tag and a file, and can only be marked preload";
+			}
+			else if (FindName(textureTags, tokens[1]) >= 0)
+			{
+				error = "texture " + tokens[1] + " is defined twice";
+			}
+			else
+			{
+				TEXTURE texture;
+				texture.tag = AddString(strings, tokens[1]);
+				texture.filename = AddString(strings, tokens[2]);
+				texture.flags = (tokens.size() == 4) ? TEXTURE_PRELOAD : 0;
+				textures.push_back(texture);
+				textureTags.push_back(tokens[1]);
+			}
+		}
+		else if (keyword == "material")
+		{
+			MATERIAL material;
+			memset(&material, 0, sizeof(material));
+
+			if (tokens.size() < 2)
+			{
+				error = "material needs a tag";
+			}
+			else if (FindName(materialTags, tokens[1]) >= 0)
+			{
+				error = "material " + tokens[1] + " is defined twice";
+			}
+			while ((error.empty() == true) && (++index < tokens.size()))
+			{
+				const std::string& key = tokens[index];
+				bool bRead = false;
+				if (key == "diffuse")
+					bRead = ReadValues(tokens, index, material.diffuseColor, 3);
+				else if (key == "specular")
+					bRead = ReadValues(tokens, index, material.specularColor, 3);
+				else if (key == "shininess")
+					bRead = ReadValues(tokens, index, &material.shininess, 1);
+
+				if (bRead == false)
+				{
+					error = "bad material value " + key;
+				}
+			}
+			if (error.empty() == true)
+			{
+				material.tag = AddString(strings, tokens[1]);
+				materials.push_back(material);
+				materialTags.push_back(tokens[1]);
+			}
+		}
+		else if (keyword == "light")
+		{
+			LIGHT light;
+			memset(&light, 0, sizeof(light));
+			light.direction[1] = -1.0f;
+
+			if ((tokens.size() >= 2) && (tokens[1] == g_LightTypeNames[LIGHT_DIRECTIONAL]))
+				light.type = LIGHT_DIRECTIONAL;
+			else if ((tokens.size() >= 2) && (tokens[1] == g_LightTypeNames[LIGHT_POINT]))
+				light.type = LIGHT_POINT;
+			else
+				error = "light needs a type of directional or point";
+
+			while ((error.empty() == true) && (++index < tokens.size()))
+			{
+				const std::string& key = tokens[index];
+				bool bRead = false;
+				if (key == "position")
+					bRead = ReadValues(tokens, index, light.position, 3);
+				else if (key == "direction")
+					bRead = ReadValues(tokens, index, light.direction, 3);
+				else if (key == "ambient")
+					bRead = ReadValues(tokens, index, light.ambient, 3);
+				else if (key == "diffuse")
+					bRead = ReadValues(tokens, index, light.diffuse, 3);
+				else if (key == "specular")
+					bRead = ReadValues(tokens, index, light.specular, 3);
+
+				if (bRead == false)
+				{
+					error = "bad light value " + key;
+				}
+			}
+			if (error.empty() == true)
+			{
+				lights.push_back(light);
+			}
+		}
+		else if (keyword == "object")
+		{
+			OBJECT object;
+			memset(&object, 0, sizeof(object));
+			object.parent = NO_INDEX;
+			object.texture = NO_INDEX;
+			object.material = NO_INDEX;
+			for (int i = 0; i < 3; i++)
+			{
+				object.scale[i] = 1.0f;
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				object.color[i] = 1.0f;
+			}
+
+			int mesh = -1;
+			for (int i = 0; (tokens.size() >= 3) && (i <= MESH_CYLINDER); i++)
+			{
+				if (tokens[2] == g_MeshNames[i])
+				{
+					mesh = i;
+				}
+			}
+
+			if (mesh < 0)
+			{
+				error = "object needs a name, or -, and a mesh of plane, box or cylinder";
+			}
+			else if ((tokens[1] != "-") && (FindName(objectNames, tokens[1]) >= 0))
+			{
+				error = "object " + tokens[1] + " is defined twice";
+			}
+			object.mesh = (uint32_t)mesh;
+
+			index = 2;
+			while ((error.empty() == true) && (++index < tokens.size()))
+			{
+				const std::string& key = tokens[index];
+				std::string word;
+				bool bRead = false;
+				if (key == "scale")
+					bRead = ReadValues(tokens, index, object.scale, 3);
+				else if (key == "rotation")
+					bRead = ReadValues(tokens, index, object.rotationDegrees, 3);
+				else if (key == "position")
+					bRead = ReadValues(tokens, index, object.position, 3);
+				else if (key == "color")
+					bRead = ReadValues(tokens, index, object.color, 4);
+				else if (key == "texture")
+				{
+					bRead = ReadWord(tokens, index, word);
+					object.texture = FindName(textureTags, word);
+					bRead = bRead && (object.texture != NO_INDEX);
+				}
+				else if (key == "material")
+				{
+					bRead = ReadWord(tokens, index, word);
+					object.material = FindName(materialTags, word);
+					bRead = bRead && (object.material != NO_INDEX);
+				}
+				else if (key == "parent")
+				{
+					bRead = ReadWord(tokens, index, word);
+					object.parent = FindName(objectNames, word);
+					bRead = bRead && (word != "-") && (object.parent != NO_INDEX);
+				}
+				else if (key == "occluder")
+				{
+					object.flags |= OBJECT_OCCLUDER;
+					bRead = true;
+				}
+				else if (key == "skyfallback")
+				{
+					object.flags |= OBJECT_SKY_FALLBACK;
+					bRead = true;
+				}
+
+				if (bRead == false)
+				{
+					error = "bad object value " + key;
+					if (word.empty() == false)
+					{
+						error += " " + word + ", which has to be defined above";
+					}
+				}
+			}
+			if (error.empty() == true)
+			{
+				object.name = (tokens[1] != "-") ? AddString(strings, tokens[1]) : 0;
+				objects.push_back(object);
+				objectNames.push_back(tokens[1]);
+			}
+		}
+		else
+		{
+			error = "unknown entry " + keyword;
+		}
+
+		if (error.empty() == false)
+		{
+			std::cout << "ERROR: " << sourceName << "(" << lineNumber << "): " << error << std::endl;
+			return(false);
+		}
+	}
+
+	// the string table ends the image, padded so the size
+	// stays a multiple of the record alignment
+	while ((strings.size() % 4) != 0)
+	{
+		strings.push_back('\0');
+	}
+
+	HEADER header;
+	header.magic = g_SceneMagic;
+	header.version = g_SceneVersion;
+	header.textureCount = (uint32_t)textures.size();
+	header.materialCount = (uint32_t)materials.size();
+	header.lightCount = (uint32_t)lights.size();
+	header.objectCount = (uint32_t)objects.size();
+	header.textureOffset = (uint32_t)sizeof(HEADER);
+	header.materialOffset = header.textureOffset + header.textureCount * (uint32_t)sizeof(TEXTURE);
+	header.lightOffset = header.materialOffset + header.materialCount * (uint32_t)sizeof(MATERIAL);
+	header.objectOffset = header.lightOffset + header.lightCount * (uint32_t)sizeof(LIGHT);
+	header.stringOffset = header.objectOffset + header.objectCount * (uint32_t)sizeof(OBJECT);
+	header.stringSize = (uint32_t)strings.size();
+	header.imageSize = header.stringOffset + header.stringSize;
+
+	image.assign(header.imageSize, 0);
+	memcpy(image.data(), &header, sizeof(header));
+	if (textures.empty() == false)
+	{
+		memcpy(image.data() + header.textureOffset, textures.data(), textures.size() * sizeof(TEXTURE));
+	}
+	if (materials.empty() == false)
+	{
+		memcpy(image.data() + header.materialOffset, materials.data(), materials.size() * sizeof(MATERIAL));
+	}
+	if (lights.empty() == false)
+	{
+		memcpy(image.data() + header.lightOffset, lights.data(), lights.size() * sizeof(LIGHT));
+	}
+	if (objects.empty() == false)
+	{
+		memcpy(image.data() + header.objectOffset, objects.data(), objects.size() * sizeof(OBJECT));
+	}
+	memcpy(image.data() + header.stringOffset, strings.data(), strings.size());
+
+	return(true);
+}
+
+/***********************************************************
+ *  UseImage()
+ *
+ *  This method is used for checking a compiled image before
+ *  its records are used in place.  Every array has to lie
+ *  inside the image, every string offset inside the string
+ *  table, and every index has to refer to an existing
+ *  record, so the records can be read without checks later.
+ ***********************************************************/
+bool SceneFile::UseImage(const uint8_t* pImage, size_t imageSize, const char* sourceName)
+{
+	bool bValid = false;
+	const HEADER* pHeader = (const HEADER*)pImage;
+
+	if ((imageSize >= sizeof(HEADER)) &&
+		(pHeader->magic == g_SceneMagic) &&
+		(pHeader->version == g_SceneVersion) &&
+		(pHeader->imageSize == imageSize) &&
+		IsRangeValid(pHeader->textureOffset, pHeader->textureCount, sizeof(TEXTURE), imageSize) &&
+		IsRangeValid(pHeader->materialOffset, pHeader->materialCount, sizeof(MATERIAL), imageSize) &&
+		IsRangeValid(pHeader->lightOffset, pHeader->lightCount, sizeof(LIGHT), imageSize) &&
+		IsRangeValid(pHeader->objectOffset, pHeader->objectCount, sizeof(OBJECT), imageSize) &&
+		IsRangeValid(pHeader->stringOffset, pHeader->stringSize, 1, imageSize) &&
+		(pHeader->stringSize > 0) &&
+		(pImage[pHeader->stringOffset] == '\0') &&
+		(pImage[pHeader->stringOffset + pHeader->stringSize - 1] == '\0'))
+	{
+		const TEXTURE* pTextures = (const TEXTURE*)(pImage + pHeader->textureOffset);
+		const MATERIAL* pMaterials = (const MATERIAL*)(pImage + pHeader->materialOffset);
+		const LIGHT* pLights = (const LIGHT*)(pImage + pHeader->lightOffset);
+		const OBJECT* pObjects = (const OBJECT*)(pImage + pHeader->objectOffset);
+		uint32_t stringSize = pHeader->stringSize;
+
+		bValid = true;
+		for (uint32_t i = 0; (i < pHeader->textureCount) && (bValid == true); i++)
+		{
+			bValid = (pTextures[i].tag < stringSize) && (pTextures[i].filename < stringSize);
+		}
+		for (uint32_t i = 0; (i < pHeader->materialCount) && (bValid == true); i++)
+		{
+			bValid = (pMaterials[i].tag < stringSize);
+		}
+		for (uint32_t i = 0; (i < pHeader->lightCount) && (bValid == true); i++)
+		{
+			bValid = (pLights[i].type <= LIGHT_POINT);
+		}
+		for (uint32_t i = 0; (i < pHeader->objectCount) && (bValid == true); i++)
+		{
+			const OBJECT& object = pObjects[i];
+			bValid = (object.name < stringSize) &&
+				(object.mesh <= MESH_CYLINDER) &&
+				(object.parent >= NO_INDEX) && (object.parent < (int32_t)i) &&
+				(object.texture >= NO_INDEX) && (object.texture < (int32_t)pHeader->textureCount) &&
+				(object.material >= NO_INDEX) && (object.material < (int32_t)pHeader->materialCount);
+		}
+	}
+
+	if (bValid == false)
+	{
+		std::cout << "ERROR: Scene file " << sourceName << " is damaged or from another version" << std::endl;
+		return(false);
+	}
+
+	m_pImage = pImage;
+	m_imageSize = imageSize;
+	m_pHeader = pHeader;
+	m_pTextures = (const TEXTURE*)(pImage + pHeader->textureOffset);
+	m_pMaterials = (const MATERIAL*)(pImage + pHeader->materialOffset);
+	m_pLights = (const LIGHT*)(pImage + pHeader->lightOffset);
+	m_pObjects = (const OBJECT*)(pImage + pHeader->objectOffset);
+	m_pStrings = (const char*)(pImage + pHeader->stringOffset);
+	return(true);
+}
+
+/***********************************************************
+ *  GetTextureCount()
+ *
+ *  This method is used for getting the number of textures
+ *  of the open scene.
+ ***********************************************************/
+uint32_t SceneFile::GetTextureCount() const
+{
+	return((m_pHeader != NULL) ? m_pHeader->textureCount : 0);
+}
+
+/***********************************************************
+ *  GetMaterialCount()
+ *
+ *  This method is used for getting the number of materials
+ *  of the open scene.
+ ***********************************************************/
+uint32_t SceneFile::GetMaterialCount() const
+{
+	return((m_pHeader != NULL) ? m_pHeader->materialCount : 0);
+}
+
+/***********************************************************
+ *  GetLightCount()
+ *
+ *  This method is used for getting the number of lights of
+ *  the open scene.
+ ***********************************************************/
+uint32_t SceneFile::GetLightCount() const
+{
+	return((m_pHeader != NULL) ? m_pHeader->lightCount : 0);
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of objects of
+ *  the open scene.
+ ***********************************************************/
+uint32_t SceneFile::GetObjectCount() const
+{
+	return((m_pHeader != NULL) ? m_pHeader->objectCount : 0);
+}
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// scene descriptions - the textures, materials, lights and objects of a scene
+// written as text for authoring, and compiled into a flat binary image that
+// is used in place straight from a memory mapped file
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class opens a scene description.  A compiled scene
+ *  is mapped and its records are read where they lie in the
+ *  file, after their counts and offsets are checked.  A
+ *  text scene is compiled into the same image in memory
+ *  first, so both are read the same way.
+ *
+ *  The text has one entry per line, and # starts a comment:
+ *
+ *    texture <tag> <file> [preload]
+ *    material <tag> [diffuse r g b] [specular r g b]
+ *        [shininess s]
+ *    light <directional|point> [position x y z]
+ *        [direction x y z] [ambient r g b] [diffuse r g b]
+ *        [specular r g b]
+ *    object <name|-> <plane|box|cylinder> [scale x y z]
+ *        [rotation x y z] [position x y z] [color r g b a]
+ *        [texture tag] [material tag] [parent name]
+ *        [occluder] [skyfallback]
+ *
+ *  Tags, names and files cannot contain spaces.  Textures,
+ *  materials and parents are referenced by the entries
+ *  above them, so the compiled records refer to each other
+ *  by index.  An object with a parent is placed relative to
+ *  it, and a skyfallback object is only added when the sky
+ *  is not drawn in a pass of its own.  Textures are loaded
+ *  when an object first draws with them, except for the
+ *  preload ones that are ready before the first frame.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// index value of a record that refers to nothing
+	static const int32_t NO_INDEX = -1;
+
+	// object flags
+	enum OBJECT_FLAGS
+	{
+		// large object drawn first that hides the ones behind it
+		OBJECT_OCCLUDER = 1,
+		// only added when the sky pass is not available
+		OBJECT_SKY_FALLBACK = 2
+	};
+
+	// texture flags
+	enum TEXTURE_FLAGS
+	{
+		// loaded while the scene is prepared
+		TEXTURE_PRELOAD = 1
+	};
+
+	// the compiled image starts with the header, followed by
+	// the record arrays and the string table - every field is
+	// four bytes in the byte order of the machine, so the
+	// records need no padding or conversion
+	struct HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t imageSize;
+		uint32_t textureCount;
+		uint32_t textureOffset;
+		uint32_t materialCount;
+		uint32_t materialOffset;
+		uint32_t lightCount;
+		uint32_t lightOffset;
+		uint32_t objectCount;
+		uint32_t objectOffset;
+		uint32_t stringOffset;
+		uint32_t stringSize;
+	};
+
+	// strings are offsets into the string table, where offset
+	// 0 is the empty string
+	struct TEXTURE
+	{
+		uint32_t tag;
+		uint32_t filename;
+		uint32_t flags;
+	};
+
+	struct MATERIAL
+	{
+		uint32_t tag;
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+	};
+
+	struct LIGHT
+	{
+		// LIGHT_TYPE value
+		uint32_t type;
+		float position[3];
+		float direction[3];
+		float ambient[3];
+		float diffuse[3];
+		float specular[3];
+	};
+
+	struct OBJECT
+	{
+		uint32_t name;
+		// SCENE_MESH value
+		uint32_t mesh;
+		uint32_t flags;
+		// indices of an earlier object, a texture and a material
+		int32_t parent;
+		int32_t texture;
+		int32_t material;
+		float scale[3];
+		float rotationDegrees[3];
+		float position[3];
+		float color[4];
+	};
+
+	// constructor
+	SceneFile();
+
+	// open a compiled or text scene, false when it is missing
+	// or not valid, which is reported
+	bool Open(const char* filename);
+	// use a compiled image kept in memory by the caller, such
+	// as the scene of an asset pack, while it stays there
+	bool OpenImage(const uint8_t* pImage, size_t imageSize, const char* sourceName);
+	// drop the scene, the records are no longer valid
+	void Close();
+	// write the compiled image of the open scene
+	bool Save(const char* filename) const;
+
+	// compile the text of a scene into its binary image, the
+	// name is used in the error messages
+	static bool Compile(
+		const char* pText,
+		size_t textSize,
+		const char* sourceName,
+		std::vector<uint8_t>& image);
+
+	bool IsOpen() const { return m_pHeader != NULL; }
+	// compiled image of the open scene
+	const uint8_t* GetImage() const { return m_pImage; }
+	size_t GetImageSize() const { return m_imageSize; }
+
+	// records of the open scene, the counts are 0 when no
+	// scene is open
+	uint32_t GetTextureCount() const;
+	uint32_t GetMaterialCount() const;
+	uint32_t GetLightCount() const;
+	uint32_t GetObjectCount() const;
+	const TEXTURE& GetTexture(uint32_t index) const { return m_pTextures[index]; }
+	const MATERIAL& GetMaterial(uint32_t index) const { return m_pMaterials[index]; }
+	const LIGHT& GetLight(uint32_t index) const { return m_pLights[index]; }
+	const OBJECT& GetSceneObject(uint32_t index) const { return m_pObjects[index]; }
+	// string at an offset taken from a record
+	const char* GetString(uint32_t offset) const { return m_pStrings + offset; }
+
+private:
+	// mapping of a compiled scene
+	MappedFile m_mappedFile;
+	// image of a text scene compiled when it was opened
+	std::vector<uint8_t> m_compiledImage;
+	// image the records are read from, in one of the above
+	const uint8_t* m_pImage;
+	size_t m_imageSize;
+	const HEADER* m_pHeader;
+	const TEXTURE* m_pTextures;
+	const MATERIAL* m_pMaterials;
+	const LIGHT* m_pLights;
+	const OBJECT* m_pObjects;
+	const char* m_pStrings;
+
+	// check an image and point the records into it
+	bool UseImage(const uint8_t* pImage, size_t imageSize, const char* sourceName);
+};
@@ -0,0 +1,3119 @@
+﻿///////////////////////////////////////////////////////////////////////////////
+// scenemanager.cpp
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UseTextureName = "bUseTexture";
+	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UsePackedNormalName = "bUsePackedNormal";
+	const char* g_UseDrawDataName = "bUseDrawData";
+
+	// buffer bindings and limits shared with the shaders
+	const GLuint g_DrawDataBinding = 0;
+	const GLuint g_MaterialBinding = 1;
+	const int g_DrawTextureCount = 8;
+	const uint32_t g_DrawFlagPackedNormal = 1;
+	// frames the CPU may write ahead of the GPU
+	const int g_FramesInFlight = 3;
+	// point lights the fragment shader has uniforms for
+	const int g_MaxPointLights = 5;
+	// texture slots the loaded textures can be bound to
+	const int g_TextureSlotCount = 16;
+	// smallest number of objects handled by one job
+	const uint32_t g_MinObjectsPerJob = 256;
+	// most frames the update thread may build ahead
+	const int g_MaxFrameQueueDepth = 3;
+	// frames between the frame rate and latency reports
+	const int g_StatsReportFrames = 600;
+	// draws recorded into each render command buffer, and the
+	// most commands they take - a pipeline bind plus a material
+	// bind, draw data and draw for every draw
+	const uint32_t g_DrawsPerCommandBuffer = 256;
+	const size_t g_CommandBufferCapacity = g_DrawsPerCommandBuffer * 3 + 1;
+	// pipeline value before the first replayed bind
+	const uint32_t g_NoPipeline = 0xFFFFFFFF;
+	// scene loaded when no other scene file is set
+	const char* g_DefaultSceneFile = "scenes/patio.scene";
+	// largest texture accepted from an asset pack
+	const uint32_t g_MaxPackedTextureSize = 16384;
+	// textures uploaded per frame once they are decoded
+	const int g_TextureUploadsPerFrame = 2;
+	// color of the texture drawn until a texture is loaded
+	const unsigned char g_PlaceholderColor[4] = { 128, 128, 128, 255 };
+
+	/***********************************************************
+	 *  TakeMilliseconds()
+	 *
+	 *  This function is used for timing stages that follow
+	 *  each other - it returns the time since the start and
+	 *  moves the start to now for the next stage.
+	 ***********************************************************/
+	double TakeMilliseconds(std::chrono::steady_clock::time_point& start)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double milliseconds = std::chrono::duration<double, std::milli>(now - start).count();
+		start = now;
+		return(milliseconds);
+	}
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager *pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_basicMeshes = new ShapeMeshes();
+	m_loadedTextures = 0;
+	m_placeholderTexture = 0;
+	m_bPreloadAssets = false;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_frameSettings.view = glm::mat4(1.0f);
+	m_frameSettings.projection = glm::mat4(1.0f);
+	m_frameSettings.bOcclusionQueries = false;
+	m_frameSettings.bSoftwareOcclusion = false;
+	m_frameSettings.bMeshLOD = true;
+	m_frameSettings.bMultiDraw = true;
+	m_frameSettings.bGpuCulling = false;
+	m_pipelineSettings = m_frameSettings;
+	m_frameQueueDepth = 2;
+	m_statsStart = std::chrono::steady_clock::now();
+	m_statsFrames = 0;
+	m_statsLatencyTotal = 0.0;
+	m_statsLatencyMax = 0.0;
+	m_statsArenaGrowth = 0;
+	m_statsReports = 0;
+	m_bOcclusionQueries = false;
+	m_bSoftwareOcclusion = false;
+	m_bMeshLOD = true;
+	m_lodTriangles = 0;
+	m_frameProfile = FRAME_PROFILE();
+	m_sceneCopies = 1;
+	m_copySpacing = 0.0f;
+	m_materialBuffer = 0;
+	m_drawIndexLocation = -1;
+	m_bDrawDataActive = false;
+	m_bReportedDrawDataFull = false;
+	m_bIndirectCommands = false;
+	m_bMultiDraw = true;
+	m_pReplayPacket = NULL;
+	m_replayFirstDraw = 0;
+	m_replayCommandStart = 0;
+	m_replayPipeline = g_NoPipeline;
+	m_bReplayPackedNormal = false;
+	m_replayStats = RenderCommandBuffer::REPLAY_STATS();
+	m_bGpuCulling = false;
+	// the first frame sends the lights even without any, which
+	// switches off the ones the shaders start with
+	m_lightsVersion = 1;
+	m_appliedLightsVersion = 0;
+	m_uniforms = UNIFORM_LOCATIONS();
+	m_directionalLightUniforms = LIGHT_UNIFORMS();
+	m_hiZCuller.SetJobSystem(&m_jobSystem);
+	m_sceneFileName = g_DefaultSceneFile;
+	for (int mesh = MESH_PLANE; mesh <= MESH_CYLINDER; mesh++)
+	{
+		GetMeshBounds((SCENE_MESH)mesh, m_meshBounds[mesh].localMin, m_meshBounds[mesh].localMax);
+		m_bBasicMeshLoaded[mesh] = false;
+	}
+	m_assetLoader.SetLoadFunction(&SceneManager::LoadTextureAsset, this);
+
+	// the packet built on the render thread uses the last set
+	// of arenas, after the ones of the pipelined packet slots -
+	// every slot of the job system has its own arena, as the
+	// registered update thread runs jobs too
+	int slotCount = m_jobSystem.GetSlotCount();
+	m_frameArenas.resize((g_MaxFrameQueueDepth + 1) * slotCount);
+	m_serialPacket.pArenas = &m_frameArenas[g_MaxFrameQueueDepth * slotCount];
+	m_serialPacket.arenaGrowth = 0;
+	m_serialPacket.profile = FRAME_PROFILE();
+	m_serialPacket.lightsVersion = 0;
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// the update thread reads the scene until it is stopped
+	m_framePipeline.Stop();
+	// the loader thread reads the texture assets and the pack
+	m_assetLoader.Stop();
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		if (m_textureAssets[i].pImage != NULL)
+		{
+			stbi_image_free(m_textureAssets[i].pImage);
+			m_textureAssets[i].pImage = NULL;
+		}
+	}
+	if (m_placeholderTexture != 0)
+	{
+		glDeleteTextures(1, &m_placeholderTexture);
+		m_placeholderTexture = 0;
+	}
+	// free up the allocated memory
+	m_pShaderManager = NULL;
+	m_drawDataRing.Destroy();
+	m_indirectRing.Destroy();
+	m_gpuCuller.Destroy();
+	m_skyRenderer.Destroy();
+	if (m_materialBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_materialBuffer);
+		m_materialBuffer = 0;
+	}
+	if (NULL != m_basicMeshes)
+	{
+		delete m_basicMeshes;
+		m_basicMeshes = NULL;
+	}
+	// clear the collection of defined materials
+	m_objectMaterials.clear();
+	// destroy the scene entities
+	m_registry.Clear();
+	m_renderEntities.clear();
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.  The texture
+ *  is loaded right away, the scene textures are instead
+ *  registered and loaded when they are first drawn.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	int textureSlot = RegisterTexture(filename, NULL, tag);
+	return((textureSlot >= 0) && (LoadTextureNow(textureSlot) == true));
+}
+
+/***********************************************************
+ *  RegisterTexture()
+ *
+ *  This method is used for giving a texture the next slot
+ *  without loading it.  The slot is bound to the placeholder
+ *  texture, so objects can draw with it right away.
+ ***********************************************************/
+int SceneManager::RegisterTexture(const std::string& filename, const AssetPack::ENTRY* pEntry, const std::string& tag)
+{
+	if (m_loadedTextures >= g_TextureSlotCount)
+	{
+		std::cout << "WARNING: No texture slot left for " << tag << std::endl;
+		return(-1);
+	}
+
+	int textureSlot = m_loadedTextures;
+	TEXTURE_ASSET& asset = m_textureAssets[textureSlot];
+	asset.filename = filename;
+	asset.pEntry = pEntry;
+	asset.pImage = NULL;
+	asset.width = 0;
+	asset.height = 0;
+	asset.colorChannels = 0;
+	asset.bRequested = false;
+	m_assetLoader.Register();
+
+	// register the texture and associate it with the special tag string
+	m_textureIDs[textureSlot].ID = m_placeholderTexture;
+	m_textureIDs[textureSlot].tag = tag;
+	m_loadedTextures++;
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  LoadTextureNow()
+ *
+ *  This method is used for loading and uploading a texture
+ *  before going on, for the textures that have to be there
+ *  on the first frame.
+ ***********************************************************/
+bool SceneManager::LoadTextureNow(int textureSlot)
+{
+	m_textureAssets[textureSlot].bRequested = true;
+	if (m_assetLoader.LoadNow((AssetLoader::ASSET_HANDLE)textureSlot) == false)
+	{
+		return(false);
+	}
+
+	UploadTexture(textureSlot);
+	return(true);
+}
+
+/***********************************************************
+ *  RequestTexture()
+ *
+ *  This method is used for queueing a texture for the
+ *  loader thread the first time an object draws with it.
+ *  Later calls only check a flag, so it can be called for
+ *  every draw.
+ ***********************************************************/
+void SceneManager::RequestTexture(int textureSlot)
+{
+	if ((textureSlot >= 0) && (textureSlot < m_loadedTextures) &&
+		(m_textureAssets[textureSlot].bRequested == false))
+	{
+		m_textureAssets[textureSlot].bRequested = true;
+		m_assetLoader.Request((AssetLoader::ASSET_HANDLE)textureSlot);
+	}
+}
+
+/***********************************************************
+ *  LoadTextureAsset()
+ *
+ *  This method is used for loading a texture on the loader
+ *  thread, without any OpenGL calls.  An image file is
+ *  decoded, while the levels of a packed texture are only
+ *  read once, so their pages come in from disk here and
+ *  not during the upload.
+ ***********************************************************/
+bool SceneManager::LoadTextureAsset(void* pContext, AssetLoader::ASSET_HANDLE handle)
+{
+	SceneManager* pScene = (SceneManager*)pContext;
+	TEXTURE_ASSET& asset = pScene->m_textureAssets[handle];
+
+	if (asset.pEntry != NULL)
+	{
+		const volatile uint8_t* pData = pScene->m_assetPack.GetEntryData(*asset.pEntry);
+		for (uint32_t offset = 0; offset < asset.pEntry->size; offset += AssetPack::ENTRY_ALIGNMENT)
+		{
+			(void)pData[offset];
+		}
+		return(true);
+	}
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// try to parse the image data from the specified image file
+	asset.pImage = stbi_load(
+		asset.filename.c_str(),
+		&asset.width,
+		&asset.height,
+		&asset.colorChannels,
+		0);
+
+	if (asset.pImage == NULL)
+	{
+		std::cout << "Could not load image:" << asset.filename << std::endl;
+		return(false);
+	}
+	if ((asset.colorChannels != 3) && (asset.colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << asset.colorChannels << " channels" << std::endl;
+		stbi_image_free(asset.pImage);
+		asset.pImage = NULL;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  UploadTexture()
+ *
+ *  This method is used for creating the OpenGL texture of
+ *  a loaded texture, configuring the texture mapping
+ *  parameters, and binding it to its slot in place of the
+ *  placeholder.  Decoded images get their mipmaps generated
+ *  and are freed, while the levels of a packed texture are
+ *  filtered already and handed to OpenGL straight from the
+ *  mapped pack.
+ ***********************************************************/
+void SceneManager::UploadTexture(int textureSlot)
+{
+	TEXTURE_ASSET& asset = m_textureAssets[textureSlot];
+	GLuint textureID = 0;
+
+	// the texture is created on the unit of its slot, so the
+	// textures bound to the other slots stay in place
+	glActiveTexture(GL_TEXTURE0 + textureSlot);
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (asset.pEntry != NULL)
+	{
+		uint32_t width = asset.pEntry->values[0];
+		uint32_t height = asset.pEntry->values[1];
+		uint32_t levelCount = asset.pEntry->values[2];
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+
+		const uint8_t* pLevel = m_assetPack.GetEntryData(*asset.pEntry);
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			GLsizei levelWidth = (GLsizei)AssetPack::GetLevelSize(width, level);
+			GLsizei levelHeight = (GLsizei)AssetPack::GetLevelSize(height, level);
+			glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8, levelWidth, levelHeight, 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, pLevel);
+			pLevel += (size_t)levelWidth * levelHeight * 4;
+		}
+
+		std::cout << "Successfully loaded packed texture:" << m_textureIDs[textureSlot].tag << ", width:" << width
+			<< ", height:" << height << ", levels:" << levelCount << std::endl;
+	}
+	else
+	{
+		std::cout << "Successfully loaded image:" << asset.filename << ", width:" << asset.width << ", height:"
+			<< asset.height << ", channels:" << asset.colorChannels << std::endl;
+
+		// if the loaded image is in RGB format
+		if (asset.colorChannels == 3)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, asset.width, asset.height, 0, GL_RGB, GL_UNSIGNED_BYTE, asset.pImage);
+		// if the loaded image is in RGBA format - it supports transparency
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, asset.width, asset.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, asset.pImage);
+
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// free the image data from local memory
+		stbi_image_free(asset.pImage);
+		asset.pImage = NULL;
+	}
+
+	glActiveTexture(GL_TEXTURE0);
+	m_textureIDs[textureSlot].ID = textureID;
+}
+
+/***********************************************************
+ *  UploadLoadedTextures()
+ *
+ *  This method is used for uploading the textures that the
+ *  loader thread finished since the last frame.  Only a few
+ *  are uploaded per frame, so when many textures come into
+ *  view at once their uploads are spread over some frames.
+ ***********************************************************/
+void SceneManager::UploadLoadedTextures()
+{
+	AssetLoader::ASSET_HANDLE handle = 0;
+	for (int i = 0; (i < g_TextureUploadsPerFrame) && (m_assetLoader.TakeLoaded(handle) == true); i++)
+	{
+		UploadTexture((int)handle);
+	}
+}
+
+/***********************************************************
+ *  CreatePlaceholderTexture()
+ *
+ *  This method is used for creating the single texel texture
+ *  that the slots are bound to until their textures are
+ *  loaded.  It has no mipmaps, so it needs a filter that
+ *  does not use them.
+ ***********************************************************/
+void SceneManager::CreatePlaceholderTexture()
+{
+	glGenTextures(1, &m_placeholderTexture);
+	glBindTexture(GL_TEXTURE_2D, m_placeholderTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, g_PlaceholderColor);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to 16 slots.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		glGenTextures(1, &m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(const std::string& tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(const std::string& tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	modelView = translation * rotationZ * rotationY * rotationX * scale;
+
+	if (NULL != m_pShaderManager)
+	{
+		glUniformMatrix4fv(m_uniforms.model, 1, GL_FALSE, glm::value_ptr(modelView));
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1i(m_uniforms.bUseTexture, false);
+		glUniform4fv(m_uniforms.objectColor, 1, glm::value_ptr(currentColor));
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	const std::string& textureTag)
+{
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1i(m_uniforms.bUseTexture, true);
+
+		int textureID = -1;
+		textureID = FindTextureSlot(textureTag);
+		glUniform1i(m_uniforms.objectTexture, textureID);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderManager)
+	{
+		glUniform2f(m_uniforms.uvScale, u, v);
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	const std::string& materialTag)
+{
+	if (m_objectMaterials.size() > 0)
+	{
+		OBJECT_MATERIAL material;
+		bool bReturn = false;
+
+		// find the defined material that matches the tag
+		bReturn = FindMaterial(materialTag, material);
+		if (bReturn == true)
+		{
+			// pass the material properties into the shader
+			glUniform3fv(m_uniforms.materialDiffuseColor, 1, glm::value_ptr(material.diffuseColor));
+			glUniform3fv(m_uniforms.materialSpecularColor, 1, glm::value_ptr(material.specularColor));
+			glUniform1f(m_uniforms.materialShininess, material.shininess);
+
+		}
+	}
+}
+
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for defining the materials of the
+ *  scene file.  Objects without a material use the first
+ *  one, so a default is defined when the file has none.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	OBJECT_MATERIAL material;
+
+	for (uint32_t i = 0; i < m_sceneFile.GetMaterialCount(); i++)
+	{
+		const SceneFile::MATERIAL& sceneMaterial = m_sceneFile.GetMaterial(i);
+		material.tag = m_sceneFile.GetString(sceneMaterial.tag);
+		material.diffuseColor = glm::make_vec3(sceneMaterial.diffuseColor);
+		material.specularColor = glm::make_vec3(sceneMaterial.specularColor);
+		material.shininess = sceneMaterial.shininess;
+		m_objectMaterials.push_back(material);
+	}
+
+	if (m_objectMaterials.empty() == true)
+	{
+		material.tag = "default";
+		material.diffuseColor = glm::vec3(0.6f, 0.6f, 0.5f);
+		material.specularColor = glm::vec3(0.9f, 0.9f, 0.8f);
+		material.shininess = 64.0f;
+		m_objectMaterials.push_back(material);
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+void SceneManager::SetupSceneLights()
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting, if no light sources have
+	// been added then the display window will be black - to use the 
+	// default OpenGL lighting then comment out the following line
+	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+
+	// the lights of the scene file become entities, which are
+	// added and sent to the shaders with the first frame built
+	LIGHT_COMPONENT light;
+	for (uint32_t i = 0; i < m_sceneFile.GetLightCount(); i++)
+	{
+		const SceneFile::LIGHT& sceneLight = m_sceneFile.GetLight(i);
+		light.type = (LIGHT_TYPE)sceneLight.type;
+		light.position = glm::make_vec3(sceneLight.position);
+		light.direction = glm::make_vec3(sceneLight.direction);
+		light.ambient = glm::make_vec3(sceneLight.ambient);
+		light.diffuse = glm::make_vec3(sceneLight.diffuse);
+		light.specular = glm::make_vec3(sceneLight.specular);
+		AddSceneLight(light);
+	}
+}
+
+/***********************************************************
+ *  AddSceneLight()
+ *
+ *  This method is used for adding a light source entity.
+ *  The entity is created right away so it can be returned,
+ *  and its light is added by the thread building the next
+ *  frame.
+ ***********************************************************/
+ENTITY SceneManager::AddSceneLight(const LIGHT_COMPONENT& light)
+{
+	std::lock_guard<std::mutex> lock(m_sceneEditMutex);
+
+	ENTITY entity = m_registry.CreateEntity();
+	if (entity != NULL_ENTITY)
+	{
+		SCENE_EDIT edit = SCENE_EDIT();
+		edit.type = EDIT_ADD_LIGHT;
+		edit.entity = entity;
+		edit.light = light;
+		m_sceneEdits.push_back(edit);
+	}
+	return(entity);
+}
+
+/***********************************************************
+ *  RemoveSceneLight()
+ *
+ *  This method is used for queuing the removal of a light
+ *  source entity.
+ ***********************************************************/
+void SceneManager::RemoveSceneLight(ENTITY entity)
+{
+	SCENE_EDIT edit = SCENE_EDIT();
+	edit.type = EDIT_REMOVE_LIGHT;
+	edit.entity = entity;
+
+	std::lock_guard<std::mutex> lock(m_sceneEditMutex);
+	m_sceneEdits.push_back(edit);
+}
+
+/***********************************************************
+ *  ApplySceneEdits()
+ *
+ *  This method is used for applying the scene changes that
+ *  were queued since the last frame was built, before the
+ *  frame reads the scene.  The queue stays locked while
+ *  they are applied, since light entities are created on
+ *  the render thread.  The lights are copied into every
+ *  packet, so a change is not lost with a packet that is
+ *  dropped when the update thread stops.
+ ***********************************************************/
+void SceneManager::ApplySceneEdits(FRAME_PACKET& packet)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sceneEditMutex);
+		for (size_t i = 0; i < m_sceneEdits.size(); i++)
+		{
+			const SCENE_EDIT& edit = m_sceneEdits[i];
+			switch (edit.type)
+			{
+			case EDIT_TRANSFORM:
+				ApplyObjectTransform(edit);
+				break;
+			case EDIT_ADD_LIGHT:
+				m_registry.Add(edit.entity, edit.light);
+				m_lightsVersion++;
+				break;
+			case EDIT_REMOVE_LIGHT:
+				if (m_registry.Has<LIGHT_COMPONENT>(edit.entity) == true)
+				{
+					m_registry.DestroyEntity(edit.entity);
+					m_lightsVersion++;
+				}
+				break;
+			}
+		}
+		m_sceneEdits.clear();
+	}
+
+	packet.lights.clear();
+	m_registry.ForEach<LIGHT_COMPONENT>([&packet](ENTITY, const LIGHT_COMPONENT& light)
+		{
+			packet.lights.push_back(light);
+		});
+	packet.lightsVersion = m_lightsVersion;
+}
+
+/***********************************************************
+ *  ApplySceneLights()
+ *
+ *  This method is used for sending the lights of a packet to
+ *  the shader uniforms, when they include changes the ones
+ *  sent last did not.  The first directional light and the
+ *  first point lights that fit the shader are used, and the
+ *  shader lights left over are switched off.
+ ***********************************************************/
+void SceneManager::ApplySceneLights(const FRAME_PACKET& packet)
+{
+	if ((NULL == m_pShaderManager) || (packet.lightsVersion == m_appliedLightsVersion))
+	{
+		return;
+	}
+
+	bool bDirectional = false;
+	size_t pointLightCount = 0;
+
+	for (const LIGHT_COMPONENT& light : packet.lights)
+	{
+		const LIGHT_UNIFORMS* pUniforms = NULL;
+		if ((light.type == LIGHT_DIRECTIONAL) && (bDirectional == false))
+		{
+			pUniforms = &m_directionalLightUniforms;
+			bDirectional = true;
+		}
+		else if ((light.type == LIGHT_POINT) && (pointLightCount < m_pointLightUniforms.size()))
+		{
+			pUniforms = &m_pointLightUniforms[pointLightCount];
+			pointLightCount++;
+		}
+
+		if (pUniforms != NULL)
+		{
+			glUniform3fv(pUniforms->position, 1, glm::value_ptr(light.position));
+			glUniform3fv(pUniforms->direction, 1, glm::value_ptr(light.direction));
+			glUniform3fv(pUniforms->ambient, 1, glm::value_ptr(light.ambient));
+			glUniform3fv(pUniforms->diffuse, 1, glm::value_ptr(light.diffuse));
+			glUniform3fv(pUniforms->specular, 1, glm::value_ptr(light.specular));
+			glUniform1i(pUniforms->bActive, 1);
+		}
+	}
+
+	if (bDirectional == false)
+	{
+		glUniform1i(m_directionalLightUniforms.bActive, 0);
+	}
+	for (size_t i = pointLightCount; i < m_pointLightUniforms.size(); i++)
+	{
+		glUniform1i(m_pointLightUniforms[i].bActive, 0);
+	}
+
+	m_appliedLightsVersion = packet.lightsVersion;
+}
+
+/***********************************************************
+ *  FindUniformLocations()
+ *
+ *  This method is used for looking up the locations of the
+ *  uniforms that are set while drawing.  Setting them by
+ *  name would build a string and look the name up on every
+ *  call.  Names the shaders do not use get location -1,
+ *  which OpenGL ignores like the shader manager does.
+ ***********************************************************/
+void SceneManager::FindUniformLocations()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	GLuint program = m_pShaderManager->m_programID;
+	m_uniforms.model = glGetUniformLocation(program, g_ModelName);
+	m_uniforms.objectColor = glGetUniformLocation(program, g_ColorValueName);
+	m_uniforms.objectTexture = glGetUniformLocation(program, g_TextureValueName);
+	m_uniforms.bUseTexture = glGetUniformLocation(program, g_UseTextureName);
+	m_uniforms.bUsePackedNormal = glGetUniformLocation(program, g_UsePackedNormalName);
+	m_uniforms.bUseDrawData = glGetUniformLocation(program, g_UseDrawDataName);
+	m_uniforms.uvScale = glGetUniformLocation(program, "UVscale");
+	m_uniforms.materialDiffuseColor = glGetUniformLocation(program, "material.diffuseColor");
+	m_uniforms.materialSpecularColor = glGetUniformLocation(program, "material.specularColor");
+	m_uniforms.materialShininess = glGetUniformLocation(program, "material.shininess");
+
+	FindLightUniforms("directionalLight.", m_directionalLightUniforms);
+	m_pointLightUniforms.resize(g_MaxPointLights);
+	for (int i = 0; i < g_MaxPointLights; i++)
+	{
+		FindLightUniforms("pointLights[" + std::to_string(i) + "].", m_pointLightUniforms[i]);
+	}
+}
+
+/***********************************************************
+ *  FindLightUniforms()
+ *
+ *  This method is used for looking up the uniforms of one
+ *  light of the shaders.
+ ***********************************************************/
+void SceneManager::FindLightUniforms(const std::string& prefix, LIGHT_UNIFORMS& uniforms)
+{
+	GLuint program = m_pShaderManager->m_programID;
+	uniforms.position = glGetUniformLocation(program, (prefix + "position").c_str());
+	uniforms.direction = glGetUniformLocation(program, (prefix + "direction").c_str());
+	uniforms.ambient = glGetUniformLocation(program, (prefix + "ambient").c_str());
+	uniforms.diffuse = glGetUniformLocation(program, (prefix + "diffuse").c_str());
+	uniforms.specular = glGetUniformLocation(program, (prefix + "specular").c_str());
+	uniforms.bActive = glGetUniformLocation(program, (prefix + "bActive").c_str());
+}
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// look up the uniforms that are set while drawing
+	FindUniformLocations();
+	// the scene is described by a text or compiled scene file,
+	// or comes from an asset pack with its textures and meshes
+	// ready to upload - the scene stays open while the scene
+	// is prepared, and the pack while textures are loaded from
+	// it, and a scene that cannot be loaded is left empty
+	if (AssetPack::IsAssetPack(m_sceneFileName.c_str()) == true)
+	{
+		if (m_assetPack.Open(m_sceneFileName.c_str()) == true)
+		{
+			const AssetPack::ENTRY* pScene = m_assetPack.FindEntry(AssetPack::ENTRY_SCENE, AssetPack::SCENE_ENTRY_NAME);
+			if (pScene != NULL)
+			{
+				m_sceneFile.OpenImage(m_assetPack.GetEntryData(*pScene), pScene->size, m_sceneFileName.c_str());
+			}
+		}
+	}
+	else
+	{
+		m_sceneFile.Open(m_sceneFileName.c_str());
+	}
+	// define the materials for objects in the scene
+	DefineObjectMaterials();
+	// add and define the light sources for the scene
+	SetupSceneLights();
+	// Load scene textures from the provided files, the slots
+	// draw with the placeholder until their texture is loaded
+	CreatePlaceholderTexture();
+	LoadSceneTextures();
+
+	// Bind all loaded textures to texture slots
+	BindGLTextures();
+
+	// the sky is drawn unlit after the objects, only where
+	// they leave the screen uncovered
+	if (m_skyRenderer.Create() == true)
+	{
+		m_skyRenderer.SetTextureUnit(FindTextureSlot("sky"));
+		RequestTexture(FindTextureSlot("sky"));
+	}
+
+	// the basic shapes are created when an object first draws
+	// with them, which the multi-draw calls never do
+	if (m_bPreloadAssets == true)
+	{
+		for (int mesh = MESH_PLANE; mesh <= MESH_CYLINDER; mesh++)
+		{
+			LoadBasicMesh((SCENE_MESH)mesh);
+		}
+	}
+	// tessellation levels for drawing small cylinders cheaply,
+	// in the 16 byte packed vertex format, baked into the pack
+	// or generated here
+	if (LoadPackedMeshes() == false)
+	{
+		m_meshLibrary.LoadLODMeshes(MeshLibrary::VERTEX_FORMAT_PACKED);
+	}
+
+	// define the objects that make up the 3D scene
+	DefineSceneObjects();
+	m_sceneFile.Close();
+
+	// compose the local matrices of all the objects in batches
+	// on the job threads and place the objects in the world
+	// through the hierarchy
+	m_objectMatrices.resize(m_transformBatch.GetCount());
+	m_jobSystem.ParallelFor((uint32_t)m_objectMatrices.size(), g_MinObjectsPerJob,
+		[this](uint32_t first, uint32_t last)
+		{
+			m_transformBatch.ComputeMatrices(first, last, m_objectMatrices.data());
+		});
+	m_registry.ForEach<TRANSFORM_COMPONENT>([this](ENTITY, const TRANSFORM_COMPONENT& transform)
+		{
+			uint32_t node = transform.transformIndex;
+			m_transformHierarchy.SetLocalTransform(node, m_objectMatrices[node], transform.scaleXYZ);
+		});
+	UpdateObjectTransforms();
+
+	// one occlusion query for each scene object
+	m_occlusionQueries.CreateQueries(m_renderEntities.size());
+	m_inFrustumFlags.resize(m_renderEntities.size(), 0);
+
+	// the finest level is kept while an object covers at least
+	// a quarter of the viewport height, the coarsest below 2%
+	m_lodSelector.SetThresholds({ 0.25f, 0.08f, 0.02f });
+	m_lodSelector.SetObjectCount(m_renderEntities.size());
+
+	// per draw values are read from a buffer when supported,
+	// and the objects can then also be culled on the GPU
+	if (CreateDrawDataBuffers() == true)
+	{
+		CreateGpuCulling();
+	}
+}
+
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the default local space
+ *  bounds of the basic shape meshes.  The box is a unit
+ *  cube around the origin, the plane spans -1 to 1 on the
+ *  ground, and the cylinder has a radius of 1 and stands on
+ *  the origin.
+ ***********************************************************/
+void SceneManager::GetMeshBounds(
+	SCENE_MESH mesh,
+	glm::vec3& localMin,
+	glm::vec3& localMax)
+{
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		localMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+		localMax = glm::vec3(1.0f, 0.0f, 1.0f);
+		break;
+	case MESH_CYLINDER:
+		localMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+		localMax = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	default:
+		localMin = glm::vec3(-0.5f, -0.5f, -0.5f);
+		localMax = glm::vec3(0.5f, 0.5f, 0.5f);
+		break;
+	}
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for creating a scene object entity
+ *  with its transform, mesh, material, texture and bounds
+ *  components, and giving it the next render index.  The
+ *  parent object has to be the last added object or one
+ *  that it is attached to, so the objects of a subtree stay
+ *  next to each other.
+ ***********************************************************/
+ENTITY SceneManager::AddSceneObject(
+	SCENE_MESH mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	std::string textureTag,
+	std::string materialTag,
+	bool bOccluder,
+	ENTITY parentObject)
+{
+	TRANSFORM_COMPONENT transform;
+	MESH_COMPONENT objectMesh;
+	MATERIAL_COMPONENT objectMaterial;
+	BOUNDS_COMPONENT bounds;
+
+	ENTITY entity = m_registry.CreateEntity();
+	if (entity == NULL_ENTITY)
+	{
+		return(NULL_ENTITY);
+	}
+
+	transform.scaleXYZ = scaleXYZ;
+	transform.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	transform.positionXYZ = positionXYZ;
+	transform.parent = parentObject;
+	// filled in for all the objects at once by UpdateObjectTransforms()
+	transform.modelMatrix = glm::mat4(1.0f);
+
+	// the scale is kept out of the local matrix so that it only
+	// stretches this object and not the objects attached to it
+	int32_t node = TransformHierarchy::NO_PARENT;
+	if (m_registry.Has<TRANSFORM_COMPONENT>(parentObject) == true)
+	{
+		int32_t parentNode = (int32_t)m_registry.Get<TRANSFORM_COMPONENT>(parentObject).transformIndex;
+		node = m_transformHierarchy.AddNode(parentNode, glm::mat4(1.0f), scaleXYZ);
+	}
+	if (node == TransformHierarchy::NO_PARENT)
+	{
+		if (parentObject != NULL_ENTITY)
+		{
+			std::cout << "WARNING: Scene object placed in world space instead of below its parent" << std::endl;
+		}
+		transform.parent = NULL_ENTITY;
+		node = m_transformHierarchy.AddNode(TransformHierarchy::NO_PARENT, glm::mat4(1.0f), scaleXYZ);
+	}
+	transform.transformIndex = (uint32_t)node;
+
+	objectMesh.mesh = mesh;
+	objectMesh.bOccluder = bOccluder;
+	objectMesh.renderIndex = (uint32_t)m_renderEntities.size();
+
+	objectMaterial.color = color;
+	objectMaterial.materialTag = materialTag;
+	objectMaterial.materialIndex = 0;
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		if (m_objectMaterials[i].tag.compare(materialTag) == 0)
+		{
+			objectMaterial.materialIndex = (int)i;
+			break;
+		}
+	}
+
+	bounds = m_meshBounds[mesh];
+
+	m_registry.Add(entity, transform);
+	m_registry.Add(entity, objectMesh);
+	m_registry.Add(entity, objectMaterial);
+	m_registry.Add(entity, bounds);
+	if (textureTag.empty() == false)
+	{
+		TEXTURE_COMPONENT objectTexture;
+		objectTexture.textureTag = textureTag;
+		objectTexture.textureSlot = FindTextureSlot(textureTag);
+		m_registry.Add(entity, objectTexture);
+	}
+
+	// every object is drawn and transformed, so its hierarchy
+	// node, batch entry and render index are the same
+	m_renderEntities.push_back(entity);
+	m_transformBatch.Add(positionXYZ, transform.rotationDegrees, glm::vec3(1.0f));
+	m_frustumCuller.AddBounds(glm::vec3(0.0f), glm::vec3(0.0f));
+
+	return(entity);
+}
+
+/***********************************************************
+ *  SetObjectTransform()
+ *
+ *  This method is used for queuing new transformation values
+ *  of a scene object, which ApplySceneEdits() passes on when
+ *  the next frame is built.
+ ***********************************************************/
+void SceneManager::SetObjectTransform(
+	ENTITY entity,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	SCENE_EDIT edit = SCENE_EDIT();
+	edit.type = EDIT_TRANSFORM;
+	edit.entity = entity;
+	edit.scaleXYZ = scaleXYZ;
+	edit.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	edit.positionXYZ = positionXYZ;
+
+	std::lock_guard<std::mutex> lock(m_sceneEditMutex);
+	m_sceneEdits.push_back(edit);
+}
+
+/***********************************************************
+ *  ApplyObjectTransform()
+ *
+ *  This method is used for replacing the transformation
+ *  values of a scene object.  The object is only marked as
+ *  edited here, its local matrix is composed together with
+ *  the other edited ones by UpdateObjectTransforms().
+ ***********************************************************/
+void SceneManager::ApplyObjectTransform(const SCENE_EDIT& edit)
+{
+	TRANSFORM_COMPONENT* pTransform = m_registry.Find<TRANSFORM_COMPONENT>(edit.entity);
+	if ((pTransform == NULL) || (pTransform->transformIndex >= m_objectMatrices.size()))
+	{
+		return;
+	}
+
+	uint32_t node = pTransform->transformIndex;
+	pTransform->scaleXYZ = edit.scaleXYZ;
+	pTransform->rotationDegrees = edit.rotationDegrees;
+	pTransform->positionXYZ = edit.positionXYZ;
+
+	m_transformBatch.Set(node, edit.positionXYZ, edit.rotationDegrees, glm::vec3(1.0f));
+	m_editedTransforms.push_back(node);
+}
+
+/***********************************************************
+ *  ComposeEditedTransforms()
+ *
+ *  This method is used for composing the local matrices of
+ *  the objects edited since the last frame.  The edited
+ *  entries are sorted, so an object edited several times is
+ *  composed once and neighbouring entries are composed in
+ *  one run of the batch kernel.
+ ***********************************************************/
+void SceneManager::ComposeEditedTransforms()
+{
+	if (m_editedTransforms.empty() == true)
+	{
+		return;
+	}
+
+	std::sort(m_editedTransforms.begin(), m_editedTransforms.end());
+	m_editedTransforms.erase(
+		std::unique(m_editedTransforms.begin(), m_editedTransforms.end()), m_editedTransforms.end());
+
+	size_t first = 0;
+	while (first < m_editedTransforms.size())
+	{
+		size_t last = first + 1;
+		while ((last < m_editedTransforms.size()) &&
+			(m_editedTransforms[last] == m_editedTransforms[last - 1] + 1))
+		{
+			last++;
+		}
+		m_transformBatch.ComputeMatrices(
+			m_editedTransforms[first], m_editedTransforms[last - 1] + 1, m_objectMatrices.data());
+		first = last;
+	}
+
+	for (size_t i = 0; i < m_editedTransforms.size(); i++)
+	{
+		uint32_t node = m_editedTransforms[i];
+		const TRANSFORM_COMPONENT& transform = m_registry.Get<TRANSFORM_COMPONENT>(m_renderEntities[node]);
+		m_transformHierarchy.SetLocalTransform(node, m_objectMatrices[node], transform.scaleXYZ);
+	}
+	m_editedTransforms.clear();
+}
+
+/***********************************************************
+ *  GetTextureSlot()
+ *
+ *  This method is used for getting the texture slot of an
+ *  entity, or -1 when it is drawn without a texture.
+ ***********************************************************/
+int SceneManager::GetTextureSlot(ENTITY entity) const
+{
+	const TEXTURE_COMPONENT* pTexture = m_registry.Find<TEXTURE_COMPONENT>(entity);
+	return((pTexture != NULL) ? pTexture->textureSlot : -1);
+}
+
+/***********************************************************
+ *  UpdateObjectTransforms()
+ *
+ *  This method is used for composing the edited transforms,
+ *  passing the changes down the hierarchy in one pass and
+ *  replacing the model matrix and world space bounds of
+ *  every object that moved.  The moved objects are
+ *  independent of each other, so their bounds are computed
+ *  on the job threads, and only the GPU copies are sent
+ *  from the calling thread.  Nothing is done when no object
+ *  changed.
+ ***********************************************************/
+void SceneManager::UpdateObjectTransforms()
+{
+	ComposeEditedTransforms();
+	if (m_transformHierarchy.Update() == 0)
+	{
+		return;
+	}
+
+	const std::vector<uint32_t>& changedObjects = m_transformHierarchy.GetChangedNodes();
+	m_jobSystem.ParallelFor((uint32_t)changedObjects.size(), g_MinObjectsPerJob,
+		[this, &changedObjects](uint32_t first, uint32_t last)
+		{
+			glm::vec3 center;
+			glm::vec3 extents;
+
+			for (uint32_t i = first; i < last; i++)
+			{
+				uint32_t objectIndex = changedObjects[i];
+				ENTITY entity = m_renderEntities[objectIndex];
+				TRANSFORM_COMPONENT& transform = m_registry.Get<TRANSFORM_COMPONENT>(entity);
+				const BOUNDS_COMPONENT& bounds = m_registry.Get<BOUNDS_COMPONENT>(entity);
+
+				transform.modelMatrix = m_transformHierarchy.GetModelMatrix(objectIndex);
+				FrustumCuller::TransformBounds(transform.modelMatrix, bounds.localMin, bounds.localMax, center, extents);
+				m_frustumCuller.SetBounds(objectIndex, center, extents);
+			}
+		});
+
+	for (size_t i = 0; i < changedObjects.size(); i++)
+	{
+		UpdateGpuObject(changedObjects[i]);
+	}
+}
+
+/***********************************************************
+ *  DefineSceneObjects()
+ *
+ *  This method is used for adding the objects of the scene
+ *  file.  A parent is always an earlier object, so its
+ *  entity exists when the objects attached to it are added.
+ ***********************************************************/
+void SceneManager::DefineSceneObjects()
+{
+	std::vector<ENTITY> entities(m_sceneFile.GetObjectCount(), NULL_ENTITY);
+
+	int gridSize = (int)std::ceil(std::sqrt((double)m_sceneCopies));
+	float gridCenter = (gridSize - 1) * 0.5f;
+
+	// the objects of each copy are added together, so the
+	// objects attached to a parent stay next to it
+	for (int copy = 0; copy < m_sceneCopies; copy++)
+	{
+		glm::vec3 copyOffset(
+			((copy % gridSize) - gridCenter) * m_copySpacing,
+			0.0f,
+			((copy / gridSize) - gridCenter) * m_copySpacing);
+
+		for (uint32_t i = 0; i < m_sceneFile.GetObjectCount(); i++)
+		{
+			const SceneFile::OBJECT& object = m_sceneFile.GetSceneObject(i);
+
+			// only needed when the sky pass could not be created,
+			// and only once
+			if (((object.flags & SceneFile::OBJECT_SKY_FALLBACK) != 0) &&
+				((m_skyRenderer.IsCreated() == true) || (copy > 0)))
+			{
+				continue;
+			}
+
+			std::string textureTag;
+			if (object.texture != SceneFile::NO_INDEX)
+			{
+				textureTag = m_sceneFile.GetString(m_sceneFile.GetTexture(object.texture).tag);
+			}
+			std::string materialTag;
+			if (object.material != SceneFile::NO_INDEX)
+			{
+				materialTag = m_sceneFile.GetString(m_sceneFile.GetMaterial(object.material).tag);
+			}
+			// attached objects are placed relative to their parent,
+			// so only the others are moved to the copy
+			ENTITY parentObject = NULL_ENTITY;
+			glm::vec3 position = glm::make_vec3(object.position);
+			if (object.parent != SceneFile::NO_INDEX)
+			{
+				parentObject = entities[object.parent];
+			}
+			else
+			{
+				position += copyOffset;
+			}
+
+			entities[i] = AddSceneObject(
+				(SCENE_MESH)object.mesh,
+				glm::make_vec3(object.scale),
+				object.rotationDegrees[0],
+				object.rotationDegrees[1],
+				object.rotationDegrees[2],
+				position,
+				glm::make_vec4(object.color),
+				textureTag,
+				materialTag,
+				(object.flags & SceneFile::OBJECT_OCCLUDER) != 0,
+				parentObject);
+		}
+	}
+
+	if (m_sceneCopies > 1)
+	{
+		std::cout << "INFO: Scene repeated " << m_sceneCopies << " times on a " << gridSize << " x "
+			<< gridSize << " grid - " << m_renderEntities.size() << " objects" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  LoadSceneTextures()
+ *
+ *  This method is used for registering the textures of the
+ *  scene file in the texture slots, read from the asset
+ *  pack when the scene came from one.  The preload ones are
+ *  loaded here, the others on the loader thread when they
+ *  are first drawn.  Textures past the last slot are left
+ *  out.
+ ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	bool bStreamed = false;
+
+	for (uint32_t i = 0; i < m_sceneFile.GetTextureCount(); i++)
+	{
+		const SceneFile::TEXTURE& texture = m_sceneFile.GetTexture(i);
+		const char* tag = m_sceneFile.GetString(texture.tag);
+
+		const AssetPack::ENTRY* pEntry = m_assetPack.FindEntry(AssetPack::ENTRY_TEXTURE, tag);
+		if ((pEntry != NULL) && (IsPackedTextureValid(*pEntry, tag) == false))
+		{
+			pEntry = NULL;
+		}
+
+		int textureSlot = RegisterTexture(m_sceneFile.GetString(texture.filename), pEntry, tag);
+		if (textureSlot < 0)
+		{
+			break;
+		}
+
+		if ((m_bPreloadAssets == true) || ((texture.flags & SceneFile::TEXTURE_PRELOAD) != 0))
+		{
+			LoadTextureNow(textureSlot);
+		}
+		else
+		{
+			bStreamed = true;
+		}
+	}
+
+	if (bStreamed == true)
+	{
+		m_assetLoader.Start();
+	}
+}
+
+/***********************************************************
+ *  IsPackedTextureValid()
+ *
+ *  This method is used for checking that the mip levels of
+ *  a texture in the asset pack have a size OpenGL accepts
+ *  and fill its entry exactly.
+ ***********************************************************/
+bool SceneManager::IsPackedTextureValid(const AssetPack::ENTRY& entry, const std::string& tag) const
+{
+	uint32_t width = entry.values[0];
+	uint32_t height = entry.values[1];
+	uint32_t levelCount = entry.values[2];
+
+	if ((width == 0) || (width > g_MaxPackedTextureSize) ||
+		(height == 0) || (height > g_MaxPackedTextureSize) ||
+		(levelCount == 0) || (levelCount > 32) ||
+		(AssetPack::GetTextureBytes(width, height, levelCount) != entry.size))
+	{
+		std::cout << "WARNING: Texture " << tag << " of the asset pack is damaged" << std::endl;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  LoadPackedMeshes()
+ *
+ *  This method is used for uploading the mesh pool baked
+ *  into the asset pack and taking over the mesh bounds
+ *  computed from its vertices.  Returns false when the
+ *  scene did not come from a pack or its pool is damaged,
+ *  and the pool then has to be generated.
+ ***********************************************************/
+bool SceneManager::LoadPackedMeshes()
+{
+	const AssetPack::ENTRY* pVertices = m_assetPack.FindEntry(AssetPack::ENTRY_MESH_VERTICES, AssetPack::MESH_POOL_ENTRY_NAME);
+	const AssetPack::ENTRY* pIndices = m_assetPack.FindEntry(AssetPack::ENTRY_MESH_INDICES, AssetPack::MESH_POOL_ENTRY_NAME);
+	const AssetPack::ENTRY* pTable = m_assetPack.FindEntry(AssetPack::ENTRY_MESH_TABLE, AssetPack::MESH_POOL_ENTRY_NAME);
+	if ((pVertices == NULL) || (pIndices == NULL) || (pTable == NULL))
+	{
+		return(false);
+	}
+
+	MeshLibrary::VERTEX_FORMAT format = (MeshLibrary::VERTEX_FORMAT)pVertices->values[0];
+	uint64_t vertexCount = pVertices->values[1];
+	uint64_t indexCount = pIndices->values[0];
+	uint64_t vertexSize = (format == MeshLibrary::VERTEX_FORMAT_PACKED) ?
+		sizeof(MeshLibrary::PACKED_VERTEX) : sizeof(MeshLibrary::MESH_VERTEX);
+	const AssetPack::MESH_ENTRY* pMeshes = (const AssetPack::MESH_ENTRY*)m_assetPack.GetEntryData(*pTable);
+
+	bool bValid = (pVertices->values[0] <= MeshLibrary::VERTEX_FORMAT_PACKED) &&
+		(vertexCount * vertexSize == pVertices->size) &&
+		(indexCount * sizeof(uint32_t) == pIndices->size) &&
+		(pTable->size == MeshLibrary::POOL_RANGE_COUNT * sizeof(AssetPack::MESH_ENTRY));
+
+	MeshLibrary::MESH_RANGE ranges[MeshLibrary::POOL_RANGE_COUNT];
+	for (int i = 0; (i < MeshLibrary::POOL_RANGE_COUNT) && (bValid == true); i++)
+	{
+		bValid = ((uint64_t)pMeshes[i].firstIndex + pMeshes[i].indexCount <= indexCount) &&
+			(pMeshes[i].baseVertex >= 0) && ((uint64_t)pMeshes[i].baseVertex < vertexCount);
+		ranges[i].firstIndex = pMeshes[i].firstIndex;
+		ranges[i].indexCount = pMeshes[i].indexCount;
+		ranges[i].baseVertex = pMeshes[i].baseVertex;
+	}
+	if (bValid == false)
+	{
+		std::cout << "WARNING: Mesh pool of the asset pack is damaged, generating the meshes" << std::endl;
+		return(false);
+	}
+
+	m_meshLibrary.LoadMeshPool(format,
+		m_assetPack.GetEntryData(*pVertices), pVertices->size,
+		(const uint32_t*)m_assetPack.GetEntryData(*pIndices), (size_t)indexCount,
+		ranges);
+
+	// the basic shapes are drawn with the same local space as
+	// the pool meshes, whose bounds the pack computed
+	const int fixedStart = MeshLibrary::LOD_SHAPE_COUNT * MeshLibrary::LOD_LEVEL_COUNT;
+	const AssetPack::MESH_ENTRY* pMeshBounds[MESH_CYLINDER + 1];
+	pMeshBounds[MESH_PLANE] = &pMeshes[fixedStart + MeshLibrary::FIXED_PLANE];
+	pMeshBounds[MESH_BOX] = &pMeshes[fixedStart + MeshLibrary::FIXED_BOX];
+	pMeshBounds[MESH_CYLINDER] = &pMeshes[MeshLibrary::LOD_CYLINDER * MeshLibrary::LOD_LEVEL_COUNT];
+	for (int mesh = MESH_PLANE; mesh <= MESH_CYLINDER; mesh++)
+	{
+		m_meshBounds[mesh].localMin = glm::make_vec3(pMeshBounds[mesh]->boundsMin);
+		m_meshBounds[mesh].localMax = glm::make_vec3(pMeshBounds[mesh]->boundsMax);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  SetSceneFile()
+ *
+ *  This method is used for choosing the scene file that is
+ *  loaded by PrepareScene(), instead of the default scene.
+ ***********************************************************/
+void SceneManager::SetSceneFile(const std::string& filename)
+{
+	m_sceneFileName = filename;
+}
+
+/***********************************************************
+ *  SetPreloadAssets()
+ *
+ *  This method is used for loading every texture and basic
+ *  shape mesh in PrepareScene(), as needed when the first
+ *  frames have to look like all the others.
+ ***********************************************************/
+void SceneManager::SetPreloadAssets(bool bEnabled)
+{
+	m_bPreloadAssets = bEnabled;
+}
+
+/***********************************************************
+ *  SetSceneCopies()
+ *
+ *  This method is used for setting how many times the
+ *  objects of the scene file are added, each copy moved by
+ *  the spacing from its neighbors on the grid.
+ ***********************************************************/
+void SceneManager::SetSceneCopies(int copies, float spacing)
+{
+	m_sceneCopies = std::max(1, copies);
+	m_copySpacing = spacing;
+}
+
+/***********************************************************
+ *  LoadBasicMesh()
+ *
+ *  This method is used for creating a basic shape mesh the
+ *  first time it is drawn.
+ ***********************************************************/
+void SceneManager::LoadBasicMesh(SCENE_MESH mesh)
+{
+	if (m_bBasicMeshLoaded[mesh] == true)
+	{
+		return;
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		m_basicMeshes->LoadPlaneMesh();
+		break;
+	case MESH_BOX:
+		m_basicMeshes->LoadBoxMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->LoadCylinderMesh();  // For table & chair legs
+		break;
+	}
+	m_bBasicMeshLoaded[mesh] = true;
+}
+
+/***********************************************************
+ *  SetViewTransforms()
+ *
+ *  This method is used for setting the view and projection
+ *  matrices of the current frame, which the scene objects
+ *  are culled against.
+ ***********************************************************/
+void SceneManager::SetViewTransforms(
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	m_frameSettings.view = view;
+	m_frameSettings.projection = projection;
+}
+
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method is used for picking the tessellation level
+ *  of a scene object and drawing it with the current values
+ *  of its components, for the draws that are not recorded
+ *  in a frame packet.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(uint32_t objectIndex)
+{
+	ENTITY entity = m_renderEntities[objectIndex];
+	const TRANSFORM_COMPONENT& transform = m_registry.Get<TRANSFORM_COMPONENT>(entity);
+	const MATERIAL_COMPONENT& objectMaterial = m_registry.Get<MATERIAL_COMPONENT>(entity);
+	DRAW_DATA values;
+
+	// cylinders are drawn from the tessellation levels
+	int lodLevel = -1;
+	if ((m_registry.Get<MESH_COMPONENT>(entity).mesh == MESH_CYLINDER) && (m_bMeshLOD == true))
+	{
+		lodLevel = SelectCylinderLevel(objectIndex);
+		m_lodTriangles += m_meshLibrary.GetTriangleCount(MeshLibrary::LOD_CYLINDER, lodLevel);
+	}
+
+	FillDrawData(values, transform.modelMatrix, objectMaterial.color,
+		GetTextureSlot(entity), objectMaterial.materialIndex, false);
+	DrawSceneObject(objectIndex, lodLevel, values);
+}
+
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method is used for setting the shader values of a
+ *  scene object and drawing its basic shape mesh or one of
+ *  its tessellation levels.  When the draw data buffer is
+ *  in use, only the draw index is set.  The model matrix
+ *  and color come from the passed in values, so a frame
+ *  built ahead is drawn the way it was recorded while the
+ *  update thread already moves the objects.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(uint32_t objectIndex, int lodLevel, const DRAW_DATA& values)
+{
+	ENTITY entity = m_renderEntities[objectIndex];
+	const MESH_COMPONENT& objectMesh = m_registry.Get<MESH_COMPONENT>(entity);
+	const MATERIAL_COMPONENT& objectMaterial = m_registry.Get<MATERIAL_COMPONENT>(entity);
+	const TEXTURE_COMPONENT* pObjectTexture = m_registry.Find<TEXTURE_COMPONENT>(entity);
+	int textureSlot = (pObjectTexture != NULL) ? pObjectTexture->textureSlot : -1;
+	RequestTexture(textureSlot);
+
+	// the packed normals are only decoded for these draws
+	bool bPackedNormal = (lodLevel >= 0) &&
+		(m_meshLibrary.GetVertexFormat() == MeshLibrary::VERTEX_FORMAT_PACKED);
+
+	bool bUniforms = (WriteDrawData(values.model, values.color,
+		textureSlot, values.materialIndex, bPackedNormal) == false);
+	if (bUniforms == true)
+	{
+		const glm::vec4& color = values.color;
+
+		// the model matrix already includes the parent objects
+		if (NULL != m_pShaderManager)
+		{
+			glUniformMatrix4fv(m_uniforms.model, 1, GL_FALSE, glm::value_ptr(values.model));
+		}
+		SetShaderColor(color.r, color.g, color.b, color.a);
+		if (pObjectTexture != NULL)
+		{
+			SetShaderTexture(pObjectTexture->textureTag);
+		}
+		SetShaderMaterial(objectMaterial.materialTag);
+		if ((bPackedNormal == true) && (NULL != m_pShaderManager))
+		{
+			glUniform1i(m_uniforms.bUsePackedNormal, true);
+		}
+	}
+
+	DrawMesh(objectMesh.mesh, lodLevel);
+
+	if ((bUniforms == true) && (bPackedNormal == true) && (NULL != m_pShaderManager))
+	{
+		glUniform1i(m_uniforms.bUsePackedNormal, false);
+	}
+}
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a basic shape mesh, or
+ *  one of the tessellation levels of the cylinder.
+ ***********************************************************/
+void SceneManager::DrawMesh(SCENE_MESH mesh, int lodLevel)
+{
+	if ((mesh != MESH_CYLINDER) || (lodLevel < 0))
+	{
+		LoadBasicMesh(mesh);
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case MESH_CYLINDER:
+		if (lodLevel >= 0)
+		{
+			m_meshLibrary.DrawLODMesh(MeshLibrary::LOD_CYLINDER, lodLevel);
+		}
+		else
+		{
+			m_basicMeshes->DrawCylinderMesh();
+		}
+		break;
+	}
+}
+
+/***********************************************************
+ *  SelectCylinderLevel()
+ *
+ *  This method is used for picking the tessellation level
+ *  that fits the projected size of a cylinder's bounds, so
+ *  thin legs far away use few triangles while a large
+ *  cylinder around the camera keeps the finest level.  Only
+ *  the object's own level is changed, so different objects
+ *  can be selected on different job threads.
+ ***********************************************************/
+int SceneManager::SelectCylinderLevel(uint32_t objectIndex)
+{
+	glm::vec3 center;
+	glm::vec3 extents;
+
+	m_frustumCuller.GetBounds(objectIndex, center, extents);
+	float screenSize = LODSelector::GetScreenSize(
+		m_viewMatrix, m_projectionMatrix, center, glm::length(extents));
+
+	return(m_lodSelector.SelectLevel(objectIndex, screenSize));
+}
+
+/***********************************************************
+ *  CreateDrawDataBuffers()
+ *
+ *  This method is used for creating the ring buffer that
+ *  the per draw values are written into every frame, and
+ *  the buffer of the defined materials, which only changes
+ *  when the materials do.  Without persistent mapping the
+ *  draws keep setting the uniforms.
+ ***********************************************************/
+bool SceneManager::CreateDrawDataBuffers()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	GLint alignment = 256;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+	// every object and its occlusion query bounds once per frame
+	size_t drawCapacity = m_renderEntities.size() * 2 + 64;
+	if (m_drawDataRing.Create(drawCapacity * sizeof(DRAW_DATA), g_FramesInFlight, (size_t)alignment) == false)
+	{
+		std::cout << "INFO: Per draw values are set with uniforms" << std::endl;
+		return(false);
+	}
+
+	std::vector<MATERIAL_DATA> materials(std::max((size_t)1, m_objectMaterials.size()));
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		materials[i].diffuseColor = glm::vec4(m_objectMaterials[i].diffuseColor, 0.0f);
+		materials[i].specularColor = glm::vec4(m_objectMaterials[i].specularColor, m_objectMaterials[i].shininess);
+	}
+
+	glGenBuffers(1, &m_materialBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER,
+		materials.size() * sizeof(MATERIAL_DATA), materials.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_MaterialBinding, m_materialBuffer);
+
+	// the texture units are bound once, so the sampler array
+	// only needs to point at them once
+	for (int i = 0; i < g_DrawTextureCount; i++)
+	{
+		m_pShaderManager->setSampler2DValue("objectTextures[" + std::to_string(i) + "]", i);
+	}
+	if (m_loadedTextures > g_DrawTextureCount)
+	{
+		std::cout << "WARNING: Only the first " << g_DrawTextureCount
+			<< " textures can be used from the draw data buffer" << std::endl;
+	}
+
+	m_drawIndexLocation = glGetUniformLocation(m_pShaderManager->m_programID, "drawIndex");
+
+	std::cout << "INFO: Per draw values are read from a persistent mapped ring buffer ("
+		<< g_FramesInFlight << " x " << drawCapacity << " draws)" << std::endl;
+
+	// one indirect command for every object in the scene, the
+	// shaders read the draw index from gl_BaseInstance, which
+	// OpenGL 4.5 only has with the shader draw parameters
+	if ((GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) &&
+		(GLEW_VERSION_4_6 || GLEW_ARB_shader_draw_parameters) &&
+		(m_meshLibrary.IsLoaded() == true))
+	{
+		size_t commandCapacity = m_renderEntities.size() + 64;
+		if (m_indirectRing.Create(commandCapacity * sizeof(INDIRECT_COMMAND), g_FramesInFlight) == true)
+		{
+			std::cout << "INFO: Visible objects are drawn with multi-draw indirect from the mesh pool" << std::endl;
+		}
+	}
+	m_bIndirectCommands = m_indirectRing.IsCreated();
+	if (m_bIndirectCommands == false)
+	{
+		std::cout << "INFO: Visible objects are drawn one at a time" << std::endl;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  BeginDrawData()
+ *
+ *  This method is used for starting the frame's region of
+ *  the ring buffer and binding it for the shaders.
+ ***********************************************************/
+void SceneManager::BeginDrawData()
+{
+	m_bDrawDataActive = false;
+	if ((m_drawDataRing.IsCreated() == false) || (NULL == m_pShaderManager))
+	{
+		return;
+	}
+
+	GrowDrawDataBuffers();
+
+	m_drawDataRing.BeginFrame();
+	m_drawDataRing.BindFrameRange(GL_SHADER_STORAGE_BUFFER, g_DrawDataBinding);
+	m_indirectRing.BeginFrame();
+	glUniform1i(m_uniforms.bUseDrawData, true);
+	m_bDrawDataActive = true;
+}
+
+/***********************************************************
+ *  EndDrawData()
+ *
+ *  This method is used for fencing the frame's region after
+ *  the last draw that reads it.
+ ***********************************************************/
+void SceneManager::EndDrawData()
+{
+	if (m_drawDataRing.IsCreated() == true)
+	{
+		m_drawDataRing.EndFrame();
+	}
+	if (m_indirectRing.IsCreated() == true)
+	{
+		m_indirectRing.EndFrame();
+	}
+}
+
+/***********************************************************
+ *  GrowDrawDataBuffers()
+ *
+ *  This method is used for growing the ring buffers when the
+ *  last frame asked for more than a region holds, which
+ *  happens when objects are added after the buffers were
+ *  made.  It runs before the next frame starts, and the
+ *  regions get room to spare, so they are not grown every
+ *  frame while the scene keeps growing.  If a buffer cannot
+ *  be grown, the frames keep falling back to the uniforms.
+ ***********************************************************/
+void SceneManager::GrowDrawDataBuffers()
+{
+	size_t drawBytes = m_drawDataRing.GetRequestedBytes();
+	if (drawBytes > m_drawDataRing.GetFrameBytes())
+	{
+		// the draws stop asking once the region is full, so the
+		// region at least doubles
+		drawBytes = std::max(drawBytes, m_drawDataRing.GetFrameBytes() * 2);
+		if (m_drawDataRing.Resize(drawBytes + drawBytes / 2) == false)
+		{
+			return;
+		}
+		std::cout << "INFO: Draw data buffer grown to " << g_FramesInFlight << " x "
+			<< m_drawDataRing.GetFrameBytes() / sizeof(DRAW_DATA) << " draws" << std::endl;
+	}
+
+	size_t commandBytes = m_indirectRing.GetRequestedBytes();
+	if (commandBytes > m_indirectRing.GetFrameBytes())
+	{
+		m_indirectRing.Resize(commandBytes + commandBytes / 2);
+	}
+}
+
+/***********************************************************
+ *  StopDrawData()
+ *
+ *  This method is used for going back to setting the
+ *  uniforms when the frame's region is full.  The buffer is
+ *  grown before the next frame, so this is only reported
+ *  the first time.
+ ***********************************************************/
+void SceneManager::StopDrawData()
+{
+	if (m_bReportedDrawDataFull == false)
+	{
+		std::cout << "WARNING: Draw data buffer is full, using uniforms until it is grown" << std::endl;
+		m_bReportedDrawDataFull = true;
+	}
+	glUniform1i(m_uniforms.bUseDrawData, false);
+	m_bDrawDataActive = false;
+}
+
+/***********************************************************
+ *  WriteDrawData()
+ *
+ *  This method is used for writing the values of the next
+ *  draw straight into the mapped buffer and pointing the
+ *  shaders at them.  If the region is full, the rest of the
+ *  frame goes back to setting the uniforms.
+ ***********************************************************/
+bool SceneManager::WriteDrawData(
+	const glm::mat4& model,
+	const glm::vec4& color,
+	int textureSlot,
+	int materialIndex,
+	bool bPackedNormal)
+{
+	if (m_bDrawDataActive == false)
+	{
+		return(false);
+	}
+
+	size_t offset = 0;
+	DRAW_DATA* pDrawData = (DRAW_DATA*)m_drawDataRing.Allocate(sizeof(DRAW_DATA), sizeof(DRAW_DATA), offset);
+	if (pDrawData == NULL)
+	{
+		StopDrawData();
+		return(false);
+	}
+
+	FillDrawData(*pDrawData, model, color, textureSlot, materialIndex, bPackedNormal);
+
+	glUniform1i(m_drawIndexLocation, (GLint)(offset / sizeof(DRAW_DATA)));
+	return(true);
+}
+
+/***********************************************************
+ *  FillDrawData()
+ *
+ *  This method is used for filling in the values of one
+ *  draw.  Texture slots past the sampler array are drawn
+ *  untextured.
+ ***********************************************************/
+void SceneManager::FillDrawData(
+	DRAW_DATA& drawData,
+	const glm::mat4& model,
+	const glm::vec4& color,
+	int textureSlot,
+	int materialIndex,
+	bool bPackedNormal)
+{
+	drawData.model = model;
+	drawData.color = color;
+	drawData.uvScale = glm::vec2(1.0f, 1.0f);
+	drawData.materialIndex = materialIndex;
+	drawData.textureSlot = (textureSlot < g_DrawTextureCount) ? textureSlot : -1;
+	drawData.flags = (bPackedNormal == true) ? g_DrawFlagPackedNormal : 0;
+}
+
+/***********************************************************
+ *  SetMultiDrawIndirect()
+ *
+ *  This method is used for enabling or disabling drawing the
+ *  visible objects with multi-draw indirect calls.
+ ***********************************************************/
+void SceneManager::SetMultiDrawIndirect(bool bEnabled)
+{
+	m_frameSettings.bMultiDraw = bEnabled;
+}
+
+/***********************************************************
+ *  RecordFramePacket()
+ *
+ *  This method is used for turning the visible objects into
+ *  the draws of a frame packet.  The objects are grouped by
+ *  texture with a counting sort on the texture slot plus
+ *  one, which keeps the scene order within each group, and
+ *  the sort keys, the LOD levels, the per draw values and
+ *  the render commands are recorded on the job threads.  A
+ *  packet that is drawn right away on the render thread is
+ *  written straight into the mapped buffers instead of the
+ *  packet's own storage.
+ ***********************************************************/
+void SceneManager::RecordFramePacket(FRAME_PACKET& packet, bool bMapBuffers)
+{
+	size_t drawCount = m_visibleObjects.size();
+
+	packet.bMultiDraw = (m_bMultiDraw == true) && (m_bIndirectCommands == true);
+	packet.bMapped = false;
+	packet.commandStart = 0;
+	packet.lodTriangles = 0;
+
+	// the frame last built into the packet has been drawn, so
+	// its arenas start over
+	int slotCount = m_jobSystem.GetSlotCount();
+	uint32_t growCount = 0;
+	for (int i = 0; i < slotCount; i++)
+	{
+		packet.pArenas[i].Reset();
+		growCount += packet.pArenas[i].GetGrowCount();
+	}
+	FrameArena* pArena = &packet.pArenas[m_jobSystem.GetWorkerIndex()];
+
+	FrameVector<uint8_t> drawKeys(drawCount, 0, FrameAllocator<uint8_t>(pArena));
+	m_jobSystem.ParallelFor((uint32_t)drawCount, g_MinObjectsPerJob,
+		[this, &drawKeys](uint32_t first, uint32_t last)
+		{
+			for (uint32_t i = first; i < last; i++)
+			{
+				drawKeys[i] = (uint8_t)(GetTextureSlot(m_renderEntities[m_visibleObjects[i]]) + 1);
+			}
+		});
+
+	size_t keyStarts[g_TextureSlotCount + 2] = { 0 };
+	for (size_t i = 0; i < drawCount; i++)
+	{
+		keyStarts[drawKeys[i] + 1]++;
+	}
+	for (int key = 1; key <= g_TextureSlotCount + 1; key++)
+	{
+		keyStarts[key] += keyStarts[key - 1];
+	}
+	packet.draws = FrameVector<PACKET_DRAW>(drawCount, PACKET_DRAW(), FrameAllocator<PACKET_DRAW>(pArena));
+	packet.drawKeys = FrameVector<uint8_t>(drawCount, 0, FrameAllocator<uint8_t>(pArena));
+	for (size_t i = 0; i < drawCount; i++)
+	{
+		size_t position = keyStarts[drawKeys[i]]++;
+		packet.draws[position].objectIndex = m_visibleObjects[i];
+		packet.drawKeys[position] = drawKeys[i];
+	}
+
+	GLuint firstDrawIndex = 0;
+	if ((bMapBuffers == true) && (packet.bMultiDraw == true) && (m_bDrawDataActive == true) && (drawCount > 0))
+	{
+		size_t drawOffset = 0;
+		size_t commandOffset = 0;
+		packet.pDrawData = (DRAW_DATA*)m_drawDataRing.Allocate(
+			drawCount * sizeof(DRAW_DATA), sizeof(DRAW_DATA), drawOffset);
+		packet.pCommands = (INDIRECT_COMMAND*)m_indirectRing.Allocate(
+			drawCount * sizeof(INDIRECT_COMMAND), sizeof(GLuint), commandOffset);
+		packet.bMapped = (packet.pDrawData != NULL) && (packet.pCommands != NULL);
+		firstDrawIndex = (GLuint)(drawOffset / sizeof(DRAW_DATA));
+		packet.commandStart = m_indirectRing.GetFrameStart() + commandOffset;
+	}
+	// the per draw values are read by both pipelines, while the
+	// indirect commands are only taken from the arena when they
+	// are made, so the arena only grows by what the frame uses
+	packet.drawData = FrameVector<DRAW_DATA>(FrameAllocator<DRAW_DATA>(pArena));
+	packet.commands = FrameVector<INDIRECT_COMMAND>(FrameAllocator<INDIRECT_COMMAND>(pArena));
+	if (packet.bMapped == false)
+	{
+		packet.drawData.resize(drawCount);
+		packet.pDrawData = packet.drawData.data();
+		packet.pCommands = NULL;
+		if (packet.bMultiDraw == true)
+		{
+			packet.commands.resize(drawCount);
+			packet.pCommands = packet.commands.data();
+		}
+		firstDrawIndex = 0;
+	}
+
+	// every chunk of draws is recorded into a command buffer
+	// of its own, so the job threads never share a buffer and
+	// the merged buffers keep the sorted order - the commands
+	// are stored in the arena of the thread recording them
+	size_t bufferCount = (drawCount + g_DrawsPerCommandBuffer - 1) / g_DrawsPerCommandBuffer;
+	packet.commandBuffers = FrameVector<RenderCommandBuffer>(
+		bufferCount, RenderCommandBuffer(), FrameAllocator<RenderCommandBuffer>(pArena));
+
+	// the mesh pool only holds packed vertices, while of the
+	// basic meshes only the cylinder levels are packed
+	bool bPackedPool = (m_meshLibrary.GetVertexFormat() == MeshLibrary::VERTEX_FORMAT_PACKED);
+	std::atomic<int> lodTriangles(0);
+	std::atomic<uint64_t> triangles(0);
+
+	m_jobSystem.ParallelFor((uint32_t)bufferCount, 1,
+		[this, &packet, drawCount, bPackedPool, firstDrawIndex, &lodTriangles, &triangles](uint32_t firstBuffer, uint32_t lastBuffer)
+		{
+			int chunkTriangles = 0;
+			uint64_t chunkAllTriangles = 0;
+			FrameArena& arena = packet.pArenas[m_jobSystem.GetWorkerIndex()];
+
+			for (uint32_t b = firstBuffer; b < lastBuffer; b++)
+			{
+				RenderCommandBuffer& commands = packet.commandBuffers[b];
+				commands.SetStorage((RenderCommandBuffer::RENDER_COMMAND*)arena.Allocate(
+					g_CommandBufferCapacity * sizeof(RenderCommandBuffer::RENDER_COMMAND),
+					alignof(RenderCommandBuffer::RENDER_COMMAND)), g_CommandBufferCapacity);
+				uint32_t first = b * g_DrawsPerCommandBuffer;
+				uint32_t last = (uint32_t)std::min(drawCount, (size_t)(first + g_DrawsPerCommandBuffer));
+
+				commands.BindPipeline((packet.bMultiDraw == true) ? PIPELINE_MESH_POOL : PIPELINE_OBJECTS);
+
+				for (uint32_t i = first; i < last; i++)
+				{
+					PACKET_DRAW& draw = packet.draws[i];
+					ENTITY entity = m_renderEntities[draw.objectIndex];
+					const TRANSFORM_COMPONENT& transform = m_registry.Get<TRANSFORM_COMPONENT>(entity);
+					const MATERIAL_COMPONENT& objectMaterial = m_registry.Get<MATERIAL_COMPONENT>(entity);
+					int textureSlot = (int)packet.drawKeys[i] - 1;
+
+					draw.mesh = m_registry.Get<MESH_COMPONENT>(entity).mesh;
+					draw.lodLevel = -1;
+					if ((draw.mesh == MESH_CYLINDER) && (m_bMeshLOD == true))
+					{
+						draw.lodLevel = SelectCylinderLevel(draw.objectIndex);
+						chunkTriangles += m_meshLibrary.GetTriangleCount(MeshLibrary::LOD_CYLINDER, draw.lodLevel);
+					}
+
+					bool bPackedNormal = bPackedPool && ((packet.bMultiDraw == true) || (draw.lodLevel >= 0));
+					FillDrawData(packet.pDrawData[i], transform.modelMatrix, objectMaterial.color,
+						textureSlot, objectMaterial.materialIndex, bPackedNormal);
+
+					// without LOD the cylinders use the finest level, and
+					// the basic meshes have the triangles of their range
+					const MeshLibrary::MESH_RANGE* pRange = NULL;
+					switch (draw.mesh)
+					{
+					case MESH_PLANE:
+						pRange = &m_meshLibrary.GetMeshRange(MeshLibrary::FIXED_PLANE);
+						break;
+					case MESH_BOX:
+						pRange = &m_meshLibrary.GetMeshRange(MeshLibrary::FIXED_BOX);
+						break;
+					default:
+						pRange = &m_meshLibrary.GetMeshRange(MeshLibrary::LOD_CYLINDER, std::max(0, draw.lodLevel));
+						break;
+					}
+					chunkAllTriangles += pRange->indexCount / 3;
+
+					if (packet.bMultiDraw == false)
+					{
+						commands.BindMaterial(objectMaterial.materialIndex, textureSlot);
+						commands.SetDrawData(i);
+						commands.Draw((uint32_t)draw.mesh, draw.lodLevel);
+						continue;
+					}
+
+					INDIRECT_COMMAND& command = packet.pCommands[i];
+					command.count = pRange->indexCount;
+					command.instanceCount = 1;
+					command.firstIndex = pRange->firstIndex;
+					command.baseVertex = pRange->baseVertex;
+					command.baseInstance = firstDrawIndex + (GLuint)i;
+				}
+
+				// one multi-draw call per run of draws with the same
+				// texture, so the sampler index stays the same for the
+				// whole call - the replay joins the runs that continue
+				// into the next buffer
+				uint32_t runFirst = first;
+				while ((packet.bMultiDraw == true) && (runFirst < last))
+				{
+					uint32_t runLast = runFirst + 1;
+					while ((runLast < last) && (packet.drawKeys[runLast] == packet.drawKeys[runFirst]))
+					{
+						runLast++;
+					}
+					commands.DrawIndirect(runFirst, runLast - runFirst, packet.drawKeys[runFirst]);
+					runFirst = runLast;
+				}
+			}
+
+			lodTriangles += chunkTriangles;
+			triangles += chunkAllTriangles;
+		});
+	packet.lodTriangles = lodTriangles.load();
+	packet.profile.visibleObjects = (uint32_t)drawCount;
+	packet.profile.triangles = triangles.load();
+
+	// once the arenas have seen the largest frame, building a
+	// packet takes nothing from the heap
+	packet.arenaGrowth = 0;
+	for (int i = 0; i < slotCount; i++)
+	{
+		packet.arenaGrowth += packet.pArenas[i].GetGrowCount();
+	}
+	packet.arenaGrowth -= growCount;
+}
+
+/***********************************************************
+ *  SubmitFramePacket()
+ *
+ *  This method is used for making the draws of a packet by
+ *  replaying its render commands.  When the buffers for the
+ *  multi-draw calls are full, the objects are drawn one at
+ *  a time instead.
+ ***********************************************************/
+void SceneManager::SubmitFramePacket(const FRAME_PACKET& packet)
+{
+	m_lodTriangles += packet.lodTriangles;
+
+	if (packet.draws.size() == 0)
+	{
+		return;
+	}
+
+	// the draws are grouped by texture, so each texture is
+	// only requested once per frame
+	for (size_t i = 0; i < packet.drawKeys.size(); i++)
+	{
+		if ((i == 0) || (packet.drawKeys[i] != packet.drawKeys[i - 1]))
+		{
+			RequestTexture((int)packet.drawKeys[i] - 1);
+		}
+	}
+
+	if (packet.bMultiDraw == true)
+	{
+		if (PrepareMultiDraw(packet) == false)
+		{
+			for (size_t i = 0; i < packet.draws.size(); i++)
+			{
+				const PACKET_DRAW& draw = packet.draws[i];
+				DrawSceneObject(draw.objectIndex, draw.lodLevel, packet.pDrawData[i]);
+			}
+			return;
+		}
+	}
+	else
+	{
+		PrepareObjectDraws(packet);
+	}
+
+	m_pReplayPacket = &packet;
+	m_replayPipeline = g_NoPipeline;
+	m_bReplayPackedNormal = false;
+	RenderCommandBuffer::Replay(packet.commandBuffers.data(), packet.commandBuffers.size(),
+		&SceneManager::ReplayCommand, this, m_replayStats);
+	m_pReplayPacket = NULL;
+
+	if (m_replayPipeline == PIPELINE_MESH_POOL)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+	if ((m_bReplayPackedNormal == true) && (NULL != m_pShaderManager))
+	{
+		glUniform1i(m_uniforms.bUsePackedNormal, false);
+	}
+}
+/***********************************************************
+ *  PrepareMultiDraw()
+ *
+ *  This method is used for making the draw data and the
+ *  indirect commands of a packet available to the GPU.
+ *  Packets built ahead are copied into the mapped buffers
+ *  here, with the draw indices moved to the frame's region.
+ ***********************************************************/
+bool SceneManager::PrepareMultiDraw(const FRAME_PACKET& packet)
+{
+	if ((m_bDrawDataActive == false) || (m_indirectRing.IsCreated() == false))
+	{
+		return(false);
+	}
+
+	if (packet.bMapped == true)
+	{
+		m_replayCommandStart = packet.commandStart;
+		return(true);
+	}
+
+	size_t drawCount = packet.draws.size();
+	size_t drawOffset = 0;
+	size_t commandOffset = 0;
+	DRAW_DATA* pDrawData = (DRAW_DATA*)m_drawDataRing.Allocate(
+		drawCount * sizeof(DRAW_DATA), sizeof(DRAW_DATA), drawOffset);
+	INDIRECT_COMMAND* pCommands = (INDIRECT_COMMAND*)m_indirectRing.Allocate(
+		drawCount * sizeof(INDIRECT_COMMAND), sizeof(GLuint), commandOffset);
+	if ((pDrawData == NULL) || (pCommands == NULL))
+	{
+		return(false);
+	}
+
+	GLuint firstDrawIndex = (GLuint)(drawOffset / sizeof(DRAW_DATA));
+	std::memcpy(pDrawData, packet.pDrawData, drawCount * sizeof(DRAW_DATA));
+	for (size_t i = 0; i < drawCount; i++)
+	{
+		pCommands[i] = packet.pCommands[i];
+		pCommands[i].baseInstance += firstDrawIndex;
+	}
+	m_replayCommandStart = m_indirectRing.GetFrameStart() + commandOffset;
+	return(true);
+}
+
+/***********************************************************
+ *  PrepareObjectDraws()
+ *
+ *  This method is used for copying the draw data of a packet
+ *  into the mapped buffer in one block.  If the region is
+ *  full, the rest of the frame goes back to setting the
+ *  uniforms.
+ ***********************************************************/
+void SceneManager::PrepareObjectDraws(const FRAME_PACKET& packet)
+{
+	m_replayFirstDraw = 0;
+	if (m_bDrawDataActive == false)
+	{
+		return;
+	}
+
+	size_t drawCount = packet.draws.size();
+	size_t drawOffset = 0;
+	DRAW_DATA* pDrawData = (DRAW_DATA*)m_drawDataRing.Allocate(
+		drawCount * sizeof(DRAW_DATA), sizeof(DRAW_DATA), drawOffset);
+	if (pDrawData == NULL)
+	{
+		StopDrawData();
+		return;
+	}
+
+	std::memcpy(pDrawData, packet.pDrawData, drawCount * sizeof(DRAW_DATA));
+	m_replayFirstDraw = (GLuint)(drawOffset / sizeof(DRAW_DATA));
+}
+
+/***********************************************************
+ *  ReplayCommand()
+ *
+ *  This method is used for passing a replayed command to
+ *  the scene manager that recorded it.
+ ***********************************************************/
+void SceneManager::ReplayCommand(void* pContext, const RenderCommandBuffer::RENDER_COMMAND& command)
+{
+	((SceneManager*)pContext)->ExecuteRenderCommand(command);
+}
+
+/***********************************************************
+ *  ExecuteRenderCommand()
+ *
+ *  This method is used for turning one render command into
+ *  OpenGL calls.  While the draws read the draw data buffer
+ *  a material bind changes nothing, since the material and
+ *  texture are part of the per draw values, and the draw
+ *  data only selects the draw index - otherwise both set
+ *  the uniforms they stand for.
+ ***********************************************************/
+void SceneManager::ExecuteRenderCommand(const RenderCommandBuffer::RENDER_COMMAND& command)
+{
+	switch (command.type)
+	{
+	case RenderCommandBuffer::COMMAND_BIND_PIPELINE:
+		m_replayPipeline = command.values[0];
+		if (m_replayPipeline == PIPELINE_MESH_POOL)
+		{
+			// the draw index uniform is added to gl_BaseInstance
+			glUniform1i(m_drawIndexLocation, 0);
+			m_meshLibrary.BindMeshPool();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectRing.GetBuffer());
+		}
+		break;
+
+	case RenderCommandBuffer::COMMAND_BIND_MATERIAL:
+		if ((m_bDrawDataActive == false) && (NULL != m_pShaderManager))
+		{
+			int materialIndex = (int)command.values[0];
+			int textureSlot = (int)command.values[1];
+
+			glUniform1i(m_uniforms.bUseTexture, (textureSlot >= 0) ? 1 : 0);
+			if (textureSlot >= 0)
+			{
+				glUniform1i(m_uniforms.objectTexture, textureSlot);
+			}
+			if ((materialIndex >= 0) && (materialIndex < (int)m_objectMaterials.size()))
+			{
+				const OBJECT_MATERIAL& material = m_objectMaterials[materialIndex];
+				glUniform3fv(m_uniforms.materialDiffuseColor, 1, glm::value_ptr(material.diffuseColor));
+				glUniform3fv(m_uniforms.materialSpecularColor, 1, glm::value_ptr(material.specularColor));
+				glUniform1f(m_uniforms.materialShininess, material.shininess);
+			}
+		}
+		break;
+
+	case RenderCommandBuffer::COMMAND_SET_DRAW_DATA:
+		if (m_bDrawDataActive == true)
+		{
+			glUniform1i(m_drawIndexLocation, (GLint)(m_replayFirstDraw + command.values[0]));
+		}
+		else if (NULL != m_pShaderManager)
+		{
+			const DRAW_DATA& values = m_pReplayPacket->pDrawData[command.values[0]];
+			bool bPackedNormal = ((values.flags & g_DrawFlagPackedNormal) != 0);
+
+			glUniformMatrix4fv(m_uniforms.model, 1, GL_FALSE, glm::value_ptr(values.model));
+			glUniform4fv(m_uniforms.objectColor, 1, glm::value_ptr(values.color));
+			if (bPackedNormal != m_bReplayPackedNormal)
+			{
+				glUniform1i(m_uniforms.bUsePackedNormal, bPackedNormal);
+				m_bReplayPackedNormal = bPackedNormal;
+			}
+		}
+		break;
+
+	case RenderCommandBuffer::COMMAND_DRAW:
+		DrawMesh((SCENE_MESH)command.values[0], (int)command.values[1]);
+		break;
+
+	case RenderCommandBuffer::COMMAND_DRAW_INDIRECT:
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(void*)(m_replayCommandStart + command.values[0] * sizeof(INDIRECT_COMMAND)),
+			(GLsizei)command.values[1], sizeof(INDIRECT_COMMAND));
+		break;
+	}
+}
+/***********************************************************
+ *  SetGpuCulling()
+ *
+ *  This method is used for enabling or disabling culling
+ *  and draw generation with compute shaders.
+ ***********************************************************/
+void SceneManager::SetGpuCulling(bool bEnabled)
+{
+	m_frameSettings.bGpuCulling = bEnabled;
+}
+
+/***********************************************************
+ *  CreateGpuCulling()
+ *
+ *  This method is used for creating the compute shader
+ *  culling with the mesh pool ranges and one bucket for the
+ *  untextured objects plus one for each texture slot, then
+ *  sending every scene object to it.
+ ***********************************************************/
+bool SceneManager::CreateGpuCulling()
+{
+	if ((m_meshLibrary.IsLoaded() == false) || (m_renderEntities.empty() == true))
+	{
+		return(false);
+	}
+
+	// the box, the plane, then the cylinder levels finest first
+	std::vector<GpuCuller::GPU_MESH_RANGE> ranges;
+	const MeshLibrary::MESH_RANGE* poolRanges[2 + MeshLibrary::LOD_LEVEL_COUNT];
+	poolRanges[0] = &m_meshLibrary.GetMeshRange(MeshLibrary::FIXED_BOX);
+	poolRanges[1] = &m_meshLibrary.GetMeshRange(MeshLibrary::FIXED_PLANE);
+	for (int level = 0; level < MeshLibrary::LOD_LEVEL_COUNT; level++)
+	{
+		poolRanges[2 + level] = &m_meshLibrary.GetMeshRange(MeshLibrary::LOD_CYLINDER, level);
+	}
+	for (size_t i = 0; i < sizeof(poolRanges) / sizeof(poolRanges[0]); i++)
+	{
+		GpuCuller::GPU_MESH_RANGE range = { poolRanges[i]->firstIndex,
+			poolRanges[i]->indexCount, poolRanges[i]->baseVertex, 0 };
+		ranges.push_back(range);
+	}
+
+	if (m_gpuCuller.Create(m_renderEntities.size(), sizeof(DRAW_DATA), g_DrawTextureCount + 1, ranges) == false)
+	{
+		return(false);
+	}
+	m_gpuCuller.SetLODThresholds(m_lodSelector.GetThresholds());
+
+	for (uint32_t i = 0; i < (uint32_t)m_renderEntities.size(); i++)
+	{
+		UpdateGpuObject(i);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateGpuObject()
+ *
+ *  This method is used for sending the draw values, bounds,
+ *  mesh ranges and texture bucket of a scene object to the
+ *  GPU culling.  Only the objects passed in here are
+ *  uploaded before the next cull.
+ ***********************************************************/
+void SceneManager::UpdateGpuObject(uint32_t objectIndex)
+{
+	if ((m_gpuCuller.IsCreated() == false) || (objectIndex >= m_renderEntities.size()))
+	{
+		return;
+	}
+
+	ENTITY entity = m_renderEntities[objectIndex];
+	const TRANSFORM_COMPONENT& transform = m_registry.Get<TRANSFORM_COMPONENT>(entity);
+	const MATERIAL_COMPONENT& objectMaterial = m_registry.Get<MATERIAL_COMPONENT>(entity);
+	bool bPackedNormal = (m_meshLibrary.GetVertexFormat() == MeshLibrary::VERTEX_FORMAT_PACKED);
+	DRAW_DATA drawData;
+	glm::vec3 center;
+	glm::vec3 extents;
+
+	FillDrawData(drawData, transform.modelMatrix, objectMaterial.color,
+		GetTextureSlot(entity), objectMaterial.materialIndex, bPackedNormal);
+	m_frustumCuller.GetBounds(objectIndex, center, extents);
+
+	// ranges in the order CreateGpuCulling() adds them
+	uint32_t firstRange = 0;
+	uint32_t rangeCount = 1;
+	switch (m_registry.Get<MESH_COMPONENT>(entity).mesh)
+	{
+	case MESH_PLANE:
+		firstRange = 1;
+		break;
+	case MESH_CYLINDER:
+		firstRange = 2;
+		rangeCount = MeshLibrary::LOD_LEVEL_COUNT;
+		break;
+	default:
+		break;
+	}
+
+	// bucket 0 holds the untextured objects
+	int bucket = ((drawData.textureSlot >= 0) && (drawData.textureSlot < g_DrawTextureCount)) ?
+		drawData.textureSlot + 1 : 0;
+
+	m_gpuCuller.SetObject(objectIndex, &drawData, center, extents, firstRange, rangeCount, bucket);
+}
+
+/***********************************************************
+ *  RenderWithGpuCulling()
+ *
+ *  This method is used for culling the scene objects with
+ *  the compute pass and drawing the buckets it filled.  The
+ *  draw records of all the objects stay on the GPU, so the
+ *  CPU cost per frame does not depend on the object count.
+ *  With occlusion culling on, the pass also tests the depth
+ *  pyramid built from the previous frame.
+ ***********************************************************/
+bool SceneManager::RenderWithGpuCulling()
+{
+	if ((m_bDrawDataActive == false) || (m_gpuCuller.IsCreated() == false))
+	{
+		return(false);
+	}
+
+	// which objects the GPU draws is not read back, so every
+	// texture is requested
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		RequestTexture(i);
+	}
+
+	m_frustumCuller.SetFrustum(m_projectionMatrix * m_viewMatrix);
+	m_gpuCuller.Cull(m_frustumCuller.GetPlanes(), m_viewMatrix, m_projectionMatrix,
+		m_bMeshLOD, m_bSoftwareOcclusion);
+
+	m_serialPacket.profile.uploadedObjects = (uint32_t)m_gpuCuller.GetUploadedObjectCount();
+
+	// the draw index uniform is added to gl_BaseInstance, which
+	// holds the object index in every generated command
+	glUniform1i(m_drawIndexLocation, 0);
+	m_meshLibrary.BindMeshPool();
+	m_serialPacket.profile.gpuCullDrawCalls = (uint32_t)m_gpuCuller.DrawBuckets(g_DrawDataBinding);
+	glBindVertexArray(0);
+
+	// later draws this frame read the ring buffer again
+	m_drawDataRing.BindFrameRange(GL_SHADER_STORAGE_BUFFER, g_DrawDataBinding);
+
+	if (m_bSoftwareOcclusion == true)
+	{
+		m_gpuCuller.BuildDepthPyramid();
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  SetMeshLOD()
+ *
+ *  This method is used for enabling or disabling the screen
+ *  size based tessellation levels of the cylinders.
+ ***********************************************************/
+void SceneManager::SetMeshLOD(bool bEnabled)
+{
+	m_frameSettings.bMeshLOD = bEnabled;
+}
+
+/***********************************************************
+ *  SetOcclusionQueries()
+ *
+ *  This method is used for enabling or disabling occlusion
+ *  culling with hardware queries.  The switch is taken over
+ *  with the next frame that is built, which is when
+ *  ApplyFrameSettings() forgets the old query results.
+ ***********************************************************/
+void SceneManager::SetOcclusionQueries(bool bEnabled)
+{
+	m_frameSettings.bOcclusionQueries = bEnabled;
+}
+
+/***********************************************************
+ *  DrawObjectBounds()
+ *
+ *  This method is used for drawing the world space bounds
+ *  of a scene object with color and depth writes disabled,
+ *  so only the depth test result is counted by the query.
+ ***********************************************************/
+void SceneManager::DrawObjectBounds(uint32_t objectIndex)
+{
+	glm::vec3 center;
+	glm::vec3 extents;
+
+	m_frustumCuller.GetBounds(objectIndex, center, extents);
+
+	// the bounds are grown slightly so that the box never
+	// fights with the object's own surfaces in the depth test
+	glm::vec3 size = (extents + glm::vec3(0.01f)) * 2.0f;
+	glm::mat4 model = glm::translate(center) * glm::scale(size);
+	if ((WriteDrawData(model, glm::vec4(1.0f), -1, 0, false) == false) && (NULL != m_pShaderManager))
+	{
+		glUniformMatrix4fv(m_uniforms.model, 1, GL_FALSE, glm::value_ptr(model));
+	}
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	LoadBasicMesh(MESH_BOX);
+	m_basicMeshes->DrawBoxMesh();
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+/***********************************************************
+ *  RenderWithOcclusionQueries()
+ *
+ *  This method is used for drawing the visible objects with
+ *  occlusion culling.  The occluders are drawn first to fill
+ *  the depth buffer.  Every other object is drawn inside its
+ *  query unless last frame's query proved it hidden, in
+ *  which case only its bounds are drawn inside the query to
+ *  find out when it comes back into view.
+ ***********************************************************/
+void SceneManager::RenderWithOcclusionQueries()
+{
+	// the camera position is the translation of the inverse view
+	glm::vec3 cameraPosition = glm::vec3(glm::inverse(m_viewMatrix)[3]);
+
+	m_occlusionQueries.BeginFrame();
+
+	std::fill(m_inFrustumFlags.begin(), m_inFrustumFlags.end(), (uint8_t)0);
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		m_inFrustumFlags[m_visibleObjects[i]] = 1;
+	}
+
+	// objects outside the frustum are not queried this frame
+	for (uint32_t i = 0; i < (uint32_t)m_renderEntities.size(); i++)
+	{
+		if (m_inFrustumFlags[i] == 0)
+		{
+			m_occlusionQueries.ResetObject(i);
+		}
+	}
+
+	// draw the occluders first so their depth hides the rest
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		if (m_registry.Get<MESH_COMPONENT>(m_renderEntities[m_visibleObjects[i]]).bOccluder == true)
+		{
+			DrawSceneObject(m_visibleObjects[i]);
+		}
+	}
+
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		uint32_t objectIndex = m_visibleObjects[i];
+		glm::vec3 center;
+		glm::vec3 extents;
+
+		if (m_registry.Get<MESH_COMPONENT>(m_renderEntities[objectIndex]).bOccluder == true)
+		{
+			continue;
+		}
+
+		// bounds around the camera cannot be tested since their
+		// faces are clipped away, like a sky around the scene
+		m_frustumCuller.GetBounds(objectIndex, center, extents);
+		glm::vec3 offset = glm::abs(cameraPosition - center);
+		if ((offset.x <= extents.x + 0.1f) &&
+			(offset.y <= extents.y + 0.1f) &&
+			(offset.z <= extents.z + 0.1f))
+		{
+			m_occlusionQueries.ResetObject(objectIndex);
+			DrawSceneObject(objectIndex);
+			continue;
+		}
+
+		bool bHidden = m_occlusionQueries.IsObjectHidden(objectIndex);
+		bool bQuery = m_occlusionQueries.CanIssueQuery(objectIndex);
+
+		m_occlusionQueries.CountTestedDraw();
+		if (bQuery == true)
+		{
+			m_occlusionQueries.BeginQuery(objectIndex);
+		}
+
+		if (bHidden == true)
+		{
+			m_occlusionQueries.CountSkippedDraw();
+			if (bQuery == true)
+			{
+				DrawObjectBounds(objectIndex);
+			}
+		}
+		else
+		{
+			DrawSceneObject(objectIndex);
+		}
+
+		if (bQuery == true)
+		{
+			m_occlusionQueries.EndQuery();
+		}
+	}
+
+	m_serialPacket.profile.occlusionTestedDraws = (uint32_t)m_occlusionQueries.GetTestedDraws();
+	m_serialPacket.profile.occlusionSkippedDraws = (uint32_t)m_occlusionQueries.GetSkippedDraws();
+}
+
+/***********************************************************
+ *  SetSoftwareOcclusion()
+ *
+ *  This method is used for enabling or disabling occlusion
+ *  culling with the depth hierarchy built on the CPU.
+ ***********************************************************/
+void SceneManager::SetSoftwareOcclusion(bool bEnabled)
+{
+	m_frameSettings.bSoftwareOcclusion = bEnabled;
+}
+
+/***********************************************************
+ *  CullWithSoftwareOcclusion()
+ *
+ *  This method is used for rasterizing the box occluders in
+ *  the view into the software depth buffer and removing the
+ *  objects whose bounds are hidden behind them from the
+ *  visible list.  The occluders themselves always stay in
+ *  the list, and nothing is read back from the GPU.
+ ***********************************************************/
+void SceneManager::CullWithSoftwareOcclusion(FRAME_PROFILE& profile)
+{
+	m_hiZCuller.BeginFrame(m_projectionMatrix * m_viewMatrix);
+	m_hiZCandidates.clear();
+
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		ENTITY entity = m_renderEntities[m_visibleObjects[i]];
+		const MESH_COMPONENT& objectMesh = m_registry.Get<MESH_COMPONENT>(entity);
+
+		// only the boxes are solid enough to hide other objects
+		if ((objectMesh.bOccluder == true) && (objectMesh.mesh == MESH_BOX))
+		{
+			const BOUNDS_COMPONENT& bounds = m_registry.Get<BOUNDS_COMPONENT>(entity);
+			m_hiZCuller.AddBoxOccluder(m_registry.Get<TRANSFORM_COMPONENT>(entity).modelMatrix,
+				bounds.localMin, bounds.localMax);
+		}
+		else if (objectMesh.bOccluder == false)
+		{
+			m_hiZCandidates.push_back(m_visibleObjects[i]);
+		}
+	}
+
+	m_hiZCuller.RenderOccluders();
+	m_hiZCuller.CullBounds(m_hiZCandidates, m_frustumCuller, m_hiZVisible);
+
+	// merge the surviving candidates back with the occluders,
+	// both lists are in scene order so the draw order is kept
+	size_t visibleCount = 0;
+	size_t nextSurvivor = 0;
+	for (size_t i = 0; i < m_visibleObjects.size(); i++)
+	{
+		uint32_t objectIndex = m_visibleObjects[i];
+		bool bOccluder = m_registry.Get<MESH_COMPONENT>(m_renderEntities[objectIndex]).bOccluder;
+		if ((bOccluder == true) ||
+			((nextSurvivor < m_hiZVisible.size()) && (m_hiZVisible[nextSurvivor] == objectIndex)))
+		{
+			if (bOccluder == false)
+			{
+				nextSurvivor++;
+			}
+			m_visibleObjects[visibleCount++] = objectIndex;
+		}
+	}
+	m_visibleObjects.resize(visibleCount);
+
+	profile.hiZTestedObjects = (uint32_t)m_hiZCandidates.size();
+	profile.hiZCulledObjects = (uint32_t)(m_hiZCandidates.size() - m_hiZVisible.size());
+	profile.hiZOccluderTriangles = (uint32_t)m_hiZCuller.GetTriangleCount();
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene.  While
+ *  frames are built ahead, the oldest built frame is drawn
+ *  and the update thread builds the next ones meanwhile,
+ *  otherwise the frame is culled and drawn right here.  The
+ *  modes that cull with results read back on the render
+ *  thread always run here.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	UploadLoadedTextures();
+
+	m_lodTriangles = 0;
+	m_replayStats = RenderCommandBuffer::REPLAY_STATS();
+	m_frameProfile = FRAME_PROFILE();
+
+	bool bGpuCulled = false;
+	if ((m_frameQueueDepth >= 2) &&
+		(m_frameSettings.bOcclusionQueries == false) &&
+		(m_frameSettings.bGpuCulling == false))
+	{
+		RenderPipelinedFrame();
+	}
+	else
+	{
+		bGpuCulled = RenderSerialFrame();
+	}
+
+	// the GPU culling picks the levels itself and does not read
+	// back the triangles they have
+	if ((bGpuCulled == false) && (m_frameSettings.bMeshLOD == true))
+	{
+		m_frameProfile.lodTriangles = (uint32_t)m_lodTriangles;
+	}
+}
+
+/***********************************************************
+ *  RenderPipelinedFrame()
+ *
+ *  This method is used for passing the latest settings to
+ *  the update thread and drawing the oldest frame it built.
+ *  The update thread is started on the first such frame and
+ *  restarted when the queue depth changes.
+ ***********************************************************/
+void SceneManager::RenderPipelinedFrame()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_settingsMutex);
+		m_pipelineSettings = m_frameSettings;
+	}
+
+	if ((m_framePipeline.IsRunning() == false) ||
+		(m_framePipeline.GetQueueDepth() != m_frameQueueDepth))
+	{
+		m_framePipeline.Stop();
+		m_framePackets.resize(m_frameQueueDepth);
+		for (int i = 0; i < m_frameQueueDepth; i++)
+		{
+			m_framePackets[i].pArenas = &m_frameArenas[i * m_jobSystem.GetSlotCount()];
+			m_framePackets[i].arenaGrowth = 0;
+		}
+		if (m_framePipeline.Start(m_frameQueueDepth, &SceneManager::BuildFrame, this, &m_jobSystem) == false)
+		{
+			std::cout << "WARNING: Frames are built on the render thread, the update thread could not be started" << std::endl;
+			m_frameQueueDepth = 1;
+			RenderSerialFrame();
+			return;
+		}
+	}
+
+	int slot = m_framePipeline.AcquireFrame();
+	const FRAME_PACKET& packet = m_framePackets[slot];
+	ApplySceneLights(packet);
+
+	std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+	BeginDrawData();
+	SubmitFramePacket(packet);
+	// the sky fills the pixels no object covered
+	m_skyRenderer.Draw(packet.settings.view, packet.settings.projection);
+	EndDrawData();
+	m_frameProfile = packet.profile;
+	m_frameProfile.submitMilliseconds = TakeMilliseconds(stageStart);
+
+	UpdateFrameStats(packet);
+	m_framePipeline.ReleaseFrame(slot);
+}
+
+/***********************************************************
+ *  BuildFrame()
+ *
+ *  This method is used for building a frame on the update
+ *  thread - applying the queued scene changes, moving the
+ *  changed objects, culling them with the settings the
+ *  render thread passed in last, and recording the draws
+ *  into the packet of the slot.  The render thread only
+ *  queues changes while frames are built ahead, so this
+ *  thread is the only one touching the scene.  It is
+ *  registered with the job system, so its jobs use their
+ *  own queue and pool.
+ ***********************************************************/
+void SceneManager::BuildFrame(void* pContext, int slot)
+{
+	SceneManager* pScene = (SceneManager*)pContext;
+	FRAME_PACKET& packet = pScene->m_framePackets[slot];
+
+	{
+		std::lock_guard<std::mutex> lock(pScene->m_settingsMutex);
+		packet.settings = pScene->m_pipelineSettings;
+	}
+	packet.sampleTime = std::chrono::steady_clock::now();
+
+	std::chrono::steady_clock::time_point stageStart = packet.sampleTime;
+	pScene->ApplySceneEdits(packet);
+	pScene->ApplyFrameSettings(packet.settings);
+	pScene->UpdateObjectTransforms();
+	packet.profile.updateMilliseconds = TakeMilliseconds(stageStart);
+	pScene->CullFrame(packet.profile);
+	packet.profile.cullMilliseconds = TakeMilliseconds(stageStart);
+	pScene->RecordFramePacket(packet, false);
+	packet.profile.recordMilliseconds = TakeMilliseconds(stageStart);
+}
+
+/***********************************************************
+ *  RenderSerialFrame()
+ *
+ *  This method is used for building and drawing a frame on
+ *  the render thread, after the update thread is stopped.
+ ***********************************************************/
+bool SceneManager::RenderSerialFrame()
+{
+	m_framePipeline.Stop();
+
+	m_serialPacket.settings = m_frameSettings;
+	m_serialPacket.sampleTime = std::chrono::steady_clock::now();
+	m_serialPacket.arenaGrowth = 0;
+	m_serialPacket.profile = FRAME_PROFILE();
+	std::chrono::steady_clock::time_point stageStart = m_serialPacket.sampleTime;
+	ApplySceneEdits(m_serialPacket);
+	ApplySceneLights(m_serialPacket);
+	ApplyFrameSettings(m_serialPacket.settings);
+
+	// move the objects whose transforms changed since the last
+	// frame, together with the objects attached to them
+	UpdateObjectTransforms();
+	m_serialPacket.profile.updateMilliseconds = TakeMilliseconds(stageStart);
+
+	BeginDrawData();
+
+	// the GPU culls the objects and writes their draws itself,
+	// and the occlusion queries cull while drawing, so both
+	// count as submitting
+	bool bGpuCulled = (m_bGpuCulling == true) && (m_bOcclusionQueries == false) &&
+		(RenderWithGpuCulling() == true);
+
+	if (bGpuCulled == false)
+	{
+		CullFrame(m_serialPacket.profile);
+		m_serialPacket.profile.cullMilliseconds = TakeMilliseconds(stageStart);
+
+		if (m_bOcclusionQueries == true)
+		{
+			RenderWithOcclusionQueries();
+		}
+		else
+		{
+			RecordFramePacket(m_serialPacket, true);
+			m_serialPacket.profile.recordMilliseconds = TakeMilliseconds(stageStart);
+			SubmitFramePacket(m_serialPacket);
+		}
+	}
+
+	// the sky fills the pixels no object covered
+	m_skyRenderer.Draw(m_viewMatrix, m_projectionMatrix);
+
+	EndDrawData();
+	m_frameProfile = m_serialPacket.profile;
+	m_frameProfile.submitMilliseconds = TakeMilliseconds(stageStart);
+
+	UpdateFrameStats(m_serialPacket);
+	return(bGpuCulled);
+}
+
+/***********************************************************
+ *  ApplyFrameSettings()
+ *
+ *  This method is used for taking over the view and render
+ *  switches on the thread that builds the frame.  Results
+ *  of occlusion queries collected before the mode was last
+ *  disabled are forgotten.
+ ***********************************************************/
+void SceneManager::ApplyFrameSettings(const FRAME_SETTINGS& settings)
+{
+	m_viewMatrix = settings.view;
+	m_projectionMatrix = settings.projection;
+
+	if ((settings.bOcclusionQueries == true) && (m_bOcclusionQueries == false))
+	{
+		for (uint32_t i = 0; i < (uint32_t)m_renderEntities.size(); i++)
+		{
+			m_occlusionQueries.ResetObject(i);
+		}
+	}
+
+	m_bOcclusionQueries = settings.bOcclusionQueries;
+	m_bSoftwareOcclusion = settings.bSoftwareOcclusion;
+	m_bMeshLOD = settings.bMeshLOD;
+	m_bMultiDraw = settings.bMultiDraw;
+	m_bGpuCulling = settings.bGpuCulling;
+}
+
+/***********************************************************
+ *  CullFrame()
+ *
+ *  This method is used for collecting the objects inside
+ *  the view frustum and dropping the ones hidden behind the
+ *  occluders when that is enabled, which the profile of the
+ *  frame counts.
+ ***********************************************************/
+void SceneManager::CullFrame(FRAME_PROFILE& profile)
+{
+	m_frustumCuller.SetFrustum(m_projectionMatrix * m_viewMatrix);
+	m_frustumCuller.CullBounds(m_visibleObjects, m_jobSystem);
+
+	if (m_bSoftwareOcclusion == true)
+	{
+		CullWithSoftwareOcclusion(profile);
+	}
+}
+
+/***********************************************************
+ *  SetFrameQueueDepth()
+ *
+ *  This method is used for setting how many frames are in
+ *  the pipeline.  A deeper queue keeps the CPU and GPU busy
+ *  at the same time at the cost of showing the input that
+ *  many frames later, which the frame report measures.
+ ***********************************************************/
+void SceneManager::SetFrameQueueDepth(int queueDepth)
+{
+	queueDepth = std::max(1, std::min(g_MaxFrameQueueDepth, queueDepth));
+	if (queueDepth == m_frameQueueDepth)
+	{
+		return;
+	}
+
+	m_framePipeline.Stop();
+	m_frameQueueDepth = queueDepth;
+	m_statsStart = std::chrono::steady_clock::now();
+	m_statsFrames = 0;
+	m_statsLatencyTotal = 0.0;
+	m_statsLatencyMax = 0.0;
+	m_statsArenaGrowth = 0;
+	m_statsReports = 0;
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for adding a submitted frame to the
+ *  report of the frame rate and of the latency from taking
+ *  the frame's settings to submitting its draws.  Frame
+ *  arenas that still grow after the first report point at
+ *  a frame that took memory from the heap in steady state.
+ ***********************************************************/
+void SceneManager::UpdateFrameStats(const FRAME_PACKET& packet)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double latency = std::chrono::duration<double, std::milli>(now - packet.sampleTime).count();
+
+	m_statsFrames++;
+	m_statsLatencyTotal += latency;
+	m_statsLatencyMax = std::max(m_statsLatencyMax, latency);
+	m_statsArenaGrowth += packet.arenaGrowth;
+
+	if (m_statsFrames < g_StatsReportFrames)
+	{
+		return;
+	}
+
+	double seconds = std::chrono::duration<double>(now - m_statsStart).count();
+	std::cout << "INFO: Frame queue depth " << m_frameQueueDepth << ": "
+		<< (m_statsFrames / seconds) << " frames/s, input to submit latency "
+		<< (m_statsLatencyTotal / m_statsFrames) << " ms average, "
+		<< m_statsLatencyMax << " ms max" << std::endl;
+	if ((m_statsArenaGrowth > 0) && (m_statsReports > 0))
+	{
+		std::cout << "WARNING: Frame arenas took " << m_statsArenaGrowth
+			<< " blocks from the heap in steady state" << std::endl;
+	}
+
+	m_statsStart = now;
+	m_statsFrames = 0;
+	m_statsLatencyTotal = 0.0;
+	m_statsLatencyMax = 0.0;
+	m_statsArenaGrowth = 0;
+	m_statsReports++;
+}
@@ -0,0 +1,682 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.h
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "FrustumCuller.h"
+#include "OcclusionQueries.h"
+#include "HiZOcclusionCuller.h"
+#include "MeshLibrary.h"
+#include "LODSelector.h"
+#include "DynamicRingBuffer.h"
+#include "GpuCuller.h"
+#include "SkyRenderer.h"
+#include "TransformBatch.h"
+#include "TransformHierarchy.h"
+#include "SceneRegistry.h"
+#include "JobSystem.h"
+#include "FramePipeline.h"
+#include "RenderCommandBuffer.h"
+#include "FrameArena.h"
+#include "SceneFile.h"
+#include "AssetPack.h"
+#include "AssetLoader.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+	// the per draw methods are timed by the benchmarks
+	friend class DrawStateBenchmark;
+
+public:
+	// constructor
+	SceneManager(ShaderManager *pShaderManager);
+	// destructor
+	~SceneManager();
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+	};
+
+	// where a registered texture is loaded from, and its image
+	// between the loader thread and the upload
+	struct TEXTURE_ASSET
+	{
+		std::string filename;
+		// mip levels in the asset pack, NULL to decode the file
+		const AssetPack::ENTRY* pEntry;
+		unsigned char* pImage;
+		int width;
+		int height;
+		int colorChannels;
+		// whether it was requested, only used on the render thread
+		bool bRequested;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	// per draw values read by the shaders from the ring buffer,
+	// laid out to match the std430 DrawData struct
+	struct DRAW_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		int32_t materialIndex;
+		int32_t textureSlot;
+		uint32_t flags;
+		uint32_t padding[3];
+	};
+
+	// material values laid out to match the std430 MaterialData
+	struct MATERIAL_DATA
+	{
+		glm::vec4 diffuseColor;
+		// specular color in xyz and shininess in w
+		glm::vec4 specularColor;
+	};
+
+	// indexed indirect draw laid out as OpenGL reads it, the
+	// base instance carries the draw data index to the shaders
+	struct INDIRECT_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// view and render switches that a frame is built with
+	struct FRAME_SETTINGS
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		bool bOcclusionQueries;
+		bool bSoftwareOcclusion;
+		bool bMeshLOD;
+		bool bMultiDraw;
+		bool bGpuCulling;
+	};
+
+	// locations of the object shader uniforms set while drawing
+	struct UNIFORM_LOCATIONS
+	{
+		GLint model;
+		GLint objectColor;
+		GLint objectTexture;
+		GLint bUseTexture;
+		GLint bUsePackedNormal;
+		GLint bUseDrawData;
+		GLint uvScale;
+		GLint materialDiffuseColor;
+		GLint materialSpecularColor;
+		GLint materialShininess;
+	};
+
+	// locations of the uniforms of one shader light
+	struct LIGHT_UNIFORMS
+	{
+		GLint position;
+		GLint direction;
+		GLint ambient;
+		GLint diffuse;
+		GLint specular;
+		GLint bActive;
+	};
+
+	// ways of drawing that the recorded commands switch between
+	enum RENDER_PIPELINE
+	{
+		// one draw per object from the basic and LOD meshes
+		PIPELINE_OBJECTS = 0,
+		// multi-draw indirect calls from the mesh pool
+		PIPELINE_MESH_POOL
+	};
+
+	// CPU time of the stages of a frame in milliseconds, and
+	// what it drew - the build stages run on the update thread
+	// while frames are built ahead
+	struct FRAME_PROFILE
+	{
+		// moving the changed objects
+		double updateMilliseconds;
+		// frustum and occlusion culling
+		double cullMilliseconds;
+		// sorting the draws and recording their commands
+		double recordMilliseconds;
+		// replaying the commands and drawing the sky
+		double submitMilliseconds;
+		uint32_t visibleObjects;
+		// triangles of the recorded draws
+		uint64_t triangles;
+		// changed objects the GPU culling uploaded, and the
+		// multi-draw calls of the buckets it filled
+		uint32_t uploadedObjects;
+		uint32_t gpuCullDrawCalls;
+		// draws tested by the occlusion queries and the ones
+		// they skipped
+		uint32_t occlusionTestedDraws;
+		uint32_t occlusionSkippedDraws;
+		// objects tested against the software depth hierarchy
+		// and the ones it culled, with the occluder triangles
+		uint32_t hiZTestedObjects;
+		uint32_t hiZCulledObjects;
+		uint32_t hiZOccluderTriangles;
+		// cylinder triangles drawn at their tessellation levels,
+		// which the GPU culling does not read back
+		uint32_t lodTriangles;
+	};
+
+	// one visible object of a frame packet
+	struct PACKET_DRAW
+	{
+		uint32_t objectIndex;
+		SCENE_MESH mesh;
+		// tessellation level of a cylinder, -1 for the basic mesh
+		int lodLevel;
+	};
+
+	// everything the render thread needs to draw a frame, which
+	// is not changed while it is drawn - the containers live in
+	// the packet's frame arenas, one for each job thread, which
+	// are reset when the packet is built again
+	struct FRAME_PACKET
+	{
+		FrameArena* pArenas;
+		// blocks the arenas took from the heap for this frame
+		uint32_t arenaGrowth;
+		// when the settings of the frame were taken
+		std::chrono::steady_clock::time_point sampleTime;
+		FRAME_SETTINGS settings;
+		// draws grouped by texture, and the texture slot plus one
+		// of every draw
+		FrameVector<PACKET_DRAW> draws;
+		FrameVector<uint8_t> drawKeys;
+		// whether the draws are made with multi-draw calls
+		bool bMultiDraw;
+		// per draw values and indirect commands, kept in the
+		// packet or written straight into the mapped buffers
+		FrameVector<DRAW_DATA> drawData;
+		FrameVector<INDIRECT_COMMAND> commands;
+		DRAW_DATA* pDrawData;
+		INDIRECT_COMMAND* pCommands;
+		bool bMapped;
+		// start of the mapped commands in the indirect buffer
+		size_t commandStart;
+		// cylinder triangles drawn with LOD
+		int lodTriangles;
+		// build times and draws of the packet
+		FRAME_PROFILE profile;
+		// render commands recorded on the job threads, one buffer
+		// per chunk of draws
+		FrameVector<RenderCommandBuffer> commandBuffers;
+		// the scene lights when the packet was built, and the
+		// count of light changes they include
+		std::vector<LIGHT_COMPONENT> lights;
+		uint32_t lightsVersion;
+	};
+
+	// kinds of scene changes queued by the render thread
+	enum SCENE_EDIT_TYPE
+	{
+		EDIT_TRANSFORM = 0,
+		EDIT_ADD_LIGHT,
+		EDIT_REMOVE_LIGHT
+	};
+
+	// one queued scene change with the values it applies
+	struct SCENE_EDIT
+	{
+		SCENE_EDIT_TYPE type;
+		ENTITY entity;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		LIGHT_COMPONENT light;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to basic shapes object, whose meshes are drawn
+	// with float vertices when the mesh pool is not used
+	ShapeMeshes* m_basicMeshes;
+	// total number of registered textures, which draw with the
+	// placeholder until they are loaded
+	int m_loadedTextures;
+	// loaded textures info
+	TEXTURE_INFO m_textureIDs[16];
+	// source of the texture in each slot
+	TEXTURE_ASSET m_textureAssets[16];
+	// loader thread that decodes the textures when they are
+	// first drawn, the handle of a texture is its slot
+	AssetLoader m_assetLoader;
+	// single grey texel bound to the slots not loaded yet
+	GLuint m_placeholderTexture;
+	// whether all the textures and meshes are loaded while the
+	// scene is prepared
+	bool m_bPreloadAssets;
+	// whether each basic shape mesh was created
+	bool m_bBasicMeshLoaded[MESH_CYLINDER + 1];
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// worker threads that the per frame scene work is split
+	// across, the OpenGL calls stay on the calling thread
+	JobSystem m_jobSystem;
+	// frame arenas of every job thread for each packet slot and
+	// the packet built on the render thread, never resized so
+	// the packets can keep pointers to them
+	std::vector<FrameArena> m_frameArenas;
+	// locations of the uniforms set while drawing
+	UNIFORM_LOCATIONS m_uniforms;
+	LIGHT_UNIFORMS m_directionalLightUniforms;
+	std::vector<LIGHT_UNIFORMS> m_pointLightUniforms;
+	// scene description the scene is prepared from, and the
+	// asset pack it came from when it was compiled into one
+	std::string m_sceneFileName;
+	SceneFile m_sceneFile;
+	AssetPack m_assetPack;
+	// local space bounds of each basic shape mesh
+	BOUNDS_COMPONENT m_meshBounds[MESH_CYLINDER + 1];
+	// entities and components of the scene objects and lights
+	SceneRegistry m_registry;
+	// entity drawn at each render index, which is the index of
+	// the object in the culling, LOD and draw arrays
+	std::vector<ENTITY> m_renderEntities;
+	// changes of the lights made to the registry, and the count
+	// included in the lights last sent to the shaders
+	uint32_t m_lightsVersion;
+	uint32_t m_appliedLightsVersion;
+	// transformation values of the scene objects relative to
+	// their parents, composed into local matrices in one batch
+	TransformBatch m_transformBatch;
+	std::vector<glm::mat4> m_objectMatrices;
+	// batch entries changed by the scene edits since their
+	// local matrices were last composed
+	std::vector<uint32_t> m_editedTransforms;
+	// parent / child links of the scene objects, which turn the
+	// local matrices into the model matrices
+	TransformHierarchy m_transformHierarchy;
+	// world space bounds of the scene objects for culling
+	FrustumCuller m_frustumCuller;
+	// indices of the scene objects inside the view frustum
+	std::vector<uint32_t> m_visibleObjects;
+	// whether each scene object passed the frustum test this frame
+	std::vector<uint8_t> m_inFrustumFlags;
+	// hardware occlusion queries of the scene objects
+	OcclusionQueries m_occlusionQueries;
+	// whether occlusion culling with hardware queries is enabled
+	bool m_bOcclusionQueries;
+	// software depth buffer that the occluders are rasterized into
+	HiZOcclusionCuller m_hiZCuller;
+	// whether occlusion culling on the CPU is enabled
+	bool m_bSoftwareOcclusion;
+	// objects tested against the depth hierarchy this frame
+	std::vector<uint32_t> m_hiZCandidates;
+	std::vector<uint32_t> m_hiZVisible;
+	// shapes generated with several tessellation levels
+	MeshLibrary m_meshLibrary;
+	// tessellation level of every scene object
+	LODSelector m_lodSelector;
+	// whether the cylinders are drawn with screen size based LOD
+	bool m_bMeshLOD;
+	// cylinder triangles drawn this frame
+	int m_lodTriangles;
+	// stages of the last drawn frame
+	FRAME_PROFILE m_frameProfile;
+	// copies of the scene objects and the grid spacing
+	// between them
+	int m_sceneCopies;
+	float m_copySpacing;
+	// per draw values written by the CPU for each frame in flight
+	DynamicRingBuffer m_drawDataRing;
+	// defined materials in a buffer indexed by the shaders
+	GLuint m_materialBuffer;
+	// location of the draw index uniform
+	GLint m_drawIndexLocation;
+	// whether the draws of this frame read the draw data buffer
+	bool m_bDrawDataActive;
+	// whether a full draw data buffer was reported already
+	bool m_bReportedDrawDataFull;
+	// indirect draw commands written for each frame in flight
+	DynamicRingBuffer m_indirectRing;
+	// whether the indirect ring buffer was created, which the
+	// update thread reads while the render thread grows it
+	bool m_bIndirectCommands;
+	// whether the visible objects are drawn with multi-draw
+	// indirect calls from the mesh pool
+	bool m_bMultiDraw;
+	// packet whose commands are being replayed, with the start
+	// of its per draw values and indirect commands in the rings
+	const FRAME_PACKET* m_pReplayPacket;
+	GLuint m_replayFirstDraw;
+	size_t m_replayCommandStart;
+	// pipeline bound and packed normal switch set by the replay
+	uint32_t m_replayPipeline;
+	bool m_bReplayPackedNormal;
+	// commands and state changes of the last replayed packet
+	RenderCommandBuffer::REPLAY_STATS m_replayStats;
+	// objects culled and turned into draws by compute shaders
+	GpuCuller m_gpuCuller;
+	// whether culling and draw generation run on the GPU
+	bool m_bGpuCulling;
+	// sky drawn behind the objects in a pass of its own
+	SkyRenderer m_skyRenderer;
+	// view and projection matrices of the frame being built
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	// settings passed in by the render thread for the next frame,
+	// and the copy that the update thread takes them from
+	FRAME_SETTINGS m_frameSettings;
+	FRAME_SETTINGS m_pipelineSettings;
+	std::mutex m_settingsMutex;
+	// scene changes made on the render thread, which the thread
+	// building the next frame applies before it reads the scene -
+	// the mutex also guards creating and destroying entities
+	std::vector<SCENE_EDIT> m_sceneEdits;
+	std::mutex m_sceneEditMutex;
+	// frames built ahead on the update thread, 1 builds every
+	// frame on the render thread right before it is drawn
+	int m_frameQueueDepth;
+	FramePipeline m_framePipeline;
+	std::vector<FRAME_PACKET> m_framePackets;
+	// packet of the frames built on the render thread
+	FRAME_PACKET m_serialPacket;
+	// frame rate and latency since the last report
+	std::chrono::steady_clock::time_point m_statsStart;
+	int m_statsFrames;
+	double m_statsLatencyTotal;
+	double m_statsLatencyMax;
+	// arena blocks taken since the last report, and the reports
+	// since the queue depth changed - the first one includes
+	// the frames the arenas grow to their size in
+	uint32_t m_statsArenaGrowth;
+	int m_statsReports;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, std::string tag);
+	// give a texture the next slot, bound to the placeholder
+	// until it is loaded - returns -1 when no slot is left
+	int RegisterTexture(const std::string& filename, const AssetPack::ENTRY* pEntry, const std::string& tag);
+	// load a registered texture before going on
+	bool LoadTextureNow(int textureSlot);
+	// queue a texture for the loader thread the first time it
+	// is drawn
+	void RequestTexture(int textureSlot);
+	// read or decode a texture on the loader thread
+	static bool LoadTextureAsset(void* pContext, AssetLoader::ASSET_HANDLE handle);
+	// create the OpenGL texture of a loaded texture in its slot
+	void UploadTexture(int textureSlot);
+	// upload a few of the textures the loader thread finished
+	void UploadLoadedTextures();
+	// create the texture the unloaded slots are bound to
+	void CreatePlaceholderTexture();
+	// create a basic shape mesh the first time it is drawn
+	void LoadBasicMesh(SCENE_MESH mesh);
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
+	// find a defined material by tag
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		const std::string& textureTag);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		const std::string& materialTag);
+
+	// define the materials, lights and textures of the scene file
+	void DefineObjectMaterials();
+	void SetupSceneLights();
+	void LoadSceneTextures();
+	// check the size of the mip levels of an asset pack texture
+	bool IsPackedTextureValid(const AssetPack::ENTRY& entry, const std::string& tag) const;
+	// upload the mesh pool of the asset pack, false when the
+	// meshes have to be generated
+	bool LoadPackedMeshes();
+
+	// add an object entity to the 3D scene, positioned relative
+	// to the parent object when one is passed in
+	ENTITY AddSceneObject(
+		SCENE_MESH mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec4 color,
+		std::string textureTag,
+		std::string materialTag,
+		bool bOccluder = false,
+		ENTITY parentObject = NULL_ENTITY);
+
+	// add the objects of the scene file to the 3D scene
+	void DefineSceneObjects();
+	// refresh the model matrices and world space bounds of the
+	// scene objects whose transforms or parents changed
+	void UpdateObjectTransforms();
+	// apply the queued scene changes and copy the lights into
+	// the packet being built
+	void ApplySceneEdits(FRAME_PACKET& packet);
+	// move a scene object to the values of a queued change
+	void ApplyObjectTransform(const SCENE_EDIT& edit);
+	// compose the local matrices of the edited objects
+	void ComposeEditedTransforms();
+	// send the lights of a packet to the shaders when they
+	// changed since the last ones sent
+	void ApplySceneLights(const FRAME_PACKET& packet);
+	// look up the uniforms set while drawing
+	void FindUniformLocations();
+	void FindLightUniforms(const std::string& prefix, LIGHT_UNIFORMS& uniforms);
+	// get the texture slot of an entity, -1 when it has no texture
+	int GetTextureSlot(ENTITY entity) const;
+
+	// draw one scene object with its current values
+	void DrawSceneObject(uint32_t objectIndex);
+	// draw one scene object with the passed in values
+	void DrawSceneObject(uint32_t objectIndex, int lodLevel, const DRAW_DATA& values);
+	// draw a basic shape mesh, or a tessellation level of it
+	void DrawMesh(SCENE_MESH mesh, int lodLevel);
+	// pick the tessellation level of a cylinder from its screen
+	// size, safe on the job threads for different objects
+	int SelectCylinderLevel(uint32_t objectIndex);
+	// draw the world space bounds of a scene object without
+	// writing color or depth, for occlusion queries
+	void DrawObjectBounds(uint32_t objectIndex);
+	// draw the visible scene objects using the results of the
+	// hardware occlusion queries from the previous frame
+	void RenderWithOcclusionQueries();
+	// remove the visible objects hidden behind the occluders
+	// using the depth hierarchy built on the CPU
+	void CullWithSoftwareOcclusion(FRAME_PROFILE& profile);
+
+	// create the draw data ring buffer and the material buffer
+	bool CreateDrawDataBuffers();
+	// start and finish writing the draw data of a frame
+	void BeginDrawData();
+	void EndDrawData();
+	// grow the ring buffers that were too small last frame
+	void GrowDrawDataBuffers();
+	// go back to setting the uniforms for the rest of the frame
+	void StopDrawData();
+	// write the values of the next draw and select them in the
+	// shaders, returns false when the uniforms have to be set
+	bool WriteDrawData(
+		const glm::mat4& model,
+		const glm::vec4& color,
+		int textureSlot,
+		int materialIndex,
+		bool bPackedNormal);
+	// fill in the values of one draw in the mapped buffer
+	static void FillDrawData(
+		DRAW_DATA& drawData,
+		const glm::mat4& model,
+		const glm::vec4& color,
+		int textureSlot,
+		int materialIndex,
+		bool bPackedNormal);
+	// put the draw data and indirect commands of a packet into
+	// the mapped buffers, returns false when the objects still
+	// have to be drawn one by one
+	bool PrepareMultiDraw(const FRAME_PACKET& packet);
+	// put the draw data of a packet into the mapped buffer, or
+	// else switch the frame to setting the uniforms
+	void PrepareObjectDraws(const FRAME_PACKET& packet);
+	// execute one replayed render command with OpenGL
+	static void ReplayCommand(void* pContext, const RenderCommandBuffer::RENDER_COMMAND& command);
+	void ExecuteRenderCommand(const RenderCommandBuffer::RENDER_COMMAND& command);
+
+	// take over the settings a frame is built with
+	void ApplyFrameSettings(const FRAME_SETTINGS& settings);
+	// collect the visible objects of the frame being built
+	void CullFrame(FRAME_PROFILE& profile);
+	// turn the visible objects into the draws of a packet,
+	// mapping the draw buffers when it is drawn right away
+	void RecordFramePacket(FRAME_PACKET& packet, bool bMapBuffers);
+	// make the draws of a packet
+	void SubmitFramePacket(const FRAME_PACKET& packet);
+	// build a frame into a packet slot on the update thread
+	static void BuildFrame(void* pContext, int slot);
+	// draw the oldest frame built on the update thread
+	void RenderPipelinedFrame();
+	// build and draw a frame on the render thread, returns
+	// true when the GPU culled it
+	bool RenderSerialFrame();
+	// add a drawn frame to the frame rate and latency report
+	void UpdateFrameStats(const FRAME_PACKET& packet);
+
+	// create the compute shader culling for the scene objects
+	bool CreateGpuCulling();
+	// send the current values of a scene object to the GPU
+	// culling, called again whenever the object changes
+	void UpdateGpuObject(uint32_t objectIndex);
+	// cull and draw the scene objects entirely on the GPU,
+	// returns false when the CPU has to do it
+	bool RenderWithGpuCulling();
+
+	// get the default local space bounds of a basic shape mesh
+	static void GetMeshBounds(
+		SCENE_MESH mesh,
+		glm::vec3& localMin,
+		glm::vec3& localMax);
+
+public:
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	void RenderScene();
+
+	// set the text or compiled scene file that PrepareScene()
+	// loads, the patio scene is loaded when none is set
+	void SetSceneFile(const std::string& filename);
+	// load every texture and mesh in PrepareScene() instead of
+	// when it is first drawn
+	void SetPreloadAssets(bool bEnabled);
+	// repeat the objects of the scene file on a square grid
+	// around the origin, for measuring the renderer at scale -
+	// set before PrepareScene()
+	void SetSceneCopies(int copies, float spacing);
+
+	// set the view and projection of the current frame
+	void SetViewTransforms(
+		const glm::mat4& view,
+		const glm::mat4& projection);
+
+	// enable or disable occlusion culling with hardware queries
+	void SetOcclusionQueries(bool bEnabled);
+	// enable or disable occlusion culling on the CPU
+	void SetSoftwareOcclusion(bool bEnabled);
+	// enable or disable the screen size based cylinder LOD
+	void SetMeshLOD(bool bEnabled);
+	// enable or disable drawing with multi-draw indirect calls
+	void SetMultiDrawIndirect(bool bEnabled);
+	// enable or disable culling with compute shaders
+	void SetGpuCulling(bool bEnabled);
+	// set the number of frames in the pipeline - 1 builds each
+	// frame right before it is drawn, 2 builds the next frame
+	// while the current one is drawn and 3 one more ahead
+	void SetFrameQueueDepth(int queueDepth);
+
+	// get the commands, binds and draw calls of the last
+	// replayed frame
+	const RenderCommandBuffer::REPLAY_STATS& GetReplayStats() const { return m_replayStats; }
+	// get the stage times and draws of the last drawn frame
+	const FRAME_PROFILE& GetFrameProfile() const { return m_frameProfile; }
+	// number of objects in the scene
+	uint32_t GetObjectCount() const { return (uint32_t)m_renderEntities.size(); }
+
+	// move a scene object relative to its parent, the objects
+	// attached to it follow in the next frame that is built -
+	// the change is queued, so it can be made while frames are
+	// built ahead
+	void SetObjectTransform(
+		ENTITY entity,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// add or remove a light source, queued like the transforms
+	// and sent to the shaders with the next frame that is built -
+	// the scene objects are fixed once the scene is prepared,
+	// since their render index is the index into the culling,
+	// LOD, occlusion query and GPU object arrays
+	ENTITY AddSceneLight(const LIGHT_COMPONENT& light);
+	void RemoveSceneLight(ENTITY entity);
+
+};
\ No newline at end of file
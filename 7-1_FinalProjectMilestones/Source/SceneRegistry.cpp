@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneregistry.cpp
+// ============
+// sparse set entity-component storage - every component type is kept in its
+// own dense array that systems iterate directly
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneRegistry.h"
+
+/***********************************************************
+ *  SceneRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneRegistry::SceneRegistry()
+{
+}
+
+/***********************************************************
+ *  ~SceneRegistry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneRegistry::~SceneRegistry()
+{
+}
+
+/***********************************************************
+ *  CreateEntity()
+ *
+ *  This method is used for creating an entity in a freed
+ *  slot when there is one, or in a new slot otherwise.
+ ***********************************************************/
+ENTITY SceneRegistry::CreateEntity()
+{
+	uint32_t slot = 0;
+
+	if (m_freeSlots.empty() == false)
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = (uint32_t)m_generations.size();
+		// the last slot is reserved for NULL_ENTITY
+		if (slot >= ENTITY_INDEX_MASK)
+		{
+			return(NULL_ENTITY);
+		}
+		m_generations.push_back(0);
+	}
+
+	return(((uint32_t)m_generations[slot] << ENTITY_INDEX_BITS) | slot);
+}
+
+/***********************************************************
+ *  DestroyEntity()
+ *
+ *  This method is used for removing the components of an
+ *  entity and freeing its slot under the next generation.
+ ***********************************************************/
+void SceneRegistry::DestroyEntity(ENTITY entity)
+{
+	if (IsAlive(entity) == false)
+	{
+		return;
+	}
+
+	m_transforms.Remove(entity);
+	m_meshes.Remove(entity);
+	m_materials.Remove(entity);
+	m_textures.Remove(entity);
+	m_bounds.Remove(entity);
+	m_lights.Remove(entity);
+
+	uint32_t slot = entity & ENTITY_INDEX_MASK;
+	m_generations[slot]++;
+	m_freeSlots.push_back(slot);
+}
+
+/***********************************************************
+ *  IsAlive()
+ *
+ *  This method is used for checking that a handle belongs
+ *  to the current generation of its slot.
+ ***********************************************************/
+bool SceneRegistry::IsAlive(ENTITY entity) const
+{
+	uint32_t slot = entity & ENTITY_INDEX_MASK;
+
+	return((entity != NULL_ENTITY) && (slot < m_generations.size()) &&
+		((entity >> ENTITY_INDEX_BITS) == m_generations[slot]));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for destroying all the entities.
+ ***********************************************************/
+void SceneRegistry::Clear()
+{
+	m_generations.clear();
+	m_freeSlots.clear();
+	m_transforms.Clear();
+	m_meshes.Clear();
+	m_materials.Clear();
+	m_textures.Clear();
+	m_bounds.Clear();
+	m_lights.Clear();
+}
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneregistry.h
+// ============
+// sparse set entity-component storage - every component type is kept in its
+// own dense array that systems iterate directly
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneComponents.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  ComponentPool
+ *
+ *  This class template contains the components of one type.
+ *  The components and their entities are packed in dense
+ *  arrays, and a sparse array indexed by the entity slot
+ *  points into them.  Adding appends, and removing moves
+ *  the last component into the hole, so both are constant
+ *  time and the dense arrays never have gaps.
+ ***********************************************************/
+template<typename T>
+class ComponentPool
+{
+public:
+	// add the component to an entity, or replace the one it has
+	T& Add(ENTITY entity, const T& component)
+	{
+		uint32_t slot = entity & ENTITY_INDEX_MASK;
+
+		if (Has(entity) == true)
+		{
+			T& existing = m_components[m_sparse[slot]];
+			existing = component;
+			return(existing);
+		}
+
+		if (slot >= m_sparse.size())
+		{
+			// copied so the constant needs no out of class definition
+			m_sparse.resize(slot + 1, (uint32_t)INVALID_INDEX);
+		}
+		m_sparse[slot] = (uint32_t)m_entities.size();
+		m_entities.push_back(entity);
+		m_components.push_back(component);
+		return(m_components.back());
+	}
+
+	// remove the component of an entity, if it has one
+	void Remove(ENTITY entity)
+	{
+		if (Has(entity) == false)
+		{
+			return;
+		}
+
+		uint32_t slot = entity & ENTITY_INDEX_MASK;
+		uint32_t index = m_sparse[slot];
+		uint32_t last = (uint32_t)m_entities.size() - 1;
+
+		if (index != last)
+		{
+			m_entities[index] = m_entities[last];
+			m_components[index] = m_components[last];
+			m_sparse[m_entities[index] & ENTITY_INDEX_MASK] = index;
+		}
+		m_entities.pop_back();
+		m_components.pop_back();
+		m_sparse[slot] = INVALID_INDEX;
+	}
+
+	// check whether an entity has the component
+	bool Has(ENTITY entity) const
+	{
+		uint32_t slot = entity & ENTITY_INDEX_MASK;
+		return((slot < m_sparse.size()) && (m_sparse[slot] != INVALID_INDEX) &&
+			(m_entities[m_sparse[slot]] == entity));
+	}
+
+	// get the component of an entity, NULL when it has none
+	T* Find(ENTITY entity)
+	{
+		return(Has(entity) ? &m_components[m_sparse[entity & ENTITY_INDEX_MASK]] : NULL);
+	}
+	const T* Find(ENTITY entity) const
+	{
+		return(Has(entity) ? &m_components[m_sparse[entity & ENTITY_INDEX_MASK]] : NULL);
+	}
+
+	// get the component of an entity that is known to have it
+	T& Get(ENTITY entity) { return(m_components[m_sparse[entity & ENTITY_INDEX_MASK]]); }
+	const T& Get(ENTITY entity) const { return(m_components[m_sparse[entity & ENTITY_INDEX_MASK]]); }
+
+	// dense arrays for systems, entity i owns component i
+	size_t GetCount() const { return m_components.size(); }
+	const ENTITY* GetEntities() const { return m_entities.data(); }
+	T* GetComponents() { return m_components.data(); }
+	const T* GetComponents() const { return m_components.data(); }
+
+	// remove all the components
+	void Clear()
+	{
+		m_sparse.clear();
+		m_entities.clear();
+		m_components.clear();
+	}
+
+private:
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	std::vector<uint32_t> m_sparse;
+	std::vector<ENTITY> m_entities;
+	std::vector<T> m_components;
+};
+
+/***********************************************************
+ *  SceneRegistry
+ *
+ *  This class contains the entities of the scene and one
+ *  component pool for each component type.  Entity slots
+ *  are recycled after an entity is destroyed, with a new
+ *  generation so old handles stop matching.
+ ***********************************************************/
+class SceneRegistry
+{
+public:
+	// constructor
+	SceneRegistry();
+	// destructor
+	~SceneRegistry();
+
+	// create an entity without components
+	ENTITY CreateEntity();
+	// remove all the components of an entity and free its slot
+	void DestroyEntity(ENTITY entity);
+	// check whether a handle refers to a living entity
+	bool IsAlive(ENTITY entity) const;
+	// destroy all the entities
+	void Clear();
+
+	// get the pool of a component type
+	template<typename T> ComponentPool<T>& GetPool();
+	template<typename T> const ComponentPool<T>& GetPool() const
+	{
+		return(const_cast<SceneRegistry*>(this)->GetPool<T>());
+	}
+
+	// component access by entity
+	template<typename T> T& Add(ENTITY entity, const T& component) { return(GetPool<T>().Add(entity, component)); }
+	template<typename T> void Remove(ENTITY entity) { GetPool<T>().Remove(entity); }
+	template<typename T> bool Has(ENTITY entity) const { return(GetPool<T>().Has(entity)); }
+	template<typename T> T* Find(ENTITY entity) { return(GetPool<T>().Find(entity)); }
+	template<typename T> const T* Find(ENTITY entity) const { return(GetPool<T>().Find(entity)); }
+	template<typename T> T& Get(ENTITY entity) { return(GetPool<T>().Get(entity)); }
+	template<typename T> const T& Get(ENTITY entity) const { return(GetPool<T>().Get(entity)); }
+
+	// call function(entity, component) for every component of
+	// a type, in the order of the dense array
+	template<typename T, typename FUNCTION>
+	void ForEach(FUNCTION function)
+	{
+		ComponentPool<T>& pool = GetPool<T>();
+		const ENTITY* pEntities = pool.GetEntities();
+		T* pComponents = pool.GetComponents();
+
+		for (size_t i = 0; i < pool.GetCount(); i++)
+		{
+			function(pEntities[i], pComponents[i]);
+		}
+	}
+
+private:
+	// generation of every slot and the slots free for reuse
+	std::vector<uint8_t> m_generations;
+	std::vector<uint32_t> m_freeSlots;
+
+	ComponentPool<TRANSFORM_COMPONENT> m_transforms;
+	ComponentPool<MESH_COMPONENT> m_meshes;
+	ComponentPool<MATERIAL_COMPONENT> m_materials;
+	ComponentPool<TEXTURE_COMPONENT> m_textures;
+	ComponentPool<BOUNDS_COMPONENT> m_bounds;
+	ComponentPool<LIGHT_COMPONENT> m_lights;
+};
+
+template<> inline ComponentPool<TRANSFORM_COMPONENT>& SceneRegistry::GetPool() { return(m_transforms); }
+template<> inline ComponentPool<MESH_COMPONENT>& SceneRegistry::GetPool() { return(m_meshes); }
+template<> inline ComponentPool<MATERIAL_COMPONENT>& SceneRegistry::GetPool() { return(m_materials); }
+template<> inline ComponentPool<TEXTURE_COMPONENT>& SceneRegistry::GetPool() { return(m_textures); }
+template<> inline ComponentPool<BOUNDS_COMPONENT>& SceneRegistry::GetPool() { return(m_bounds); }
+template<> inline ComponentPool<LIGHT_COMPONENT>& SceneRegistry::GetPool() { return(m_lights); }
@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+// skyrenderer.cpp
+// ============
+// unlit sky drawn as one full screen triangle at the far plane after the
+// opaque objects, so only the pixels they leave uncovered are shaded
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SkyRenderer.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_SkyVertexShaderFile = "shaders/skyVertexShader.glsl";
+	const char* g_SkyFragmentShaderFile = "shaders/skyFragmentShader.glsl";
+}
+
+/***********************************************************
+ *  SkyRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SkyRenderer::SkyRenderer()
+{
+	m_vao = 0;
+	m_horizonColor = glm::vec3(0.9f, 0.75f, 0.6f);
+	m_zenithColor = glm::vec3(0.3f, 0.5f, 0.85f);
+	m_textureUnit = -1;
+}
+
+/***********************************************************
+ *  ~SkyRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SkyRenderer::~SkyRenderer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for loading the sky shaders and
+ *  creating the vertex array the triangle is drawn with,
+ *  which the core profile needs even without attributes.
+ ***********************************************************/
+bool SkyRenderer::Create()
+{
+	Destroy();
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	GLuint program = m_skyShader.LoadShaders(g_SkyVertexShaderFile, g_SkyFragmentShaderFile);
+	glUseProgram((GLuint)previousProgram);
+
+	if (program == 0)
+	{
+		std::cout << "WARNING: Could not load the sky shaders" << std::endl;
+		return(false);
+	}
+
+	glGenVertexArrays(1, &m_vao);
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the vertex array.
+ ***********************************************************/
+void SkyRenderer::Destroy()
+{
+	if (m_vao != 0)
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = 0;
+	}
+}
+
+/***********************************************************
+ *  SetColors()
+ *
+ *  This method is used for setting the gradient colors.
+ ***********************************************************/
+void SkyRenderer::SetColors(const glm::vec3& horizonColor, const glm::vec3& zenithColor)
+{
+	m_horizonColor = horizonColor;
+	m_zenithColor = zenithColor;
+}
+
+/***********************************************************
+ *  SetTextureUnit()
+ *
+ *  This method is used for setting the texture unit the
+ *  sky texture is bound to.
+ ***********************************************************/
+void SkyRenderer::SetTextureUnit(int textureUnit)
+{
+	m_textureUnit = textureUnit;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the sky.  The view is
+ *  used without its translation, so the sky stays at the
+ *  same distance wherever the camera moves.  The triangle
+ *  lies exactly on the far plane, so the depth test has to
+ *  pass equal depths, and it writes no depth of its own.
+ ***********************************************************/
+void SkyRenderer::Draw(const glm::mat4& view, const glm::mat4& projection)
+{
+	if (IsCreated() == false)
+	{
+		return;
+	}
+
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	glm::mat4 rotation = glm::mat4(glm::mat3(view));
+	glm::mat4 inverseViewProjection = glm::inverse(projection * rotation);
+
+	m_skyShader.use();
+	m_skyShader.setMat4Value("inverseViewProjection", inverseViewProjection);
+	m_skyShader.setVec3Value("horizonColor", m_horizonColor);
+	m_skyShader.setVec3Value("zenithColor", m_zenithColor);
+	m_skyShader.setBoolValue("bUseSkyTexture", m_textureUnit >= 0);
+	if (m_textureUnit >= 0)
+	{
+		m_skyShader.setSampler2DValue("skyTexture", m_textureUnit);
+	}
+
+	glDepthFunc(GL_LEQUAL);
+	glDepthMask(GL_FALSE);
+	glBindVertexArray(m_vao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+
+	glUseProgram((GLuint)previousProgram);
+}
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// skyrenderer.h
+// ============
+// unlit sky drawn as one full screen triangle at the far plane after the
+// opaque objects, so only the pixels they leave uncovered are shaded
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  SkyRenderer
+ *
+ *  This class draws the sky with its own shader program.
+ *  The triangle is generated from gl_VertexID and sits at
+ *  the far plane, and the depth test against the opaque
+ *  objects drawn before it rejects every covered pixel
+ *  before the fragment shader runs.  The sky color comes
+ *  from a texture wrapped around the camera, or from a
+ *  gradient between the horizon and the zenith.
+ ***********************************************************/
+class SkyRenderer
+{
+public:
+	// constructor
+	SkyRenderer();
+	// destructor
+	~SkyRenderer();
+
+	// load the sky shaders and create the empty vertex array
+	bool Create();
+	// free the vertex array
+	void Destroy();
+	// check whether the sky can be drawn
+	bool IsCreated() const { return m_vao != 0; }
+
+	// set the gradient colors used without a texture
+	void SetColors(const glm::vec3& horizonColor, const glm::vec3& zenithColor);
+	// set the texture unit of the sky texture, or -1 for the
+	// gradient
+	void SetTextureUnit(int textureUnit);
+
+	// draw the sky behind everything already in the depth
+	// buffer, restoring the previous shader program
+	void Draw(const glm::mat4& view, const glm::mat4& projection);
+
+private:
+	// shader program of the sky pass
+	ShaderManager m_skyShader;
+	// vertex array without attributes for the triangle
+	GLuint m_vao;
+	glm::vec3 m_horizonColor;
+	glm::vec3 m_zenithColor;
+	int m_textureUnit;
+};
@@ -0,0 +1,568 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// batched composition of world matrices from position, rotation and scale -
+// SoA transform storage with SSE2 / AVX2 kernels selected at runtime and a
+// scalar fallback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+#include "CpuFeatures.h"
+
+#include <cmath>
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const float g_DegreesToRadians = 0.017453292519943295f;
+
+#if defined(SIMD_X86)
+	// constants of the polynomial sine and cosine, the angle is
+	// reduced to [-pi/4, pi/4] by subtracting multiples of pi/4
+	// split in three parts so the reduction stays exact
+	const float g_FourOverPi = 1.27323954473516f;
+	const float g_ReduceDP1 = -0.78515625f;
+	const float g_ReduceDP2 = -2.4187564849853515625e-4f;
+	const float g_ReduceDP3 = -3.77489497744594108e-8f;
+	const float g_SinCoefficient0 = -1.9515295891e-4f;
+	const float g_SinCoefficient1 = 8.3321608736e-3f;
+	const float g_SinCoefficient2 = -1.6666654611e-1f;
+	const float g_CosCoefficient0 = 2.443315711809948e-5f;
+	const float g_CosCoefficient1 = -1.388731625493765e-3f;
+	const float g_CosCoefficient2 = 4.166664568298827e-2f;
+
+	/***********************************************************
+	 *  SinCosSSE2()
+	 *
+	 *  This function is used for evaluating the sine and cosine
+	 *  of four angles in radians at once.  The octant of each
+	 *  angle selects between the sine and cosine polynomials
+	 *  and the signs of the two results.
+	 ***********************************************************/
+	inline void SinCosSSE2(__m128 x, __m128& sine, __m128& cosine)
+	{
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+		// take the sign out of the angle, sine is odd
+		__m128 sineSign = _mm_and_ps(x, signMask);
+		x = _mm_andnot_ps(signMask, x);
+
+		// octant of the angle, rounded up to an even number
+		__m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(g_FourOverPi)));
+		octant = _mm_add_epi32(octant, _mm_set1_epi32(1));
+		octant = _mm_and_si128(octant, _mm_set1_epi32(~1));
+		__m128 y = _mm_cvtepi32_ps(octant);
+
+		__m128i sineSwap = _mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29);
+		__m128 polyMask = _mm_castsi128_ps(
+			_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+		__m128i cosineSign = _mm_slli_epi32(
+			_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29);
+		sineSign = _mm_xor_ps(sineSign, _mm_castsi128_ps(sineSwap));
+
+		// remainder of the angle within the octant
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(g_ReduceDP1)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(g_ReduceDP2)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(g_ReduceDP3)));
+		__m128 z = _mm_mul_ps(x, x);
+
+		// cosine polynomial
+		__m128 c = _mm_set1_ps(g_CosCoefficient0);
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(g_CosCoefficient1));
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(g_CosCoefficient2));
+		c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+		c = _mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+		c = _mm_add_ps(c, _mm_set1_ps(1.0f));
+
+		// sine polynomial
+		__m128 s = _mm_set1_ps(g_SinCoefficient0);
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(g_SinCoefficient1));
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(g_SinCoefficient2));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+		// pick the polynomial that belongs to each result
+		__m128 sineValue = _mm_or_ps(_mm_and_ps(polyMask, s), _mm_andnot_ps(polyMask, c));
+		__m128 cosineValue = _mm_or_ps(_mm_and_ps(polyMask, c), _mm_andnot_ps(polyMask, s));
+
+		sine = _mm_xor_ps(sineValue, sineSign);
+		cosine = _mm_xor_ps(cosineValue, _mm_castsi128_ps(cosineSign));
+	}
+
+	/***********************************************************
+	 *  SinCosAVX2()
+	 *
+	 *  This function is used for evaluating the sine and cosine
+	 *  of eight angles in radians at once, with the same steps
+	 *  as SinCosSSE2().
+	 ***********************************************************/
+	SIMD_TARGET_AVX2
+	inline void SinCosAVX2(__m256 x, __m256& sine, __m256& cosine)
+	{
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+
+		__m256 sineSign = _mm256_and_ps(x, signMask);
+		x = _mm256_andnot_ps(signMask, x);
+
+		__m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(g_FourOverPi)));
+		octant = _mm256_add_epi32(octant, _mm256_set1_epi32(1));
+		octant = _mm256_and_si256(octant, _mm256_set1_epi32(~1));
+		__m256 y = _mm256_cvtepi32_ps(octant);
+
+		__m256i sineSwap = _mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29);
+		__m256 polyMask = _mm256_castsi256_ps(
+			_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+		__m256i cosineSign = _mm256_slli_epi32(
+			_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29);
+		sineSign = _mm256_xor_ps(sineSign, _mm256_castsi256_ps(sineSwap));
+
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(g_ReduceDP1), x);
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(g_ReduceDP2), x);
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(g_ReduceDP3), x);
+		__m256 z = _mm256_mul_ps(x, x);
+
+		__m256 c = _mm256_set1_ps(g_CosCoefficient0);
+		c = _mm256_fmadd_ps(c, z, _mm256_set1_ps(g_CosCoefficient1));
+		c = _mm256_fmadd_ps(c, z, _mm256_set1_ps(g_CosCoefficient2));
+		c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+		c = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), c);
+		c = _mm256_add_ps(c, _mm256_set1_ps(1.0f));
+
+		__m256 s = _mm256_set1_ps(g_SinCoefficient0);
+		s = _mm256_fmadd_ps(s, z, _mm256_set1_ps(g_SinCoefficient1));
+		s = _mm256_fmadd_ps(s, z, _mm256_set1_ps(g_SinCoefficient2));
+		s = _mm256_fmadd_ps(_mm256_mul_ps(s, z), x, x);
+
+		__m256 sineValue = _mm256_blendv_ps(c, s, polyMask);
+		__m256 cosineValue = _mm256_blendv_ps(s, c, polyMask);
+
+		sine = _mm256_xor_ps(sineValue, sineSign);
+		cosine = _mm256_xor_ps(cosineValue, _mm256_castsi256_ps(cosineSign));
+	}
+#endif
+}
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+	// pick the widest kernel the processor supports
+	if (IsPathSupported(TRANSFORM_PATH_AVX2))
+	{
+		m_autoPath = TRANSFORM_PATH_AVX2;
+	}
+	else if (IsPathSupported(TRANSFORM_PATH_SSE2))
+	{
+		m_autoPath = TRANSFORM_PATH_SSE2;
+	}
+	else
+	{
+		m_autoPath = TRANSFORM_PATH_SCALAR;
+	}
+}
+
+/***********************************************************
+ *  ~TransformBatch()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformBatch::~TransformBatch()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the transforms.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for reserving the storage of every
+ *  component array.
+ ***********************************************************/
+void TransformBatch::Reserve(size_t count)
+{
+	m_positionX.reserve(count);
+	m_positionY.reserve(count);
+	m_positionZ.reserve(count);
+	m_rotationX.reserve(count);
+	m_rotationY.reserve(count);
+	m_rotationZ.reserve(count);
+	m_scaleX.reserve(count);
+	m_scaleY.reserve(count);
+	m_scaleZ.reserve(count);
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding a transform, and returns
+ *  the index of its matrix.
+ ***********************************************************/
+uint32_t TransformBatch::Add(
+	const glm::vec3& position,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& scale)
+{
+	uint32_t index = (uint32_t)m_positionX.size();
+
+	m_positionX.push_back(position.x);
+	m_positionY.push_back(position.y);
+	m_positionZ.push_back(position.z);
+	m_rotationX.push_back(rotationDegrees.x * g_DegreesToRadians);
+	m_rotationY.push_back(rotationDegrees.y * g_DegreesToRadians);
+	m_rotationZ.push_back(rotationDegrees.z * g_DegreesToRadians);
+	m_scaleX.push_back(scale.x);
+	m_scaleY.push_back(scale.y);
+	m_scaleZ.push_back(scale.z);
+
+	return(index);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for replacing the previously added
+ *  transform at the passed in index.
+ ***********************************************************/
+void TransformBatch::Set(
+	uint32_t index,
+	const glm::vec3& position,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& scale)
+{
+	if (index < m_positionX.size())
+	{
+		m_positionX[index] = position.x;
+		m_positionY[index] = position.y;
+		m_positionZ[index] = position.z;
+		m_rotationX[index] = rotationDegrees.x * g_DegreesToRadians;
+		m_rotationY[index] = rotationDegrees.y * g_DegreesToRadians;
+		m_rotationZ[index] = rotationDegrees.z * g_DegreesToRadians;
+		m_scaleX[index] = scale.x;
+		m_scaleY[index] = scale.y;
+		m_scaleZ[index] = scale.z;
+	}
+}
+
+/***********************************************************
+ *  ComputeMatrices()
+ *
+ *  This method is used for composing the matrices of all
+ *  the stored transforms into the list.
+ ***********************************************************/
+void TransformBatch::ComputeMatrices(
+	std::vector<glm::mat4>& matrices,
+	TRANSFORM_PATH transformPath) const
+{
+	uint32_t count = (uint32_t)m_positionX.size();
+
+	matrices.resize(count);
+	if (count > 0)
+	{
+		ComputeMatrices(0, count, matrices.data(), transformPath);
+	}
+}
+
+/***********************************************************
+ *  ComputeMatrices()
+ *
+ *  This method is used for composing the matrices of a
+ *  range of transforms with the requested kernel, or the
+ *  automatic one when the processor does not support it.
+ ***********************************************************/
+void TransformBatch::ComputeMatrices(
+	uint32_t first,
+	uint32_t last,
+	glm::mat4* pMatrices,
+	TRANSFORM_PATH transformPath) const
+{
+	if (last > (uint32_t)m_positionX.size())
+	{
+		last = (uint32_t)m_positionX.size();
+	}
+	if (first >= last)
+	{
+		return;
+	}
+
+	if ((transformPath == TRANSFORM_PATH_AUTO) || (IsPathSupported(transformPath) == false))
+	{
+		transformPath = m_autoPath;
+	}
+
+	switch (transformPath)
+	{
+	case TRANSFORM_PATH_AVX2:
+		ComputeAVX2(first, last, pMatrices);
+		break;
+	case TRANSFORM_PATH_SSE2:
+		ComputeSSE2(first, last, pMatrices);
+		break;
+	default:
+		ComputeScalar(first, last, pMatrices);
+		break;
+	}
+}
+
+/***********************************************************
+ *  GetPathName()
+ *
+ *  This method is used for getting a readable kernel name.
+ ***********************************************************/
+const char* TransformBatch::GetPathName(TRANSFORM_PATH transformPath)
+{
+	switch (transformPath)
+	{
+	case TRANSFORM_PATH_SCALAR:
+		return("scalar");
+	case TRANSFORM_PATH_SSE2:
+		return("SSE2");
+	case TRANSFORM_PATH_AVX2:
+		return("AVX2");
+	default:
+		return("auto");
+	}
+}
+
+/***********************************************************
+ *  IsPathSupported()
+ *
+ *  This method is used for checking whether the running
+ *  processor can execute the passed in kernel.
+ ***********************************************************/
+bool TransformBatch::IsPathSupported(TRANSFORM_PATH transformPath)
+{
+	switch (transformPath)
+	{
+	case TRANSFORM_PATH_SCALAR:
+		return(true);
+#if defined(SIMD_X86)
+	case TRANSFORM_PATH_SSE2:
+		return(CpuFeatures::HasSSE2());
+	case TRANSFORM_PATH_AVX2:
+		return(CpuFeatures::HasAVX2());
+#endif
+	default:
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  ComposeMatrix()
+ *
+ *  This method is used for writing out the product
+ *  translation * Rz * Ry * Rx * scale directly.  Column j
+ *  of the rotation is scaled by the scale on axis j and the
+ *  position becomes the last column.
+ ***********************************************************/
+glm::mat4 TransformBatch::ComposeMatrix(
+	const glm::vec3& position,
+	const glm::vec3& rotationDegrees,
+	const glm::vec3& scale)
+{
+	float sa = std::sin(rotationDegrees.x * g_DegreesToRadians);
+	float ca = std::cos(rotationDegrees.x * g_DegreesToRadians);
+	float sb = std::sin(rotationDegrees.y * g_DegreesToRadians);
+	float cb = std::cos(rotationDegrees.y * g_DegreesToRadians);
+	float sc = std::sin(rotationDegrees.z * g_DegreesToRadians);
+	float cc = std::cos(rotationDegrees.z * g_DegreesToRadians);
+	glm::mat4 matrix;
+
+	matrix[0] = glm::vec4(cc * cb, sc * cb, -sb, 0.0f) * scale.x;
+	matrix[1] = glm::vec4(cc * sb * sa - sc * ca, sc * sb * sa + cc * ca, cb * sa, 0.0f) * scale.y;
+	matrix[2] = glm::vec4(cc * sb * ca + sc * sa, sc * sb * ca - cc * sa, cb * ca, 0.0f) * scale.z;
+	matrix[3] = glm::vec4(position, 1.0f);
+
+	return(matrix);
+}
+
+/***********************************************************
+ *  ComputeScalar()
+ *
+ *  This method is used for composing the matrices one at a
+ *  time from the stored components.
+ ***********************************************************/
+void TransformBatch::ComputeScalar(uint32_t first, uint32_t last, glm::mat4* pMatrices) const
+{
+	for (uint32_t i = first; i < last; i++)
+	{
+		float sa = std::sin(m_rotationX[i]);
+		float ca = std::cos(m_rotationX[i]);
+		float sb = std::sin(m_rotationY[i]);
+		float cb = std::cos(m_rotationY[i]);
+		float sc = std::sin(m_rotationZ[i]);
+		float cc = std::cos(m_rotationZ[i]);
+		glm::mat4& matrix = pMatrices[i];
+
+		matrix[0] = glm::vec4(cc * cb, sc * cb, -sb, 0.0f) * m_scaleX[i];
+		matrix[1] = glm::vec4(cc * sb * sa - sc * ca, sc * sb * sa + cc * ca, cb * sa, 0.0f) * m_scaleY[i];
+		matrix[2] = glm::vec4(cc * sb * ca + sc * sa, sc * sb * ca - cc * sa, cb * ca, 0.0f) * m_scaleZ[i];
+		matrix[3] = glm::vec4(m_positionX[i], m_positionY[i], m_positionZ[i], 1.0f);
+	}
+}
+
+/***********************************************************
+ *  ComputeSSE2()
+ *
+ *  This method is used for composing four matrices per loop
+ *  iteration.  Each register holds one matrix element of
+ *  four objects, and every column is transposed back into
+ *  the four column-major matrices before it is stored.
+ ***********************************************************/
+void TransformBatch::ComputeSSE2(uint32_t first, uint32_t last, glm::mat4* pMatrices) const
+{
+#if defined(SIMD_X86)
+	uint32_t i = first;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 sa, ca, sb, cb, sc, cc;
+		SinCosSSE2(_mm_loadu_ps(&m_rotationX[i]), sa, ca);
+		SinCosSSE2(_mm_loadu_ps(&m_rotationY[i]), sb, cb);
+		SinCosSSE2(_mm_loadu_ps(&m_rotationZ[i]), sc, cc);
+		__m128 scaleX = _mm_loadu_ps(&m_scaleX[i]);
+		__m128 scaleY = _mm_loadu_ps(&m_scaleY[i]);
+		__m128 scaleZ = _mm_loadu_ps(&m_scaleZ[i]);
+
+		__m128 ccsb = _mm_mul_ps(cc, sb);
+		__m128 scsb = _mm_mul_ps(sc, sb);
+
+		// columns of the four matrices, element by element
+		__m128 column[4][4];
+		column[0][0] = _mm_mul_ps(_mm_mul_ps(cc, cb), scaleX);
+		column[0][1] = _mm_mul_ps(_mm_mul_ps(sc, cb), scaleX);
+		column[0][2] = _mm_mul_ps(_mm_sub_ps(zero, sb), scaleX);
+		column[0][3] = zero;
+		column[1][0] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ccsb, sa), _mm_mul_ps(sc, ca)), scaleY);
+		column[1][1] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(scsb, sa), _mm_mul_ps(cc, ca)), scaleY);
+		column[1][2] = _mm_mul_ps(_mm_mul_ps(cb, sa), scaleY);
+		column[1][3] = zero;
+		column[2][0] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ccsb, ca), _mm_mul_ps(sc, sa)), scaleZ);
+		column[2][1] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(scsb, ca), _mm_mul_ps(cc, sa)), scaleZ);
+		column[2][2] = _mm_mul_ps(_mm_mul_ps(cb, ca), scaleZ);
+		column[2][3] = zero;
+		column[3][0] = _mm_loadu_ps(&m_positionX[i]);
+		column[3][1] = _mm_loadu_ps(&m_positionY[i]);
+		column[3][2] = _mm_loadu_ps(&m_positionZ[i]);
+		column[3][3] = one;
+
+		for (int c = 0; c < 4; c++)
+		{
+			_MM_TRANSPOSE4_PS(column[c][0], column[c][1], column[c][2], column[c][3]);
+			_mm_storeu_ps(&pMatrices[i + 0][c][0], column[c][0]);
+			_mm_storeu_ps(&pMatrices[i + 1][c][0], column[c][1]);
+			_mm_storeu_ps(&pMatrices[i + 2][c][0], column[c][2]);
+			_mm_storeu_ps(&pMatrices[i + 3][c][0], column[c][3]);
+		}
+	}
+
+	// the remaining transforms that do not fill a full group
+	ComputeScalar(i, last, pMatrices);
+#else
+	ComputeScalar(first, last, pMatrices);
+#endif
+}
+
+/***********************************************************
+ *  ComputeAVX2()
+ *
+ *  This method is used for composing eight matrices per
+ *  loop iteration.  The transpose works within each 128-bit
+ *  half, so the low half of a result holds the column of
+ *  object k and the high half the column of object k + 4.
+ ***********************************************************/
+#if defined(SIMD_X86)
+SIMD_TARGET_AVX2
+#endif
+void TransformBatch::ComputeAVX2(uint32_t first, uint32_t last, glm::mat4* pMatrices) const
+{
+#if defined(SIMD_X86)
+	uint32_t i = first;
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	for (; i + 8 <= last; i += 8)
+	{
+		__m256 sa, ca, sb, cb, sc, cc;
+		SinCosAVX2(_mm256_loadu_ps(&m_rotationX[i]), sa, ca);
+		SinCosAVX2(_mm256_loadu_ps(&m_rotationY[i]), sb, cb);
+		SinCosAVX2(_mm256_loadu_ps(&m_rotationZ[i]), sc, cc);
+		__m256 scaleX = _mm256_loadu_ps(&m_scaleX[i]);
+		__m256 scaleY = _mm256_loadu_ps(&m_scaleY[i]);
+		__m256 scaleZ = _mm256_loadu_ps(&m_scaleZ[i]);
+
+		__m256 ccsb = _mm256_mul_ps(cc, sb);
+		__m256 scsb = _mm256_mul_ps(sc, sb);
+
+		__m256 column[4][4];
+		column[0][0] = _mm256_mul_ps(_mm256_mul_ps(cc, cb), scaleX);
+		column[0][1] = _mm256_mul_ps(_mm256_mul_ps(sc, cb), scaleX);
+		column[0][2] = _mm256_mul_ps(_mm256_sub_ps(zero, sb), scaleX);
+		column[0][3] = zero;
+		column[1][0] = _mm256_mul_ps(_mm256_fmsub_ps(ccsb, sa, _mm256_mul_ps(sc, ca)), scaleY);
+		column[1][1] = _mm256_mul_ps(_mm256_fmadd_ps(scsb, sa, _mm256_mul_ps(cc, ca)), scaleY);
+		column[1][2] = _mm256_mul_ps(_mm256_mul_ps(cb, sa), scaleY);
+		column[1][3] = zero;
+		column[2][0] = _mm256_mul_ps(_mm256_fmadd_ps(ccsb, ca, _mm256_mul_ps(sc, sa)), scaleZ);
+		column[2][1] = _mm256_mul_ps(_mm256_fmsub_ps(scsb, ca, _mm256_mul_ps(cc, sa)), scaleZ);
+		column[2][2] = _mm256_mul_ps(_mm256_mul_ps(cb, ca), scaleZ);
+		column[2][3] = zero;
+		column[3][0] = _mm256_loadu_ps(&m_positionX[i]);
+		column[3][1] = _mm256_loadu_ps(&m_positionY[i]);
+		column[3][2] = _mm256_loadu_ps(&m_positionZ[i]);
+		column[3][3] = one;
+
+		for (int c = 0; c < 4; c++)
+		{
+			__m256 t0 = _mm256_unpacklo_ps(column[c][0], column[c][1]);
+			__m256 t1 = _mm256_unpackhi_ps(column[c][0], column[c][1]);
+			__m256 t2 = _mm256_unpacklo_ps(column[c][2], column[c][3]);
+			__m256 t3 = _mm256_unpackhi_ps(column[c][2], column[c][3]);
+			__m256 o0 = _mm256_shuffle_ps(t0, t2, 0x44);
+			__m256 o1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+			__m256 o2 = _mm256_shuffle_ps(t1, t3, 0x44);
+			__m256 o3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+
+			_mm_storeu_ps(&pMatrices[i + 0][c][0], _mm256_castps256_ps128(o0));
+			_mm_storeu_ps(&pMatrices[i + 1][c][0], _mm256_castps256_ps128(o1));
+			_mm_storeu_ps(&pMatrices[i + 2][c][0], _mm256_castps256_ps128(o2));
+			_mm_storeu_ps(&pMatrices[i + 3][c][0], _mm256_castps256_ps128(o3));
+			_mm_storeu_ps(&pMatrices[i + 4][c][0], _mm256_extractf128_ps(o0, 1));
+			_mm_storeu_ps(&pMatrices[i + 5][c][0], _mm256_extractf128_ps(o1, 1));
+			_mm_storeu_ps(&pMatrices[i + 6][c][0], _mm256_extractf128_ps(o2, 1));
+			_mm_storeu_ps(&pMatrices[i + 7][c][0], _mm256_extractf128_ps(o3, 1));
+		}
+	}
+
+	// the remaining transforms go through the SSE2 kernel
+	ComputeSSE2(i, last, pMatrices);
+#else
+	ComputeScalar(first, last, pMatrices);
+#endif
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// batched composition of world matrices from position, rotation and scale -
+// SoA transform storage with SSE2 / AVX2 kernels selected at runtime and a
+// scalar fallback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class contains the position, Euler rotation and
+ *  scale of many objects stored as separate arrays per
+ *  component, and composes their column-major world
+ *  matrices 4 (SSE2) or 8 (AVX2) at a time.  The matrices
+ *  match SetTransformations(), translation * rotation Z *
+ *  rotation Y * rotation X * scale, and the sine and cosine
+ *  of the three angles are evaluated together for a whole
+ *  group instead of one call per axis and object.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+	// destructor
+	~TransformBatch();
+
+	// available composition kernels
+	enum TRANSFORM_PATH
+	{
+		TRANSFORM_PATH_AUTO = 0,
+		TRANSFORM_PATH_SCALAR,
+		TRANSFORM_PATH_SSE2,
+		TRANSFORM_PATH_AVX2
+	};
+
+	// remove all the stored transforms
+	void Clear();
+	// reserve storage for the passed in number of transforms
+	void Reserve(size_t count);
+	// add a transform, the rotation is in degrees around the
+	// X, Y and Z axes, and the returned index is the position
+	// of its matrix in the output
+	uint32_t Add(
+		const glm::vec3& position,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& scale);
+	// replace a previously added transform
+	void Set(
+		uint32_t index,
+		const glm::vec3& position,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& scale);
+	// number of stored transforms
+	size_t GetCount() const { return m_positionX.size(); }
+
+	// compose the world matrices of all the stored transforms,
+	// the list is resized to the transform count
+	void ComputeMatrices(
+		std::vector<glm::mat4>& matrices,
+		TRANSFORM_PATH transformPath = TRANSFORM_PATH_AUTO) const;
+	// compose the world matrices of the transforms in
+	// [first, last) into the passed in array
+	void ComputeMatrices(
+		uint32_t first,
+		uint32_t last,
+		glm::mat4* pMatrices,
+		TRANSFORM_PATH transformPath = TRANSFORM_PATH_AUTO) const;
+
+	// the kernel used when TRANSFORM_PATH_AUTO is requested
+	TRANSFORM_PATH GetAutoPath() const { return m_autoPath; }
+	// readable name of a composition kernel
+	static const char* GetPathName(TRANSFORM_PATH transformPath);
+	// whether the running processor supports a kernel
+	static bool IsPathSupported(TRANSFORM_PATH transformPath);
+
+	// compose one world matrix with the same formula as the
+	// kernels, without any glm matrix products
+	static glm::mat4 ComposeMatrix(
+		const glm::vec3& position,
+		const glm::vec3& rotationDegrees,
+		const glm::vec3& scale);
+
+private:
+	// transforms stored as one array per component, with the
+	// rotations already converted to radians
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+
+	// kernel chosen from the detected instruction sets
+	TRANSFORM_PATH m_autoPath;
+
+	// composition kernels - each writes the matrices of the
+	// transforms in [first, last) starting at pMatrices[first]
+	void ComputeScalar(uint32_t first, uint32_t last, glm::mat4* pMatrices) const;
+	void ComputeSSE2(uint32_t first, uint32_t last, glm::mat4* pMatrices) const;
+	void ComputeAVX2(uint32_t first, uint32_t last, glm::mat4* pMatrices) const;
+};
@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformhierarchy.cpp
+// ============
+// parent / child transform hierarchy stored as flat arrays in depth-first
+// order, so the world matrices are updated in one linear pass that skips
+// the branches where nothing changed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformHierarchy.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  TransformHierarchy()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+/***********************************************************
+ *  ~TransformHierarchy()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformHierarchy::~TransformHierarchy()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all the nodes.
+ ***********************************************************/
+void TransformHierarchy::Clear()
+{
+	m_parents.clear();
+	m_subtreeEnds.clear();
+	m_localMatrices.clear();
+	m_scales.clear();
+	m_worldMatrices.clear();
+	m_modelMatrices.clear();
+	m_flags.clear();
+	m_recomputed.clear();
+	m_changedNodes.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for reserving the storage of every
+ *  node array.
+ ***********************************************************/
+void TransformHierarchy::Reserve(size_t count)
+{
+	m_parents.reserve(count);
+	m_subtreeEnds.reserve(count);
+	m_localMatrices.reserve(count);
+	m_scales.reserve(count);
+	m_worldMatrices.reserve(count);
+	m_modelMatrices.reserve(count);
+	m_flags.reserve(count);
+	m_recomputed.reserve(count);
+	m_changedNodes.reserve(count);
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for appending a node.  Only the last
+ *  node and its ancestors can take a new child, which keeps
+ *  every subtree contiguous, and the subtree ranges of the
+ *  ancestors are extended to include the new node.
+ ***********************************************************/
+int32_t TransformHierarchy::AddNode(
+	int32_t parentIndex,
+	const glm::mat4& localMatrix,
+	const glm::vec3& scale)
+{
+	int32_t index = (int32_t)m_parents.size();
+
+	if (parentIndex != NO_PARENT)
+	{
+		// the parent has to be on the chain from the last node
+		// up to its root
+		int32_t ancestor = index - 1;
+		while ((ancestor != NO_PARENT) && (ancestor != parentIndex))
+		{
+			ancestor = m_parents[ancestor];
+		}
+		if (ancestor == NO_PARENT)
+		{
+			std::cout << "ERROR: Transform node " << parentIndex
+				<< " cannot take a child after its subtree is closed" << std::endl;
+			return(NO_PARENT);
+		}
+	}
+
+	m_parents.push_back(parentIndex);
+	m_subtreeEnds.push_back((uint32_t)index + 1);
+	m_localMatrices.push_back(localMatrix);
+	m_scales.push_back(scale);
+	m_worldMatrices.push_back(glm::mat4(1.0f));
+	m_modelMatrices.push_back(glm::mat4(1.0f));
+	m_flags.push_back(0);
+	m_recomputed.push_back(0);
+
+	for (int32_t ancestor = parentIndex; ancestor != NO_PARENT; ancestor = m_parents[ancestor])
+	{
+		m_subtreeEnds[ancestor] = (uint32_t)index + 1;
+	}
+
+	MarkDirty((uint32_t)index);
+	return(index);
+}
+
+/***********************************************************
+ *  SetLocalTransform()
+ *
+ *  This method is used for replacing the local matrix and
+ *  scale of a node.
+ ***********************************************************/
+void TransformHierarchy::SetLocalTransform(
+	uint32_t index,
+	const glm::mat4& localMatrix,
+	const glm::vec3& scale)
+{
+	if (index < m_parents.size())
+	{
+		m_localMatrices[index] = localMatrix;
+		m_scales[index] = scale;
+		MarkDirty(index);
+	}
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method is used for flagging a changed node and its
+ *  ancestors.  The walk up stops at the first ancestor that
+ *  is already flagged, since the ones above it are too.
+ ***********************************************************/
+void TransformHierarchy::MarkDirty(uint32_t index)
+{
+	m_flags[index] |= NODE_DIRTY;
+
+	int32_t ancestor = m_parents[index];
+	while ((ancestor != NO_PARENT) && ((m_flags[ancestor] & NODE_CHILD_DIRTY) == 0))
+	{
+		m_flags[ancestor] |= NODE_CHILD_DIRTY;
+		ancestor = m_parents[ancestor];
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for recomputing the matrices in one
+ *  pass over the arrays.  Parents come before children, so
+ *  a parent's world matrix is always final when its
+ *  children are reached.  A node that is clean, has no
+ *  changed descendant and whose parent was not recomputed
+ *  is skipped together with its whole subtree.
+ ***********************************************************/
+size_t TransformHierarchy::Update()
+{
+	uint32_t count = (uint32_t)m_parents.size();
+	uint32_t index = 0;
+
+	m_changedNodes.clear();
+
+	while (index < count)
+	{
+		int32_t parent = m_parents[index];
+		bool bParentRecomputed = (parent != NO_PARENT) && (m_recomputed[parent] != 0);
+
+		if ((m_flags[index] == 0) && (bParentRecomputed == false))
+		{
+			index = m_subtreeEnds[index];
+			continue;
+		}
+
+		bool bRecompute = ((m_flags[index] & NODE_DIRTY) != 0) || (bParentRecomputed == true);
+		if (bRecompute == true)
+		{
+			glm::mat4& world = m_worldMatrices[index];
+			glm::mat4& model = m_modelMatrices[index];
+			const glm::vec3& scale = m_scales[index];
+
+			if (parent == NO_PARENT)
+			{
+				world = m_localMatrices[index];
+			}
+			else
+			{
+				world = m_worldMatrices[parent] * m_localMatrices[index];
+			}
+
+			// the scale only stretches the node's own axes
+			model[0] = world[0] * scale.x;
+			model[1] = world[1] * scale.y;
+			model[2] = world[2] * scale.z;
+			model[3] = world[3];
+
+			m_changedNodes.push_back(index);
+		}
+
+		m_recomputed[index] = bRecompute ? 1 : 0;
+		m_flags[index] = 0;
+		index++;
+	}
+
+	return(m_changedNodes.size());
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformhierarchy.h
+// ============
+// parent / child transform hierarchy stored as flat arrays in depth-first
+// order, so the world matrices are updated in one linear pass that skips
+// the branches where nothing changed
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TransformHierarchy
+ *
+ *  This class contains a forest of transform nodes.  Every
+ *  node is stored after its parent and the descendants of a
+ *  node follow it directly, so each subtree is one range of
+ *  the arrays.  A node's world matrix is its parent's world
+ *  matrix times its local matrix, while its scale is only
+ *  applied to its own model matrix, so a child is not
+ *  stretched by the scale of the mesh it is attached to.
+ ***********************************************************/
+class TransformHierarchy
+{
+public:
+	// constructor
+	TransformHierarchy();
+	// destructor
+	~TransformHierarchy();
+
+	// parent index of the nodes without a parent
+	static const int32_t NO_PARENT = -1;
+
+	// remove all the nodes
+	void Clear();
+	// reserve storage for the passed in number of nodes
+	void Reserve(size_t count);
+	// add a node below the passed in parent, which has to be
+	// the last added node or one of its ancestors so the
+	// order stays depth-first, returns the node index or
+	// NO_PARENT when the parent is not valid
+	int32_t AddNode(
+		int32_t parentIndex,
+		const glm::mat4& localMatrix,
+		const glm::vec3& scale);
+	// replace the local matrix and scale of a node, which is
+	// applied to the node and its subtree by the next update
+	void SetLocalTransform(
+		uint32_t index,
+		const glm::mat4& localMatrix,
+		const glm::vec3& scale);
+
+	// recompute the matrices of the changed nodes and their
+	// descendants, returns the number of recomputed nodes
+	size_t Update();
+	// indices of the nodes recomputed by the last update
+	const std::vector<uint32_t>& GetChangedNodes() const { return m_changedNodes; }
+
+	// number of stored nodes
+	size_t GetCount() const { return m_parents.size(); }
+	// parent of a node, NO_PARENT for a root
+	int32_t GetParent(uint32_t index) const { return m_parents[index]; }
+	// one past the last node of the subtree starting at a node
+	uint32_t GetSubtreeEnd(uint32_t index) const { return m_subtreeEnds[index]; }
+	// world matrix inherited by the children of a node
+	const glm::mat4& GetWorldMatrix(uint32_t index) const { return m_worldMatrices[index]; }
+	// world matrix with the node's own scale applied
+	const glm::mat4& GetModelMatrix(uint32_t index) const { return m_modelMatrices[index]; }
+
+private:
+	// node state flags
+	enum NODE_FLAGS
+	{
+		// the local transform of the node changed
+		NODE_DIRTY = 1,
+		// a node below this one changed
+		NODE_CHILD_DIRTY = 2
+	};
+
+	std::vector<int32_t> m_parents;
+	std::vector<uint32_t> m_subtreeEnds;
+	std::vector<glm::mat4> m_localMatrices;
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::mat4> m_worldMatrices;
+	std::vector<glm::mat4> m_modelMatrices;
+	std::vector<uint8_t> m_flags;
+	// whether each visited node was recomputed in the update
+	// that is running, read back by its children
+	std::vector<uint8_t> m_recomputed;
+	std::vector<uint32_t> m_changedNodes;
+
+	// flag a node as changed and its ancestors as having a
+	// changed descendant
+	void MarkDirty(uint32_t index);
+};
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "HeadlessContext.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderManager* pShaderManager);
+	// destructor
+	~ViewManager();
+
+	// mouse position callback for mouse interaction with the 3D scene
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// context and frame buffer when rendering without a window
+	HeadlessContext m_headlessContext;
+	// view and projection matrices of the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	// whether occlusion culling with hardware queries is enabled
+	bool m_bOcclusionQueries;
+	// whether occlusion culling on the CPU is enabled
+	bool m_bSoftwareOcclusion;
+	// whether the cylinders use screen size based LOD
+	bool m_bMeshLOD;
+	// whether the scene is drawn with multi-draw indirect calls
+	bool m_bMultiDraw;
+	// whether the scene is culled with compute shaders
+	bool m_bGpuCulling;
+	// number of frames in the pipeline, 1 builds every frame
+	// on the render thread
+	int m_frameQueueDepth;
+
+	// process keyboard events for interaction with the 3D scene
+	void ProcessKeyboardEvents();
+	// check whether a key went down since the previous check
+	bool WasKeyPressed(int key);
+
+public:
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	// create the OpenGL context for rendering offscreen without
+	// a window, the camera is then only moved by SetCameraPose()
+	bool CreateOffscreenView();
+	// create the frame buffer of the offscreen view, once
+	// OpenGL is initialized
+	bool CreateOffscreenTarget();
+	// wait for the offscreen frame and save it as an image
+	void FinishOffscreenFrame();
+	bool SaveOffscreenImage(const char* filename);
+
+	// place the camera and point it in a direction
+	void SetCameraPose(const glm::vec3& position, const glm::vec3& front);
+	
+	// prepare the conversion from 3D object display to 2D scene display
+	void PrepareSceneView();
+
+	// get the view and projection matrices of the current frame
+	const glm::mat4& GetViewMatrix() const { return m_viewMatrix; }
+	const glm::mat4& GetProjectionMatrix() const { return m_projectionMatrix; }
+
+	// get the render toggles set from the keyboard
+	bool IsOcclusionQueriesEnabled() const { return m_bOcclusionQueries; }
+	bool IsSoftwareOcclusionEnabled() const { return m_bSoftwareOcclusion; }
+	bool IsMeshLODEnabled() const { return m_bMeshLOD; }
+	bool IsMultiDrawEnabled() const { return m_bMultiDraw; }
+	bool IsGpuCullingEnabled() const { return m_bGpuCulling; }
+	int GetFrameQueueDepth() const { return m_frameQueueDepth; }
+};
\ No newline at end of file
@@ -0,0 +1,179 @@
+#version 450 core
+// one invocation per scene object - tests the object's bounds against
+// the view frustum and last frame's depth pyramid, picks a mesh range
+// by screen size, and appends a draw command to the object's bucket
+layout(local_size_x = 64) in;
+
+struct ObjectBounds {
+    vec4 center;
+    vec4 extents;
+    uint firstRange;
+    uint rangeCount;
+    uint bucket;
+    uint padding;
+};
+
+struct MeshRange {
+    uint firstIndex;
+    uint indexCount;
+    int baseVertex;
+    uint padding;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 2) readonly buffer BoundsBuffer {
+    ObjectBounds bounds[];
+};
+layout(std430, binding = 3) readonly buffer RangeBuffer {
+    MeshRange ranges[];
+};
+layout(std430, binding = 4) readonly buffer BucketStartBuffer {
+    uint bucketStarts[];
+};
+layout(std430, binding = 5) writeonly buffer CommandBuffer {
+    DrawCommand commands[];
+};
+layout(std430, binding = 6) buffer CountBuffer {
+    uint counts[];
+};
+
+uniform uint objectCount;
+// normalized planes with the normals pointing inside
+uniform vec4 frustumPlanes[6];
+uniform mat4 view;
+uniform mat4 projection;
+// smallest screen size of each mesh range but the last
+uniform vec3 lodThresholds;
+uniform bool bUseLOD = false;
+// farthest depth pyramid of the previous frame
+uniform bool bUseDepthPyramid = false;
+uniform sampler2D depthPyramid;
+uniform vec2 pyramidSize;
+uniform int pyramidLevelCount;
+
+// test the box against every plane of the frustum
+bool IsInsideFrustum(vec3 center, vec3 extents)
+{
+    for(int i = 0; i < 6; i++)
+    {
+        vec4 plane = frustumPlanes[i];
+        if(dot(plane.xyz, center) + plane.w + dot(abs(plane.xyz), extents) < 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// projected diameter of the bounding sphere as a fraction of the
+// viewport height, the same as LODSelector::GetScreenSize()
+float GetScreenSize(vec3 center, float radius)
+{
+    float scale = projection[1][1];
+    if(projection[3][3] != 0.0)
+    {
+        return radius * scale;
+    }
+
+    float depth = -(view * vec4(center, 1.0)).z;
+    if(depth <= radius)
+    {
+        return 2.0;
+    }
+    return radius * scale / depth;
+}
+
+// finest mesh range whose threshold the screen size still reaches
+uint SelectRange(uint rangeCount, float screenSize)
+{
+    uint level = 0u;
+    while((level + 1u < rangeCount) && (level < 3u) && (screenSize < lodThresholds[level]))
+    {
+        level++;
+    }
+    return level;
+}
+
+// compare the nearest depth of the box with the farthest depth of
+// the pyramid texels covering it, at the level where the box spans
+// at most one texel so four samples are enough
+bool IsHiddenByPyramid(vec3 center, vec3 extents)
+{
+    mat4 viewProjection = projection * view;
+    vec2 ndcMin = vec2(1.0);
+    vec2 ndcMax = vec2(-1.0);
+    float nearestDepth = 1.0;
+
+    for(int i = 0; i < 8; i++)
+    {
+        vec3 corner = center + extents * vec3(
+            ((i & 1) != 0) ? 1.0 : -1.0,
+            ((i & 2) != 0) ? 1.0 : -1.0,
+            ((i & 4) != 0) ? 1.0 : -1.0);
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+        // boxes reaching behind the near plane cannot be tested
+        if(clip.w <= 0.0001)
+        {
+            return false;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc.xy);
+        ndcMax = max(ndcMax, ndc.xy);
+        nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+    }
+
+    vec2 uvMin = clamp(ndcMin * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(ndcMax * 0.5 + 0.5, 0.0, 1.0);
+    vec2 size = (uvMax - uvMin) * pyramidSize;
+    float level = ceil(log2(max(max(size.x, size.y), 1.0)));
+    level = clamp(level, 0.0, float(pyramidLevelCount - 1));
+
+    float farthest = max(
+        max(textureLod(depthPyramid, uvMin, level).r,
+            textureLod(depthPyramid, vec2(uvMax.x, uvMin.y), level).r),
+        max(textureLod(depthPyramid, vec2(uvMin.x, uvMax.y), level).r,
+            textureLod(depthPyramid, uvMax, level).r));
+    return nearestDepth > farthest;
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if(index >= objectCount)
+    {
+        return;
+    }
+
+    ObjectBounds object = bounds[index];
+    if(object.rangeCount == 0u)
+    {
+        return;
+    }
+    if(IsInsideFrustum(object.center.xyz, object.extents.xyz) == false)
+    {
+        return;
+    }
+    if((bUseDepthPyramid == true) && (IsHiddenByPyramid(object.center.xyz, object.extents.xyz) == true))
+    {
+        return;
+    }
+
+    uint level = 0u;
+    if(bUseLOD == true)
+    {
+        level = SelectRange(object.rangeCount, GetScreenSize(object.center.xyz, length(object.extents.xyz)));
+    }
+    MeshRange range = ranges[object.firstRange + level];
+
+    // the base instance tells the draw shaders which object's
+    // draw record to read
+    uint slot = bucketStarts[object.bucket] + atomicAdd(counts[object.bucket], 1u);
+    commands[slot] = DrawCommand(range.indexCount, 1u, range.firstIndex, range.baseVertex, index);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#version 450 core
+// builds one level of the depth pyramid - level 0 copies the depth
+// buffer, and every texel of the other levels keeps the farthest
+// depth of the texels it covers in the level below
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D sourceDepth;
+uniform int sourceLevel;
+uniform ivec2 sourceSize;
+uniform ivec2 targetSize;
+uniform bool bCopyLevel = false;
+layout(r32f, binding = 0) uniform writeonly image2D targetLevel;
+
+void main()
+{
+    ivec2 target = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(target, targetSize)))
+    {
+        return;
+    }
+
+    if(bCopyLevel == true)
+    {
+        imageStore(targetLevel, target, vec4(texelFetch(sourceDepth, target, 0).r));
+        return;
+    }
+
+    // with an odd source size the last texel also covers the
+    // row or column that has no pair
+    ivec2 first = target * 2;
+    ivec2 last = first + ivec2(1) + ivec2(equal(target, targetSize - 1)) * (sourceSize & 1);
+    last = min(last, sourceSize - 1);
+
+    float farthest = 0.0;
+    for(int y = first.y; y <= last.y; y++)
+    {
+        for(int x = first.x; x <= last.x; x++)
+        {
+            farthest = max(farthest, texelFetch(sourceDepth, ivec2(x, y), sourceLevel).r);
+        }
+    }
+    imageStore(targetLevel, target, vec4(farthest));
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+#version 450 core
+out vec4 fragmentColor;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in int fragmentDrawIndex;
+
+struct Material {
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+}; 
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+
+#define TOTAL_POINT_LIGHTS 5
+
+uniform bool bUseTexture=false;
+uniform bool bUseLighting=false;
+uniform vec4 objectColor = vec4(1.0f);
+uniform vec3 viewPosition;
+uniform DirectionalLight directionalLight;
+uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
+uniform SpotLight spotLight;
+uniform Material material;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+
+// per draw values written by the CPU into a ring buffer, used
+// instead of the uniforms above when bUseDrawData is set
+#define TOTAL_DRAW_TEXTURES 8
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec2 uvScale;
+    int materialIndex;
+    int textureSlot;
+    uint flags;
+};
+
+struct MaterialData {
+    vec4 diffuseColor;
+    // specular color in xyz and shininess in w
+    vec4 specularColor;
+};
+
+layout(std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData drawData[];
+};
+layout(std430, binding = 1) readonly buffer MaterialBuffer {
+    MaterialData materials[];
+};
+
+uniform bool bUseDrawData = false;
+uniform sampler2D objectTextures[TOTAL_DRAW_TEXTURES];
+
+// values of the current draw from either source
+vec4 drawColor;
+bool bDrawTexture;
+int drawTextureSlot;
+vec2 drawUVScale;
+Material drawMaterial;
+
+// function prototypes
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec4 SampleObjectTexture(vec2 textureCoordinate);
+
+void main()
+{    
+    if(bUseDrawData == true)
+    {
+        DrawData current = drawData[fragmentDrawIndex];
+        MaterialData currentMaterial = materials[current.materialIndex];
+        drawColor = current.color;
+        bDrawTexture = (current.textureSlot >= 0);
+        drawTextureSlot = current.textureSlot;
+        drawUVScale = current.uvScale;
+        drawMaterial.diffuseColor = currentMaterial.diffuseColor.xyz;
+        drawMaterial.specularColor = currentMaterial.specularColor.xyz;
+        drawMaterial.shininess = currentMaterial.specularColor.w;
+    }
+    else
+    {
+        drawColor = objectColor;
+        bDrawTexture = bUseTexture;
+        drawTextureSlot = 0;
+        drawUVScale = UVscale;
+        drawMaterial = material;
+    }
+
+    if(bUseLighting == true)
+    {
+        vec3 phongResult = vec3(0.0f);
+        // properties
+        vec3 norm = normalize(fragmentVertexNormal);
+        vec3 viewDir = normalize(viewPosition - fragmentPosition);
+    
+        // == =====================================================
+        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+        // For each phase, a calculate function is defined that calculates the corresponding color
+        // per light source. In the main() function we take all the calculated colors and sum them 
+        // up for this fragment's final color.
+        // == =====================================================
+        // phase 1: directional lighting
+        if(directionalLight.bActive == true)
+        {
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
+        }
+        // phase 2: point lights
+        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+        {
+	    if(pointLights[i].bActive == true)
+            {
+                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
+            }
+        } 
+        // phase 3: spot light
+        if(spotLight.bActive == true)
+        {
+            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir);    
+        }
+    
+        if(bDrawTexture == true)
+        {
+            fragmentColor = vec4(phongResult, (SampleObjectTexture(fragmentTextureCoordinate)).a);
+        }
+        else
+        {
+            fragmentColor = vec4(phongResult, drawColor.a);
+        }
+    }
+    else
+    {
+        if(bDrawTexture == true)
+        {
+            fragmentColor = SampleObjectTexture(fragmentTextureCoordinate * drawUVScale);
+        }
+        else
+        {
+            fragmentColor = drawColor;
+        }
+    }
+}
+
+// calculates the color when using a directional light.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), drawMaterial.shininess);
+    // combine results
+    if(bDrawTexture == true)
+    {
+        ambient = light.ambient * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        specular = light.specular * spec * drawMaterial.specularColor * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+    }
+    else
+    {
+        ambient = light.ambient * vec3(drawColor);
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(drawColor);
+        specular = light.specular * spec * drawMaterial.specularColor * vec3(drawColor);
+    }
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular= vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), drawMaterial.shininess);
+   
+    // combine results
+    if(bDrawTexture == true)
+    {
+        ambient = light.ambient * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        specular = light.specular * specularComponent * drawMaterial.specularColor;
+    }
+    else
+    {
+        ambient = light.ambient * vec3(drawColor);
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(drawColor);
+        specular = light.specular * specularComponent * drawMaterial.specularColor;
+    }
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), drawMaterial.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    if(bDrawTexture == true)
+    {
+        ambient = light.ambient * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+        specular = light.specular * spec * drawMaterial.specularColor * vec3(SampleObjectTexture(fragmentTextureCoordinate));
+    }
+    else
+    {
+        ambient = light.ambient * vec3(drawColor);
+        diffuse = light.diffuse * diff * drawMaterial.diffuseColor * vec3(drawColor);
+        specular = light.specular * spec * drawMaterial.specularColor * vec3(drawColor);
+    }
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+// samples the texture of the current draw - the slot is the same
+// for the whole draw, and multi-draw calls are split by texture,
+// so indexing the sampler array is allowed
+vec4 SampleObjectTexture(vec2 textureCoordinate)
+{
+    if(bUseDrawData == true)
+    {
+        return texture(objectTextures[drawTextureSlot], textureCoordinate);
+    }
+    return texture(objectTexture, textureCoordinate);
+}
@@ -0,0 +1,29 @@
+#version 450 core
+out vec4 fragmentColor;
+
+in vec3 skyDirection;
+
+uniform vec3 horizonColor;
+uniform vec3 zenithColor;
+uniform bool bUseSkyTexture = false;
+uniform sampler2D skyTexture;
+
+void main()
+{
+    vec3 direction = normalize(skyDirection);
+    float elevation = clamp(direction.y, -1.0, 1.0);
+
+    if(bUseSkyTexture == true)
+    {
+        // wrap the texture around the camera like the inside of a
+        // cylinder - the angle jumps from 1 to 0 behind the camera,
+        // so the top level is sampled to keep that seam invisible
+        float u = atan(direction.z, direction.x) / 6.28318530718 + 0.5;
+        float v = elevation * 0.5 + 0.5;
+        fragmentColor = vec4(textureLod(skyTexture, vec2(u, v), 0.0).rgb, 1.0);
+    }
+    else
+    {
+        fragmentColor = vec4(mix(horizonColor, zenithColor, sqrt(max(elevation, 0.0))), 1.0);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 450 core
+// one triangle covering the screen at the far plane, with the view
+// direction of each corner interpolated for the fragment shader
+out vec3 skyDirection;
+
+// inverse of the projection times the view without translation
+uniform mat4 inverseViewProjection;
+
+void main()
+{
+   // vertices 0, 1 and 2 land on (-1, -1), (3, -1) and (-1, 3)
+   vec2 position = vec2((gl_VertexID == 1) ? 3.0 : -1.0, (gl_VertexID == 2) ? 3.0 : -1.0);
+   vec4 farPoint = inverseViewProjection * vec4(position, 1.0, 1.0);
+
+   skyDirection = farPoint.xyz / farPoint.w;
+   gl_Position = vec4(position, 1.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#version 450 core
+// the draw index of a multi-draw command is in gl_BaseInstance
+#extension GL_ARB_shader_draw_parameters : enable
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+// draw data index of this draw for the fragment shader
+flat out int fragmentDrawIndex;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+// packed meshes store the normal octahedral encoded in x and y
+uniform bool bUsePackedNormal = false;
+
+// per draw values written by the CPU into a ring buffer, used
+// instead of the model and bUsePackedNormal uniforms when
+// bUseDrawData is set
+#define DRAW_FLAG_PACKED_NORMAL 1u
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+    vec2 uvScale;
+    int materialIndex;
+    int textureSlot;
+    uint flags;
+};
+
+layout(std430, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData drawData[];
+};
+
+uniform bool bUseDrawData = false;
+// multi-draw indirect commands carry the index of their draw
+// data in the base instance, which is added to this uniform
+uniform int drawIndex = 0;
+
+// reverse the octahedral mapping of a normal
+vec3 DecodeOctahedral(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   if (normal.z < 0.0)
+   {
+      vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+      normal.xy = (1.0 - abs(normal.yx)) * signs;
+   }
+   return normalize(normal);
+}
+
+void main()
+{
+   mat4 objectModel = model;
+   bool bPackedNormal = bUsePackedNormal;
+#ifdef GL_ARB_shader_draw_parameters
+   int index = drawIndex + gl_BaseInstanceARB;
+#else
+   // without the extension nothing is drawn with multi-draw,
+   // so the uniform holds the whole index
+   int index = drawIndex;
+#endif
+   if (bUseDrawData == true)
+   {
+      objectModel = drawData[index].model;
+      bPackedNormal = ((drawData[index].flags & DRAW_FLAG_PACKED_NORMAL) != 0u);
+   }
+   fragmentDrawIndex = index;
+
+   fragmentPosition = vec3(objectModel * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * objectModel * vec4(inVertexPosition, 1.0f);
+   if (bPackedNormal == true)
+      fragmentVertexNormal = DecodeOctahedral(inVertexNormal.xy);
+   else
+      fragmentVertexNormal = inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+}
\ No newline at end of file